@@ -24,6 +24,21 @@
 a lot of data that needs to be copied, this should be set high. */
 #define MEM_SIZE                (10240)
 
+/* LWIP_AL_HEAP==1: take the lwIP heap from al_heap_malloc() of alumy.c
+   instead of the MEM_SIZE pool, so lwIP allocates from the slab set by
+   al_heap_set_slab() like mbedtls and cJSON, or from al_os_malloc()
+   without one. */
+#ifndef LWIP_AL_HEAP
+#define LWIP_AL_HEAP            0
+#endif
+
+#if LWIP_AL_HEAP
+#define MEM_LIBC_MALLOC         1
+#define mem_clib_malloc         al_heap_malloc
+#define mem_clib_calloc         al_heap_calloc
+#define mem_clib_free           al_heap_free
+#endif
+
 /* MEMP_NUM_PBUF: the number of memp struct pbufs. If the application
    sends a lot of data out of ROM (or other static memory), this
    should be set high. */
@@ -56,6 +56,8 @@
 #define MBEDTLS_BASE64_C
 #define MBEDTLS_BIGNUM_C
 #define MBEDTLS_CCM_C
+#define MBEDTLS_CHACHA20_C
+#define MBEDTLS_CHACHAPOLY_C
 #define MBEDTLS_CIPHER_C
 #define MBEDTLS_ECDSA_C
 #define MBEDTLS_ECP_C
@@ -69,6 +71,7 @@
 #define MBEDTLS_PK_PARSE_C
 #define MBEDTLS_PK_WRITE_C
 #define MBEDTLS_PLATFORM_C
+#define MBEDTLS_POLY1305_C
 #define MBEDTLS_RSA_C
 /* The library does not currently support enabling SHA-224 without SHA-256.
  * A future version of the library will have this option disabled
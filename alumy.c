@@ -5,6 +5,7 @@
 #include "alumy/errno.h"
 #include "alumy/time.h"
 #include "alumy/osal.h"
+#include "alumy/slab.h"
 #include "alumy/cJSON.h"
 #include "mbedtls/aes.h"
 #include "mbedtls/cipher.h"
@@ -14,15 +15,41 @@
 __BEGIN_DECLS
 
 static uint32_t initialized = 0;
+static al_slab_t *heap_slab = NULL;
+
+void al_heap_set_slab(al_slab_t *slab)
+{
+	heap_slab = slab;
+}
+
+void *al_heap_malloc(size_t size)
+{
+	return heap_slab ? al_slab_malloc(heap_slab, size) : al_os_malloc(size);
+}
+
+void *al_heap_calloc(size_t nmemb, size_t size)
+{
+	return heap_slab ? al_slab_calloc(heap_slab, nmemb, size) :
+					   al_os_calloc(nmemb, size);
+}
+
+void al_heap_free(void *p)
+{
+	if (heap_slab) {
+		al_slab_free(heap_slab, p);
+	} else {
+		al_os_free(p);
+	}
+}
 
 static void *__mbedtls_calloc(size_t n, size_t size)
 {
-	return al_os_malloc(n * size);
+	return al_heap_calloc(n, size);
 }
 
 static void __mbedtls_free(void *p)
 {
-	al_os_free(p);
+	al_heap_free(p);
 }
 
 static void __putc(void *p, char c)
@@ -35,8 +62,8 @@ static void __putc(void *p, char c)
 __static_inline__ int32_t __al_init(void)
 {
 	cJSON_Hooks cjson_hooks = {
-		.malloc_fn = al_os_malloc,
-		.free_fn = al_os_free,
+		.malloc_fn = al_heap_malloc,
+		.free_fn = al_heap_free,
 	};
 
     init_printf(NULL, __putc);
@@ -168,9 +168,6 @@ int Base64decode(char *bufplain, const char *bufcoded)
     return nbytesdecoded;
 }
 
-static const char basis_64[] =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
 int Base64encode_len(int len)
 {
     return ((len + 2) / 3 * 4) + 1;
@@ -178,32 +175,18 @@ int Base64encode_len(int len)
 
 int Base64encode(char *encoded, const char *string, int len)
 {
-    int i;
-    char *p;
-
-    p = encoded;
-    for (i = 0; i < len - 2; i += 3) {
-    *p++ = basis_64[(string[i] >> 2) & 0x3F];
-    *p++ = basis_64[((string[i] & 0x3) << 4) |
-                    ((int) (string[i + 1] & 0xF0) >> 4)];
-    *p++ = basis_64[((string[i + 1] & 0xF) << 2) |
-                    ((int) (string[i + 2] & 0xC0) >> 6)];
-    *p++ = basis_64[string[i + 2] & 0x3F];
-    }
-    if (i < len) {
-    *p++ = basis_64[(string[i] >> 2) & 0x3F];
-    if (i == (len - 1)) {
-        *p++ = basis_64[((string[i] & 0x3) << 4)];
-        *p++ = '=';
-    }
-    else {
-        *p++ = basis_64[((string[i] & 0x3) << 4) |
-                        ((int) (string[i + 1] & 0xF0) >> 4)];
-        *p++ = basis_64[((string[i + 1] & 0xF) << 2)];
+    ssize_t n;
+
+    if (len < 0) {
+        return -1;
     }
-    *p++ = '=';
+
+    /* same output, through the vectorised encoder of codec.c */
+    n = al_base64_encode(encoded, Base64encode_len(len), string, len);
+    if (n < 0) {
+        return -1;
     }
 
-    *p++ = '\0';
-    return p - encoded;
+    encoded[n] = '\0';
+    return n + 1;
 }
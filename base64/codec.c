@@ -0,0 +1,625 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/base64.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BASE64_X86		1
+#else
+#define BASE64_X86		0
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BASE64_NEON		1
+#else
+#define BASE64_NEON		0
+#endif
+
+__BEGIN_DECLS
+
+/*
+ * A kernel handles the bulk of the data, both calls work on a prefix of
+ * whole groups and return the input consumed, the scalar code finishes
+ * the rest. dec stops early at a character outside the alphabet.
+ */
+typedef struct base64_kernel {
+	size_t (*enc)(char *dst, const uint8_t *src, size_t len);
+	size_t (*dec)(uint8_t *dst, size_t dstsz, const uint8_t *src, size_t len);
+} base64_kernel_t;
+
+static const char base64_enc_table[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* 0xff marks characters outside the alphabet */
+static const uint8_t base64_dec_table[256] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+	0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+static size_t base64_enc_scalar(char *dst, const uint8_t *src, size_t len)
+{
+	size_t i;
+	uint32_t v;
+
+	for (i = 0; i + 3 <= len; i += 3) {
+		v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+
+		*dst++ = base64_enc_table[(v >> 18) & 0x3f];
+		*dst++ = base64_enc_table[(v >> 12) & 0x3f];
+		*dst++ = base64_enc_table[(v >> 6) & 0x3f];
+		*dst++ = base64_enc_table[v & 0x3f];
+	}
+
+	return i;
+}
+
+static size_t base64_dec_scalar(uint8_t *dst, size_t dstsz,
+								const uint8_t *src, size_t len)
+{
+	size_t i;
+	uint32_t a, b, c, d;
+
+	UNUSED(dstsz);
+
+	for (i = 0; i + 4 <= len; i += 4) {
+		a = base64_dec_table[src[i]];
+		b = base64_dec_table[src[i + 1]];
+		c = base64_dec_table[src[i + 2]];
+		d = base64_dec_table[src[i + 3]];
+
+		if ((a | b | c | d) & 0x80) {
+			break;
+		}
+
+		a = (a << 18) | (b << 12) | (c << 6) | d;
+
+		*dst++ = a >> 16;
+		*dst++ = a >> 8;
+		*dst++ = a;
+	}
+
+	return i;
+}
+
+static const base64_kernel_t base64_scalar = {
+	.enc = base64_enc_scalar,
+	.dec = base64_dec_scalar,
+};
+
+#if BASE64_X86
+/*
+ * Both x86 kernels follow W. Mula and D. Lemire, "Faster Base64 Encoding
+ * and Decoding Using AVX2 Instructions": the 6-bit fields are split with
+ * multiplies, mapped to ASCII by one pshufb of per-range offsets, and
+ * decoding validates every character with two nibble lookups.
+ */
+#define BASE64_X86_ENC_SPLIT(in, set1, and, mulhi, mullo, or)				\
+	or(mulhi(and(in, set1(0x0fc0fc00)), set1(0x04000040)),				\
+	   mullo(and(in, set1(0x003f03f0)), set1(0x01000010)))
+
+__attribute__((target("ssse3")))
+static __m128i base64_ssse3_enc_lookup(__m128i idx)
+{
+	const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	__m128i r;
+
+	r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+	r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx),
+									  _mm_set1_epi8(13)));
+
+	return _mm_add_epi8(_mm_shuffle_epi8(shift, r), idx);
+}
+
+__attribute__((target("ssse3")))
+static size_t base64_enc_ssse3(char *dst, const uint8_t *src, size_t len)
+{
+	const __m128i shuf = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+									  4, 5, 3, 4, 1, 2, 0, 1);
+	__m128i in;
+	size_t i;
+
+	/* 16 bytes are loaded for the 12 used */
+	for (i = 0; i + 16 <= len; i += 12, dst += 16) {
+		in = _mm_loadu_si128((const __m128i *)(src + i));
+		in = _mm_shuffle_epi8(in, shuf);
+		in = BASE64_X86_ENC_SPLIT(in, _mm_set1_epi32, _mm_and_si128,
+								  _mm_mulhi_epu16, _mm_mullo_epi16,
+								  _mm_or_si128);
+		_mm_storeu_si128((__m128i *)dst, base64_ssse3_enc_lookup(in));
+	}
+
+	return i;
+}
+
+#define BASE64_X86_LUT_LO	0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, \
+							0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+#define BASE64_X86_LUT_HI	0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, \
+							0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+#define BASE64_X86_LUT_ROLL	0, 16, 19, 4, -65, -65, -71, -71, \
+							0, 0, 0, 0, 0, 0, 0, 0
+#define BASE64_X86_PACK		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+__attribute__((target("ssse3")))
+static size_t base64_dec_ssse3(uint8_t *dst, size_t dstsz,
+							   const uint8_t *src, size_t len)
+{
+	const __m128i lut_lo = _mm_setr_epi8(BASE64_X86_LUT_LO);
+	const __m128i lut_hi = _mm_setr_epi8(BASE64_X86_LUT_HI);
+	const __m128i lut_roll = _mm_setr_epi8(BASE64_X86_LUT_ROLL);
+	const __m128i pack = _mm_setr_epi8(BASE64_X86_PACK);
+	const __m128i mask = _mm_set1_epi8(0x2f);
+	__m128i in, lo, hi, roll;
+	size_t i, o = 0;
+
+	/* 16 bytes are stored for the 12 produced */
+	for (i = 0; (i + 16 <= len) && (o + 16 <= dstsz); i += 16, o += 12) {
+		in = _mm_loadu_si128((const __m128i *)(src + i));
+		hi = _mm_and_si128(_mm_srli_epi32(in, 4), mask);
+		lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(in, mask));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(
+					_mm_and_si128(lo, _mm_shuffle_epi8(lut_hi, hi)),
+					_mm_setzero_si128())) != 0xffff) {
+			break;
+		}
+
+		roll = _mm_add_epi8(_mm_cmpeq_epi8(in, mask), hi);
+		in = _mm_add_epi8(in, _mm_shuffle_epi8(lut_roll, roll));
+
+		in = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+		in = _mm_madd_epi16(in, _mm_set1_epi32(0x00011000));
+		_mm_storeu_si128((__m128i *)(dst + o), _mm_shuffle_epi8(in, pack));
+	}
+
+	return i;
+}
+
+static const base64_kernel_t base64_ssse3 = {
+	.enc = base64_enc_ssse3,
+	.dec = base64_dec_ssse3,
+};
+
+__attribute__((target("avx2")))
+static size_t base64_enc_avx2(char *dst, const uint8_t *src, size_t len)
+{
+	const __m256i shuf = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+										 4, 5, 3, 4, 1, 2, 0, 1,
+										 10, 11, 9, 10, 7, 8, 6, 7,
+										 4, 5, 3, 4, 1, 2, 0, 1);
+	const __m256i shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+		'a' - 26, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	__m256i in, r;
+	size_t i;
+
+	/* every lane takes 12 bytes, the second load reads 4 past them */
+	for (i = 0; i + 28 <= len; i += 24, dst += 32) {
+		in = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(src + i)));
+		in = _mm256_inserti128_si256(in,
+				_mm_loadu_si128((const __m128i *)(src + i + 12)), 1);
+		in = _mm256_shuffle_epi8(in, shuf);
+		in = BASE64_X86_ENC_SPLIT(in, _mm256_set1_epi32, _mm256_and_si256,
+								  _mm256_mulhi_epu16, _mm256_mullo_epi16,
+								  _mm256_or_si256);
+
+		r = _mm256_subs_epu8(in, _mm256_set1_epi8(51));
+		r = _mm256_or_si256(r, _mm256_and_si256(
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(26), in),
+				_mm256_set1_epi8(13)));
+		r = _mm256_add_epi8(_mm256_shuffle_epi8(shift, r), in);
+
+		_mm256_storeu_si256((__m256i *)dst, r);
+	}
+
+	return i + base64_enc_ssse3(dst, src + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static size_t base64_dec_avx2(uint8_t *dst, size_t dstsz,
+							  const uint8_t *src, size_t len)
+{
+	const __m256i lut_lo = _mm256_setr_epi8(BASE64_X86_LUT_LO, BASE64_X86_LUT_LO);
+	const __m256i lut_hi = _mm256_setr_epi8(BASE64_X86_LUT_HI, BASE64_X86_LUT_HI);
+	const __m256i lut_roll = _mm256_setr_epi8(BASE64_X86_LUT_ROLL,
+											  BASE64_X86_LUT_ROLL);
+	const __m256i pack = _mm256_setr_epi8(BASE64_X86_PACK, BASE64_X86_PACK);
+	const __m256i mask = _mm256_set1_epi8(0x2f);
+	__m256i in, lo, hi, roll;
+	size_t i, o = 0;
+
+	/* 32 bytes are stored for the 24 produced */
+	for (i = 0; (i + 32 <= len) && (o + 32 <= dstsz); i += 32, o += 24) {
+		in = _mm256_loadu_si256((const __m256i *)(src + i));
+		hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+		lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(in, mask));
+
+		if (!_mm256_testz_si256(lo, _mm256_shuffle_epi8(lut_hi, hi))) {
+			break;
+		}
+
+		roll = _mm256_add_epi8(_mm256_cmpeq_epi8(in, mask), hi);
+		in = _mm256_add_epi8(in, _mm256_shuffle_epi8(lut_roll, roll));
+
+		in = _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+		in = _mm256_madd_epi16(in, _mm256_set1_epi32(0x00011000));
+		in = _mm256_shuffle_epi8(in, pack);
+		in = _mm256_permutevar8x32_epi32(in,
+				_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+		_mm256_storeu_si256((__m256i *)(dst + o), in);
+	}
+
+	return i + base64_dec_ssse3(dst + o, dstsz - o, src + i, len - i);
+}
+
+static const base64_kernel_t base64_avx2 = {
+	.enc = base64_enc_avx2,
+	.dec = base64_dec_avx2,
+};
+#endif
+
+#if BASE64_NEON
+/* value + 1 of the first 128 characters, 0 outside the alphabet */
+static const uint8_t base64_neon_dec_table[128] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 63, 0, 0, 0, 64,
+	53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 0, 0, 0, 0, 0, 0,
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 0, 0, 0, 0, 0,
+	0, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41,
+	42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 0, 0, 0, 0, 0,
+};
+
+static uint8x16x4_t base64_neon_table(const uint8_t *t)
+{
+	uint8x16x4_t v;
+
+	v.val[0] = vld1q_u8(t);
+	v.val[1] = vld1q_u8(t + 16);
+	v.val[2] = vld1q_u8(t + 32);
+	v.val[3] = vld1q_u8(t + 48);
+
+	return v;
+}
+
+static size_t base64_enc_neon(char *dst, const uint8_t *src, size_t len)
+{
+	const uint8x16x4_t tbl = base64_neon_table((const uint8_t *)base64_enc_table);
+	const uint8x16_t m = vdupq_n_u8(0x3f);
+	uint8x16x3_t in;
+	uint8x16x4_t out;
+	size_t i;
+
+	for (i = 0; i + 48 <= len; i += 48, dst += 64) {
+		in = vld3q_u8(src + i);
+
+		out.val[0] = vshrq_n_u8(in.val[0], 2);
+		out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4),
+									   vshrq_n_u8(in.val[1], 4)), m);
+		out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2),
+									   vshrq_n_u8(in.val[2], 6)), m);
+		out.val[3] = vandq_u8(in.val[2], m);
+
+		out.val[0] = vqtbl4q_u8(tbl, out.val[0]);
+		out.val[1] = vqtbl4q_u8(tbl, out.val[1]);
+		out.val[2] = vqtbl4q_u8(tbl, out.val[2]);
+		out.val[3] = vqtbl4q_u8(tbl, out.val[3]);
+
+		vst4q_u8((uint8_t *)dst, out);
+	}
+
+	return i;
+}
+
+static size_t base64_dec_neon(uint8_t *dst, size_t dstsz,
+							  const uint8_t *src, size_t len)
+{
+	const uint8x16x4_t lo = base64_neon_table(base64_neon_dec_table);
+	const uint8x16x4_t hi = base64_neon_table(base64_neon_dec_table + 64);
+	const uint8x16_t k64 = vdupq_n_u8(64);
+	const uint8x16_t one = vdupq_n_u8(1);
+	uint8x16x4_t in;
+	uint8x16x3_t out;
+	uint8x16_t bad;
+	size_t i, o = 0;
+	int_t k;
+
+	for (i = 0; (i + 64 <= len) && (o + 48 <= dstsz); i += 64, o += 48) {
+		in = vld4q_u8(src + i);
+		bad = vdupq_n_u8(0);
+
+		/* characters of 128 and up miss both tables and stay 0 */
+		for (k = 0; k < 4; k++) {
+			in.val[k] = vqtbx4q_u8(vqtbl4q_u8(lo, in.val[k]), hi,
+								   vsubq_u8(in.val[k], k64));
+			bad = vorrq_u8(bad, vceqq_u8(in.val[k], vdupq_n_u8(0)));
+			in.val[k] = vsubq_u8(in.val[k], one);
+		}
+
+		if (vmaxvq_u8(bad) != 0) {
+			break;
+		}
+
+		out.val[0] = vorrq_u8(vshlq_n_u8(in.val[0], 2), vshrq_n_u8(in.val[1], 4));
+		out.val[1] = vorrq_u8(vshlq_n_u8(in.val[1], 4), vshrq_n_u8(in.val[2], 2));
+		out.val[2] = vorrq_u8(vshlq_n_u8(in.val[2], 6), in.val[3]);
+
+		vst3q_u8(dst + o, out);
+	}
+
+	return i;
+}
+
+static const base64_kernel_t base64_neon = {
+	.enc = base64_enc_neon,
+	.dec = base64_dec_neon,
+};
+#endif
+
+static const base64_kernel_t *base64_kernel = NULL;
+static al_base64_impl_t base64_impl = AL_BASE64_IMPL_AUTO;
+
+static const base64_kernel_t *base64_lookup(al_base64_impl_t impl)
+{
+	switch (impl) {
+	case AL_BASE64_IMPL_SCALAR:
+		return &base64_scalar;
+#if BASE64_X86
+	case AL_BASE64_IMPL_SSSE3:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3") ? &base64_ssse3 : NULL;
+	case AL_BASE64_IMPL_AVX2:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? &base64_avx2 : NULL;
+#endif
+#if BASE64_NEON
+	case AL_BASE64_IMPL_NEON:
+		return &base64_neon;
+#endif
+	default:
+		return NULL;
+	}
+}
+
+int32_t al_base64_set_impl(al_base64_impl_t impl)
+{
+	static const al_base64_impl_t order[] = {
+		AL_BASE64_IMPL_AVX2, AL_BASE64_IMPL_SSSE3, AL_BASE64_IMPL_NEON,
+		AL_BASE64_IMPL_SCALAR,
+	};
+	const base64_kernel_t *k = NULL;
+	int_t i;
+
+	if (impl == AL_BASE64_IMPL_AUTO) {
+		for (i = 0; (k == NULL) && (i < ARRAY_SIZE(order)); i++) {
+			k = base64_lookup(order[i]);
+			impl = order[i];
+		}
+	} else {
+		k = base64_lookup(impl);
+	}
+
+	if (k == NULL) {
+		set_errno(ENOTSUP);
+		return -1;
+	}
+
+	base64_impl = impl;
+	__atomic_store_n(&base64_kernel, k, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+al_base64_impl_t al_base64_get_impl(void)
+{
+	if (__atomic_load_n(&base64_kernel, __ATOMIC_ACQUIRE) == NULL) {
+		al_base64_set_impl(AL_BASE64_IMPL_AUTO);
+	}
+
+	return base64_impl;
+}
+
+static const base64_kernel_t *base64_get_kernel(void)
+{
+	const base64_kernel_t *k = __atomic_load_n(&base64_kernel, __ATOMIC_ACQUIRE);
+
+	if (k == NULL) {
+		/* first call picks the fastest kernel of this cpu */
+		al_base64_set_impl(AL_BASE64_IMPL_AUTO);
+		k = base64_kernel;
+	}
+
+	return k;
+}
+
+size_t al_base64_encode_len(size_t len)
+{
+	return (len + 2) / 3 * 4;
+}
+
+size_t al_base64_decode_len(const char *src, size_t len)
+{
+	size_t n = len;
+
+	if ((n >= 4) && ((n & 3) == 0)) {
+		n -= (src[n - 1] == '=');
+		n -= (src[n - 1] == '=');
+	}
+
+	return n / 4 * 3 + (((n & 3) > 1) ? (n & 3) - 1 : 0);
+}
+
+/* the 2 or 4 characters of the last 1 or 2 bytes, padded */
+static void base64_enc_tail(char *dst, const uint8_t *src, size_t len)
+{
+	uint32_t v = (uint32_t)src[0] << 16;
+
+	if (len > 1) {
+		v |= (uint32_t)src[1] << 8;
+	}
+
+	dst[0] = base64_enc_table[(v >> 18) & 0x3f];
+	dst[1] = base64_enc_table[(v >> 12) & 0x3f];
+	dst[2] = (len > 1) ? base64_enc_table[(v >> 6) & 0x3f] : '=';
+	dst[3] = '=';
+}
+
+static size_t base64_enc_groups(char *dst, const uint8_t *src, size_t len)
+{
+	size_t n = base64_get_kernel()->enc(dst, src, len);
+
+	return n + base64_enc_scalar(dst + n / 3 * 4, src + n, len - n);
+}
+
+ssize_t al_base64_encode(char *dst, size_t dstsz, const void *src, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)src;
+	size_t n;
+
+	AL_CHECK_RET((dst != NULL) && ((src != NULL) || (len == 0)), EINVAL, -1);
+	AL_CHECK_RET(dstsz >= al_base64_encode_len(len), ENOBUFS, -1);
+
+	n = base64_enc_groups(dst, p, len);
+
+	if (n < len) {
+		base64_enc_tail(dst + n / 3 * 4, p + n, len - n);
+	}
+
+	return al_base64_encode_len(len);
+}
+
+ssize_t al_base64_decode(void *dst, size_t dstsz, const char *src, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)src;
+	uint8_t *o = (uint8_t *)dst;
+	size_t out, full, n;
+	uint32_t v, c;
+
+	AL_CHECK_RET((dst != NULL) || (len == 0), EINVAL, -1);
+	AL_CHECK_RET((src != NULL) || (len == 0), EINVAL, -1);
+
+	out = al_base64_decode_len(src, len);
+	AL_CHECK_RET(out <= dstsz, ENOBUFS, -1);
+
+	if ((len >= 4) && ((len & 3) == 0)) {
+		len -= (p[len - 1] == '=');
+		len -= (p[len - 1] == '=');
+	}
+
+	AL_CHECK_RET((len & 3) != 1, EINVAL, -1);
+
+	full = len & ~(size_t)3;
+
+	n = base64_get_kernel()->dec(o, dstsz, p, full);
+	n += base64_dec_scalar(o + n / 4 * 3, dstsz - n / 4 * 3, p + n, full - n);
+
+	AL_CHECK_RET(n == full, EINVAL, -1);
+
+	/* the unpadded remainder of 2 or 3 characters */
+	if (len > full) {
+		v = 0;
+
+		for (n = full; n < len; n++) {
+			c = base64_dec_table[p[n]];
+			AL_CHECK_RET(c < 64, EINVAL, -1);
+			v = (v << 6) | c;
+		}
+
+		if (len - full == 2) {
+			o[out - 1] = v >> 4;
+		} else {
+			o[out - 2] = v >> 10;
+			o[out - 1] = v >> 2;
+		}
+	}
+
+	return out;
+}
+
+void al_base64_enc_init(al_base64_enc_t *ctx)
+{
+	ctx->ntail = 0;
+}
+
+ssize_t al_base64_enc_update(al_base64_enc_t *ctx, char *dst, size_t dstsz,
+							 const void *src, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)src;
+	uint8_t grp[3];
+	size_t need, n, w = 0;
+
+	AL_CHECK_RET((ctx != NULL) && ((src != NULL) || (len == 0)), EINVAL, -1);
+
+	need = (ctx->ntail + len) / 3 * 4;
+	AL_CHECK_RET((dst != NULL) || (need == 0), EINVAL, -1);
+	AL_CHECK_RET(need <= dstsz, ENOBUFS, -1);
+
+	if (ctx->ntail + len < 3) {
+		memcpy(ctx->tail + ctx->ntail, p, len);
+		ctx->ntail += len;
+		return 0;
+	}
+
+	/* complete the group left over by the previous call */
+	if (ctx->ntail > 0) {
+		n = 3 - ctx->ntail;
+		memcpy(grp, ctx->tail, ctx->ntail);
+		memcpy(grp + ctx->ntail, p, n);
+		base64_enc_scalar(dst, grp, 3);
+		ctx->ntail = 0;
+		p += n;
+		len -= n;
+		w = 4;
+	}
+
+	n = base64_enc_groups(dst + w, p, len);
+	w += n / 3 * 4;
+
+	ctx->ntail = len - n;
+	memcpy(ctx->tail, p + n, ctx->ntail);
+
+	return w;
+}
+
+ssize_t al_base64_enc_final(al_base64_enc_t *ctx, char *dst, size_t dstsz)
+{
+	AL_CHECK_RET(ctx != NULL, EINVAL, -1);
+
+	if (ctx->ntail == 0) {
+		return 0;
+	}
+
+	AL_CHECK_RET((dst != NULL) && (dstsz >= 4), ENOBUFS, -1);
+
+	base64_enc_tail(dst, ctx->tail, ctx->ntail);
+	ctx->ntail = 0;
+
+	return 4;
+}
+
+__END_DECLS
+
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+static uint8_t b64_raw[3072];
+static char b64_text[4096 + 1];
+
+static void bench_base64_encode(al_bench_t *b, al_base64_impl_t impl)
+{
+	/* a kernel this cpu or build lacks is skipped */
+	if (al_base64_set_impl(impl) != 0) {
+		return;
+	}
+
+	memset(b64_raw, 0x5A, sizeof(b64_raw));
+	al_bench_bytes(b, sizeof(b64_raw));
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(al_base64_encode(b64_text, sizeof(b64_text),
+									   b64_raw, sizeof(b64_raw)));
+	}
+
+	al_base64_set_impl(AL_BASE64_IMPL_AUTO);
+}
+
+static void bench_base64_decode(al_bench_t *b, al_base64_impl_t impl)
+{
+	ssize_t len;
+
+	if (al_base64_set_impl(impl) != 0) {
+		return;
+	}
+
+	memset(b64_raw, 0x5A, sizeof(b64_raw));
+	len = al_base64_encode(b64_text, sizeof(b64_text), b64_raw, sizeof(b64_raw));
+	al_bench_bytes(b, len);
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(al_base64_decode(b64_raw, sizeof(b64_raw), b64_text, len));
+	}
+
+	al_base64_set_impl(AL_BASE64_IMPL_AUTO);
+}
+
+/* 3 KiB of data encode to 4 KiB of text */
+#define BENCH_BASE64(impl, name)										\
+	static void bench_base64_encode_##name##3k(al_bench_t *b)			\
+	{																	\
+		bench_base64_encode(b, AL_BASE64_IMPL_##impl);					\
+	}																	\
+	AL_BENCH(base64_encode_##name##3k, bench_base64_encode_##name##3k);	\
+																		\
+	static void bench_base64_decode_##name##4k(al_bench_t *b)			\
+	{																	\
+		bench_base64_decode(b, AL_BASE64_IMPL_##impl);					\
+	}																	\
+	AL_BENCH(base64_decode_##name##4k, bench_base64_decode_##name##4k)
+
+BENCH_BASE64(AUTO, );
+BENCH_BASE64(SCALAR, scalar_);
+BENCH_BASE64(SSSE3, ssse3_);
+BENCH_BASE64(AVX2, avx2_);
+BENCH_BASE64(NEON, neon_);
+
+__END_DECLS
@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES	1
+#endif
+
+__BEGIN_DECLS
+
+enum {
+	BENCH_START = 0,
+	BENCH_WARMUP,
+	BENCH_MEASURE,
+	BENCH_DONE,
+};
+
+typedef struct bench_result {
+	const char *name;
+	size_t bytes;
+	uint64_t iters;
+	double min, mean, p50, p90, p99;
+	double cyc;
+} bench_result_t;
+
+extern const al_bench_case_t *__start_al_bench[];
+extern const al_bench_case_t *__stop_al_bench[];
+
+static struct {
+	uint64_t sample_ns;
+	uint64_t warmup_ns;
+	int_t samples;
+	const char *filter;
+	const char *json;
+} bench_cfg = {
+	.sample_ns = 2000000,
+	.warmup_ns = 50000000,
+	.samples = 30,
+};
+
+static uint64_t bench_cycles(void)
+{
+#if BENCH_HAS_CYCLES
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+bool_t al_bench_next(al_bench_t *b)
+{
+	uint64_t t = al_tick_get_ns();
+	uint64_t c = bench_cycles();
+	uint64_t dt = t - b->t0;
+
+	switch (b->phase) {
+	case BENCH_START:
+		b->batch = 1;
+		b->warm = t;
+		b->phase = BENCH_WARMUP;
+		break;
+
+	case BENCH_WARMUP:
+		if (dt < b->sample_ns) {
+			/* aim at the sample time, but grow 10 times at most */
+			b->batch = min_t(uint64_t, b->batch * 10,
+							 b->batch * b->sample_ns / max_t(uint64_t, dt, 1) + 1);
+		} else if (t - b->warm >= b->warmup_ns) {
+			b->phase = BENCH_MEASURE;
+		}
+		break;
+
+	case BENCH_MEASURE:
+		b->ns[b->n] = (double)dt / b->batch;
+		b->cyc[b->n] = (double)(c - b->c0) / b->batch;
+		b->iters += b->batch;
+
+		if (++b->n >= b->samples) {
+			b->phase = BENCH_DONE;
+			return false;
+		}
+		break;
+
+	default:
+		return false;
+	}
+
+	b->left = b->batch - 1;
+	b->c0 = bench_cycles();
+	b->t0 = al_tick_get_ns();
+
+	return true;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* nearest rank of the sorted samples */
+static double bench_pct(const double *v, int_t n, int_t pct)
+{
+	int_t i = (pct * n + 99) / 100 - 1;
+
+	return v[max_t(int_t, i, 0)];
+}
+
+static void bench_run(const al_bench_case_t *bc, bench_result_t *r)
+{
+	static al_bench_t b;
+	double sum = 0;
+	int_t i;
+
+	memset(&b, 0, sizeof(b));
+	b.samples = bench_cfg.samples;
+	b.sample_ns = bench_cfg.sample_ns;
+	b.warmup_ns = bench_cfg.warmup_ns;
+
+	bc->func(&b);
+
+	memset(r, 0, sizeof(*r));
+	r->name = bc->name;
+	r->bytes = b.bytes;
+	r->iters = b.iters;
+
+	if (b.n == 0) {
+		return;
+	}
+
+	qsort(b.ns, b.n, sizeof(b.ns[0]), bench_cmp);
+	qsort(b.cyc, b.n, sizeof(b.cyc[0]), bench_cmp);
+
+	for (i = 0; i < b.n; i++) {
+		sum += b.ns[i];
+	}
+
+	r->min = b.ns[0];
+	r->mean = sum / b.n;
+	r->p50 = bench_pct(b.ns, b.n, 50);
+	r->p90 = bench_pct(b.ns, b.n, 90);
+	r->p99 = bench_pct(b.ns, b.n, 99);
+	r->cyc = bench_pct(b.cyc, b.n, 50);
+}
+
+static void bench_print(const bench_result_t *r)
+{
+	/* the benchmark returned without a loop, it can't run here */
+	if (r->iters == 0) {
+		printf("%-28s %10s\n", r->name, "skipped");
+		return;
+	}
+
+	printf("%-28s %10.1f %10.1f %10.1f", r->name, r->p50, r->p90, r->p99);
+
+	if (r->bytes > 0) {
+		printf(" %8.3f %9.1f", r->p50 / r->bytes, r->bytes * 1e3 / r->p50);
+#if BENCH_HAS_CYCLES
+		printf(" %7.2f", r->cyc / r->bytes);
+#endif
+	}
+
+	printf("\n");
+}
+
+static void bench_json(FILE *fp, const bench_result_t *r, bool_t last)
+{
+	fprintf(fp, "    {\"name\": \"%s\", \"bytes\": %lu, \"iterations\": %lu,\n",
+			r->name, (unsigned long)r->bytes, (unsigned long)r->iters);
+	fprintf(fp, "     \"ns_per_op\": {\"min\": %.3f, \"mean\": %.3f, "
+			"\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f}",
+			r->min, r->mean, r->p50, r->p90, r->p99);
+
+	if (r->bytes > 0) {
+		fprintf(fp, ",\n     \"ns_per_byte\": %.4f, \"mb_per_s\": %.2f",
+				r->p50 / r->bytes, r->bytes * 1e3 / r->p50);
+#if BENCH_HAS_CYCLES
+		fprintf(fp, ", \"cycles_per_byte\": %.3f", r->cyc / r->bytes);
+#endif
+	}
+
+	fprintf(fp, "}%s\n", last ? "" : ",");
+}
+
+static void bench_usage(const char *prog)
+{
+	fprintf(stderr,
+			"usage: %s [-q] [-f filter] [-j file]\n"
+			"  -q         quick run, fewer and shorter samples\n"
+			"  -f filter  run the benchmarks whose name contains filter\n"
+			"  -j file    write the results as JSON\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+	const al_bench_case_t **bc;
+	bench_result_t *res;
+	int_t n = 0, i;
+	FILE *fp;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-q") == 0) {
+			bench_cfg.sample_ns = 200000;
+			bench_cfg.warmup_ns = 2000000;
+			bench_cfg.samples = 5;
+		} else if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc)) {
+			bench_cfg.filter = argv[++i];
+		} else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) {
+			bench_cfg.json = argv[++i];
+		} else {
+			bench_usage(argv[0]);
+			return 2;
+		}
+	}
+
+	alumy_init();
+
+	res = (bench_result_t *)calloc(__stop_al_bench - __start_al_bench + 1,
+								   sizeof(*res));
+	if (res == NULL) {
+		return 1;
+	}
+
+	printf("%-28s %10s %10s %10s %8s %9s %7s\n", "benchmark",
+		   "p50 ns", "p90 ns", "p99 ns", "ns/B", "MB/s", "cyc/B");
+
+	for (bc = __start_al_bench; bc < __stop_al_bench; bc++) {
+		if (bench_cfg.filter && (strstr((*bc)->name, bench_cfg.filter) == NULL)) {
+			continue;
+		}
+
+		bench_run(*bc, &res[n]);
+		bench_print(&res[n]);
+		fflush(stdout);
+
+		/* a skipped benchmark has no result */
+		if (res[n].iters > 0) {
+			n++;
+		}
+	}
+
+	if (bench_cfg.json) {
+		fp = fopen(bench_cfg.json, "w");
+		if (fp == NULL) {
+			perror(bench_cfg.json);
+			free(res);
+			return 1;
+		}
+
+		fprintf(fp, "{\n  \"version\": \"%s\",\n  \"git\": \"%s\",\n"
+				"  \"benchmarks\": [\n", al_get_version_s(),
+				al_version_get_git_hash(al_get_version()));
+
+		for (i = 0; i < n; i++) {
+			bench_json(fp, &res[i], i == n - 1);
+		}
+
+		fprintf(fp, "  ]\n}\n");
+		fclose(fp);
+	}
+
+	free(res);
+
+	return 0;
+}
+
+__END_DECLS
@@ -0,0 +1,130 @@
+/**
+ * @file bench.h
+ * @brief Micro benchmark framework of alumy-bench
+ *
+ * A benchmark is a function that runs its operation in a loop:
+ *
+ * @code
+ * static void bench_crc32(al_bench_t *b)
+ * {
+ *     al_bench_bytes(b, sizeof(buf));
+ *
+ *     while (al_bench_loop(b)) {
+ *         al_bench_keep(al_crc32(0, buf, sizeof(buf)));
+ *     }
+ * }
+ * AL_BENCH(crc32_4k, bench_crc32);
+ * @endcode
+ *
+ * The framework decides how often the loop runs: it warms up while it
+ * grows the batch until a batch takes a sample time, then times a number
+ * of batches. The samples give the percentiles of the time per operation,
+ * the throughput and, on x86, the TSC cycles per byte. A benchmark that
+ * can't run on this machine returns without entering the loop and is
+ * reported as skipped.
+ *
+ * alumy-bench is the one place for timings, the unit tests check results
+ * only. Compare two runs saved with -j using tools/bench_compare.py.
+ *
+ * @author Alumy Development Team
+ * @date 2026
+ */
+
+#ifndef __AL_BENCH_H
+#define __AL_BENCH_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+
+__BEGIN_DECLS
+
+/** @brief Most samples of one benchmark */
+#define AL_BENCH_SAMPLES_MAX	100
+
+typedef struct al_bench al_bench_t;
+typedef void (*al_bench_func_t)(al_bench_t *b);
+
+typedef struct al_bench_case {
+	const char *name;
+	al_bench_func_t func;
+} al_bench_case_t;
+
+struct al_bench {
+	uint64_t left;			/* iterations left in the batch */
+	uint64_t batch;
+	uint64_t iters;			/* timed iterations */
+	uint64_t t0;
+	uint64_t c0;
+	uint64_t warm;			/* start of the warmup */
+	int_t phase;
+	int_t n;
+	int_t samples;
+	uint64_t sample_ns;
+	uint64_t warmup_ns;
+	size_t bytes;			/* bytes per operation */
+	double ns[AL_BENCH_SAMPLES_MAX];
+	double cyc[AL_BENCH_SAMPLES_MAX];
+};
+
+/**
+ * @brief Register a benchmark
+ *
+ * @param name The name, a C identifier
+ * @param func The benchmark function
+ */
+#define AL_BENCH(name, func)											\
+	static const al_bench_case_t __bench_case_##name = { #name, func };	\
+	static const al_bench_case_t *__bench_##name __used					\
+	__attribute__((__section__("al_bench"))) = &__bench_case_##name
+
+/**
+ * @brief Set the bytes processed by one operation, for the throughput
+ */
+__static_inline__ void al_bench_bytes(al_bench_t *b, size_t bytes)
+{
+	b->bytes = bytes;
+}
+
+/**
+ * @brief Keep the compiler from optimizing a result away
+ */
+#define al_bench_keep(x)	do {										\
+	__typeof__(x) __bench_v = (x);										\
+	__asm__ __volatile__("" : : "g"(__bench_v) : "memory");			\
+} while (0)
+
+/**
+ * @brief Make the compiler assume that all memory was read and written
+ */
+#define al_bench_clobber()	__asm__ __volatile__("" : : : "memory")
+
+/**
+ * @brief Start the next batch, called by al_bench_loop()
+ *
+ * @param b The benchmark
+ *
+ * @return bool_t true to run one more operation
+ */
+bool_t al_bench_next(al_bench_t *b);
+
+/**
+ * @brief Condition of the benchmark loop
+ *
+ * @param b The benchmark
+ *
+ * @return bool_t true to run one more operation
+ */
+__static_inline__ bool_t al_bench_loop(al_bench_t *b)
+{
+	if (__likely(b->left > 0)) {
+		b->left--;
+		return true;
+	}
+
+	return al_bench_next(b);
+}
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+static uint8_t crc_buf[64 * 1024];
+
+static void bench_crc32(al_bench_t *b, al_crc32_impl_t impl, size_t len)
+{
+	/* an implementation this cpu or build lacks is skipped */
+	if (al_crc32_set_impl(impl) != 0) {
+		return;
+	}
+
+	memset(crc_buf, 0xA5, sizeof(crc_buf));
+	al_bench_bytes(b, len);
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(al_crc32(0, crc_buf, len));
+	}
+
+	al_crc32_set_impl(AL_CRC32_IMPL_AUTO);
+}
+
+#define BENCH_CRC32(impl, name, len)									\
+	static void bench_crc32_##name(al_bench_t *b)						\
+	{																	\
+		bench_crc32(b, AL_CRC32_IMPL_##impl, len);						\
+	}																	\
+	AL_BENCH(crc32_##name, bench_crc32_##name)
+
+BENCH_CRC32(AUTO, 64, 64);
+BENCH_CRC32(AUTO, 4k, 4096);
+BENCH_CRC32(TABLE, table_64, 64);
+BENCH_CRC32(TABLE, table_64k, 65536);
+BENCH_CRC32(SLICE8, slice8_64, 64);
+BENCH_CRC32(SLICE8, slice8_64k, 65536);
+BENCH_CRC32(SLICE16, slice16_64, 64);
+BENCH_CRC32(SLICE16, slice16_64k, 65536);
+BENCH_CRC32(PCLMUL, pclmul_64, 64);
+BENCH_CRC32(PCLMUL, pclmul_64k, 65536);
+BENCH_CRC32(ARMV8, armv8_64, 64);
+BENCH_CRC32(ARMV8, armv8_64k, 65536);
+
+static void bench_crc16_modbus(al_bench_t *b, const al_crc_model_t *m)
+{
+	memset(crc_buf, 0xA5, 256);
+	al_bench_bytes(b, 256);
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(al_crc_calc(m, crc_buf, 256));
+	}
+}
+
+/* the same model without a table, one bit at a time */
+static void bench_crc16_modbus_bitwise(al_bench_t *b)
+{
+	const al_crc_model_t bitwise = {
+		.width = 16, .reflect = true, .poly = 0x8005, .init = 0xFFFF,
+	};
+
+	bench_crc16_modbus(b, &bitwise);
+}
+AL_BENCH(crc16_modbus_bitwise_256, bench_crc16_modbus_bitwise);
+
+static void bench_crc16_modbus_slice(al_bench_t *b)
+{
+	bench_crc16_modbus(b, &al_crc16_modbus_model);
+}
+AL_BENCH(crc16_modbus_slice_256, bench_crc16_modbus_slice);
+
+__END_DECLS
@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+static const uint8_t crypto_key[32] = { 0x2B, 0x7E, 0x15, 0x16 };
+static const uint8_t crypto_iv[16] = { 0xF0, 0xF1, 0xF2, 0xF3 };
+static uint8_t crypto_in[4096];
+static uint8_t crypto_out[4096 + 16];	/* room for the CBC padding */
+
+static void bench_aes_ctr(al_bench_t *b)
+{
+	al_aes_ctx_t ctx;
+
+	al_aes_setkey(&ctx, crypto_key, 16);
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		al_aes_ctr(&ctx, crypto_out, sizeof(crypto_in),
+				   crypto_in, sizeof(crypto_in), crypto_iv);
+		al_bench_clobber();
+	}
+
+	al_aes_free(&ctx);
+}
+AL_BENCH(aes128_ctr_4k, bench_aes_ctr);
+
+static void bench_aes_cbc(al_bench_t *b)
+{
+	al_aes_ctx_t ctx;
+
+	al_aes_setkey(&ctx, crypto_key, 16);
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		al_aes_cbc_enc(&ctx, crypto_out, sizeof(crypto_out),
+					   crypto_in, sizeof(crypto_in), crypto_iv);
+		al_bench_clobber();
+	}
+
+	al_aes_free(&ctx);
+}
+AL_BENCH(aes128_cbc_enc_4k, bench_aes_cbc);
+
+/* a short message, the key schedule expanded per call or once */
+static void bench_aes_cbc_setkey(al_bench_t *b)
+{
+	al_bench_bytes(b, 48);
+
+	while (al_bench_loop(b)) {
+		aes_cbc_enc(crypto_out, sizeof(crypto_out), crypto_in, 48,
+					crypto_key, 16, crypto_iv, 16);
+		al_bench_clobber();
+	}
+}
+AL_BENCH(aes128_cbc_setkey_48, bench_aes_cbc_setkey);
+
+static void bench_aes_cbc_keyed(al_bench_t *b)
+{
+	al_aes_ctx_t ctx;
+
+	al_aes_setkey(&ctx, crypto_key, 16);
+	al_bench_bytes(b, 48);
+
+	while (al_bench_loop(b)) {
+		al_aes_cbc_enc(&ctx, crypto_out, sizeof(crypto_out),
+					   crypto_in, 48, crypto_iv);
+		al_bench_clobber();
+	}
+
+	al_aes_free(&ctx);
+}
+AL_BENCH(aes128_cbc_keyed_48, bench_aes_cbc_keyed);
+
+static void bench_aes_impl(al_bench_t *b, al_aes_impl_t impl, bool_t ctr)
+{
+	al_aes_ctx_t ctx;
+
+	/* an implementation this cpu or build lacks is skipped */
+	if (al_aes_set_impl(impl) != 0) {
+		return;
+	}
+
+	al_aes_setkey(&ctx, crypto_key, 16);
+	al_aes_set_impl(AL_AES_IMPL_AUTO);
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		if (ctr) {
+			al_aes_ctr(&ctx, crypto_out, sizeof(crypto_in),
+					   crypto_in, sizeof(crypto_in), crypto_iv);
+		} else {
+			al_aes_cbc_dec(&ctx, crypto_out, sizeof(crypto_out),
+						   crypto_in, sizeof(crypto_in), crypto_iv, false);
+		}
+		al_bench_clobber();
+	}
+
+	al_aes_free(&ctx);
+}
+
+#define BENCH_AES(impl, name)											\
+	static void bench_aes_ctr_##name(al_bench_t *b)						\
+	{																	\
+		bench_aes_impl(b, AL_AES_IMPL_##impl, true);					\
+	}																	\
+	AL_BENCH(aes128_ctr_##name##_4k, bench_aes_ctr_##name);				\
+																		\
+	static void bench_aes_cbc_dec_##name(al_bench_t *b)					\
+	{																	\
+		bench_aes_impl(b, AL_AES_IMPL_##impl, false);					\
+	}																	\
+	AL_BENCH(aes128_cbc_dec_##name##_4k, bench_aes_cbc_dec_##name)
+
+BENCH_AES(SOFT, soft);
+BENCH_AES(AESNI, aesni);
+
+#define BENCH_AES_BIG		(4 * 1024 * 1024)
+
+/* a 4 MiB CTR stream on the calling thread or split over a pool of 4 */
+static void bench_aes_ctr_big(al_bench_t *b, bool_t parallel)
+{
+	static al_worker_pool_t pool;
+	al_aes_ctx_t ctx;
+	uint8_t *in, *out;
+
+	/* al_worker_pool_init() wants a zeroed pool */
+	memset(&pool, 0, sizeof(pool));
+	in = (uint8_t *)calloc(1, BENCH_AES_BIG);
+	out = (uint8_t *)malloc(BENCH_AES_BIG);
+
+	if ((in == NULL) || (out == NULL) ||
+		(parallel && (al_worker_pool_init(&pool, 4, 64, "aes", 1, 4096) != 0))) {
+		free(in);
+		free(out);
+		return;
+	}
+
+	al_aes_setkey(&ctx, crypto_key, 16);
+	al_bench_bytes(b, BENCH_AES_BIG);
+
+	while (al_bench_loop(b)) {
+		if (parallel) {
+			al_aes_ctr_parallel(&ctx, &pool, out, BENCH_AES_BIG, in,
+								BENCH_AES_BIG, crypto_iv, 0);
+		} else {
+			al_aes_ctr(&ctx, out, BENCH_AES_BIG, in, BENCH_AES_BIG, crypto_iv);
+		}
+		al_bench_clobber();
+	}
+
+	al_aes_free(&ctx);
+
+	if (parallel) {
+		al_worker_pool_deinit(&pool);
+	}
+
+	free(in);
+	free(out);
+}
+
+static void bench_aes_ctr_4m(al_bench_t *b)
+{
+	bench_aes_ctr_big(b, false);
+}
+AL_BENCH(aes128_ctr_4m, bench_aes_ctr_4m);
+
+static void bench_aes_ctr_pool_4m(al_bench_t *b)
+{
+	bench_aes_ctr_big(b, true);
+}
+AL_BENCH(aes128_ctr_pool4_4m, bench_aes_ctr_pool_4m);
+
+static void bench_aead(al_bench_t *b, al_aead_type_t type, size_t keylen)
+{
+	al_aead_ctx_t ctx;
+	uint8_t tag[AL_AEAD_TAG_SIZE];
+
+	al_aead_setkey(&ctx, type, crypto_key, keylen);
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		al_aead_encrypt(&ctx, crypto_iv, AL_AEAD_NONCE_SIZE, NULL, 0,
+						crypto_out, sizeof(crypto_out),
+						crypto_in, sizeof(crypto_in), tag, sizeof(tag));
+		al_bench_clobber();
+	}
+
+	al_aead_free(&ctx);
+}
+
+static void bench_aes_gcm(al_bench_t *b)
+{
+	bench_aead(b, AL_AEAD_AES_GCM, 16);
+}
+AL_BENCH(aes128_gcm_4k, bench_aes_gcm);
+
+static void bench_chachapoly(al_bench_t *b)
+{
+	bench_aead(b, AL_AEAD_CHACHAPOLY, 32);
+}
+AL_BENCH(chachapoly_4k, bench_chachapoly);
+
+/* the two passes AES-CBC then MD5 that one AEAD pass replaces */
+static void bench_aes_cbc_md5(al_bench_t *b)
+{
+	al_aes_ctx_t ctx;
+	al_md5_ctx_t md5;
+	uint8_t digest[16];
+
+	al_aes_setkey(&ctx, crypto_key, 16);
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		al_aes_cbc_enc(&ctx, crypto_out, sizeof(crypto_out),
+					   crypto_in, sizeof(crypto_in), crypto_iv);
+		al_md5_sign(&md5, digest, crypto_out, sizeof(crypto_out));
+		al_bench_clobber();
+	}
+
+	al_aes_free(&ctx);
+}
+AL_BENCH(aes128_cbc_md5_4k, bench_aes_cbc_md5);
+
+static void bench_md5(al_bench_t *b)
+{
+	al_md5_ctx_t ctx;
+	uint8_t digest[16];
+
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		al_md5_init(&ctx);
+		al_md5_update(&ctx, crypto_in, sizeof(crypto_in));
+		al_md5_final(&ctx, digest);
+		al_bench_clobber();
+	}
+}
+AL_BENCH(md5_4k, bench_md5);
+
+/* 16 messages of 256 bytes, one after the other or across the lanes */
+#define BENCH_MD5_MSGS		(sizeof(crypto_in) / 256)
+
+static void bench_md5_msgs(al_bench_t *b)
+{
+	al_md5_ctx_t ctx;
+	uint8_t digest[16];
+	size_t i;
+
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		for (i = 0; i < BENCH_MD5_MSGS; i++) {
+			al_md5_sign(&ctx, digest, crypto_in + i * 256, 256);
+		}
+		al_bench_clobber();
+	}
+}
+AL_BENCH(md5_256x16, bench_md5_msgs);
+
+static void bench_md5_mb(al_bench_t *b)
+{
+	const void *data[BENCH_MD5_MSGS];
+	size_t len[BENCH_MD5_MSGS];
+	uint8_t digest[BENCH_MD5_MSGS][16];
+	size_t i;
+
+	for (i = 0; i < BENCH_MD5_MSGS; i++) {
+		data[i] = crypto_in + i * 256;
+		len[i] = 256;
+	}
+
+	al_bench_bytes(b, sizeof(crypto_in));
+
+	while (al_bench_loop(b)) {
+		al_md5_mb(data, len, digest, BENCH_MD5_MSGS);
+		al_bench_clobber();
+	}
+}
+AL_BENCH(md5_mb_256x16, bench_md5_mb);
+
+__END_DECLS
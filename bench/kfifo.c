@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+static void bench_kfifo_64(al_bench_t *b)
+{
+	static DEFINE_KFIFO(fifo, uint8_t, 1024);
+	uint8_t buf[64];
+
+	memset(buf, 0x33, sizeof(buf));
+	al_bench_bytes(b, sizeof(buf));
+
+	while (al_bench_loop(b)) {
+		kfifo_in(&fifo, buf, sizeof(buf));
+		al_bench_keep(kfifo_out(&fifo, buf, sizeof(buf)));
+	}
+}
+AL_BENCH(kfifo_in_out_64, bench_kfifo_64);
+
+static void bench_kfifo_rec(al_bench_t *b)
+{
+	static struct kfifo_rec_ptr_2 fifo;
+	uint8_t buf[64];
+
+	if (!kfifo_initialized(&fifo) && kfifo_alloc(&fifo, 4096) != 0) {
+		return;
+	}
+
+	memset(buf, 0x33, sizeof(buf));
+	al_bench_bytes(b, sizeof(buf));
+
+	while (al_bench_loop(b)) {
+		kfifo_in(&fifo, buf, sizeof(buf));
+		al_bench_keep(kfifo_out(&fifo, buf, sizeof(buf)));
+	}
+}
+AL_BENCH(kfifo_rec_in_out_64, bench_kfifo_rec);
+
+__END_DECLS
@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+/* the output of the benchmarks is dropped, only the formatting is timed */
+void al_log_write(const void *buf, size_t len)
+{
+	al_bench_keep(buf);
+	al_bench_keep(len);
+}
+
+static void bench_log_bin(al_bench_t *b)
+{
+	static uint8_t data[4096];
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t)(i * 7);
+	}
+
+	al_bench_bytes(b, sizeof(data));
+
+	while (al_bench_loop(b)) {
+		al_log_bin(AL_LOG_DEBUG, AL_LOG_LINE, data, sizeof(data));
+	}
+}
+AL_BENCH(log_bin_4k, bench_log_bin);
+
+__END_DECLS
@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+/* the results are printed by libc, keep tinyprintf under its own names */
+#define TINYPRINTF_OVERRIDE_LIBC	0
+#include "tinyprintf.h"
+
+__BEGIN_DECLS
+
+static ssize_t bench_logd_encode(void *buf, size_t bufsz, uint32_t types, ...)
+{
+	ssize_t len;
+	va_list ap;
+
+	va_start(ap, types);
+	len = al_logd_encode(buf, bufsz, AL_LOG_INFO, 1234, 0, types, ap);
+	va_end(ap);
+
+	return len;
+}
+
+/* the same three argument message as a record or as text */
+static void bench_logd_record(al_bench_t *b)
+{
+	uint8_t rec[AL_LOGD_REC_MAX];
+	int_t i = 0;
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(bench_logd_encode(rec, sizeof(rec),
+										__al_logd_types(i, i, "adc"),
+										i, -i, "adc"));
+		i++;
+	}
+}
+AL_BENCH(logd_record_3args, bench_logd_record);
+
+static void bench_logd_text(al_bench_t *b)
+{
+	char text[128];
+	int_t i = 0;
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(tfp_snprintf(text, sizeof(text),
+								   "[%5ld.%03d] channel %d read %d from %s\r\n",
+								   1L, 234, i, -i, "adc"));
+		i++;
+	}
+}
+AL_BENCH(logd_text_3args, bench_logd_text);
+
+__END_DECLS
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+#define MAT_N	8
+
+static void bench_matrix_mult(al_bench_t *b)
+{
+	al_matrix_data_t da[MAT_N * MAT_N], db[MAT_N * MAT_N], dc[MAT_N * MAT_N];
+	al_matrix_data_t aux[MAT_N];
+	al_matrix_t ma, mb, mc;
+	int_t i;
+
+	for (i = 0; i < MAT_N * MAT_N; i++) {
+		da[i] = (al_matrix_data_t)i / 7;
+		db[i] = (al_matrix_data_t)(MAT_N * MAT_N - i) / 5;
+	}
+
+	al_matrix_init(&ma, MAT_N, MAT_N, da);
+	al_matrix_init(&mb, MAT_N, MAT_N, db);
+	al_matrix_init(&mc, MAT_N, MAT_N, dc);
+
+	while (al_bench_loop(b)) {
+		al_matrix_mult(&ma, &mb, &mc, aux);
+		al_bench_clobber();
+	}
+}
+AL_BENCH(matrix_mult_8x8, bench_matrix_mult);
+
+__END_DECLS
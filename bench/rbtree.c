@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+#define RB_NODES	1024
+
+struct rb_item {
+	struct rb_node node;
+	uint32_t key;
+};
+
+static struct rb_item rb_items[RB_NODES];
+
+static void rb_item_insert(struct rb_root *root, struct rb_item *item)
+{
+	struct rb_node **p = &root->rb_node, *parent = NULL;
+
+	while (*p) {
+		parent = *p;
+
+		if (item->key < rb_entry(parent, struct rb_item, node)->key) {
+			p = &(*p)->rb_left;
+		} else {
+			p = &(*p)->rb_right;
+		}
+	}
+
+	rb_link_node(&item->node, parent, p);
+	rb_insert_color(&item->node, root);
+}
+
+/* insert and erase RB_NODES keys in a scattered order */
+static void bench_rbtree(al_bench_t *b)
+{
+	struct rb_root root = RB_ROOT;
+	int_t i;
+
+	for (i = 0; i < RB_NODES; i++) {
+		rb_items[i].key = (uint32_t)i * 2654435761u;
+	}
+
+	while (al_bench_loop(b)) {
+		for (i = 0; i < RB_NODES; i++) {
+			rb_item_insert(&root, &rb_items[i]);
+		}
+
+		for (i = 0; i < RB_NODES; i++) {
+			rb_erase(&rb_items[i].node, &root);
+		}
+	}
+}
+AL_BENCH(rbtree_1k, bench_rbtree);
+
+__END_DECLS
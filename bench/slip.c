@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "alumy/net/slip.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+#define SLIP_LEN		1500
+
+static uint8_t slip_data[SLIP_LEN];
+static uint8_t slip_enc[AL_SLIP_ENCODE_MAX(SLIP_LEN)];
+static uint8_t slip_recv[SLIP_LEN];
+static size_t slip_enc_len;
+
+static int_t slip_putc(int_t c)
+{
+	slip_enc[slip_enc_len++] = c;
+	return c;
+}
+
+static int_t slip_write(const void *buf, size_t len)
+{
+	memcpy(slip_enc + slip_enc_len, buf, len);
+	slip_enc_len += len;
+	return 0;
+}
+
+static int_t slip_getc(void)
+{
+	return EOF;
+}
+
+/* an MTU of random bytes, about 1 in 128 of them to escape */
+static void slip_setup(al_bench_t *b)
+{
+	srand(1);
+
+	for (size_t i = 0; i < SLIP_LEN; i++) {
+		slip_data[i] = rand();
+	}
+
+	al_bench_bytes(b, SLIP_LEN);
+}
+
+static void bench_slip_write_putc(al_bench_t *b)
+{
+	static const al_slip_opt_t opt = { .sl_putc = slip_putc, .sl_getc = slip_getc };
+	al_slip_t slip;
+
+	al_slip_init(&slip, slip_recv, sizeof(slip_recv), &opt);
+	slip_setup(b);
+
+	while (al_bench_loop(b)) {
+		slip_enc_len = 0;
+		al_slip_write(&slip, slip_data, SLIP_LEN);
+	}
+}
+AL_BENCH(slip_write_putc_1500, bench_slip_write_putc);
+
+static void bench_slip_write(al_bench_t *b)
+{
+	static const al_slip_opt_t opt = { .sl_write = slip_write };
+	al_slip_t slip;
+
+	al_slip_init(&slip, slip_recv, sizeof(slip_recv), &opt);
+	slip_setup(b);
+
+	while (al_bench_loop(b)) {
+		slip_enc_len = 0;
+		al_slip_write(&slip, slip_data, SLIP_LEN);
+	}
+}
+AL_BENCH(slip_write_1500, bench_slip_write);
+
+static void bench_slip_recv_byte(al_bench_t *b)
+{
+	static const al_slip_opt_t opt = { .sl_putc = slip_putc };
+	al_slip_t slip;
+	size_t len;
+
+	al_slip_init(&slip, slip_recv, sizeof(slip_recv), &opt);
+	slip_setup(b);
+	len = al_slip_encode(slip_enc, sizeof(slip_enc), slip_data, SLIP_LEN);
+
+	while (al_bench_loop(b)) {
+		for (size_t i = 0; i < len; i++) {
+			al_slip_recv_byte(&slip, slip_enc[i]);
+		}
+		al_bench_clobber();
+	}
+}
+AL_BENCH(slip_recv_byte_1500, bench_slip_recv_byte);
+
+static void bench_slip_decode(al_bench_t *b)
+{
+	static const al_slip_opt_t opt = { .sl_putc = slip_putc };
+	al_slip_t slip;
+	size_t len;
+
+	al_slip_init(&slip, slip_recv, sizeof(slip_recv), &opt);
+	slip_setup(b);
+	len = al_slip_encode(slip_enc, sizeof(slip_enc), slip_data, SLIP_LEN);
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(al_slip_decode(&slip, slip_enc, len, NULL));
+	}
+}
+AL_BENCH(slip_decode_1500, bench_slip_decode);
+
+__END_DECLS
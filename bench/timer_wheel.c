@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+#define TW_TIMERS	4096
+
+static al_timer_wheel_t tw;
+static al_timer_t tw_tmr[TW_TIMERS];
+
+static void tw_func(al_timer_t *tmr, void *arg)
+{
+	UNUSED(tmr);
+	UNUSED(arg);
+}
+
+static void tw_setup(void)
+{
+	uint32_t i;
+
+	al_timer_wheel_init(&tw, 0);
+
+	for (i = 0; i < TW_TIMERS; i++) {
+		al_timer_init(&tw_tmr[i], tw_func, NULL);
+		al_timer_add(&tw, &tw_tmr[i], 1 + (i * 7919) % 100000, 0);
+	}
+}
+
+/* re-arm a timer among TW_TIMERS pending ones, the usual timeout reset */
+static void bench_timer_wheel_mod(al_bench_t *b)
+{
+	uint32_t i = 0;
+
+	tw_setup();
+
+	while (al_bench_loop(b)) {
+		i = (i + 1) & (TW_TIMERS - 1);
+		al_timer_add(&tw, &tw_tmr[i], 1 + (i * 104729) % 100000, 0);
+	}
+}
+AL_BENCH(timer_wheel_mod_4k, bench_timer_wheel_mod);
+
+static void bench_timer_wheel_next(al_bench_t *b)
+{
+	tw_setup();
+
+	while (al_bench_loop(b)) {
+		al_bench_keep(al_timer_wheel_next(&tw));
+	}
+}
+AL_BENCH(timer_wheel_next_4k, bench_timer_wheel_next);
+
+__END_DECLS
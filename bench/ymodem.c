@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include "alumy.h"
+#include "bench.h"
+
+__BEGIN_DECLS
+
+#define YM_FILE_SIZE		(32 * 1024)
+#define YM_BUF_SIZE			YMODEM_TOTAL_LEN(YMODEM_PACKET_SIZE_1K)
+
+/* a reply reaches the sender this late, like on a radio link */
+#define YM_LATENCY_US		2000
+
+/* the link, two pipes: the sender reads [0] and writes [1], the receiver
+ * reads [2] and writes [3] */
+static int ym_fd[4];
+
+static uint8_t ym_file[YM_FILE_SIZE];
+static uint8_t ym_tx_recv[YM_BUF_SIZE], ym_tx_send[YM_BUF_SIZE];
+static uint8_t ym_rx_recv[YM_BUF_SIZE], ym_rx_send[YM_BUF_SIZE];
+
+static ssize_t ym_read(int fd, void *buf, size_t size, int32_t timeout)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	ssize_t n;
+
+	if (poll(&pfd, 1, timeout) <= 0) {
+		return 0;
+	}
+
+	n = read(fd, buf, size);
+
+	return (n < 0) ? 0 : n;
+}
+
+static int32_t ym_getc(int fd, int32_t timeout)
+{
+	uint8_t c;
+
+	return (ym_read(fd, &c, 1, timeout) == 1) ? c : AL_EOF;
+}
+
+static int32_t ym_putc(int fd, int32_t c)
+{
+	uint8_t b = c;
+
+	return (write(fd, &b, 1) == 1) ? c : AL_EOF;
+}
+
+static int32_t ym_recv_clear(int fd)
+{
+	uint8_t buf[64];
+
+	while (ym_read(fd, buf, sizeof(buf), 0) > 0) {
+	}
+
+	return 0;
+}
+
+static int32_t ym_tx_putc(int32_t c)
+{
+	return ym_putc(ym_fd[1], c);
+}
+
+static int32_t ym_rx_putc(int32_t c)
+{
+	return ym_putc(ym_fd[3], c);
+}
+
+static int32_t ym_tx_getc(int32_t timeout)
+{
+	struct pollfd pfd = { .fd = ym_fd[0], .events = POLLIN };
+
+	if (poll(&pfd, 1, timeout) > 0) {
+		usleep(YM_LATENCY_US);
+	}
+
+	return ym_getc(ym_fd[0], timeout);
+}
+
+static int32_t ym_rx_getc(int32_t timeout)
+{
+	return ym_getc(ym_fd[2], timeout);
+}
+
+static ssize_t ym_tx_write(const void *buf, size_t len)
+{
+	return write(ym_fd[1], buf, len);
+}
+
+static ssize_t ym_tx_recv_data(void *buf, size_t size)
+{
+	return ym_read(ym_fd[0], buf, size, 0);
+}
+
+static ssize_t ym_rx_recv_data(void *buf, size_t size)
+{
+	return ym_read(ym_fd[2], buf, size, 0);
+}
+
+static int32_t ym_tx_recv_clear(void)
+{
+	return ym_recv_clear(ym_fd[0]);
+}
+
+static int32_t ym_rx_recv_clear(void)
+{
+	return ym_recv_clear(ym_fd[2]);
+}
+
+static void ym_flush(void)
+{
+
+}
+
+static uint32_t ym_tick_ms(void)
+{
+	return al_tick_get_ns() / 1000000;
+}
+
+static void ym_delay_ms(int32_t ms)
+{
+	usleep(ms * 1000);
+}
+
+static int32_t ym_recv_header(const char *filename, size_t filesize)
+{
+	UNUSED(filename);
+
+	return (filesize == sizeof(ym_file)) ? 0 : -1;
+}
+
+static int32_t ym_recv_packet(const void *data, size_t len)
+{
+	al_bench_keep(data);
+	al_bench_keep(len);
+
+	return 0;
+}
+
+static int32_t ym_recv_finish(al_ymodem_finish_reason_t reason)
+{
+	UNUSED(reason);
+
+	return 0;
+}
+
+static const al_ymodem_callback_t ym_cb = {
+	.recv_header = ym_recv_header,
+	.recv_packet = ym_recv_packet,
+	.recv_finish = ym_recv_finish,
+};
+
+static const al_ymodem_opt_t ym_rx_opt = {
+	.ym_putc = ym_rx_putc,
+	.ym_getc = ym_rx_getc,
+	.ym_flush = ym_flush,
+	.recv = ym_rx_recv_data,
+	.recv_clear = ym_rx_recv_clear,
+	.tick_ms = ym_tick_ms,
+	.delay_ms = ym_delay_ms,
+};
+
+static const al_ymodem_opt_t ym_tx_opt = {
+	.ym_putc = ym_tx_putc,
+	.ym_getc = ym_tx_getc,
+	.ym_flush = ym_flush,
+	.recv = ym_tx_recv_data,
+	.recv_clear = ym_tx_recv_clear,
+	.tick_ms = ym_tick_ms,
+	.delay_ms = ym_delay_ms,
+	.ym_write = ym_tx_write,
+};
+
+static void ym_sender_task(void *arg)
+{
+	al_os_sem_t done = (al_os_sem_t)arg;
+	al_ymodem_t ym;
+	int_t i;
+
+	if (al_ymodem_init(&ym, ym_tx_recv, sizeof(ym_tx_recv), ym_tx_send,
+					   sizeof(ym_tx_send), &ym_tx_opt, &ym_cb) == 0) {
+		for (i = 0; i < 100; i++) {
+			if (al_ymodem_wait_send(&ym) == 0) {
+				al_ymodem_send_file(&ym, "fw.bin", ym_file, sizeof(ym_file));
+				break;
+			}
+		}
+	}
+
+	al_os_sem_give(done);
+	al_os_task_delete(NULL);
+}
+
+/* one transfer of the file to a receiver that drops it */
+static int32_t ym_transfer(bool stream)
+{
+	al_ymodem_t ym;
+	al_os_sem_t done;
+	int32_t ret = 0;
+	int fd[4];
+
+	if ((pipe(fd) != 0) || (pipe(fd + 2) != 0)) {
+		return -1;
+	}
+
+	/* the receiver reads what the sender writes and the other way round */
+	ym_fd[0] = fd[2];
+	ym_fd[1] = fd[1];
+	ym_fd[2] = fd[0];
+	ym_fd[3] = fd[3];
+
+	done = al_os_sem_bin_create();
+
+	if ((done == NULL) ||
+		(al_ymodem_init(&ym, ym_rx_recv, sizeof(ym_rx_recv), ym_rx_send,
+						sizeof(ym_rx_send), &ym_rx_opt, &ym_cb) != 0) ||
+		(al_ymodem_set_stream(&ym, stream) != 0) ||
+		(al_os_task_create("ymodem", 1, 0, ym_sender_task, done) == NULL)) {
+		ret = -1;
+	} else {
+		while (ret == 0) {
+			ret = al_ymodem_recv(&ym);
+		}
+
+		al_os_sem_take(done, -1);
+	}
+
+	if (done != NULL) {
+		al_os_sem_bin_del(done);
+	}
+
+	for (int_t i = 0; i < 4; i++) {
+		close(ym_fd[i]);
+	}
+
+	return ret;
+}
+
+/* every reply of the classic protocol pays the link latency */
+static void bench_ymodem(al_bench_t *b, bool stream)
+{
+	memset(ym_file, 0x5A, sizeof(ym_file));
+	al_bench_bytes(b, sizeof(ym_file));
+
+	while (al_bench_loop(b)) {
+		if (ym_transfer(stream) != 1) {
+			break;
+		}
+	}
+}
+
+static void bench_ymodem_classic(al_bench_t *b)
+{
+	bench_ymodem(b, false);
+}
+AL_BENCH(ymodem_32k_2ms, bench_ymodem_classic);
+
+static void bench_ymodem_g(al_bench_t *b)
+{
+	bench_ymodem(b, true);
+}
+AL_BENCH(ymodem_g_32k_2ms, bench_ymodem_g);
+
+__END_DECLS
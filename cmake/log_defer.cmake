@@ -0,0 +1,16 @@
+# Extract the format strings of the deferred log (alumy/log_defer.h)
+#
+#   al_logd_strtab(<target>)
+#
+# writes <target file>.logd after every link of the target, the string
+# table tools/logd_decode.py needs to turn the records back into text. The
+# section is flagged allocatable first, on a target it is an INFO section
+# which objcopy -O binary would skip otherwise.
+function(al_logd_strtab target)
+    add_custom_command(TARGET ${target}
+        POST_BUILD
+        COMMAND ${CMAKE_OBJCOPY} -O binary --only-section=.al_logd
+                --set-section-flags .al_logd=alloc,load,contents
+                $<TARGET_FILE:${target}> $<TARGET_FILE:${target}>.logd
+        COMMENT "Extracting the deferred log formats of ${target}")
+endfunction()
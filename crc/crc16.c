@@ -7,22 +7,16 @@ __BEGIN_DECLS
 
 uint16_t crc16_poly(uint16_t crc, uint16_t poly, const void *data, size_t len)
 {
-    const uint8_t *p = (const uint8_t *)data;
-    uint8_t i;
+    /* the polynomial is only known here, use the bitwise engine */
+    const al_crc_model_t model = {
+        .width = 16, .reflect = false, .poly = poly,
+    };
 
-    while (len--) {
-        crc = crc ^ *p++ << 8;
-
-        for (i = 0; i < 8; i++) {
-            if (crc & 0x8000) {
-                crc = crc << 1 ^ poly;
-            } else {
-                crc = crc << 1;
-            }
-        }
+    if (poly == al_crc16_xmodem_model.poly) {
+        return al_crc_update(&al_crc16_xmodem_model, crc, data, len);
     }
 
-    return crc;
+    return al_crc_update(&model, crc, data, len);
 }
 
 __END_DECLS
@@ -3,7 +3,42 @@
 #include "alumy/byteorder.h"
 #include "alumy/byteswap.h"
 #include "alumy/types.h"
+#include "alumy/base.h"
 #include "alumy/watchdog.h"
+#include "alumy/errno.h"
+#include "alumy/crc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CRC32_PCLMUL	1
+#else
+#define CRC32_PCLMUL	0
+#endif
+
+#if defined(__GNUC__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32_ARMV8		1
+#define CRC32_ARMV8_TARGET
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CRC32_ARMV8		1
+#define CRC32_ARMV8_TARGET	__attribute__((target("+crc")))
+#else
+#define CRC32_ARMV8		0
+#endif
+
+#if (AL_CRC32_SLICE != 1) && (AL_CRC32_SLICE != 8) && (AL_CRC32_SLICE != 16)
+#error "AL_CRC32_SLICE must be 1, 8 or 16"
+#endif
+
+/* Slicing works on little endian words only */
+#if (__BYTE_ORDER == __LITTLE_ENDIAN) && (AL_CRC32_SLICE >= 8)
+#define CRC32_SLICE		AL_CRC32_SLICE
+#else
+#define CRC32_SLICE		1
+#endif
 
 #define htonl(x)            al_htonl(x)
 #define cpu_to_le32(x)      al_cpu_to_le32(x)
@@ -15,6 +50,9 @@
 
 static int crc_table_empty = 1;
 static uint32_t crc_table[256];
+#if CRC32_SLICE > 1
+static uint32_t crc_slice_table[CRC32_SLICE - 1][256];
+#endif
 static void make_crc_table(void);
 
 /*
@@ -62,6 +100,20 @@ static void make_crc_table(void)
       c = c & 1 ? poly ^ (c >> 1) : c >> 1;
     crc_table[n] = tole(c);
   }
+
+#if CRC32_SLICE > 1
+  /* row k - 1 is the crc of every byte followed by k zero bytes */
+  for (n = 0; n < 256; n++)
+  {
+    c = crc_table[n];
+    for (k = 0; k < CRC32_SLICE - 1; k++)
+    {
+      c = crc_table[c & 0xff] ^ (c >> 8);
+      crc_slice_table[k][n] = c;
+    }
+  }
+#endif
+
   crc_table_empty = 0;
 }
 #else
@@ -135,6 +187,10 @@ tole(0xbad03605L), tole(0xcdd70693L), tole(0x54de5729L), tole(0x23d967bfL),
 tole(0xb3667a2eL), tole(0xc4614ab8L), tole(0x5d681b02L), tole(0x2a6f2b94L),
 tole(0xb40bbe37L), tole(0xc30c8ea1L), tole(0x5a05df1bL), tole(0x2d02ef8dL)
 };
+
+#if CRC32_SLICE > 1
+#include "crc32_slice.h"
+#endif
 #endif
 
 /* =========================================================================
@@ -159,18 +215,13 @@ const uint32_t *al_get_crc_table()
 
 /* ========================================================================= */
 
-/* No ones complement version. JFFS2 (and other things ?)
- * don't use ones compliment in their CRC calculations.
- */
-uint32_t al_crc32_no_comp(uint32_t crc, const void *buf, uint32_t len)
+/* One table lookup per byte, works for both byte orders */
+static uint32_t crc32_table(uint32_t crc, const uint8_t *buf, size_t len)
 {
     const uint32_t *tab = crc_table;
     const uint32_t *b =(const uint32_t *)buf;
     size_t rem_len;
-#if AL_DYNAMIC_CRC_TABLE
-    if (crc_table_empty)
-      make_crc_table();
-#endif
+
     crc = cpu_to_le32(crc);
     /* Align it */
     if (((long)b) & 3 && len) {
@@ -204,11 +255,403 @@ uint32_t al_crc32_no_comp(uint32_t crc, const void *buf, uint32_t len)
 }
 #undef DO_CRC
 
+#if CRC32_SLICE > 1
+__static_inline__ uint32_t crc32_load(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+#define SLICE(k, v, s)		crc_slice_table[(k) - 1][((v) >> (s)) & 0xff]
+
+/* Eight bytes per step, one lookup in each of eight tables */
+static uint32_t crc32_slice8(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	uint32_t one, two;
+
+	while (len >= 8) {
+		one = crc32_load(buf) ^ crc;
+		two = crc32_load(buf + 4);
+
+		crc = SLICE(7, one, 0) ^ SLICE(6, one, 8) ^
+			  SLICE(5, one, 16) ^ SLICE(4, one, 24) ^
+			  SLICE(3, two, 0) ^ SLICE(2, two, 8) ^
+			  SLICE(1, two, 16) ^ crc_table[two >> 24];
+
+		buf += 8;
+		len -= 8;
+	}
+
+	return crc32_table(crc, buf, len);
+}
+
+#if CRC32_SLICE > 8
+/* Sixteen bytes per step */
+static uint32_t crc32_slice16(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	uint32_t w0, w1, w2, w3;
+
+	while (len >= 16) {
+		w0 = crc32_load(buf) ^ crc;
+		w1 = crc32_load(buf + 4);
+		w2 = crc32_load(buf + 8);
+		w3 = crc32_load(buf + 12);
+
+		crc = SLICE(15, w0, 0) ^ SLICE(14, w0, 8) ^
+			  SLICE(13, w0, 16) ^ SLICE(12, w0, 24) ^
+			  SLICE(11, w1, 0) ^ SLICE(10, w1, 8) ^
+			  SLICE(9, w1, 16) ^ SLICE(8, w1, 24) ^
+			  SLICE(7, w2, 0) ^ SLICE(6, w2, 8) ^
+			  SLICE(5, w2, 16) ^ SLICE(4, w2, 24) ^
+			  SLICE(3, w3, 0) ^ SLICE(2, w3, 8) ^
+			  SLICE(1, w3, 16) ^ crc_table[w3 >> 24];
+
+		buf += 16;
+		len -= 16;
+	}
+
+	return crc32_slice8(crc, buf, len);
+}
+#endif
+
+#undef SLICE
+#endif
+
+#if CRC32_SLICE > 8
+#define crc32_soft		crc32_slice16
+#elif CRC32_SLICE > 1
+#define crc32_soft		crc32_slice8
+#else
+#define crc32_soft		crc32_table
+#endif
+
+#if CRC32_PCLMUL
+/*
+ * Carry-less multiply folding from Intel's "Fast CRC Computation for
+ * Generic Polynomials Using PCLMULQDQ Instruction", with the bit-reflected
+ * constants for the CRC32 polynomial. Folds four 128 bit lanes while 64
+ * bytes are left, then one lane per 16 bytes, then reduces with Barrett.
+ * len must be at least 64 and a multiple of 16.
+ */
+__attribute__((target("sse2,pclmul")))
+static uint32_t crc32_pclmul_fold(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	static const uint64_t k1k2[2] __attribute__((aligned(16))) = {
+		0x0154442bd4ULL, 0x01c6e41596ULL
+	};
+	static const uint64_t k3k4[2] __attribute__((aligned(16))) = {
+		0x01751997d0ULL, 0x00ccaa009eULL
+	};
+	static const uint64_t k5k0[2] __attribute__((aligned(16))) = {
+		0x0163cd6124ULL, 0x0000000000ULL
+	};
+	static const uint64_t poly[2] __attribute__((aligned(16))) = {
+		0x01db710641ULL, 0x01f7011641ULL
+	};
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+	x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+	x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+	x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+	x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+
+	x0 = _mm_load_si128((const __m128i *)k1k2);
+
+	buf += 64;
+	len -= 64;
+
+	while (len >= 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+		y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+		y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+		y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+		y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+		buf += 64;
+		len -= 64;
+	}
+
+	/* fold the four lanes into one */
+	x0 = _mm_load_si128((const __m128i *)k3k4);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	while (len >= 16) {
+		x2 = _mm_loadu_si128((const __m128i *)buf);
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+		buf += 16;
+		len -= 16;
+	}
+
+	/* 128 bits to 64 bits */
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+
+	x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	/* Barrett reduction to 32 bits */
+	x0 = _mm_load_si128((const __m128i *)poly);
+
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+static uint32_t crc32_pclmul(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	size_t n;
+
+	if (len >= 64) {
+		n = len & ~(size_t)15;
+		crc = crc32_pclmul_fold(crc, buf, n);
+		buf += n;
+		len -= n;
+	}
+
+	return crc32_soft(crc, buf, len);
+}
+
+static bool_t crc32_pclmul_supported(void)
+{
+	__builtin_cpu_init();
+
+	return __builtin_cpu_supports("sse2") && __builtin_cpu_supports("pclmul");
+}
+#endif
+
+#if CRC32_ARMV8
+CRC32_ARMV8_TARGET
+static uint32_t crc32_armv8(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	uint64_t v;
+
+	while (len && ((uintptr_t)buf & 7)) {
+		crc = __crc32b(crc, *buf++);
+		len--;
+	}
+
+	while (len >= 8) {
+		memcpy(&v, buf, sizeof(v));
+		crc = __crc32d(crc, v);
+		buf += 8;
+		len -= 8;
+	}
+
+	while (len--) {
+		crc = __crc32b(crc, *buf++);
+	}
+
+	return crc;
+}
+
+static bool_t crc32_armv8_supported(void)
+{
+#if defined(__ARM_FEATURE_CRC32)
+	return true;
+#else
+	return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#endif
+}
+#endif
+
+typedef uint32_t (*crc32_fn_t)(uint32_t crc, const uint8_t *buf, size_t len);
+
+static crc32_fn_t crc32_fn = NULL;
+static al_crc32_impl_t crc32_impl = AL_CRC32_IMPL_AUTO;
+
+static crc32_fn_t crc32_lookup(al_crc32_impl_t impl)
+{
+	switch (impl) {
+	case AL_CRC32_IMPL_TABLE:
+		return crc32_table;
+#if CRC32_SLICE > 1
+	case AL_CRC32_IMPL_SLICE8:
+		return crc32_slice8;
+#endif
+#if CRC32_SLICE > 8
+	case AL_CRC32_IMPL_SLICE16:
+		return crc32_slice16;
+#endif
+#if CRC32_PCLMUL
+	case AL_CRC32_IMPL_PCLMUL:
+		return crc32_pclmul_supported() ? crc32_pclmul : NULL;
+#endif
+#if CRC32_ARMV8
+	case AL_CRC32_IMPL_ARMV8:
+		return crc32_armv8_supported() ? crc32_armv8 : NULL;
+#endif
+	default:
+		return NULL;
+	}
+}
+
+int32_t al_crc32_set_impl(al_crc32_impl_t impl)
+{
+	static const al_crc32_impl_t order[] = {
+		AL_CRC32_IMPL_PCLMUL, AL_CRC32_IMPL_ARMV8,
+		AL_CRC32_IMPL_SLICE16, AL_CRC32_IMPL_SLICE8,
+		AL_CRC32_IMPL_TABLE,
+	};
+	crc32_fn_t fn = NULL;
+	int_t i;
+
+#if AL_DYNAMIC_CRC_TABLE
+	if (crc_table_empty)
+		make_crc_table();
+#endif
+
+	if (impl == AL_CRC32_IMPL_AUTO) {
+		for (i = 0; (fn == NULL) && (i < ARRAY_SIZE(order)); i++) {
+			fn = crc32_lookup(order[i]);
+			impl = order[i];
+		}
+	} else {
+		fn = crc32_lookup(impl);
+	}
+
+	if (fn == NULL) {
+		set_errno(ENOTSUP);
+		return -1;
+	}
+
+	crc32_impl = impl;
+	__atomic_store_n(&crc32_fn, fn, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+al_crc32_impl_t al_crc32_get_impl(void)
+{
+	if (__atomic_load_n(&crc32_fn, __ATOMIC_ACQUIRE) == NULL) {
+		al_crc32_set_impl(AL_CRC32_IMPL_AUTO);
+	}
+
+	return crc32_impl;
+}
+
+/* No ones complement version. JFFS2 (and other things ?)
+ * don't use ones compliment in their CRC calculations.
+ */
+uint32_t al_crc32_no_comp(uint32_t crc, const void *buf, uint32_t len)
+{
+	crc32_fn_t fn = __atomic_load_n(&crc32_fn, __ATOMIC_ACQUIRE);
+
+	if (fn == NULL) {
+		/* first call picks the fastest path of this cpu */
+		al_crc32_set_impl(AL_CRC32_IMPL_AUTO);
+		fn = crc32_fn;
+	}
+
+	return fn(crc, (const uint8_t *)buf, len);
+}
+
+static uint32_t crc32_update(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)buf;
+	uint32_t n;
+
+	/* the dispatch takes 32-bit lengths */
+	do {
+		n = (len > 0x80000000UL) ? 0x80000000UL : (uint32_t)len;
+		crc = al_crc32_no_comp(crc, p, n);
+		p += n;
+		len -= n;
+	} while (len > 0);
+
+	return crc;
+}
+
+/* The tables of crc32 stay private, the engine goes through the dispatch */
+const al_crc_model_t al_crc32_model = {
+	.width = 32, .reflect = true, .poly = 0x04C11DB7,
+	.init = 0xFFFFFFFF, .xorout = 0xFFFFFFFF,
+	.update = crc32_update,
+};
+
 uint32_t al_crc32(uint32_t crc, const void *p, uint32_t len)
 {
      return al_crc32_no_comp(crc ^ 0xffffffffL, p, len) ^ 0xffffffffL;
 }
 
+/* a * b modulo the crc polynomial, both reflected */
+static uint32_t crc32_multmodp(uint32_t a, uint32_t b)
+{
+	uint32_t m = 1UL << 31, p = 0;
+
+	for (;;) {
+		if (a & m) {
+			p ^= b;
+			if ((a & (m - 1)) == 0)
+				break;
+		}
+		m >>= 1;
+		b = (b & 1) ? (b >> 1) ^ 0xedb88320UL : (b >> 1);
+	}
+
+	return p;
+}
+
+uint32_t al_crc32_combine(uint32_t crc1, uint32_t crc2, size_t len2)
+{
+	uint32_t x2n = 1UL << 30;	/* x^1, squared to x^2^k below */
+	uint32_t p = 1UL << 31;		/* x^0 */
+	uint64_t n = (uint64_t)len2 << 3;
+
+	/* crc1 shifted over len2 zero bytes is crc1 * x^(8 * len2) */
+	while (n) {
+		if (n & 1)
+			p = crc32_multmodp(x2n, p);
+		n >>= 1;
+		x2n = crc32_multmodp(x2n, x2n);
+	}
+
+	return crc32_multmodp(p, crc1) ^ crc2;
+}
+
 /*
  * Calculate the crc32 checksum triggering the watchdog every 'chunk_sz' bytes
  * of input.
@@ -0,0 +1,1005 @@
+/*
+ * Slicing tables of crc/crc32.c, row k - 1 holds the CRC of every byte
+ * value followed by k zero bytes. Row 0 of the algorithm is crc_table.
+ * Little endian only, generated by tools/crc_tables.py.
+ */
+
+#ifndef __AL_CRC32_SLICE_H
+#define __AL_CRC32_SLICE_H 1
+
+static const uint32_t crc_slice_table[AL_CRC32_SLICE - 1][256] = {
+{
+0x00000000L, 0x191b3141L, 0x32366282L, 0x2b2d53c3L,
+0x646cc504L, 0x7d77f445L, 0x565aa786L, 0x4f4196c7L,
+0xc8d98a08L, 0xd1c2bb49L, 0xfaefe88aL, 0xe3f4d9cbL,
+0xacb54f0cL, 0xb5ae7e4dL, 0x9e832d8eL, 0x87981ccfL,
+0x4ac21251L, 0x53d92310L, 0x78f470d3L, 0x61ef4192L,
+0x2eaed755L, 0x37b5e614L, 0x1c98b5d7L, 0x05838496L,
+0x821b9859L, 0x9b00a918L, 0xb02dfadbL, 0xa936cb9aL,
+0xe6775d5dL, 0xff6c6c1cL, 0xd4413fdfL, 0xcd5a0e9eL,
+0x958424a2L, 0x8c9f15e3L, 0xa7b24620L, 0xbea97761L,
+0xf1e8e1a6L, 0xe8f3d0e7L, 0xc3de8324L, 0xdac5b265L,
+0x5d5daeaaL, 0x44469febL, 0x6f6bcc28L, 0x7670fd69L,
+0x39316baeL, 0x202a5aefL, 0x0b07092cL, 0x121c386dL,
+0xdf4636f3L, 0xc65d07b2L, 0xed705471L, 0xf46b6530L,
+0xbb2af3f7L, 0xa231c2b6L, 0x891c9175L, 0x9007a034L,
+0x179fbcfbL, 0x0e848dbaL, 0x25a9de79L, 0x3cb2ef38L,
+0x73f379ffL, 0x6ae848beL, 0x41c51b7dL, 0x58de2a3cL,
+0xf0794f05L, 0xe9627e44L, 0xc24f2d87L, 0xdb541cc6L,
+0x94158a01L, 0x8d0ebb40L, 0xa623e883L, 0xbf38d9c2L,
+0x38a0c50dL, 0x21bbf44cL, 0x0a96a78fL, 0x138d96ceL,
+0x5ccc0009L, 0x45d73148L, 0x6efa628bL, 0x77e153caL,
+0xbabb5d54L, 0xa3a06c15L, 0x888d3fd6L, 0x91960e97L,
+0xded79850L, 0xc7cca911L, 0xece1fad2L, 0xf5facb93L,
+0x7262d75cL, 0x6b79e61dL, 0x4054b5deL, 0x594f849fL,
+0x160e1258L, 0x0f152319L, 0x243870daL, 0x3d23419bL,
+0x65fd6ba7L, 0x7ce65ae6L, 0x57cb0925L, 0x4ed03864L,
+0x0191aea3L, 0x188a9fe2L, 0x33a7cc21L, 0x2abcfd60L,
+0xad24e1afL, 0xb43fd0eeL, 0x9f12832dL, 0x8609b26cL,
+0xc94824abL, 0xd05315eaL, 0xfb7e4629L, 0xe2657768L,
+0x2f3f79f6L, 0x362448b7L, 0x1d091b74L, 0x04122a35L,
+0x4b53bcf2L, 0x52488db3L, 0x7965de70L, 0x607eef31L,
+0xe7e6f3feL, 0xfefdc2bfL, 0xd5d0917cL, 0xcccba03dL,
+0x838a36faL, 0x9a9107bbL, 0xb1bc5478L, 0xa8a76539L,
+0x3b83984bL, 0x2298a90aL, 0x09b5fac9L, 0x10aecb88L,
+0x5fef5d4fL, 0x46f46c0eL, 0x6dd93fcdL, 0x74c20e8cL,
+0xf35a1243L, 0xea412302L, 0xc16c70c1L, 0xd8774180L,
+0x9736d747L, 0x8e2de606L, 0xa500b5c5L, 0xbc1b8484L,
+0x71418a1aL, 0x685abb5bL, 0x4377e898L, 0x5a6cd9d9L,
+0x152d4f1eL, 0x0c367e5fL, 0x271b2d9cL, 0x3e001cddL,
+0xb9980012L, 0xa0833153L, 0x8bae6290L, 0x92b553d1L,
+0xddf4c516L, 0xc4eff457L, 0xefc2a794L, 0xf6d996d5L,
+0xae07bce9L, 0xb71c8da8L, 0x9c31de6bL, 0x852aef2aL,
+0xca6b79edL, 0xd37048acL, 0xf85d1b6fL, 0xe1462a2eL,
+0x66de36e1L, 0x7fc507a0L, 0x54e85463L, 0x4df36522L,
+0x02b2f3e5L, 0x1ba9c2a4L, 0x30849167L, 0x299fa026L,
+0xe4c5aeb8L, 0xfdde9ff9L, 0xd6f3cc3aL, 0xcfe8fd7bL,
+0x80a96bbcL, 0x99b25afdL, 0xb29f093eL, 0xab84387fL,
+0x2c1c24b0L, 0x350715f1L, 0x1e2a4632L, 0x07317773L,
+0x4870e1b4L, 0x516bd0f5L, 0x7a468336L, 0x635db277L,
+0xcbfad74eL, 0xd2e1e60fL, 0xf9ccb5ccL, 0xe0d7848dL,
+0xaf96124aL, 0xb68d230bL, 0x9da070c8L, 0x84bb4189L,
+0x03235d46L, 0x1a386c07L, 0x31153fc4L, 0x280e0e85L,
+0x674f9842L, 0x7e54a903L, 0x5579fac0L, 0x4c62cb81L,
+0x8138c51fL, 0x9823f45eL, 0xb30ea79dL, 0xaa1596dcL,
+0xe554001bL, 0xfc4f315aL, 0xd7626299L, 0xce7953d8L,
+0x49e14f17L, 0x50fa7e56L, 0x7bd72d95L, 0x62cc1cd4L,
+0x2d8d8a13L, 0x3496bb52L, 0x1fbbe891L, 0x06a0d9d0L,
+0x5e7ef3ecL, 0x4765c2adL, 0x6c48916eL, 0x7553a02fL,
+0x3a1236e8L, 0x230907a9L, 0x0824546aL, 0x113f652bL,
+0x96a779e4L, 0x8fbc48a5L, 0xa4911b66L, 0xbd8a2a27L,
+0xf2cbbce0L, 0xebd08da1L, 0xc0fdde62L, 0xd9e6ef23L,
+0x14bce1bdL, 0x0da7d0fcL, 0x268a833fL, 0x3f91b27eL,
+0x70d024b9L, 0x69cb15f8L, 0x42e6463bL, 0x5bfd777aL,
+0xdc656bb5L, 0xc57e5af4L, 0xee530937L, 0xf7483876L,
+0xb809aeb1L, 0xa1129ff0L, 0x8a3fcc33L, 0x9324fd72L
+},
+{
+0x00000000L, 0x01c26a37L, 0x0384d46eL, 0x0246be59L,
+0x0709a8dcL, 0x06cbc2ebL, 0x048d7cb2L, 0x054f1685L,
+0x0e1351b8L, 0x0fd13b8fL, 0x0d9785d6L, 0x0c55efe1L,
+0x091af964L, 0x08d89353L, 0x0a9e2d0aL, 0x0b5c473dL,
+0x1c26a370L, 0x1de4c947L, 0x1fa2771eL, 0x1e601d29L,
+0x1b2f0bacL, 0x1aed619bL, 0x18abdfc2L, 0x1969b5f5L,
+0x1235f2c8L, 0x13f798ffL, 0x11b126a6L, 0x10734c91L,
+0x153c5a14L, 0x14fe3023L, 0x16b88e7aL, 0x177ae44dL,
+0x384d46e0L, 0x398f2cd7L, 0x3bc9928eL, 0x3a0bf8b9L,
+0x3f44ee3cL, 0x3e86840bL, 0x3cc03a52L, 0x3d025065L,
+0x365e1758L, 0x379c7d6fL, 0x35dac336L, 0x3418a901L,
+0x3157bf84L, 0x3095d5b3L, 0x32d36beaL, 0x331101ddL,
+0x246be590L, 0x25a98fa7L, 0x27ef31feL, 0x262d5bc9L,
+0x23624d4cL, 0x22a0277bL, 0x20e69922L, 0x2124f315L,
+0x2a78b428L, 0x2bbade1fL, 0x29fc6046L, 0x283e0a71L,
+0x2d711cf4L, 0x2cb376c3L, 0x2ef5c89aL, 0x2f37a2adL,
+0x709a8dc0L, 0x7158e7f7L, 0x731e59aeL, 0x72dc3399L,
+0x7793251cL, 0x76514f2bL, 0x7417f172L, 0x75d59b45L,
+0x7e89dc78L, 0x7f4bb64fL, 0x7d0d0816L, 0x7ccf6221L,
+0x798074a4L, 0x78421e93L, 0x7a04a0caL, 0x7bc6cafdL,
+0x6cbc2eb0L, 0x6d7e4487L, 0x6f38fadeL, 0x6efa90e9L,
+0x6bb5866cL, 0x6a77ec5bL, 0x68315202L, 0x69f33835L,
+0x62af7f08L, 0x636d153fL, 0x612bab66L, 0x60e9c151L,
+0x65a6d7d4L, 0x6464bde3L, 0x662203baL, 0x67e0698dL,
+0x48d7cb20L, 0x4915a117L, 0x4b531f4eL, 0x4a917579L,
+0x4fde63fcL, 0x4e1c09cbL, 0x4c5ab792L, 0x4d98dda5L,
+0x46c49a98L, 0x4706f0afL, 0x45404ef6L, 0x448224c1L,
+0x41cd3244L, 0x400f5873L, 0x4249e62aL, 0x438b8c1dL,
+0x54f16850L, 0x55330267L, 0x5775bc3eL, 0x56b7d609L,
+0x53f8c08cL, 0x523aaabbL, 0x507c14e2L, 0x51be7ed5L,
+0x5ae239e8L, 0x5b2053dfL, 0x5966ed86L, 0x58a487b1L,
+0x5deb9134L, 0x5c29fb03L, 0x5e6f455aL, 0x5fad2f6dL,
+0xe1351b80L, 0xe0f771b7L, 0xe2b1cfeeL, 0xe373a5d9L,
+0xe63cb35cL, 0xe7fed96bL, 0xe5b86732L, 0xe47a0d05L,
+0xef264a38L, 0xeee4200fL, 0xeca29e56L, 0xed60f461L,
+0xe82fe2e4L, 0xe9ed88d3L, 0xebab368aL, 0xea695cbdL,
+0xfd13b8f0L, 0xfcd1d2c7L, 0xfe976c9eL, 0xff5506a9L,
+0xfa1a102cL, 0xfbd87a1bL, 0xf99ec442L, 0xf85cae75L,
+0xf300e948L, 0xf2c2837fL, 0xf0843d26L, 0xf1465711L,
+0xf4094194L, 0xf5cb2ba3L, 0xf78d95faL, 0xf64fffcdL,
+0xd9785d60L, 0xd8ba3757L, 0xdafc890eL, 0xdb3ee339L,
+0xde71f5bcL, 0xdfb39f8bL, 0xddf521d2L, 0xdc374be5L,
+0xd76b0cd8L, 0xd6a966efL, 0xd4efd8b6L, 0xd52db281L,
+0xd062a404L, 0xd1a0ce33L, 0xd3e6706aL, 0xd2241a5dL,
+0xc55efe10L, 0xc49c9427L, 0xc6da2a7eL, 0xc7184049L,
+0xc25756ccL, 0xc3953cfbL, 0xc1d382a2L, 0xc011e895L,
+0xcb4dafa8L, 0xca8fc59fL, 0xc8c97bc6L, 0xc90b11f1L,
+0xcc440774L, 0xcd866d43L, 0xcfc0d31aL, 0xce02b92dL,
+0x91af9640L, 0x906dfc77L, 0x922b422eL, 0x93e92819L,
+0x96a63e9cL, 0x976454abL, 0x9522eaf2L, 0x94e080c5L,
+0x9fbcc7f8L, 0x9e7eadcfL, 0x9c381396L, 0x9dfa79a1L,
+0x98b56f24L, 0x99770513L, 0x9b31bb4aL, 0x9af3d17dL,
+0x8d893530L, 0x8c4b5f07L, 0x8e0de15eL, 0x8fcf8b69L,
+0x8a809decL, 0x8b42f7dbL, 0x89044982L, 0x88c623b5L,
+0x839a6488L, 0x82580ebfL, 0x801eb0e6L, 0x81dcdad1L,
+0x8493cc54L, 0x8551a663L, 0x8717183aL, 0x86d5720dL,
+0xa9e2d0a0L, 0xa820ba97L, 0xaa6604ceL, 0xaba46ef9L,
+0xaeeb787cL, 0xaf29124bL, 0xad6fac12L, 0xacadc625L,
+0xa7f18118L, 0xa633eb2fL, 0xa4755576L, 0xa5b73f41L,
+0xa0f829c4L, 0xa13a43f3L, 0xa37cfdaaL, 0xa2be979dL,
+0xb5c473d0L, 0xb40619e7L, 0xb640a7beL, 0xb782cd89L,
+0xb2cddb0cL, 0xb30fb13bL, 0xb1490f62L, 0xb08b6555L,
+0xbbd72268L, 0xba15485fL, 0xb853f606L, 0xb9919c31L,
+0xbcde8ab4L, 0xbd1ce083L, 0xbf5a5edaL, 0xbe9834edL
+},
+{
+0x00000000L, 0xb8bc6765L, 0xaa09c88bL, 0x12b5afeeL,
+0x8f629757L, 0x37def032L, 0x256b5fdcL, 0x9dd738b9L,
+0xc5b428efL, 0x7d084f8aL, 0x6fbde064L, 0xd7018701L,
+0x4ad6bfb8L, 0xf26ad8ddL, 0xe0df7733L, 0x58631056L,
+0x5019579fL, 0xe8a530faL, 0xfa109f14L, 0x42acf871L,
+0xdf7bc0c8L, 0x67c7a7adL, 0x75720843L, 0xcdce6f26L,
+0x95ad7f70L, 0x2d111815L, 0x3fa4b7fbL, 0x8718d09eL,
+0x1acfe827L, 0xa2738f42L, 0xb0c620acL, 0x087a47c9L,
+0xa032af3eL, 0x188ec85bL, 0x0a3b67b5L, 0xb28700d0L,
+0x2f503869L, 0x97ec5f0cL, 0x8559f0e2L, 0x3de59787L,
+0x658687d1L, 0xdd3ae0b4L, 0xcf8f4f5aL, 0x7733283fL,
+0xeae41086L, 0x525877e3L, 0x40edd80dL, 0xf851bf68L,
+0xf02bf8a1L, 0x48979fc4L, 0x5a22302aL, 0xe29e574fL,
+0x7f496ff6L, 0xc7f50893L, 0xd540a77dL, 0x6dfcc018L,
+0x359fd04eL, 0x8d23b72bL, 0x9f9618c5L, 0x272a7fa0L,
+0xbafd4719L, 0x0241207cL, 0x10f48f92L, 0xa848e8f7L,
+0x9b14583dL, 0x23a83f58L, 0x311d90b6L, 0x89a1f7d3L,
+0x1476cf6aL, 0xaccaa80fL, 0xbe7f07e1L, 0x06c36084L,
+0x5ea070d2L, 0xe61c17b7L, 0xf4a9b859L, 0x4c15df3cL,
+0xd1c2e785L, 0x697e80e0L, 0x7bcb2f0eL, 0xc377486bL,
+0xcb0d0fa2L, 0x73b168c7L, 0x6104c729L, 0xd9b8a04cL,
+0x446f98f5L, 0xfcd3ff90L, 0xee66507eL, 0x56da371bL,
+0x0eb9274dL, 0xb6054028L, 0xa4b0efc6L, 0x1c0c88a3L,
+0x81dbb01aL, 0x3967d77fL, 0x2bd27891L, 0x936e1ff4L,
+0x3b26f703L, 0x839a9066L, 0x912f3f88L, 0x299358edL,
+0xb4446054L, 0x0cf80731L, 0x1e4da8dfL, 0xa6f1cfbaL,
+0xfe92dfecL, 0x462eb889L, 0x549b1767L, 0xec277002L,
+0x71f048bbL, 0xc94c2fdeL, 0xdbf98030L, 0x6345e755L,
+0x6b3fa09cL, 0xd383c7f9L, 0xc1366817L, 0x798a0f72L,
+0xe45d37cbL, 0x5ce150aeL, 0x4e54ff40L, 0xf6e89825L,
+0xae8b8873L, 0x1637ef16L, 0x048240f8L, 0xbc3e279dL,
+0x21e91f24L, 0x99557841L, 0x8be0d7afL, 0x335cb0caL,
+0xed59b63bL, 0x55e5d15eL, 0x47507eb0L, 0xffec19d5L,
+0x623b216cL, 0xda874609L, 0xc832e9e7L, 0x708e8e82L,
+0x28ed9ed4L, 0x9051f9b1L, 0x82e4565fL, 0x3a58313aL,
+0xa78f0983L, 0x1f336ee6L, 0x0d86c108L, 0xb53aa66dL,
+0xbd40e1a4L, 0x05fc86c1L, 0x1749292fL, 0xaff54e4aL,
+0x322276f3L, 0x8a9e1196L, 0x982bbe78L, 0x2097d91dL,
+0x78f4c94bL, 0xc048ae2eL, 0xd2fd01c0L, 0x6a4166a5L,
+0xf7965e1cL, 0x4f2a3979L, 0x5d9f9697L, 0xe523f1f2L,
+0x4d6b1905L, 0xf5d77e60L, 0xe762d18eL, 0x5fdeb6ebL,
+0xc2098e52L, 0x7ab5e937L, 0x680046d9L, 0xd0bc21bcL,
+0x88df31eaL, 0x3063568fL, 0x22d6f961L, 0x9a6a9e04L,
+0x07bda6bdL, 0xbf01c1d8L, 0xadb46e36L, 0x15080953L,
+0x1d724e9aL, 0xa5ce29ffL, 0xb77b8611L, 0x0fc7e174L,
+0x9210d9cdL, 0x2aacbea8L, 0x38191146L, 0x80a57623L,
+0xd8c66675L, 0x607a0110L, 0x72cfaefeL, 0xca73c99bL,
+0x57a4f122L, 0xef189647L, 0xfdad39a9L, 0x45115eccL,
+0x764dee06L, 0xcef18963L, 0xdc44268dL, 0x64f841e8L,
+0xf92f7951L, 0x41931e34L, 0x5326b1daL, 0xeb9ad6bfL,
+0xb3f9c6e9L, 0x0b45a18cL, 0x19f00e62L, 0xa14c6907L,
+0x3c9b51beL, 0x842736dbL, 0x96929935L, 0x2e2efe50L,
+0x2654b999L, 0x9ee8defcL, 0x8c5d7112L, 0x34e11677L,
+0xa9362eceL, 0x118a49abL, 0x033fe645L, 0xbb838120L,
+0xe3e09176L, 0x5b5cf613L, 0x49e959fdL, 0xf1553e98L,
+0x6c820621L, 0xd43e6144L, 0xc68bceaaL, 0x7e37a9cfL,
+0xd67f4138L, 0x6ec3265dL, 0x7c7689b3L, 0xc4caeed6L,
+0x591dd66fL, 0xe1a1b10aL, 0xf3141ee4L, 0x4ba87981L,
+0x13cb69d7L, 0xab770eb2L, 0xb9c2a15cL, 0x017ec639L,
+0x9ca9fe80L, 0x241599e5L, 0x36a0360bL, 0x8e1c516eL,
+0x866616a7L, 0x3eda71c2L, 0x2c6fde2cL, 0x94d3b949L,
+0x090481f0L, 0xb1b8e695L, 0xa30d497bL, 0x1bb12e1eL,
+0x43d23e48L, 0xfb6e592dL, 0xe9dbf6c3L, 0x516791a6L,
+0xccb0a91fL, 0x740cce7aL, 0x66b96194L, 0xde0506f1L
+},
+{
+0x00000000L, 0x3d6029b0L, 0x7ac05360L, 0x47a07ad0L,
+0xf580a6c0L, 0xc8e08f70L, 0x8f40f5a0L, 0xb220dc10L,
+0x30704bc1L, 0x0d106271L, 0x4ab018a1L, 0x77d03111L,
+0xc5f0ed01L, 0xf890c4b1L, 0xbf30be61L, 0x825097d1L,
+0x60e09782L, 0x5d80be32L, 0x1a20c4e2L, 0x2740ed52L,
+0x95603142L, 0xa80018f2L, 0xefa06222L, 0xd2c04b92L,
+0x5090dc43L, 0x6df0f5f3L, 0x2a508f23L, 0x1730a693L,
+0xa5107a83L, 0x98705333L, 0xdfd029e3L, 0xe2b00053L,
+0xc1c12f04L, 0xfca106b4L, 0xbb017c64L, 0x866155d4L,
+0x344189c4L, 0x0921a074L, 0x4e81daa4L, 0x73e1f314L,
+0xf1b164c5L, 0xccd14d75L, 0x8b7137a5L, 0xb6111e15L,
+0x0431c205L, 0x3951ebb5L, 0x7ef19165L, 0x4391b8d5L,
+0xa121b886L, 0x9c419136L, 0xdbe1ebe6L, 0xe681c256L,
+0x54a11e46L, 0x69c137f6L, 0x2e614d26L, 0x13016496L,
+0x9151f347L, 0xac31daf7L, 0xeb91a027L, 0xd6f18997L,
+0x64d15587L, 0x59b17c37L, 0x1e1106e7L, 0x23712f57L,
+0x58f35849L, 0x659371f9L, 0x22330b29L, 0x1f532299L,
+0xad73fe89L, 0x9013d739L, 0xd7b3ade9L, 0xead38459L,
+0x68831388L, 0x55e33a38L, 0x124340e8L, 0x2f236958L,
+0x9d03b548L, 0xa0639cf8L, 0xe7c3e628L, 0xdaa3cf98L,
+0x3813cfcbL, 0x0573e67bL, 0x42d39cabL, 0x7fb3b51bL,
+0xcd93690bL, 0xf0f340bbL, 0xb7533a6bL, 0x8a3313dbL,
+0x0863840aL, 0x3503adbaL, 0x72a3d76aL, 0x4fc3fedaL,
+0xfde322caL, 0xc0830b7aL, 0x872371aaL, 0xba43581aL,
+0x9932774dL, 0xa4525efdL, 0xe3f2242dL, 0xde920d9dL,
+0x6cb2d18dL, 0x51d2f83dL, 0x167282edL, 0x2b12ab5dL,
+0xa9423c8cL, 0x9422153cL, 0xd3826fecL, 0xeee2465cL,
+0x5cc29a4cL, 0x61a2b3fcL, 0x2602c92cL, 0x1b62e09cL,
+0xf9d2e0cfL, 0xc4b2c97fL, 0x8312b3afL, 0xbe729a1fL,
+0x0c52460fL, 0x31326fbfL, 0x7692156fL, 0x4bf23cdfL,
+0xc9a2ab0eL, 0xf4c282beL, 0xb362f86eL, 0x8e02d1deL,
+0x3c220dceL, 0x0142247eL, 0x46e25eaeL, 0x7b82771eL,
+0xb1e6b092L, 0x8c869922L, 0xcb26e3f2L, 0xf646ca42L,
+0x44661652L, 0x79063fe2L, 0x3ea64532L, 0x03c66c82L,
+0x8196fb53L, 0xbcf6d2e3L, 0xfb56a833L, 0xc6368183L,
+0x74165d93L, 0x49767423L, 0x0ed60ef3L, 0x33b62743L,
+0xd1062710L, 0xec660ea0L, 0xabc67470L, 0x96a65dc0L,
+0x248681d0L, 0x19e6a860L, 0x5e46d2b0L, 0x6326fb00L,
+0xe1766cd1L, 0xdc164561L, 0x9bb63fb1L, 0xa6d61601L,
+0x14f6ca11L, 0x2996e3a1L, 0x6e369971L, 0x5356b0c1L,
+0x70279f96L, 0x4d47b626L, 0x0ae7ccf6L, 0x3787e546L,
+0x85a73956L, 0xb8c710e6L, 0xff676a36L, 0xc2074386L,
+0x4057d457L, 0x7d37fde7L, 0x3a978737L, 0x07f7ae87L,
+0xb5d77297L, 0x88b75b27L, 0xcf1721f7L, 0xf2770847L,
+0x10c70814L, 0x2da721a4L, 0x6a075b74L, 0x576772c4L,
+0xe547aed4L, 0xd8278764L, 0x9f87fdb4L, 0xa2e7d404L,
+0x20b743d5L, 0x1dd76a65L, 0x5a7710b5L, 0x67173905L,
+0xd537e515L, 0xe857cca5L, 0xaff7b675L, 0x92979fc5L,
+0xe915e8dbL, 0xd475c16bL, 0x93d5bbbbL, 0xaeb5920bL,
+0x1c954e1bL, 0x21f567abL, 0x66551d7bL, 0x5b3534cbL,
+0xd965a31aL, 0xe4058aaaL, 0xa3a5f07aL, 0x9ec5d9caL,
+0x2ce505daL, 0x11852c6aL, 0x562556baL, 0x6b457f0aL,
+0x89f57f59L, 0xb49556e9L, 0xf3352c39L, 0xce550589L,
+0x7c75d999L, 0x4115f029L, 0x06b58af9L, 0x3bd5a349L,
+0xb9853498L, 0x84e51d28L, 0xc34567f8L, 0xfe254e48L,
+0x4c059258L, 0x7165bbe8L, 0x36c5c138L, 0x0ba5e888L,
+0x28d4c7dfL, 0x15b4ee6fL, 0x521494bfL, 0x6f74bd0fL,
+0xdd54611fL, 0xe03448afL, 0xa794327fL, 0x9af41bcfL,
+0x18a48c1eL, 0x25c4a5aeL, 0x6264df7eL, 0x5f04f6ceL,
+0xed242adeL, 0xd044036eL, 0x97e479beL, 0xaa84500eL,
+0x4834505dL, 0x755479edL, 0x32f4033dL, 0x0f942a8dL,
+0xbdb4f69dL, 0x80d4df2dL, 0xc774a5fdL, 0xfa148c4dL,
+0x78441b9cL, 0x4524322cL, 0x028448fcL, 0x3fe4614cL,
+0x8dc4bd5cL, 0xb0a494ecL, 0xf704ee3cL, 0xca64c78cL
+},
+{
+0x00000000L, 0xcb5cd3a5L, 0x4dc8a10bL, 0x869472aeL,
+0x9b914216L, 0x50cd91b3L, 0xd659e31dL, 0x1d0530b8L,
+0xec53826dL, 0x270f51c8L, 0xa19b2366L, 0x6ac7f0c3L,
+0x77c2c07bL, 0xbc9e13deL, 0x3a0a6170L, 0xf156b2d5L,
+0x03d6029bL, 0xc88ad13eL, 0x4e1ea390L, 0x85427035L,
+0x9847408dL, 0x531b9328L, 0xd58fe186L, 0x1ed33223L,
+0xef8580f6L, 0x24d95353L, 0xa24d21fdL, 0x6911f258L,
+0x7414c2e0L, 0xbf481145L, 0x39dc63ebL, 0xf280b04eL,
+0x07ac0536L, 0xccf0d693L, 0x4a64a43dL, 0x81387798L,
+0x9c3d4720L, 0x57619485L, 0xd1f5e62bL, 0x1aa9358eL,
+0xebff875bL, 0x20a354feL, 0xa6372650L, 0x6d6bf5f5L,
+0x706ec54dL, 0xbb3216e8L, 0x3da66446L, 0xf6fab7e3L,
+0x047a07adL, 0xcf26d408L, 0x49b2a6a6L, 0x82ee7503L,
+0x9feb45bbL, 0x54b7961eL, 0xd223e4b0L, 0x197f3715L,
+0xe82985c0L, 0x23755665L, 0xa5e124cbL, 0x6ebdf76eL,
+0x73b8c7d6L, 0xb8e41473L, 0x3e7066ddL, 0xf52cb578L,
+0x0f580a6cL, 0xc404d9c9L, 0x4290ab67L, 0x89cc78c2L,
+0x94c9487aL, 0x5f959bdfL, 0xd901e971L, 0x125d3ad4L,
+0xe30b8801L, 0x28575ba4L, 0xaec3290aL, 0x659ffaafL,
+0x789aca17L, 0xb3c619b2L, 0x35526b1cL, 0xfe0eb8b9L,
+0x0c8e08f7L, 0xc7d2db52L, 0x4146a9fcL, 0x8a1a7a59L,
+0x971f4ae1L, 0x5c439944L, 0xdad7ebeaL, 0x118b384fL,
+0xe0dd8a9aL, 0x2b81593fL, 0xad152b91L, 0x6649f834L,
+0x7b4cc88cL, 0xb0101b29L, 0x36846987L, 0xfdd8ba22L,
+0x08f40f5aL, 0xc3a8dcffL, 0x453cae51L, 0x8e607df4L,
+0x93654d4cL, 0x58399ee9L, 0xdeadec47L, 0x15f13fe2L,
+0xe4a78d37L, 0x2ffb5e92L, 0xa96f2c3cL, 0x6233ff99L,
+0x7f36cf21L, 0xb46a1c84L, 0x32fe6e2aL, 0xf9a2bd8fL,
+0x0b220dc1L, 0xc07ede64L, 0x46eaaccaL, 0x8db67f6fL,
+0x90b34fd7L, 0x5bef9c72L, 0xdd7beedcL, 0x16273d79L,
+0xe7718facL, 0x2c2d5c09L, 0xaab92ea7L, 0x61e5fd02L,
+0x7ce0cdbaL, 0xb7bc1e1fL, 0x31286cb1L, 0xfa74bf14L,
+0x1eb014d8L, 0xd5ecc77dL, 0x5378b5d3L, 0x98246676L,
+0x852156ceL, 0x4e7d856bL, 0xc8e9f7c5L, 0x03b52460L,
+0xf2e396b5L, 0x39bf4510L, 0xbf2b37beL, 0x7477e41bL,
+0x6972d4a3L, 0xa22e0706L, 0x24ba75a8L, 0xefe6a60dL,
+0x1d661643L, 0xd63ac5e6L, 0x50aeb748L, 0x9bf264edL,
+0x86f75455L, 0x4dab87f0L, 0xcb3ff55eL, 0x006326fbL,
+0xf135942eL, 0x3a69478bL, 0xbcfd3525L, 0x77a1e680L,
+0x6aa4d638L, 0xa1f8059dL, 0x276c7733L, 0xec30a496L,
+0x191c11eeL, 0xd240c24bL, 0x54d4b0e5L, 0x9f886340L,
+0x828d53f8L, 0x49d1805dL, 0xcf45f2f3L, 0x04192156L,
+0xf54f9383L, 0x3e134026L, 0xb8873288L, 0x73dbe12dL,
+0x6eded195L, 0xa5820230L, 0x2316709eL, 0xe84aa33bL,
+0x1aca1375L, 0xd196c0d0L, 0x5702b27eL, 0x9c5e61dbL,
+0x815b5163L, 0x4a0782c6L, 0xcc93f068L, 0x07cf23cdL,
+0xf6999118L, 0x3dc542bdL, 0xbb513013L, 0x700de3b6L,
+0x6d08d30eL, 0xa65400abL, 0x20c07205L, 0xeb9ca1a0L,
+0x11e81eb4L, 0xdab4cd11L, 0x5c20bfbfL, 0x977c6c1aL,
+0x8a795ca2L, 0x41258f07L, 0xc7b1fda9L, 0x0ced2e0cL,
+0xfdbb9cd9L, 0x36e74f7cL, 0xb0733dd2L, 0x7b2fee77L,
+0x662adecfL, 0xad760d6aL, 0x2be27fc4L, 0xe0beac61L,
+0x123e1c2fL, 0xd962cf8aL, 0x5ff6bd24L, 0x94aa6e81L,
+0x89af5e39L, 0x42f38d9cL, 0xc467ff32L, 0x0f3b2c97L,
+0xfe6d9e42L, 0x35314de7L, 0xb3a53f49L, 0x78f9ececL,
+0x65fcdc54L, 0xaea00ff1L, 0x28347d5fL, 0xe368aefaL,
+0x16441b82L, 0xdd18c827L, 0x5b8cba89L, 0x90d0692cL,
+0x8dd55994L, 0x46898a31L, 0xc01df89fL, 0x0b412b3aL,
+0xfa1799efL, 0x314b4a4aL, 0xb7df38e4L, 0x7c83eb41L,
+0x6186dbf9L, 0xaada085cL, 0x2c4e7af2L, 0xe712a957L,
+0x15921919L, 0xdececabcL, 0x585ab812L, 0x93066bb7L,
+0x8e035b0fL, 0x455f88aaL, 0xc3cbfa04L, 0x089729a1L,
+0xf9c19b74L, 0x329d48d1L, 0xb4093a7fL, 0x7f55e9daL,
+0x6250d962L, 0xa90c0ac7L, 0x2f987869L, 0xe4c4abccL
+},
+{
+0x00000000L, 0xa6770bb4L, 0x979f1129L, 0x31e81a9dL,
+0xf44f2413L, 0x52382fa7L, 0x63d0353aL, 0xc5a73e8eL,
+0x33ef4e67L, 0x959845d3L, 0xa4705f4eL, 0x020754faL,
+0xc7a06a74L, 0x61d761c0L, 0x503f7b5dL, 0xf64870e9L,
+0x67de9cceL, 0xc1a9977aL, 0xf0418de7L, 0x56368653L,
+0x9391b8ddL, 0x35e6b369L, 0x040ea9f4L, 0xa279a240L,
+0x5431d2a9L, 0xf246d91dL, 0xc3aec380L, 0x65d9c834L,
+0xa07ef6baL, 0x0609fd0eL, 0x37e1e793L, 0x9196ec27L,
+0xcfbd399cL, 0x69ca3228L, 0x582228b5L, 0xfe552301L,
+0x3bf21d8fL, 0x9d85163bL, 0xac6d0ca6L, 0x0a1a0712L,
+0xfc5277fbL, 0x5a257c4fL, 0x6bcd66d2L, 0xcdba6d66L,
+0x081d53e8L, 0xae6a585cL, 0x9f8242c1L, 0x39f54975L,
+0xa863a552L, 0x0e14aee6L, 0x3ffcb47bL, 0x998bbfcfL,
+0x5c2c8141L, 0xfa5b8af5L, 0xcbb39068L, 0x6dc49bdcL,
+0x9b8ceb35L, 0x3dfbe081L, 0x0c13fa1cL, 0xaa64f1a8L,
+0x6fc3cf26L, 0xc9b4c492L, 0xf85cde0fL, 0x5e2bd5bbL,
+0x440b7579L, 0xe27c7ecdL, 0xd3946450L, 0x75e36fe4L,
+0xb044516aL, 0x16335adeL, 0x27db4043L, 0x81ac4bf7L,
+0x77e43b1eL, 0xd19330aaL, 0xe07b2a37L, 0x460c2183L,
+0x83ab1f0dL, 0x25dc14b9L, 0x14340e24L, 0xb2430590L,
+0x23d5e9b7L, 0x85a2e203L, 0xb44af89eL, 0x123df32aL,
+0xd79acda4L, 0x71edc610L, 0x4005dc8dL, 0xe672d739L,
+0x103aa7d0L, 0xb64dac64L, 0x87a5b6f9L, 0x21d2bd4dL,
+0xe47583c3L, 0x42028877L, 0x73ea92eaL, 0xd59d995eL,
+0x8bb64ce5L, 0x2dc14751L, 0x1c295dccL, 0xba5e5678L,
+0x7ff968f6L, 0xd98e6342L, 0xe86679dfL, 0x4e11726bL,
+0xb8590282L, 0x1e2e0936L, 0x2fc613abL, 0x89b1181fL,
+0x4c162691L, 0xea612d25L, 0xdb8937b8L, 0x7dfe3c0cL,
+0xec68d02bL, 0x4a1fdb9fL, 0x7bf7c102L, 0xdd80cab6L,
+0x1827f438L, 0xbe50ff8cL, 0x8fb8e511L, 0x29cfeea5L,
+0xdf879e4cL, 0x79f095f8L, 0x48188f65L, 0xee6f84d1L,
+0x2bc8ba5fL, 0x8dbfb1ebL, 0xbc57ab76L, 0x1a20a0c2L,
+0x8816eaf2L, 0x2e61e146L, 0x1f89fbdbL, 0xb9fef06fL,
+0x7c59cee1L, 0xda2ec555L, 0xebc6dfc8L, 0x4db1d47cL,
+0xbbf9a495L, 0x1d8eaf21L, 0x2c66b5bcL, 0x8a11be08L,
+0x4fb68086L, 0xe9c18b32L, 0xd82991afL, 0x7e5e9a1bL,
+0xefc8763cL, 0x49bf7d88L, 0x78576715L, 0xde206ca1L,
+0x1b87522fL, 0xbdf0599bL, 0x8c184306L, 0x2a6f48b2L,
+0xdc27385bL, 0x7a5033efL, 0x4bb82972L, 0xedcf22c6L,
+0x28681c48L, 0x8e1f17fcL, 0xbff70d61L, 0x198006d5L,
+0x47abd36eL, 0xe1dcd8daL, 0xd034c247L, 0x7643c9f3L,
+0xb3e4f77dL, 0x1593fcc9L, 0x247be654L, 0x820cede0L,
+0x74449d09L, 0xd23396bdL, 0xe3db8c20L, 0x45ac8794L,
+0x800bb91aL, 0x267cb2aeL, 0x1794a833L, 0xb1e3a387L,
+0x20754fa0L, 0x86024414L, 0xb7ea5e89L, 0x119d553dL,
+0xd43a6bb3L, 0x724d6007L, 0x43a57a9aL, 0xe5d2712eL,
+0x139a01c7L, 0xb5ed0a73L, 0x840510eeL, 0x22721b5aL,
+0xe7d525d4L, 0x41a22e60L, 0x704a34fdL, 0xd63d3f49L,
+0xcc1d9f8bL, 0x6a6a943fL, 0x5b828ea2L, 0xfdf58516L,
+0x3852bb98L, 0x9e25b02cL, 0xafcdaab1L, 0x09baa105L,
+0xfff2d1ecL, 0x5985da58L, 0x686dc0c5L, 0xce1acb71L,
+0x0bbdf5ffL, 0xadcafe4bL, 0x9c22e4d6L, 0x3a55ef62L,
+0xabc30345L, 0x0db408f1L, 0x3c5c126cL, 0x9a2b19d8L,
+0x5f8c2756L, 0xf9fb2ce2L, 0xc813367fL, 0x6e643dcbL,
+0x982c4d22L, 0x3e5b4696L, 0x0fb35c0bL, 0xa9c457bfL,
+0x6c636931L, 0xca146285L, 0xfbfc7818L, 0x5d8b73acL,
+0x03a0a617L, 0xa5d7ada3L, 0x943fb73eL, 0x3248bc8aL,
+0xf7ef8204L, 0x519889b0L, 0x6070932dL, 0xc6079899L,
+0x304fe870L, 0x9638e3c4L, 0xa7d0f959L, 0x01a7f2edL,
+0xc400cc63L, 0x6277c7d7L, 0x539fdd4aL, 0xf5e8d6feL,
+0x647e3ad9L, 0xc209316dL, 0xf3e12bf0L, 0x55962044L,
+0x90311ecaL, 0x3646157eL, 0x07ae0fe3L, 0xa1d90457L,
+0x579174beL, 0xf1e67f0aL, 0xc00e6597L, 0x66796e23L,
+0xa3de50adL, 0x05a95b19L, 0x34414184L, 0x92364a30L
+},
+{
+0x00000000L, 0xccaa009eL, 0x4225077dL, 0x8e8f07e3L,
+0x844a0efaL, 0x48e00e64L, 0xc66f0987L, 0x0ac50919L,
+0xd3e51bb5L, 0x1f4f1b2bL, 0x91c01cc8L, 0x5d6a1c56L,
+0x57af154fL, 0x9b0515d1L, 0x158a1232L, 0xd92012acL,
+0x7cbb312bL, 0xb01131b5L, 0x3e9e3656L, 0xf23436c8L,
+0xf8f13fd1L, 0x345b3f4fL, 0xbad438acL, 0x767e3832L,
+0xaf5e2a9eL, 0x63f42a00L, 0xed7b2de3L, 0x21d12d7dL,
+0x2b142464L, 0xe7be24faL, 0x69312319L, 0xa59b2387L,
+0xf9766256L, 0x35dc62c8L, 0xbb53652bL, 0x77f965b5L,
+0x7d3c6cacL, 0xb1966c32L, 0x3f196bd1L, 0xf3b36b4fL,
+0x2a9379e3L, 0xe639797dL, 0x68b67e9eL, 0xa41c7e00L,
+0xaed97719L, 0x62737787L, 0xecfc7064L, 0x205670faL,
+0x85cd537dL, 0x496753e3L, 0xc7e85400L, 0x0b42549eL,
+0x01875d87L, 0xcd2d5d19L, 0x43a25afaL, 0x8f085a64L,
+0x562848c8L, 0x9a824856L, 0x140d4fb5L, 0xd8a74f2bL,
+0xd2624632L, 0x1ec846acL, 0x9047414fL, 0x5ced41d1L,
+0x299dc2edL, 0xe537c273L, 0x6bb8c590L, 0xa712c50eL,
+0xadd7cc17L, 0x617dcc89L, 0xeff2cb6aL, 0x2358cbf4L,
+0xfa78d958L, 0x36d2d9c6L, 0xb85dde25L, 0x74f7debbL,
+0x7e32d7a2L, 0xb298d73cL, 0x3c17d0dfL, 0xf0bdd041L,
+0x5526f3c6L, 0x998cf358L, 0x1703f4bbL, 0xdba9f425L,
+0xd16cfd3cL, 0x1dc6fda2L, 0x9349fa41L, 0x5fe3fadfL,
+0x86c3e873L, 0x4a69e8edL, 0xc4e6ef0eL, 0x084cef90L,
+0x0289e689L, 0xce23e617L, 0x40ace1f4L, 0x8c06e16aL,
+0xd0eba0bbL, 0x1c41a025L, 0x92cea7c6L, 0x5e64a758L,
+0x54a1ae41L, 0x980baedfL, 0x1684a93cL, 0xda2ea9a2L,
+0x030ebb0eL, 0xcfa4bb90L, 0x412bbc73L, 0x8d81bcedL,
+0x8744b5f4L, 0x4beeb56aL, 0xc561b289L, 0x09cbb217L,
+0xac509190L, 0x60fa910eL, 0xee7596edL, 0x22df9673L,
+0x281a9f6aL, 0xe4b09ff4L, 0x6a3f9817L, 0xa6959889L,
+0x7fb58a25L, 0xb31f8abbL, 0x3d908d58L, 0xf13a8dc6L,
+0xfbff84dfL, 0x37558441L, 0xb9da83a2L, 0x7570833cL,
+0x533b85daL, 0x9f918544L, 0x111e82a7L, 0xddb48239L,
+0xd7718b20L, 0x1bdb8bbeL, 0x95548c5dL, 0x59fe8cc3L,
+0x80de9e6fL, 0x4c749ef1L, 0xc2fb9912L, 0x0e51998cL,
+0x04949095L, 0xc83e900bL, 0x46b197e8L, 0x8a1b9776L,
+0x2f80b4f1L, 0xe32ab46fL, 0x6da5b38cL, 0xa10fb312L,
+0xabcaba0bL, 0x6760ba95L, 0xe9efbd76L, 0x2545bde8L,
+0xfc65af44L, 0x30cfafdaL, 0xbe40a839L, 0x72eaa8a7L,
+0x782fa1beL, 0xb485a120L, 0x3a0aa6c3L, 0xf6a0a65dL,
+0xaa4de78cL, 0x66e7e712L, 0xe868e0f1L, 0x24c2e06fL,
+0x2e07e976L, 0xe2ade9e8L, 0x6c22ee0bL, 0xa088ee95L,
+0x79a8fc39L, 0xb502fca7L, 0x3b8dfb44L, 0xf727fbdaL,
+0xfde2f2c3L, 0x3148f25dL, 0xbfc7f5beL, 0x736df520L,
+0xd6f6d6a7L, 0x1a5cd639L, 0x94d3d1daL, 0x5879d144L,
+0x52bcd85dL, 0x9e16d8c3L, 0x1099df20L, 0xdc33dfbeL,
+0x0513cd12L, 0xc9b9cd8cL, 0x4736ca6fL, 0x8b9ccaf1L,
+0x8159c3e8L, 0x4df3c376L, 0xc37cc495L, 0x0fd6c40bL,
+0x7aa64737L, 0xb60c47a9L, 0x3883404aL, 0xf42940d4L,
+0xfeec49cdL, 0x32464953L, 0xbcc94eb0L, 0x70634e2eL,
+0xa9435c82L, 0x65e95c1cL, 0xeb665bffL, 0x27cc5b61L,
+0x2d095278L, 0xe1a352e6L, 0x6f2c5505L, 0xa386559bL,
+0x061d761cL, 0xcab77682L, 0x44387161L, 0x889271ffL,
+0x825778e6L, 0x4efd7878L, 0xc0727f9bL, 0x0cd87f05L,
+0xd5f86da9L, 0x19526d37L, 0x97dd6ad4L, 0x5b776a4aL,
+0x51b26353L, 0x9d1863cdL, 0x1397642eL, 0xdf3d64b0L,
+0x83d02561L, 0x4f7a25ffL, 0xc1f5221cL, 0x0d5f2282L,
+0x079a2b9bL, 0xcb302b05L, 0x45bf2ce6L, 0x89152c78L,
+0x50353ed4L, 0x9c9f3e4aL, 0x121039a9L, 0xdeba3937L,
+0xd47f302eL, 0x18d530b0L, 0x965a3753L, 0x5af037cdL,
+0xff6b144aL, 0x33c114d4L, 0xbd4e1337L, 0x71e413a9L,
+0x7b211ab0L, 0xb78b1a2eL, 0x39041dcdL, 0xf5ae1d53L,
+0x2c8e0fffL, 0xe0240f61L, 0x6eab0882L, 0xa201081cL,
+0xa8c40105L, 0x646e019bL, 0xeae10678L, 0x264b06e6L
+},
+#if AL_CRC32_SLICE > 8
+{
+0x00000000L, 0x177b1443L, 0x2ef62886L, 0x398d3cc5L,
+0x5dec510cL, 0x4a97454fL, 0x731a798aL, 0x64616dc9L,
+0xbbd8a218L, 0xaca3b65bL, 0x952e8a9eL, 0x82559eddL,
+0xe634f314L, 0xf14fe757L, 0xc8c2db92L, 0xdfb9cfd1L,
+0xacc04271L, 0xbbbb5632L, 0x82366af7L, 0x954d7eb4L,
+0xf12c137dL, 0xe657073eL, 0xdfda3bfbL, 0xc8a12fb8L,
+0x1718e069L, 0x0063f42aL, 0x39eec8efL, 0x2e95dcacL,
+0x4af4b165L, 0x5d8fa526L, 0x640299e3L, 0x73798da0L,
+0x82f182a3L, 0x958a96e0L, 0xac07aa25L, 0xbb7cbe66L,
+0xdf1dd3afL, 0xc866c7ecL, 0xf1ebfb29L, 0xe690ef6aL,
+0x392920bbL, 0x2e5234f8L, 0x17df083dL, 0x00a41c7eL,
+0x64c571b7L, 0x73be65f4L, 0x4a335931L, 0x5d484d72L,
+0x2e31c0d2L, 0x394ad491L, 0x00c7e854L, 0x17bcfc17L,
+0x73dd91deL, 0x64a6859dL, 0x5d2bb958L, 0x4a50ad1bL,
+0x95e962caL, 0x82927689L, 0xbb1f4a4cL, 0xac645e0fL,
+0xc80533c6L, 0xdf7e2785L, 0xe6f31b40L, 0xf1880f03L,
+0xde920307L, 0xc9e91744L, 0xf0642b81L, 0xe71f3fc2L,
+0x837e520bL, 0x94054648L, 0xad887a8dL, 0xbaf36eceL,
+0x654aa11fL, 0x7231b55cL, 0x4bbc8999L, 0x5cc79ddaL,
+0x38a6f013L, 0x2fdde450L, 0x1650d895L, 0x012bccd6L,
+0x72524176L, 0x65295535L, 0x5ca469f0L, 0x4bdf7db3L,
+0x2fbe107aL, 0x38c50439L, 0x014838fcL, 0x16332cbfL,
+0xc98ae36eL, 0xdef1f72dL, 0xe77ccbe8L, 0xf007dfabL,
+0x9466b262L, 0x831da621L, 0xba909ae4L, 0xadeb8ea7L,
+0x5c6381a4L, 0x4b1895e7L, 0x7295a922L, 0x65eebd61L,
+0x018fd0a8L, 0x16f4c4ebL, 0x2f79f82eL, 0x3802ec6dL,
+0xe7bb23bcL, 0xf0c037ffL, 0xc94d0b3aL, 0xde361f79L,
+0xba5772b0L, 0xad2c66f3L, 0x94a15a36L, 0x83da4e75L,
+0xf0a3c3d5L, 0xe7d8d796L, 0xde55eb53L, 0xc92eff10L,
+0xad4f92d9L, 0xba34869aL, 0x83b9ba5fL, 0x94c2ae1cL,
+0x4b7b61cdL, 0x5c00758eL, 0x658d494bL, 0x72f65d08L,
+0x169730c1L, 0x01ec2482L, 0x38611847L, 0x2f1a0c04L,
+0x6655004fL, 0x712e140cL, 0x48a328c9L, 0x5fd83c8aL,
+0x3bb95143L, 0x2cc24500L, 0x154f79c5L, 0x02346d86L,
+0xdd8da257L, 0xcaf6b614L, 0xf37b8ad1L, 0xe4009e92L,
+0x8061f35bL, 0x971ae718L, 0xae97dbddL, 0xb9eccf9eL,
+0xca95423eL, 0xddee567dL, 0xe4636ab8L, 0xf3187efbL,
+0x97791332L, 0x80020771L, 0xb98f3bb4L, 0xaef42ff7L,
+0x714de026L, 0x6636f465L, 0x5fbbc8a0L, 0x48c0dce3L,
+0x2ca1b12aL, 0x3bdaa569L, 0x025799acL, 0x152c8defL,
+0xe4a482ecL, 0xf3df96afL, 0xca52aa6aL, 0xdd29be29L,
+0xb948d3e0L, 0xae33c7a3L, 0x97befb66L, 0x80c5ef25L,
+0x5f7c20f4L, 0x480734b7L, 0x718a0872L, 0x66f11c31L,
+0x029071f8L, 0x15eb65bbL, 0x2c66597eL, 0x3b1d4d3dL,
+0x4864c09dL, 0x5f1fd4deL, 0x6692e81bL, 0x71e9fc58L,
+0x15889191L, 0x02f385d2L, 0x3b7eb917L, 0x2c05ad54L,
+0xf3bc6285L, 0xe4c776c6L, 0xdd4a4a03L, 0xca315e40L,
+0xae503389L, 0xb92b27caL, 0x80a61b0fL, 0x97dd0f4cL,
+0xb8c70348L, 0xafbc170bL, 0x96312bceL, 0x814a3f8dL,
+0xe52b5244L, 0xf2504607L, 0xcbdd7ac2L, 0xdca66e81L,
+0x031fa150L, 0x1464b513L, 0x2de989d6L, 0x3a929d95L,
+0x5ef3f05cL, 0x4988e41fL, 0x7005d8daL, 0x677ecc99L,
+0x14074139L, 0x037c557aL, 0x3af169bfL, 0x2d8a7dfcL,
+0x49eb1035L, 0x5e900476L, 0x671d38b3L, 0x70662cf0L,
+0xafdfe321L, 0xb8a4f762L, 0x8129cba7L, 0x9652dfe4L,
+0xf233b22dL, 0xe548a66eL, 0xdcc59aabL, 0xcbbe8ee8L,
+0x3a3681ebL, 0x2d4d95a8L, 0x14c0a96dL, 0x03bbbd2eL,
+0x67dad0e7L, 0x70a1c4a4L, 0x492cf861L, 0x5e57ec22L,
+0x81ee23f3L, 0x969537b0L, 0xaf180b75L, 0xb8631f36L,
+0xdc0272ffL, 0xcb7966bcL, 0xf2f45a79L, 0xe58f4e3aL,
+0x96f6c39aL, 0x818dd7d9L, 0xb800eb1cL, 0xaf7bff5fL,
+0xcb1a9296L, 0xdc6186d5L, 0xe5ecba10L, 0xf297ae53L,
+0x2d2e6182L, 0x3a5575c1L, 0x03d84904L, 0x14a35d47L,
+0x70c2308eL, 0x67b924cdL, 0x5e341808L, 0x494f0c4bL
+},
+{
+0x00000000L, 0xefc26b3eL, 0x04f5d03dL, 0xeb37bb03L,
+0x09eba07aL, 0xe629cb44L, 0x0d1e7047L, 0xe2dc1b79L,
+0x13d740f4L, 0xfc152bcaL, 0x172290c9L, 0xf8e0fbf7L,
+0x1a3ce08eL, 0xf5fe8bb0L, 0x1ec930b3L, 0xf10b5b8dL,
+0x27ae81e8L, 0xc86cead6L, 0x235b51d5L, 0xcc993aebL,
+0x2e452192L, 0xc1874aacL, 0x2ab0f1afL, 0xc5729a91L,
+0x3479c11cL, 0xdbbbaa22L, 0x308c1121L, 0xdf4e7a1fL,
+0x3d926166L, 0xd2500a58L, 0x3967b15bL, 0xd6a5da65L,
+0x4f5d03d0L, 0xa09f68eeL, 0x4ba8d3edL, 0xa46ab8d3L,
+0x46b6a3aaL, 0xa974c894L, 0x42437397L, 0xad8118a9L,
+0x5c8a4324L, 0xb348281aL, 0x587f9319L, 0xb7bdf827L,
+0x5561e35eL, 0xbaa38860L, 0x51943363L, 0xbe56585dL,
+0x68f38238L, 0x8731e906L, 0x6c065205L, 0x83c4393bL,
+0x61182242L, 0x8eda497cL, 0x65edf27fL, 0x8a2f9941L,
+0x7b24c2ccL, 0x94e6a9f2L, 0x7fd112f1L, 0x901379cfL,
+0x72cf62b6L, 0x9d0d0988L, 0x763ab28bL, 0x99f8d9b5L,
+0x9eba07a0L, 0x71786c9eL, 0x9a4fd79dL, 0x758dbca3L,
+0x9751a7daL, 0x7893cce4L, 0x93a477e7L, 0x7c661cd9L,
+0x8d6d4754L, 0x62af2c6aL, 0x89989769L, 0x665afc57L,
+0x8486e72eL, 0x6b448c10L, 0x80733713L, 0x6fb15c2dL,
+0xb9148648L, 0x56d6ed76L, 0xbde15675L, 0x52233d4bL,
+0xb0ff2632L, 0x5f3d4d0cL, 0xb40af60fL, 0x5bc89d31L,
+0xaac3c6bcL, 0x4501ad82L, 0xae361681L, 0x41f47dbfL,
+0xa32866c6L, 0x4cea0df8L, 0xa7ddb6fbL, 0x481fddc5L,
+0xd1e70470L, 0x3e256f4eL, 0xd512d44dL, 0x3ad0bf73L,
+0xd80ca40aL, 0x37cecf34L, 0xdcf97437L, 0x333b1f09L,
+0xc2304484L, 0x2df22fbaL, 0xc6c594b9L, 0x2907ff87L,
+0xcbdbe4feL, 0x24198fc0L, 0xcf2e34c3L, 0x20ec5ffdL,
+0xf6498598L, 0x198beea6L, 0xf2bc55a5L, 0x1d7e3e9bL,
+0xffa225e2L, 0x10604edcL, 0xfb57f5dfL, 0x14959ee1L,
+0xe59ec56cL, 0x0a5cae52L, 0xe16b1551L, 0x0ea97e6fL,
+0xec756516L, 0x03b70e28L, 0xe880b52bL, 0x0742de15L,
+0xe6050901L, 0x09c7623fL, 0xe2f0d93cL, 0x0d32b202L,
+0xefeea97bL, 0x002cc245L, 0xeb1b7946L, 0x04d91278L,
+0xf5d249f5L, 0x1a1022cbL, 0xf12799c8L, 0x1ee5f2f6L,
+0xfc39e98fL, 0x13fb82b1L, 0xf8cc39b2L, 0x170e528cL,
+0xc1ab88e9L, 0x2e69e3d7L, 0xc55e58d4L, 0x2a9c33eaL,
+0xc8402893L, 0x278243adL, 0xccb5f8aeL, 0x23779390L,
+0xd27cc81dL, 0x3dbea323L, 0xd6891820L, 0x394b731eL,
+0xdb976867L, 0x34550359L, 0xdf62b85aL, 0x30a0d364L,
+0xa9580ad1L, 0x469a61efL, 0xadaddaecL, 0x426fb1d2L,
+0xa0b3aaabL, 0x4f71c195L, 0xa4467a96L, 0x4b8411a8L,
+0xba8f4a25L, 0x554d211bL, 0xbe7a9a18L, 0x51b8f126L,
+0xb364ea5fL, 0x5ca68161L, 0xb7913a62L, 0x5853515cL,
+0x8ef68b39L, 0x6134e007L, 0x8a035b04L, 0x65c1303aL,
+0x871d2b43L, 0x68df407dL, 0x83e8fb7eL, 0x6c2a9040L,
+0x9d21cbcdL, 0x72e3a0f3L, 0x99d41bf0L, 0x761670ceL,
+0x94ca6bb7L, 0x7b080089L, 0x903fbb8aL, 0x7ffdd0b4L,
+0x78bf0ea1L, 0x977d659fL, 0x7c4ade9cL, 0x9388b5a2L,
+0x7154aedbL, 0x9e96c5e5L, 0x75a17ee6L, 0x9a6315d8L,
+0x6b684e55L, 0x84aa256bL, 0x6f9d9e68L, 0x805ff556L,
+0x6283ee2fL, 0x8d418511L, 0x66763e12L, 0x89b4552cL,
+0x5f118f49L, 0xb0d3e477L, 0x5be45f74L, 0xb426344aL,
+0x56fa2f33L, 0xb938440dL, 0x520fff0eL, 0xbdcd9430L,
+0x4cc6cfbdL, 0xa304a483L, 0x48331f80L, 0xa7f174beL,
+0x452d6fc7L, 0xaaef04f9L, 0x41d8bffaL, 0xae1ad4c4L,
+0x37e20d71L, 0xd820664fL, 0x3317dd4cL, 0xdcd5b672L,
+0x3e09ad0bL, 0xd1cbc635L, 0x3afc7d36L, 0xd53e1608L,
+0x24354d85L, 0xcbf726bbL, 0x20c09db8L, 0xcf02f686L,
+0x2ddeedffL, 0xc21c86c1L, 0x292b3dc2L, 0xc6e956fcL,
+0x104c8c99L, 0xff8ee7a7L, 0x14b95ca4L, 0xfb7b379aL,
+0x19a72ce3L, 0xf66547ddL, 0x1d52fcdeL, 0xf29097e0L,
+0x039bcc6dL, 0xec59a753L, 0x076e1c50L, 0xe8ac776eL,
+0x0a706c17L, 0xe5b20729L, 0x0e85bc2aL, 0xe147d714L
+},
+{
+0x00000000L, 0xc18edfc0L, 0x586cb9c1L, 0x99e26601L,
+0xb0d97382L, 0x7157ac42L, 0xe8b5ca43L, 0x293b1583L,
+0xbac3e145L, 0x7b4d3e85L, 0xe2af5884L, 0x23218744L,
+0x0a1a92c7L, 0xcb944d07L, 0x52762b06L, 0x93f8f4c6L,
+0xaef6c4cbL, 0x6f781b0bL, 0xf69a7d0aL, 0x3714a2caL,
+0x1e2fb749L, 0xdfa16889L, 0x46430e88L, 0x87cdd148L,
+0x1435258eL, 0xd5bbfa4eL, 0x4c599c4fL, 0x8dd7438fL,
+0xa4ec560cL, 0x656289ccL, 0xfc80efcdL, 0x3d0e300dL,
+0x869c8fd7L, 0x47125017L, 0xdef03616L, 0x1f7ee9d6L,
+0x3645fc55L, 0xf7cb2395L, 0x6e294594L, 0xafa79a54L,
+0x3c5f6e92L, 0xfdd1b152L, 0x6433d753L, 0xa5bd0893L,
+0x8c861d10L, 0x4d08c2d0L, 0xd4eaa4d1L, 0x15647b11L,
+0x286a4b1cL, 0xe9e494dcL, 0x7006f2ddL, 0xb1882d1dL,
+0x98b3389eL, 0x593de75eL, 0xc0df815fL, 0x01515e9fL,
+0x92a9aa59L, 0x53277599L, 0xcac51398L, 0x0b4bcc58L,
+0x2270d9dbL, 0xe3fe061bL, 0x7a1c601aL, 0xbb92bfdaL,
+0xd64819efL, 0x17c6c62fL, 0x8e24a02eL, 0x4faa7feeL,
+0x66916a6dL, 0xa71fb5adL, 0x3efdd3acL, 0xff730c6cL,
+0x6c8bf8aaL, 0xad05276aL, 0x34e7416bL, 0xf5699eabL,
+0xdc528b28L, 0x1ddc54e8L, 0x843e32e9L, 0x45b0ed29L,
+0x78bedd24L, 0xb93002e4L, 0x20d264e5L, 0xe15cbb25L,
+0xc867aea6L, 0x09e97166L, 0x900b1767L, 0x5185c8a7L,
+0xc27d3c61L, 0x03f3e3a1L, 0x9a1185a0L, 0x5b9f5a60L,
+0x72a44fe3L, 0xb32a9023L, 0x2ac8f622L, 0xeb4629e2L,
+0x50d49638L, 0x915a49f8L, 0x08b82ff9L, 0xc936f039L,
+0xe00de5baL, 0x21833a7aL, 0xb8615c7bL, 0x79ef83bbL,
+0xea17777dL, 0x2b99a8bdL, 0xb27bcebcL, 0x73f5117cL,
+0x5ace04ffL, 0x9b40db3fL, 0x02a2bd3eL, 0xc32c62feL,
+0xfe2252f3L, 0x3fac8d33L, 0xa64eeb32L, 0x67c034f2L,
+0x4efb2171L, 0x8f75feb1L, 0x169798b0L, 0xd7194770L,
+0x44e1b3b6L, 0x856f6c76L, 0x1c8d0a77L, 0xdd03d5b7L,
+0xf438c034L, 0x35b61ff4L, 0xac5479f5L, 0x6ddaa635L,
+0x77e1359fL, 0xb66fea5fL, 0x2f8d8c5eL, 0xee03539eL,
+0xc738461dL, 0x06b699ddL, 0x9f54ffdcL, 0x5eda201cL,
+0xcd22d4daL, 0x0cac0b1aL, 0x954e6d1bL, 0x54c0b2dbL,
+0x7dfba758L, 0xbc757898L, 0x25971e99L, 0xe419c159L,
+0xd917f154L, 0x18992e94L, 0x817b4895L, 0x40f59755L,
+0x69ce82d6L, 0xa8405d16L, 0x31a23b17L, 0xf02ce4d7L,
+0x63d41011L, 0xa25acfd1L, 0x3bb8a9d0L, 0xfa367610L,
+0xd30d6393L, 0x1283bc53L, 0x8b61da52L, 0x4aef0592L,
+0xf17dba48L, 0x30f36588L, 0xa9110389L, 0x689fdc49L,
+0x41a4c9caL, 0x802a160aL, 0x19c8700bL, 0xd846afcbL,
+0x4bbe5b0dL, 0x8a3084cdL, 0x13d2e2ccL, 0xd25c3d0cL,
+0xfb67288fL, 0x3ae9f74fL, 0xa30b914eL, 0x62854e8eL,
+0x5f8b7e83L, 0x9e05a143L, 0x07e7c742L, 0xc6691882L,
+0xef520d01L, 0x2edcd2c1L, 0xb73eb4c0L, 0x76b06b00L,
+0xe5489fc6L, 0x24c64006L, 0xbd242607L, 0x7caaf9c7L,
+0x5591ec44L, 0x941f3384L, 0x0dfd5585L, 0xcc738a45L,
+0xa1a92c70L, 0x6027f3b0L, 0xf9c595b1L, 0x384b4a71L,
+0x11705ff2L, 0xd0fe8032L, 0x491ce633L, 0x889239f3L,
+0x1b6acd35L, 0xdae412f5L, 0x430674f4L, 0x8288ab34L,
+0xabb3beb7L, 0x6a3d6177L, 0xf3df0776L, 0x3251d8b6L,
+0x0f5fe8bbL, 0xced1377bL, 0x5733517aL, 0x96bd8ebaL,
+0xbf869b39L, 0x7e0844f9L, 0xe7ea22f8L, 0x2664fd38L,
+0xb59c09feL, 0x7412d63eL, 0xedf0b03fL, 0x2c7e6fffL,
+0x05457a7cL, 0xc4cba5bcL, 0x5d29c3bdL, 0x9ca71c7dL,
+0x2735a3a7L, 0xe6bb7c67L, 0x7f591a66L, 0xbed7c5a6L,
+0x97ecd025L, 0x56620fe5L, 0xcf8069e4L, 0x0e0eb624L,
+0x9df642e2L, 0x5c789d22L, 0xc59afb23L, 0x041424e3L,
+0x2d2f3160L, 0xeca1eea0L, 0x754388a1L, 0xb4cd5761L,
+0x89c3676cL, 0x484db8acL, 0xd1afdeadL, 0x1021016dL,
+0x391a14eeL, 0xf894cb2eL, 0x6176ad2fL, 0xa0f872efL,
+0x33008629L, 0xf28e59e9L, 0x6b6c3fe8L, 0xaae2e028L,
+0x83d9f5abL, 0x42572a6bL, 0xdbb54c6aL, 0x1a3b93aaL
+},
+{
+0x00000000L, 0x9ba54c6fL, 0xec3b9e9fL, 0x779ed2f0L,
+0x03063b7fL, 0x98a37710L, 0xef3da5e0L, 0x7498e98fL,
+0x060c76feL, 0x9da93a91L, 0xea37e861L, 0x7192a40eL,
+0x050a4d81L, 0x9eaf01eeL, 0xe931d31eL, 0x72949f71L,
+0x0c18edfcL, 0x97bda193L, 0xe0237363L, 0x7b863f0cL,
+0x0f1ed683L, 0x94bb9aecL, 0xe325481cL, 0x78800473L,
+0x0a149b02L, 0x91b1d76dL, 0xe62f059dL, 0x7d8a49f2L,
+0x0912a07dL, 0x92b7ec12L, 0xe5293ee2L, 0x7e8c728dL,
+0x1831dbf8L, 0x83949797L, 0xf40a4567L, 0x6faf0908L,
+0x1b37e087L, 0x8092ace8L, 0xf70c7e18L, 0x6ca93277L,
+0x1e3dad06L, 0x8598e169L, 0xf2063399L, 0x69a37ff6L,
+0x1d3b9679L, 0x869eda16L, 0xf10008e6L, 0x6aa54489L,
+0x14293604L, 0x8f8c7a6bL, 0xf812a89bL, 0x63b7e4f4L,
+0x172f0d7bL, 0x8c8a4114L, 0xfb1493e4L, 0x60b1df8bL,
+0x122540faL, 0x89800c95L, 0xfe1ede65L, 0x65bb920aL,
+0x11237b85L, 0x8a8637eaL, 0xfd18e51aL, 0x66bda975L,
+0x3063b7f0L, 0xabc6fb9fL, 0xdc58296fL, 0x47fd6500L,
+0x33658c8fL, 0xa8c0c0e0L, 0xdf5e1210L, 0x44fb5e7fL,
+0x366fc10eL, 0xadca8d61L, 0xda545f91L, 0x41f113feL,
+0x3569fa71L, 0xaeccb61eL, 0xd95264eeL, 0x42f72881L,
+0x3c7b5a0cL, 0xa7de1663L, 0xd040c493L, 0x4be588fcL,
+0x3f7d6173L, 0xa4d82d1cL, 0xd346ffecL, 0x48e3b383L,
+0x3a772cf2L, 0xa1d2609dL, 0xd64cb26dL, 0x4de9fe02L,
+0x3971178dL, 0xa2d45be2L, 0xd54a8912L, 0x4eefc57dL,
+0x28526c08L, 0xb3f72067L, 0xc469f297L, 0x5fccbef8L,
+0x2b545777L, 0xb0f11b18L, 0xc76fc9e8L, 0x5cca8587L,
+0x2e5e1af6L, 0xb5fb5699L, 0xc2658469L, 0x59c0c806L,
+0x2d582189L, 0xb6fd6de6L, 0xc163bf16L, 0x5ac6f379L,
+0x244a81f4L, 0xbfefcd9bL, 0xc8711f6bL, 0x53d45304L,
+0x274cba8bL, 0xbce9f6e4L, 0xcb772414L, 0x50d2687bL,
+0x2246f70aL, 0xb9e3bb65L, 0xce7d6995L, 0x55d825faL,
+0x2140cc75L, 0xbae5801aL, 0xcd7b52eaL, 0x56de1e85L,
+0x60c76fe0L, 0xfb62238fL, 0x8cfcf17fL, 0x1759bd10L,
+0x63c1549fL, 0xf86418f0L, 0x8ffaca00L, 0x145f866fL,
+0x66cb191eL, 0xfd6e5571L, 0x8af08781L, 0x1155cbeeL,
+0x65cd2261L, 0xfe686e0eL, 0x89f6bcfeL, 0x1253f091L,
+0x6cdf821cL, 0xf77ace73L, 0x80e41c83L, 0x1b4150ecL,
+0x6fd9b963L, 0xf47cf50cL, 0x83e227fcL, 0x18476b93L,
+0x6ad3f4e2L, 0xf176b88dL, 0x86e86a7dL, 0x1d4d2612L,
+0x69d5cf9dL, 0xf27083f2L, 0x85ee5102L, 0x1e4b1d6dL,
+0x78f6b418L, 0xe353f877L, 0x94cd2a87L, 0x0f6866e8L,
+0x7bf08f67L, 0xe055c308L, 0x97cb11f8L, 0x0c6e5d97L,
+0x7efac2e6L, 0xe55f8e89L, 0x92c15c79L, 0x09641016L,
+0x7dfcf999L, 0xe659b5f6L, 0x91c76706L, 0x0a622b69L,
+0x74ee59e4L, 0xef4b158bL, 0x98d5c77bL, 0x03708b14L,
+0x77e8629bL, 0xec4d2ef4L, 0x9bd3fc04L, 0x0076b06bL,
+0x72e22f1aL, 0xe9476375L, 0x9ed9b185L, 0x057cfdeaL,
+0x71e41465L, 0xea41580aL, 0x9ddf8afaL, 0x067ac695L,
+0x50a4d810L, 0xcb01947fL, 0xbc9f468fL, 0x273a0ae0L,
+0x53a2e36fL, 0xc807af00L, 0xbf997df0L, 0x243c319fL,
+0x56a8aeeeL, 0xcd0de281L, 0xba933071L, 0x21367c1eL,
+0x55ae9591L, 0xce0bd9feL, 0xb9950b0eL, 0x22304761L,
+0x5cbc35ecL, 0xc7197983L, 0xb087ab73L, 0x2b22e71cL,
+0x5fba0e93L, 0xc41f42fcL, 0xb381900cL, 0x2824dc63L,
+0x5ab04312L, 0xc1150f7dL, 0xb68bdd8dL, 0x2d2e91e2L,
+0x59b6786dL, 0xc2133402L, 0xb58de6f2L, 0x2e28aa9dL,
+0x489503e8L, 0xd3304f87L, 0xa4ae9d77L, 0x3f0bd118L,
+0x4b933897L, 0xd03674f8L, 0xa7a8a608L, 0x3c0dea67L,
+0x4e997516L, 0xd53c3979L, 0xa2a2eb89L, 0x3907a7e6L,
+0x4d9f4e69L, 0xd63a0206L, 0xa1a4d0f6L, 0x3a019c99L,
+0x448dee14L, 0xdf28a27bL, 0xa8b6708bL, 0x33133ce4L,
+0x478bd56bL, 0xdc2e9904L, 0xabb04bf4L, 0x3015079bL,
+0x428198eaL, 0xd924d485L, 0xaeba0675L, 0x351f4a1aL,
+0x4187a395L, 0xda22effaL, 0xadbc3d0aL, 0x36197165L
+},
+{
+0x00000000L, 0xdd96d985L, 0x605cb54bL, 0xbdca6cceL,
+0xc0b96a96L, 0x1d2fb313L, 0xa0e5dfddL, 0x7d730658L,
+0x5a03d36dL, 0x87950ae8L, 0x3a5f6626L, 0xe7c9bfa3L,
+0x9abab9fbL, 0x472c607eL, 0xfae60cb0L, 0x2770d535L,
+0xb407a6daL, 0x69917f5fL, 0xd45b1391L, 0x09cdca14L,
+0x74becc4cL, 0xa92815c9L, 0x14e27907L, 0xc974a082L,
+0xee0475b7L, 0x3392ac32L, 0x8e58c0fcL, 0x53ce1979L,
+0x2ebd1f21L, 0xf32bc6a4L, 0x4ee1aa6aL, 0x937773efL,
+0xb37e4bf5L, 0x6ee89270L, 0xd322febeL, 0x0eb4273bL,
+0x73c72163L, 0xae51f8e6L, 0x139b9428L, 0xce0d4dadL,
+0xe97d9898L, 0x34eb411dL, 0x89212dd3L, 0x54b7f456L,
+0x29c4f20eL, 0xf4522b8bL, 0x49984745L, 0x940e9ec0L,
+0x0779ed2fL, 0xdaef34aaL, 0x67255864L, 0xbab381e1L,
+0xc7c087b9L, 0x1a565e3cL, 0xa79c32f2L, 0x7a0aeb77L,
+0x5d7a3e42L, 0x80ece7c7L, 0x3d268b09L, 0xe0b0528cL,
+0x9dc354d4L, 0x40558d51L, 0xfd9fe19fL, 0x2009381aL,
+0xbd8d91abL, 0x601b482eL, 0xddd124e0L, 0x0047fd65L,
+0x7d34fb3dL, 0xa0a222b8L, 0x1d684e76L, 0xc0fe97f3L,
+0xe78e42c6L, 0x3a189b43L, 0x87d2f78dL, 0x5a442e08L,
+0x27372850L, 0xfaa1f1d5L, 0x476b9d1bL, 0x9afd449eL,
+0x098a3771L, 0xd41ceef4L, 0x69d6823aL, 0xb4405bbfL,
+0xc9335de7L, 0x14a58462L, 0xa96fe8acL, 0x74f93129L,
+0x5389e41cL, 0x8e1f3d99L, 0x33d55157L, 0xee4388d2L,
+0x93308e8aL, 0x4ea6570fL, 0xf36c3bc1L, 0x2efae244L,
+0x0ef3da5eL, 0xd36503dbL, 0x6eaf6f15L, 0xb339b690L,
+0xce4ab0c8L, 0x13dc694dL, 0xae160583L, 0x7380dc06L,
+0x54f00933L, 0x8966d0b6L, 0x34acbc78L, 0xe93a65fdL,
+0x944963a5L, 0x49dfba20L, 0xf415d6eeL, 0x29830f6bL,
+0xbaf47c84L, 0x6762a501L, 0xdaa8c9cfL, 0x073e104aL,
+0x7a4d1612L, 0xa7dbcf97L, 0x1a11a359L, 0xc7877adcL,
+0xe0f7afe9L, 0x3d61766cL, 0x80ab1aa2L, 0x5d3dc327L,
+0x204ec57fL, 0xfdd81cfaL, 0x40127034L, 0x9d84a9b1L,
+0xa06a2517L, 0x7dfcfc92L, 0xc036905cL, 0x1da049d9L,
+0x60d34f81L, 0xbd459604L, 0x008ffacaL, 0xdd19234fL,
+0xfa69f67aL, 0x27ff2fffL, 0x9a354331L, 0x47a39ab4L,
+0x3ad09cecL, 0xe7464569L, 0x5a8c29a7L, 0x871af022L,
+0x146d83cdL, 0xc9fb5a48L, 0x74313686L, 0xa9a7ef03L,
+0xd4d4e95bL, 0x094230deL, 0xb4885c10L, 0x691e8595L,
+0x4e6e50a0L, 0x93f88925L, 0x2e32e5ebL, 0xf3a43c6eL,
+0x8ed73a36L, 0x5341e3b3L, 0xee8b8f7dL, 0x331d56f8L,
+0x13146ee2L, 0xce82b767L, 0x7348dba9L, 0xaede022cL,
+0xd3ad0474L, 0x0e3bddf1L, 0xb3f1b13fL, 0x6e6768baL,
+0x4917bd8fL, 0x9481640aL, 0x294b08c4L, 0xf4ddd141L,
+0x89aed719L, 0x54380e9cL, 0xe9f26252L, 0x3464bbd7L,
+0xa713c838L, 0x7a8511bdL, 0xc74f7d73L, 0x1ad9a4f6L,
+0x67aaa2aeL, 0xba3c7b2bL, 0x07f617e5L, 0xda60ce60L,
+0xfd101b55L, 0x2086c2d0L, 0x9d4cae1eL, 0x40da779bL,
+0x3da971c3L, 0xe03fa846L, 0x5df5c488L, 0x80631d0dL,
+0x1de7b4bcL, 0xc0716d39L, 0x7dbb01f7L, 0xa02dd872L,
+0xdd5ede2aL, 0x00c807afL, 0xbd026b61L, 0x6094b2e4L,
+0x47e467d1L, 0x9a72be54L, 0x27b8d29aL, 0xfa2e0b1fL,
+0x875d0d47L, 0x5acbd4c2L, 0xe701b80cL, 0x3a976189L,
+0xa9e01266L, 0x7476cbe3L, 0xc9bca72dL, 0x142a7ea8L,
+0x695978f0L, 0xb4cfa175L, 0x0905cdbbL, 0xd493143eL,
+0xf3e3c10bL, 0x2e75188eL, 0x93bf7440L, 0x4e29adc5L,
+0x335aab9dL, 0xeecc7218L, 0x53061ed6L, 0x8e90c753L,
+0xae99ff49L, 0x730f26ccL, 0xcec54a02L, 0x13539387L,
+0x6e2095dfL, 0xb3b64c5aL, 0x0e7c2094L, 0xd3eaf911L,
+0xf49a2c24L, 0x290cf5a1L, 0x94c6996fL, 0x495040eaL,
+0x342346b2L, 0xe9b59f37L, 0x547ff3f9L, 0x89e92a7cL,
+0x1a9e5993L, 0xc7088016L, 0x7ac2ecd8L, 0xa754355dL,
+0xda273305L, 0x07b1ea80L, 0xba7b864eL, 0x67ed5fcbL,
+0x409d8afeL, 0x9d0b537bL, 0x20c13fb5L, 0xfd57e630L,
+0x8024e068L, 0x5db239edL, 0xe0785523L, 0x3dee8ca6L
+},
+{
+0x00000000L, 0x9d0fe176L, 0xe16ec4adL, 0x7c6125dbL,
+0x19ac8f1bL, 0x84a36e6dL, 0xf8c24bb6L, 0x65cdaac0L,
+0x33591e36L, 0xae56ff40L, 0xd237da9bL, 0x4f383bedL,
+0x2af5912dL, 0xb7fa705bL, 0xcb9b5580L, 0x5694b4f6L,
+0x66b23c6cL, 0xfbbddd1aL, 0x87dcf8c1L, 0x1ad319b7L,
+0x7f1eb377L, 0xe2115201L, 0x9e7077daL, 0x037f96acL,
+0x55eb225aL, 0xc8e4c32cL, 0xb485e6f7L, 0x298a0781L,
+0x4c47ad41L, 0xd1484c37L, 0xad2969ecL, 0x3026889aL,
+0xcd6478d8L, 0x506b99aeL, 0x2c0abc75L, 0xb1055d03L,
+0xd4c8f7c3L, 0x49c716b5L, 0x35a6336eL, 0xa8a9d218L,
+0xfe3d66eeL, 0x63328798L, 0x1f53a243L, 0x825c4335L,
+0xe791e9f5L, 0x7a9e0883L, 0x06ff2d58L, 0x9bf0cc2eL,
+0xabd644b4L, 0x36d9a5c2L, 0x4ab88019L, 0xd7b7616fL,
+0xb27acbafL, 0x2f752ad9L, 0x53140f02L, 0xce1bee74L,
+0x988f5a82L, 0x0580bbf4L, 0x79e19e2fL, 0xe4ee7f59L,
+0x8123d599L, 0x1c2c34efL, 0x604d1134L, 0xfd42f042L,
+0x41b9f7f1L, 0xdcb61687L, 0xa0d7335cL, 0x3dd8d22aL,
+0x581578eaL, 0xc51a999cL, 0xb97bbc47L, 0x24745d31L,
+0x72e0e9c7L, 0xefef08b1L, 0x938e2d6aL, 0x0e81cc1cL,
+0x6b4c66dcL, 0xf64387aaL, 0x8a22a271L, 0x172d4307L,
+0x270bcb9dL, 0xba042aebL, 0xc6650f30L, 0x5b6aee46L,
+0x3ea74486L, 0xa3a8a5f0L, 0xdfc9802bL, 0x42c6615dL,
+0x1452d5abL, 0x895d34ddL, 0xf53c1106L, 0x6833f070L,
+0x0dfe5ab0L, 0x90f1bbc6L, 0xec909e1dL, 0x719f7f6bL,
+0x8cdd8f29L, 0x11d26e5fL, 0x6db34b84L, 0xf0bcaaf2L,
+0x95710032L, 0x087ee144L, 0x741fc49fL, 0xe91025e9L,
+0xbf84911fL, 0x228b7069L, 0x5eea55b2L, 0xc3e5b4c4L,
+0xa6281e04L, 0x3b27ff72L, 0x4746daa9L, 0xda493bdfL,
+0xea6fb345L, 0x77605233L, 0x0b0177e8L, 0x960e969eL,
+0xf3c33c5eL, 0x6eccdd28L, 0x12adf8f3L, 0x8fa21985L,
+0xd936ad73L, 0x44394c05L, 0x385869deL, 0xa55788a8L,
+0xc09a2268L, 0x5d95c31eL, 0x21f4e6c5L, 0xbcfb07b3L,
+0x8373efe2L, 0x1e7c0e94L, 0x621d2b4fL, 0xff12ca39L,
+0x9adf60f9L, 0x07d0818fL, 0x7bb1a454L, 0xe6be4522L,
+0xb02af1d4L, 0x2d2510a2L, 0x51443579L, 0xcc4bd40fL,
+0xa9867ecfL, 0x34899fb9L, 0x48e8ba62L, 0xd5e75b14L,
+0xe5c1d38eL, 0x78ce32f8L, 0x04af1723L, 0x99a0f655L,
+0xfc6d5c95L, 0x6162bde3L, 0x1d039838L, 0x800c794eL,
+0xd698cdb8L, 0x4b972cceL, 0x37f60915L, 0xaaf9e863L,
+0xcf3442a3L, 0x523ba3d5L, 0x2e5a860eL, 0xb3556778L,
+0x4e17973aL, 0xd318764cL, 0xaf795397L, 0x3276b2e1L,
+0x57bb1821L, 0xcab4f957L, 0xb6d5dc8cL, 0x2bda3dfaL,
+0x7d4e890cL, 0xe041687aL, 0x9c204da1L, 0x012facd7L,
+0x64e20617L, 0xf9ede761L, 0x858cc2baL, 0x188323ccL,
+0x28a5ab56L, 0xb5aa4a20L, 0xc9cb6ffbL, 0x54c48e8dL,
+0x3109244dL, 0xac06c53bL, 0xd067e0e0L, 0x4d680196L,
+0x1bfcb560L, 0x86f35416L, 0xfa9271cdL, 0x679d90bbL,
+0x02503a7bL, 0x9f5fdb0dL, 0xe33efed6L, 0x7e311fa0L,
+0xc2ca1813L, 0x5fc5f965L, 0x23a4dcbeL, 0xbeab3dc8L,
+0xdb669708L, 0x4669767eL, 0x3a0853a5L, 0xa707b2d3L,
+0xf1930625L, 0x6c9ce753L, 0x10fdc288L, 0x8df223feL,
+0xe83f893eL, 0x75306848L, 0x09514d93L, 0x945eace5L,
+0xa478247fL, 0x3977c509L, 0x4516e0d2L, 0xd81901a4L,
+0xbdd4ab64L, 0x20db4a12L, 0x5cba6fc9L, 0xc1b58ebfL,
+0x97213a49L, 0x0a2edb3fL, 0x764ffee4L, 0xeb401f92L,
+0x8e8db552L, 0x13825424L, 0x6fe371ffL, 0xf2ec9089L,
+0x0fae60cbL, 0x92a181bdL, 0xeec0a466L, 0x73cf4510L,
+0x1602efd0L, 0x8b0d0ea6L, 0xf76c2b7dL, 0x6a63ca0bL,
+0x3cf77efdL, 0xa1f89f8bL, 0xdd99ba50L, 0x40965b26L,
+0x255bf1e6L, 0xb8541090L, 0xc435354bL, 0x593ad43dL,
+0x691c5ca7L, 0xf413bdd1L, 0x8872980aL, 0x157d797cL,
+0x70b0d3bcL, 0xedbf32caL, 0x91de1711L, 0x0cd1f667L,
+0x5a454291L, 0xc74aa3e7L, 0xbb2b863cL, 0x2624674aL,
+0x43e9cd8aL, 0xdee62cfcL, 0xa2870927L, 0x3f88e851L
+},
+{
+0x00000000L, 0xb9fbdbe8L, 0xa886b191L, 0x117d6a79L,
+0x8a7c6563L, 0x3387be8bL, 0x22fad4f2L, 0x9b010f1aL,
+0xcf89cc87L, 0x7672176fL, 0x670f7d16L, 0xdef4a6feL,
+0x45f5a9e4L, 0xfc0e720cL, 0xed731875L, 0x5488c39dL,
+0x44629f4fL, 0xfd9944a7L, 0xece42edeL, 0x551ff536L,
+0xce1efa2cL, 0x77e521c4L, 0x66984bbdL, 0xdf639055L,
+0x8beb53c8L, 0x32108820L, 0x236de259L, 0x9a9639b1L,
+0x019736abL, 0xb86ced43L, 0xa911873aL, 0x10ea5cd2L,
+0x88c53e9eL, 0x313ee576L, 0x20438f0fL, 0x99b854e7L,
+0x02b95bfdL, 0xbb428015L, 0xaa3fea6cL, 0x13c43184L,
+0x474cf219L, 0xfeb729f1L, 0xefca4388L, 0x56319860L,
+0xcd30977aL, 0x74cb4c92L, 0x65b626ebL, 0xdc4dfd03L,
+0xcca7a1d1L, 0x755c7a39L, 0x64211040L, 0xdddacba8L,
+0x46dbc4b2L, 0xff201f5aL, 0xee5d7523L, 0x57a6aecbL,
+0x032e6d56L, 0xbad5b6beL, 0xaba8dcc7L, 0x1253072fL,
+0x89520835L, 0x30a9d3ddL, 0x21d4b9a4L, 0x982f624cL,
+0xcafb7b7dL, 0x7300a095L, 0x627dcaecL, 0xdb861104L,
+0x40871e1eL, 0xf97cc5f6L, 0xe801af8fL, 0x51fa7467L,
+0x0572b7faL, 0xbc896c12L, 0xadf4066bL, 0x140fdd83L,
+0x8f0ed299L, 0x36f50971L, 0x27886308L, 0x9e73b8e0L,
+0x8e99e432L, 0x37623fdaL, 0x261f55a3L, 0x9fe48e4bL,
+0x04e58151L, 0xbd1e5ab9L, 0xac6330c0L, 0x1598eb28L,
+0x411028b5L, 0xf8ebf35dL, 0xe9969924L, 0x506d42ccL,
+0xcb6c4dd6L, 0x7297963eL, 0x63eafc47L, 0xda1127afL,
+0x423e45e3L, 0xfbc59e0bL, 0xeab8f472L, 0x53432f9aL,
+0xc8422080L, 0x71b9fb68L, 0x60c49111L, 0xd93f4af9L,
+0x8db78964L, 0x344c528cL, 0x253138f5L, 0x9ccae31dL,
+0x07cbec07L, 0xbe3037efL, 0xaf4d5d96L, 0x16b6867eL,
+0x065cdaacL, 0xbfa70144L, 0xaeda6b3dL, 0x1721b0d5L,
+0x8c20bfcfL, 0x35db6427L, 0x24a60e5eL, 0x9d5dd5b6L,
+0xc9d5162bL, 0x702ecdc3L, 0x6153a7baL, 0xd8a87c52L,
+0x43a97348L, 0xfa52a8a0L, 0xeb2fc2d9L, 0x52d41931L,
+0x4e87f0bbL, 0xf77c2b53L, 0xe601412aL, 0x5ffa9ac2L,
+0xc4fb95d8L, 0x7d004e30L, 0x6c7d2449L, 0xd586ffa1L,
+0x810e3c3cL, 0x38f5e7d4L, 0x29888dadL, 0x90735645L,
+0x0b72595fL, 0xb28982b7L, 0xa3f4e8ceL, 0x1a0f3326L,
+0x0ae56ff4L, 0xb31eb41cL, 0xa263de65L, 0x1b98058dL,
+0x80990a97L, 0x3962d17fL, 0x281fbb06L, 0x91e460eeL,
+0xc56ca373L, 0x7c97789bL, 0x6dea12e2L, 0xd411c90aL,
+0x4f10c610L, 0xf6eb1df8L, 0xe7967781L, 0x5e6dac69L,
+0xc642ce25L, 0x7fb915cdL, 0x6ec47fb4L, 0xd73fa45cL,
+0x4c3eab46L, 0xf5c570aeL, 0xe4b81ad7L, 0x5d43c13fL,
+0x09cb02a2L, 0xb030d94aL, 0xa14db333L, 0x18b668dbL,
+0x83b767c1L, 0x3a4cbc29L, 0x2b31d650L, 0x92ca0db8L,
+0x8220516aL, 0x3bdb8a82L, 0x2aa6e0fbL, 0x935d3b13L,
+0x085c3409L, 0xb1a7efe1L, 0xa0da8598L, 0x19215e70L,
+0x4da99dedL, 0xf4524605L, 0xe52f2c7cL, 0x5cd4f794L,
+0xc7d5f88eL, 0x7e2e2366L, 0x6f53491fL, 0xd6a892f7L,
+0x847c8bc6L, 0x3d87502eL, 0x2cfa3a57L, 0x9501e1bfL,
+0x0e00eea5L, 0xb7fb354dL, 0xa6865f34L, 0x1f7d84dcL,
+0x4bf54741L, 0xf20e9ca9L, 0xe373f6d0L, 0x5a882d38L,
+0xc1892222L, 0x7872f9caL, 0x690f93b3L, 0xd0f4485bL,
+0xc01e1489L, 0x79e5cf61L, 0x6898a518L, 0xd1637ef0L,
+0x4a6271eaL, 0xf399aa02L, 0xe2e4c07bL, 0x5b1f1b93L,
+0x0f97d80eL, 0xb66c03e6L, 0xa711699fL, 0x1eeab277L,
+0x85ebbd6dL, 0x3c106685L, 0x2d6d0cfcL, 0x9496d714L,
+0x0cb9b558L, 0xb5426eb0L, 0xa43f04c9L, 0x1dc4df21L,
+0x86c5d03bL, 0x3f3e0bd3L, 0x2e4361aaL, 0x97b8ba42L,
+0xc33079dfL, 0x7acba237L, 0x6bb6c84eL, 0xd24d13a6L,
+0x494c1cbcL, 0xf0b7c754L, 0xe1caad2dL, 0x583176c5L,
+0x48db2a17L, 0xf120f1ffL, 0xe05d9b86L, 0x59a6406eL,
+0xc2a74f74L, 0x7b5c949cL, 0x6a21fee5L, 0xd3da250dL,
+0x8752e690L, 0x3ea93d78L, 0x2fd45701L, 0x962f8ce9L,
+0x0d2e83f3L, 0xb4d5581bL, 0xa5a83262L, 0x1c53e98aL
+},
+{
+0x00000000L, 0xae689191L, 0x87a02563L, 0x29c8b4f2L,
+0xd4314c87L, 0x7a59dd16L, 0x539169e4L, 0xfdf9f875L,
+0x73139f4fL, 0xdd7b0edeL, 0xf4b3ba2cL, 0x5adb2bbdL,
+0xa722d3c8L, 0x094a4259L, 0x2082f6abL, 0x8eea673aL,
+0xe6273e9eL, 0x484faf0fL, 0x61871bfdL, 0xcfef8a6cL,
+0x32167219L, 0x9c7ee388L, 0xb5b6577aL, 0x1bdec6ebL,
+0x9534a1d1L, 0x3b5c3040L, 0x129484b2L, 0xbcfc1523L,
+0x4105ed56L, 0xef6d7cc7L, 0xc6a5c835L, 0x68cd59a4L,
+0x173f7b7dL, 0xb957eaecL, 0x909f5e1eL, 0x3ef7cf8fL,
+0xc30e37faL, 0x6d66a66bL, 0x44ae1299L, 0xeac68308L,
+0x642ce432L, 0xca4475a3L, 0xe38cc151L, 0x4de450c0L,
+0xb01da8b5L, 0x1e753924L, 0x37bd8dd6L, 0x99d51c47L,
+0xf11845e3L, 0x5f70d472L, 0x76b86080L, 0xd8d0f111L,
+0x25290964L, 0x8b4198f5L, 0xa2892c07L, 0x0ce1bd96L,
+0x820bdaacL, 0x2c634b3dL, 0x05abffcfL, 0xabc36e5eL,
+0x563a962bL, 0xf85207baL, 0xd19ab348L, 0x7ff222d9L,
+0x2e7ef6faL, 0x8016676bL, 0xa9ded399L, 0x07b64208L,
+0xfa4fba7dL, 0x54272becL, 0x7def9f1eL, 0xd3870e8fL,
+0x5d6d69b5L, 0xf305f824L, 0xdacd4cd6L, 0x74a5dd47L,
+0x895c2532L, 0x2734b4a3L, 0x0efc0051L, 0xa09491c0L,
+0xc859c864L, 0x663159f5L, 0x4ff9ed07L, 0xe1917c96L,
+0x1c6884e3L, 0xb2001572L, 0x9bc8a180L, 0x35a03011L,
+0xbb4a572bL, 0x1522c6baL, 0x3cea7248L, 0x9282e3d9L,
+0x6f7b1bacL, 0xc1138a3dL, 0xe8db3ecfL, 0x46b3af5eL,
+0x39418d87L, 0x97291c16L, 0xbee1a8e4L, 0x10893975L,
+0xed70c100L, 0x43185091L, 0x6ad0e463L, 0xc4b875f2L,
+0x4a5212c8L, 0xe43a8359L, 0xcdf237abL, 0x639aa63aL,
+0x9e635e4fL, 0x300bcfdeL, 0x19c37b2cL, 0xb7abeabdL,
+0xdf66b319L, 0x710e2288L, 0x58c6967aL, 0xf6ae07ebL,
+0x0b57ff9eL, 0xa53f6e0fL, 0x8cf7dafdL, 0x229f4b6cL,
+0xac752c56L, 0x021dbdc7L, 0x2bd50935L, 0x85bd98a4L,
+0x784460d1L, 0xd62cf140L, 0xffe445b2L, 0x518cd423L,
+0x5cfdedf4L, 0xf2957c65L, 0xdb5dc897L, 0x75355906L,
+0x88cca173L, 0x26a430e2L, 0x0f6c8410L, 0xa1041581L,
+0x2fee72bbL, 0x8186e32aL, 0xa84e57d8L, 0x0626c649L,
+0xfbdf3e3cL, 0x55b7afadL, 0x7c7f1b5fL, 0xd2178aceL,
+0xbadad36aL, 0x14b242fbL, 0x3d7af609L, 0x93126798L,
+0x6eeb9fedL, 0xc0830e7cL, 0xe94bba8eL, 0x47232b1fL,
+0xc9c94c25L, 0x67a1ddb4L, 0x4e696946L, 0xe001f8d7L,
+0x1df800a2L, 0xb3909133L, 0x9a5825c1L, 0x3430b450L,
+0x4bc29689L, 0xe5aa0718L, 0xcc62b3eaL, 0x620a227bL,
+0x9ff3da0eL, 0x319b4b9fL, 0x1853ff6dL, 0xb63b6efcL,
+0x38d109c6L, 0x96b99857L, 0xbf712ca5L, 0x1119bd34L,
+0xece04541L, 0x4288d4d0L, 0x6b406022L, 0xc528f1b3L,
+0xade5a817L, 0x038d3986L, 0x2a458d74L, 0x842d1ce5L,
+0x79d4e490L, 0xd7bc7501L, 0xfe74c1f3L, 0x501c5062L,
+0xdef63758L, 0x709ea6c9L, 0x5956123bL, 0xf73e83aaL,
+0x0ac77bdfL, 0xa4afea4eL, 0x8d675ebcL, 0x230fcf2dL,
+0x72831b0eL, 0xdceb8a9fL, 0xf5233e6dL, 0x5b4baffcL,
+0xa6b25789L, 0x08dac618L, 0x211272eaL, 0x8f7ae37bL,
+0x01908441L, 0xaff815d0L, 0x8630a122L, 0x285830b3L,
+0xd5a1c8c6L, 0x7bc95957L, 0x5201eda5L, 0xfc697c34L,
+0x94a42590L, 0x3accb401L, 0x130400f3L, 0xbd6c9162L,
+0x40956917L, 0xeefdf886L, 0xc7354c74L, 0x695ddde5L,
+0xe7b7badfL, 0x49df2b4eL, 0x60179fbcL, 0xce7f0e2dL,
+0x3386f658L, 0x9dee67c9L, 0xb426d33bL, 0x1a4e42aaL,
+0x65bc6073L, 0xcbd4f1e2L, 0xe21c4510L, 0x4c74d481L,
+0xb18d2cf4L, 0x1fe5bd65L, 0x362d0997L, 0x98459806L,
+0x16afff3cL, 0xb8c76eadL, 0x910fda5fL, 0x3f674bceL,
+0xc29eb3bbL, 0x6cf6222aL, 0x453e96d8L, 0xeb560749L,
+0x839b5eedL, 0x2df3cf7cL, 0x043b7b8eL, 0xaa53ea1fL,
+0x57aa126aL, 0xf9c283fbL, 0xd00a3709L, 0x7e62a698L,
+0xf088c1a2L, 0x5ee05033L, 0x7728e4c1L, 0xd9407550L,
+0x24b98d25L, 0x8ad11cb4L, 0xa319a846L, 0x0d7139d7L
+},
+#endif
+};
+
+#endif
@@ -0,0 +1,249 @@
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/crc.h"
+
+__BEGIN_DECLS
+
+#if (AL_CRC_SLICE != 1) && (AL_CRC_SLICE != 4) && (AL_CRC_SLICE != 8)
+#error "AL_CRC_SLICE must be 1, 4 or 8"
+#endif
+
+#include "crc_tables.h"
+
+const al_crc_model_t al_crc8_maxim_model = {
+	.width = 8, .reflect = true, .poly = 0x31, .init = 0x00, .xorout = 0x00,
+	.slice = AL_CRC_SLICE, .table = crc8_maxim_table,
+};
+
+const al_crc_model_t al_crc16_modbus_model = {
+	.width = 16, .reflect = true, .poly = 0x8005, .init = 0xFFFF, .xorout = 0x0000,
+	.slice = AL_CRC_SLICE, .table = crc16_modbus_table,
+};
+
+const al_crc_model_t al_crc16_xmodem_model = {
+	.width = 16, .reflect = false, .poly = 0x1021, .init = 0x0000, .xorout = 0x0000,
+	.slice = AL_CRC_SLICE, .table = crc16_xmodem_table,
+};
+
+#define crc_mask(w)			((uint32_t)(0xFFFFFFFFUL >> (32 - (w))))
+
+#define crc_le32(p)			((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | \
+							 ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+#define crc_be32(p)			((uint32_t)(p)[3] | ((uint32_t)(p)[2] << 8) | \
+							 ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[0] << 24))
+
+static uint32_t crc_reflect(uint32_t v, int_t width)
+{
+	uint32_t r = 0;
+
+	while (width--) {
+		r = (r << 1) | (v & 1);
+		v >>= 1;
+	}
+
+	return r;
+}
+
+/*
+ * Reflected models keep the register lsb aligned, the next data byte meets
+ * its low byte. Up to 4 register bytes are folded into the first word so
+ * the same step serves every width.
+ */
+#define CRC_DEFINE_REFLECT(name, type)										\
+static uint32_t name(const al_crc_model_t *m, uint32_t c,					\
+					 const uint8_t *p, size_t len)							\
+{																			\
+	const type (*t)[256] = (const type (*)[256])m->table;					\
+	uint32_t x;																\
+																			\
+	if (m->slice >= 8) {													\
+		for (; len >= 8; len -= 8, p += 8) {								\
+			x = c ^ crc_le32(p);											\
+			c = t[7][x & 0xff] ^ t[6][(x >> 8) & 0xff] ^					\
+				t[5][(x >> 16) & 0xff] ^ t[4][x >> 24] ^					\
+				t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];			\
+		}																	\
+	}																		\
+																			\
+	if (m->slice >= 4) {													\
+		for (; len >= 4; len -= 4, p += 4) {								\
+			x = c ^ crc_le32(p);											\
+			c = t[3][x & 0xff] ^ t[2][(x >> 8) & 0xff] ^					\
+				t[1][(x >> 16) & 0xff] ^ t[0][x >> 24];						\
+		}																	\
+	}																		\
+																			\
+	while (len--) {															\
+		c = t[0][(c ^ *p++) & 0xff] ^ (c >> 8);								\
+	}																		\
+																			\
+	return c;																\
+}
+
+/*
+ * Normal models keep the register msb aligned, shifting it to the top of
+ * a 32-bit word lines its high bytes up with the data bytes.
+ */
+#define CRC_DEFINE_NORMAL(name, type, w)									\
+static uint32_t name(const al_crc_model_t *m, uint32_t c,					\
+					 const uint8_t *p, size_t len)							\
+{																			\
+	const type (*t)[256] = (const type (*)[256])m->table;					\
+	uint32_t x, y;															\
+																			\
+	if (m->slice >= 8) {													\
+		for (; len >= 8; len -= 8, p += 8) {								\
+			x = (c << (32 - (w))) ^ crc_be32(p);							\
+			y = crc_be32(p + 4);											\
+			c = t[7][x >> 24] ^ t[6][(x >> 16) & 0xff] ^					\
+				t[5][(x >> 8) & 0xff] ^ t[4][x & 0xff] ^					\
+				t[3][y >> 24] ^ t[2][(y >> 16) & 0xff] ^					\
+				t[1][(y >> 8) & 0xff] ^ t[0][y & 0xff];						\
+		}																	\
+	}																		\
+																			\
+	if (m->slice >= 4) {													\
+		for (; len >= 4; len -= 4, p += 4) {								\
+			x = (c << (32 - (w))) ^ crc_be32(p);							\
+			c = t[3][x >> 24] ^ t[2][(x >> 16) & 0xff] ^					\
+				t[1][(x >> 8) & 0xff] ^ t[0][x & 0xff];						\
+		}																	\
+	}																		\
+																			\
+	while (len--) {															\
+		c = t[0][((c >> ((w) - 8)) ^ *p++) & 0xff] ^						\
+			((c << 8) & crc_mask(w));										\
+	}																		\
+																			\
+	return c;																\
+}
+
+CRC_DEFINE_REFLECT(crc_update_r8, uint8_t)
+CRC_DEFINE_REFLECT(crc_update_r16, uint16_t)
+CRC_DEFINE_REFLECT(crc_update_r32, uint32_t)
+CRC_DEFINE_NORMAL(crc_update_n8, uint8_t, 8)
+CRC_DEFINE_NORMAL(crc_update_n16, uint16_t, 16)
+CRC_DEFINE_NORMAL(crc_update_n32, uint32_t, 32)
+
+static uint32_t crc_update_bitwise(const al_crc_model_t *m, uint32_t c,
+								   const uint8_t *p, size_t len)
+{
+	uint32_t mask = crc_mask(m->width);
+	uint32_t top = 1UL << (m->width - 1);
+	uint32_t poly;
+	int_t i;
+
+	if (m->reflect) {
+		poly = crc_reflect(m->poly, m->width);
+
+		while (len--) {
+			c ^= *p++;
+
+			for (i = 0; i < 8; i++) {
+				c = (c & 1) ? (c >> 1) ^ poly : (c >> 1);
+			}
+		}
+	} else {
+		while (len--) {
+			c ^= (uint32_t)*p++ << (m->width - 8);
+
+			for (i = 0; i < 8; i++) {
+				c = (c & top) ? (c << 1) ^ m->poly : (c << 1);
+			}
+
+			c &= mask;
+		}
+	}
+
+	return c;
+}
+
+static uint32_t crc_gen_byte(const al_crc_model_t *m, uint8_t n)
+{
+	return crc_update_bitwise(m, 0, &n, 1);
+}
+
+int32_t al_crc_gen_table(const al_crc_model_t *model, void *table, int_t slice)
+{
+	uint32_t v;
+	int_t k, n;
+
+	AL_CHECK_RET((model != NULL) && (table != NULL), EINVAL, -1);
+	AL_CHECK_RET((model->width == 8) || (model->width == 16) ||
+				 (model->width == 32), EINVAL, -1);
+	AL_CHECK_RET((slice >= 1) && (slice <= AL_CRC_SLICE_MAX), EINVAL, -1);
+
+	for (k = 0; k < slice; k++) {
+		for (n = 0; n < 256; n++) {
+			/* the register after n and k zero bytes */
+			v = crc_gen_byte(model, n);
+
+			if (k > 0) {
+				static const uint8_t zero[AL_CRC_SLICE_MAX] = { 0 };
+				v = crc_update_bitwise(model, v, zero, k);
+			}
+
+			switch (model->width) {
+			case 8:
+				((uint8_t *)table)[k * 256 + n] = v;
+				break;
+			case 16:
+				((uint16_t *)table)[k * 256 + n] = v;
+				break;
+			default:
+				((uint32_t *)table)[k * 256 + n] = v;
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
+
+uint32_t al_crc_init(const al_crc_model_t *model)
+{
+	return model->reflect ? crc_reflect(model->init, model->width) : model->init;
+}
+
+uint32_t al_crc_update(const al_crc_model_t *model, uint32_t crc,
+					   const void *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)data;
+
+	if (model->update != NULL) {
+		return model->update(crc, data, len);
+	}
+
+	if (model->table == NULL) {
+		return crc_update_bitwise(model, crc, p, len);
+	}
+
+	switch (model->width) {
+	case 8:
+		return model->reflect ? crc_update_r8(model, crc, p, len) :
+								crc_update_n8(model, crc, p, len);
+	case 16:
+		return model->reflect ? crc_update_r16(model, crc, p, len) :
+								crc_update_n16(model, crc, p, len);
+	default:
+		return model->reflect ? crc_update_r32(model, crc, p, len) :
+								crc_update_n32(model, crc, p, len);
+	}
+}
+
+uint32_t al_crc_final(const al_crc_model_t *model, uint32_t crc)
+{
+	return (crc ^ model->xorout) & crc_mask(model->width);
+}
+
+uint32_t al_crc_calc(const al_crc_model_t *model, const void *data, size_t len)
+{
+	return al_crc_final(model,
+						al_crc_update(model, al_crc_init(model), data, len));
+}
+
+__END_DECLS
+
@@ -0,0 +1,219 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/bug.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/crypto/aead.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/chachapoly.h"
+
+__BEGIN_DECLS
+
+#define aead_gcm(ctx)           ((mbedtls_gcm_context *)(ctx)->priv)
+#define aead_chachapoly(ctx)    ((mbedtls_chachapoly_context *)(ctx)->priv)
+
+int32_t al_aead_setkey(al_aead_ctx_t *ctx, al_aead_type_t type,
+                       const void *key, size_t keylen)
+{
+    int ret;
+
+    BUILD_BUG_ON(sizeof(mbedtls_gcm_context) > sizeof(ctx->priv));
+    BUILD_BUG_ON(sizeof(mbedtls_chachapoly_context) > sizeof(ctx->priv));
+
+    AL_CHECK_RET((ctx != NULL) && (key != NULL), EINVAL, -1);
+
+    switch (type) {
+    case AL_AEAD_AES_GCM:
+        AL_CHECK_RET((keylen == 16) || (keylen == 24) || (keylen == 32),
+                     EINVAL, -1);
+
+        mbedtls_gcm_init(aead_gcm(ctx));
+        ret = mbedtls_gcm_setkey(aead_gcm(ctx), MBEDTLS_CIPHER_ID_AES,
+                                 key, keylen * 8);
+        if (ret != 0) {
+            mbedtls_gcm_free(aead_gcm(ctx));
+        }
+        break;
+
+    case AL_AEAD_CHACHAPOLY:
+        AL_CHECK_RET(keylen == 32, EINVAL, -1);
+
+        mbedtls_chachapoly_init(aead_chachapoly(ctx));
+        ret = mbedtls_chachapoly_setkey(aead_chachapoly(ctx), key);
+        if (ret != 0) {
+            mbedtls_chachapoly_free(aead_chachapoly(ctx));
+        }
+        break;
+
+    default:
+        set_errno(EINVAL);
+        return -1;
+    }
+
+    /* the gcm cipher context is the only allocation */
+    AL_CHECK_RET(ret == 0, ENOMEM, -1);
+
+    ctx->type = type;
+    ctx->keyed = true;
+
+    return 0;
+}
+
+void al_aead_free(al_aead_ctx_t *ctx)
+{
+    if ((ctx == NULL) || !ctx->keyed) {
+        return;
+    }
+
+    if (ctx->type == AL_AEAD_AES_GCM) {
+        mbedtls_gcm_free(aead_gcm(ctx));
+    } else {
+        mbedtls_chachapoly_free(aead_chachapoly(ctx));
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int32_t al_aead_starts(al_aead_ctx_t *ctx, bool_t enc,
+                       const void *nonce, size_t nonce_len,
+                       const void *aad, size_t aad_len)
+{
+    int ret;
+
+    AL_CHECK_RET((ctx != NULL) && ctx->keyed && (nonce != NULL) &&
+                 ((aad != NULL) || (aad_len == 0)), EINVAL, -1);
+
+    if (ctx->type == AL_AEAD_AES_GCM) {
+        AL_CHECK_RET(nonce_len > 0, EINVAL, -1);
+
+        ret = mbedtls_gcm_starts(aead_gcm(ctx),
+                                 enc ? MBEDTLS_GCM_ENCRYPT : MBEDTLS_GCM_DECRYPT,
+                                 nonce, nonce_len);
+        if ((ret == 0) && (aad_len > 0)) {
+            ret = mbedtls_gcm_update_ad(aead_gcm(ctx), aad, aad_len);
+        }
+    } else {
+        AL_CHECK_RET(nonce_len == AL_AEAD_NONCE_SIZE, EINVAL, -1);
+
+        ret = mbedtls_chachapoly_starts(aead_chachapoly(ctx), nonce,
+                                        enc ? MBEDTLS_CHACHAPOLY_ENCRYPT :
+                                              MBEDTLS_CHACHAPOLY_DECRYPT);
+        if ((ret == 0) && (aad_len > 0)) {
+            ret = mbedtls_chachapoly_update_aad(aead_chachapoly(ctx),
+                                                aad, aad_len);
+        }
+    }
+
+    AL_CHECK_RET(ret == 0, EINVAL, -1);
+
+    ctx->enc = enc;
+
+    return 0;
+}
+
+ssize_t al_aead_update(al_aead_ctx_t *ctx, void *out, size_t outsz,
+                       const void *in, size_t len)
+{
+    size_t olen;
+    int ret;
+
+    AL_CHECK_RET((ctx != NULL) && ctx->keyed, EINVAL, -1);
+    AL_CHECK_RET(((in != NULL) && (out != NULL)) || (len == 0), EINVAL, -1);
+    AL_CHECK_RET(len <= outsz, ENOBUFS, -1);
+
+    if (len == 0) {
+        return 0;
+    }
+
+    if (ctx->type == AL_AEAD_AES_GCM) {
+        ret = mbedtls_gcm_update(aead_gcm(ctx), in, len, out, outsz, &olen);
+    } else {
+        ret = mbedtls_chachapoly_update(aead_chachapoly(ctx), len, in, out);
+    }
+
+    /* only an update out of order fails */
+    AL_CHECK_RET(ret == 0, EPERM, -1);
+
+    return len;
+}
+
+int32_t al_aead_finish(al_aead_ctx_t *ctx, void *tag, size_t taglen)
+{
+    uint8_t mac[AL_AEAD_TAG_SIZE], diff = 0;
+    size_t olen, i;
+    int ret;
+
+    AL_CHECK_RET((ctx != NULL) && ctx->keyed && (tag != NULL), EINVAL, -1);
+
+    if (ctx->type == AL_AEAD_AES_GCM) {
+        AL_CHECK_RET((taglen >= 4) && (taglen <= AL_AEAD_TAG_SIZE),
+                     EINVAL, -1);
+
+        ret = mbedtls_gcm_finish(aead_gcm(ctx), NULL, 0, &olen, mac, taglen);
+    } else {
+        AL_CHECK_RET(taglen == AL_AEAD_TAG_SIZE, EINVAL, -1);
+
+        ret = mbedtls_chachapoly_finish(aead_chachapoly(ctx), mac);
+    }
+
+    AL_CHECK_RET(ret == 0, EPERM, -1);
+
+    if (ctx->enc) {
+        memcpy(tag, mac, taglen);
+        return 0;
+    }
+
+    /* constant time, a mismatch must not tell where */
+    for (i = 0; i < taglen; i++) {
+        diff |= mac[i] ^ ((const uint8_t *)tag)[i];
+    }
+
+    memset(mac, 0, sizeof(mac));
+
+    AL_CHECK_RET(diff == 0, EBADMSG, -1);
+
+    return 0;
+}
+
+ssize_t al_aead_encrypt(al_aead_ctx_t *ctx,
+                        const void *nonce, size_t nonce_len,
+                        const void *aad, size_t aad_len,
+                        void *out, size_t outsz, const void *in, size_t len,
+                        void *tag, size_t taglen)
+{
+    if ((al_aead_starts(ctx, true, nonce, nonce_len, aad, aad_len) < 0) ||
+        (al_aead_update(ctx, out, outsz, in, len) < 0) ||
+        (al_aead_finish(ctx, tag, taglen) < 0)) {
+        return -1;
+    }
+
+    return len;
+}
+
+ssize_t al_aead_decrypt(al_aead_ctx_t *ctx,
+                        const void *nonce, size_t nonce_len,
+                        const void *aad, size_t aad_len,
+                        void *out, size_t outsz, const void *in, size_t len,
+                        const void *tag, size_t taglen)
+{
+    if ((al_aead_starts(ctx, false, nonce, nonce_len, aad, aad_len) < 0) ||
+        (al_aead_update(ctx, out, outsz, in, len) < 0)) {
+        return -1;
+    }
+
+    if (al_aead_finish(ctx, (void *)tag, taglen) < 0) {
+        /* never hand out plain text that failed authentication */
+        if ((errno == EBADMSG) && (len > 0)) {
+            memset(out, 0, len);
+        }
+
+        return -1;
+    }
+
+    return len;
+}
+
+__END_DECLS
+
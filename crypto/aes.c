@@ -15,7 +15,6 @@
 #include "alumy/crypto.h"
 #include "mbedtls/aes.h"
 #include "mbedtls/cipher.h"
-#include "aes.h"
 
 __BEGIN_DECLS
 
@@ -23,60 +22,22 @@ ssize_t aes_cbc_enc(void *out, size_t outsz, const void *in, size_t len,
                     const void *key, size_t keylen,
                     const void *__iv, size_t __iv_len)
 {
-    int32_t ret;
     ssize_t rv;
-    size_t padlen = AL_IS_ALIGNED(len, 16) ? 16 : AL_ALIGN(len, 16) - len;
-    size_t outlen = len + padlen;
+    al_aes_ctx_t aes_ctx;
 
     AL_CHECK_RET((keylen == 16) || (keylen == 24) || (keylen == 32),
                  EINVAL, -1);
 
     AL_CHECK_RET(__iv_len == 16, EINVAL, -1);
 
-    AL_CHECK_RET(outlen <= outsz, ENOBUFS, -1);
-
-	uint8_t *in_pad = (uint8_t *)al_os_malloc(outlen);
-    if (in_pad == NULL) {
-        return -ENOMEM;
-    }
-
-    memcpy(in_pad, in, len);
-
-    for (intptr_t i = len; i < outlen; ++i) {
-        in_pad[i] = padlen;
+    if (al_aes_setkey(&aes_ctx, key, keylen) < 0) {
+        AL_ERROR(AL_LOG_CRYPTO, "al_aes_setkey failed, errno = %d", errno);
+        return -EPERM;
     }
 
-    unsigned char iv[16] = { 0 };
-    mbedtls_aes_context aes_ctx;
+    rv = al_aes_cbc_enc(&aes_ctx, out, outsz, in, len, __iv);
 
-    memcpy(iv, __iv, min(sizeof(iv), __iv_len));
-
-    mbedtls_aes_init(&aes_ctx);
-
-    do {
-        rv = -EPERM;
-        ret = mbedtls_aes_setkey_enc(&aes_ctx, (unsigned char *)key,
-                                     keylen * CHAR_BIT);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-                     "mbedtls_aes_setkey_enc failed, ret = %"PRId32, ret);
-            break;
-        }
-
-        ret = mbedtls_aes_crypt_cbc(&aes_ctx, MBEDTLS_AES_ENCRYPT,
-                                    outlen, iv, in_pad, out);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-                     "mbedtls_aes_crypt_cbc failed, mode = %d, ret = %"PRId32,
-                     MBEDTLS_AES_ENCRYPT, ret);
-            break;
-        }
-
-        rv = outlen;
-    } while (0);
-
-    mbedtls_aes_free(&aes_ctx);
-    al_os_free(in_pad);
+    al_aes_free(&aes_ctx);
 
     return rv;
 }
@@ -92,7 +53,7 @@ char *aes_cbc_enc_base64(const void *in, size_t len,
         return NULL;
     }
 
-    char *b64 = (char *)al_os_malloc(Base64encode_len(aes_bufsz));
+    char *b64 = (char *)al_os_malloc(al_base64_encode_len(aes_bufsz) + 1);
     if (b64 == NULL) {
         al_os_free(aesbuf);
         return NULL;
@@ -106,7 +67,9 @@ char *aes_cbc_enc_base64(const void *in, size_t len,
         return NULL;
     }
 
-    Base64encode(b64, (const char *)aesbuf, aes_len);
+    aes_len = al_base64_encode(b64, al_base64_encode_len(aes_bufsz),
+                               aesbuf, aes_len);
+    b64[aes_len] = '\0';
 
     al_os_free(aesbuf);
 
@@ -118,64 +81,25 @@ ssize_t aes_cbc_dec(void *out, size_t outsz, const void *in, size_t len,
                     const void *__iv, size_t __iv_len,
                     bool check_pad)
 {
-    int32_t ret;
     ssize_t rv;
+    al_aes_ctx_t aes_ctx;
 
     AL_CHECK_RET((keylen == 16) || (keylen == 24) || (keylen == 32),
                  EINVAL, -1);
 
     AL_CHECK_RET(__iv_len == 16, EINVAL, -1);
 
-    AL_CHECK_RET(len <= outsz, ENOBUFS, -1);
-
-    unsigned char iv[16] = { 0 };
-    mbedtls_aes_context aes_ctx;
-
-    memcpy(iv, __iv, min(sizeof(iv), __iv_len));
-
-    mbedtls_aes_init(&aes_ctx);
-
-    do {
-        rv = -EPERM;
-        ret = mbedtls_aes_setkey_dec(&aes_ctx, (unsigned char *)key,
-                                     keylen * CHAR_BIT);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-                     "mbedtls_aes_setkey_dec failed, ret = %"PRId32, ret);
-            break;
-        }
-
-        ret = mbedtls_aes_crypt_cbc(&aes_ctx, MBEDTLS_AES_DECRYPT,
-                                    len, iv, in, out);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-                     "mbedtls_aes_crypt_cbc failed, mode = %d, ret = %"PRId32,
-                     MBEDTLS_AES_ENCRYPT, ret);
-            break;
-        }
-
-        if (check_pad) {
-            const uint8_t *__out = (const uint8_t *)out;
-            size_t pad = __out[len - 1];
-
-            for (intptr_t i = 0, p = len - 1; i < pad; ++i, --p) {
-                if (__out[p] != pad) {
-                    AL_ERROR(AL_LOG_CRYPTO,
-                             "%s, pad check failed, pad = %#x, __out[%d] = %#x",
-                             __func__, pad, p, __out[p]);
-                    break;
-                }
-            }
-
-            rv = len - pad;
-        } else {
-            rv = len;
-        }
-
+    if (al_aes_setkey(&aes_ctx, key, keylen) < 0) {
+        AL_ERROR(AL_LOG_CRYPTO, "al_aes_setkey failed, errno = %d", errno);
+        return -EPERM;
+    }
 
-    } while (0);
+    rv = al_aes_cbc_dec(&aes_ctx, out, outsz, in, len, __iv, check_pad);
+    if ((rv < 0) && (errno == EBADMSG)) {
+        AL_ERROR(AL_LOG_CRYPTO, "%s, pad check failed", __func__);
+    }
 
-    mbedtls_aes_free(&aes_ctx);
+    al_aes_free(&aes_ctx);
 
     return rv;
 }
@@ -185,19 +109,18 @@ ssize_t aes_cbc_dec_base64(void *out, size_t outsz, const char *b64,
                            const void *__iv, size_t __iv_len,
                            bool check_pad)
 {
-    size_t aes_bufsz = Base64decode_len(b64);
+    size_t b64_len = strlen(b64);
+    size_t aes_bufsz = al_base64_decode_len(b64, b64_len);
     ssize_t rv;
 
-    uint8_t *aesbuf = (uint8_t *)al_os_malloc(aes_bufsz);
+    uint8_t *aesbuf = (uint8_t *)al_os_malloc(aes_bufsz + 1);
     if (aesbuf == NULL) {
         return -ENOMEM;
     }
 
-    size_t aes_len = Base64decode((char *)aesbuf, b64);
-
-    AL_ASSERT(AL_IS_ALIGNED(aes_len, 16));
+    ssize_t aes_len = al_base64_decode(aesbuf, aes_bufsz, b64, b64_len);
 
-    if (!AL_IS_ALIGNED(aes_len, 16)) {
+    if ((aes_len < 0) || !AL_IS_ALIGNED(aes_len, 16)) {
         al_os_free(aesbuf);
         return -EPERM;
     }
@@ -293,42 +216,18 @@ ssize_t aes_128_ctr_dec(void *out, size_t outsz, const void *in, size_t len,
 ssize_t aes_128_ctr_enc(void *out, size_t outsz, const void *in, size_t len,
 						const al_aes_128_key_t key, const al_aes_128_iv_t iv)
 {
-    int32_t ret;
     ssize_t rv;
-	size_t nc_off = 0;
-	uint8_t nonce_counter[16];
-	uint8_t stream_block[16] = { 0 };
-    mbedtls_aes_context aes_ctx;
-
-	AL_CHECK_RET(outsz >= len, EINVAL, -1);
-
-    mbedtls_aes_init(&aes_ctx);
-
-	memcpy(nonce_counter, iv, sizeof(nonce_counter));
-
-    do {
-        rv = -EPERM;
-        ret = mbedtls_aes_setkey_enc(&aes_ctx, key, 128);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-					 "mbedtls_aes_setkey_enc failed @ %s:%d, ret = %d",
-					 __func__, __LINE__, ret);
-            break;
-        }
+    al_aes_ctx_t aes_ctx;
 
-		ret = mbedtls_aes_crypt_ctr(&aes_ctx, len, &nc_off,
-									nonce_counter, stream_block, in, out);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-                     "mbedtls_aes_crypt_ctr failed @ %s:%d, ret = %d",
-					 __func__, __LINE__, ret);
-            break;
-        }
+    if (al_aes_setkey(&aes_ctx, key, sizeof(al_aes_128_key_t)) < 0) {
+        AL_ERROR(AL_LOG_CRYPTO, "al_aes_setkey failed @ %s:%d, errno = %d",
+                 __func__, __LINE__, errno);
+        return -EPERM;
+    }
 
-        rv = len;
-    } while (0);
+    rv = al_aes_ctr(&aes_ctx, out, outsz, in, len, iv);
 
-    mbedtls_aes_free(&aes_ctx);
+    al_aes_free(&aes_ctx);
 
     return rv;
 }
@@ -336,66 +235,26 @@ ssize_t aes_128_ctr_enc(void *out, size_t outsz, const void *in, size_t len,
 ssize_t aes_128_ctr_dec(void *out, size_t outsz, const void *in, size_t len,
 						const al_aes_128_key_t key, const al_aes_128_iv_t iv)
 {
-    int32_t ret;
-    ssize_t rv;
-	size_t nc_off = 0;
-	uint8_t nonce_counter[16];
-	uint8_t stream_block[16] = { 0 };
-	mbedtls_aes_context aes_ctx;
-
-	AL_CHECK_RET(outsz >= len, EINVAL, -1);
-
-    mbedtls_aes_init(&aes_ctx);
-
-	memcpy(nonce_counter, iv, sizeof(nonce_counter));
-
-    do {
-        rv = -EPERM;
-        ret = mbedtls_aes_setkey_enc(&aes_ctx, key, 128);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-					 "mbedtls_aes_setkey_enc failed @ %s:%d, ret = %d",
-					 __func__, __LINE__, ret);
-            break;
-        }
-
-		ret = mbedtls_aes_crypt_ctr(&aes_ctx, len, &nc_off,
-									nonce_counter, stream_block, in, out);
-        if (ret != 0) {
-            AL_ERROR(AL_LOG_CRYPTO,
-                     "mbedtls_aes_crypt_ctr failed @ %s:%d, ret = %d",
-					 __func__, __LINE__, ret);
-            break;
-        }
-
-        rv = len;
-    } while (0);
-
-    mbedtls_aes_free(&aes_ctx);
-
-    return rv;
+    return aes_128_ctr_enc(out, outsz, in, len, key, iv);
 }
 
 void al_aes128_ctr_encrypt(void *data, size_t len,
                            const al_aes_128_key_t key,
                            const al_aes_128_iv_t iv)
 {
-    struct AES_ctx aes_ctx;
-
-    AES_init_ctx_iv(&aes_ctx, key, iv);
+    al_aes_ctx_t aes_ctx;
 
-    AES_CTR_xcrypt_buffer(&aes_ctx, data, len);
+    if (al_aes_setkey(&aes_ctx, key, sizeof(al_aes_128_key_t)) == 0) {
+        al_aes_ctr(&aes_ctx, data, len, data, len, iv);
+        al_aes_free(&aes_ctx);
+    }
 }
 
 void al_aes128_ctr_decrypt(void *data, size_t len,
                            const al_aes_128_key_t key,
                            const al_aes_128_iv_t iv)
 {
-    struct AES_ctx aes_ctx;
-
-    AES_init_ctx_iv(&aes_ctx, key, iv);
-
-    AES_CTR_xcrypt_buffer(&aes_ctx, data, len);
+    al_aes128_ctr_encrypt(data, len, key, iv);
 }
 
 __END_DECLS
@@ -0,0 +1,705 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/bug.h"
+#include "alumy/mem.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/osal.h"
+#include "alumy/crypto/aes.h"
+#include "mbedtls/aes.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AES_X86     1
+#else
+#define AES_X86     0
+#endif
+
+__BEGIN_DECLS
+
+/*
+ * A kernel works on whole blocks, the padding of CBC and the partial last
+ * block of CTR are left to the callers. cbc_enc, cbc_dec and ctr advance
+ * iv or the counter so consecutive calls chain.
+ */
+typedef struct aes_kernel {
+    int32_t (*setkey)(al_aes_ctx_t *ctx, const uint8_t *key, size_t keylen);
+    void (*free)(al_aes_ctx_t *ctx);
+    void (*cbc_enc)(const al_aes_ctx_t *ctx, uint8_t *out, const uint8_t *in,
+                    size_t nblk, uint8_t iv[16]);
+    void (*cbc_dec)(const al_aes_ctx_t *ctx, uint8_t *out, const uint8_t *in,
+                    size_t nblk, uint8_t iv[16]);
+    void (*ctr)(const al_aes_ctx_t *ctx, uint8_t *out, const uint8_t *in,
+                size_t nblk, uint8_t ctr[16]);
+} aes_kernel_t;
+
+/* mbedtls, the key schedules are kept by two mbedtls contexts */
+typedef struct aes_soft_keys {
+    mbedtls_aes_context enc;
+    mbedtls_aes_context dec;
+} aes_soft_keys_t;
+
+#define aes_soft_keys(ctx)  ((aes_soft_keys_t *)(ctx)->priv)
+
+static int32_t aes_setkey_soft(al_aes_ctx_t *ctx, const uint8_t *key,
+                               size_t keylen)
+{
+    aes_soft_keys_t *ks = aes_soft_keys(ctx);
+
+    BUILD_BUG_ON(sizeof(aes_soft_keys_t) > sizeof(ctx->priv));
+
+    mbedtls_aes_init(&ks->enc);
+    mbedtls_aes_init(&ks->dec);
+
+    if ((mbedtls_aes_setkey_enc(&ks->enc, key, keylen * 8) != 0) ||
+        (mbedtls_aes_setkey_dec(&ks->dec, key, keylen * 8) != 0)) {
+        mbedtls_aes_free(&ks->enc);
+        mbedtls_aes_free(&ks->dec);
+        set_errno(EIO);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void aes_free_soft(al_aes_ctx_t *ctx)
+{
+    mbedtls_aes_free(&aes_soft_keys(ctx)->enc);
+    mbedtls_aes_free(&aes_soft_keys(ctx)->dec);
+}
+
+static void aes_cbc_enc_soft(const al_aes_ctx_t *ctx, uint8_t *out,
+                             const uint8_t *in, size_t nblk, uint8_t iv[16])
+{
+    mbedtls_aes_crypt_cbc(&aes_soft_keys(ctx)->enc, MBEDTLS_AES_ENCRYPT,
+                          nblk * 16, iv, in, out);
+}
+
+static void aes_cbc_dec_soft(const al_aes_ctx_t *ctx, uint8_t *out,
+                             const uint8_t *in, size_t nblk, uint8_t iv[16])
+{
+    mbedtls_aes_crypt_cbc(&aes_soft_keys(ctx)->dec, MBEDTLS_AES_DECRYPT,
+                          nblk * 16, iv, in, out);
+}
+
+static void aes_ctr_soft(const al_aes_ctx_t *ctx, uint8_t *out,
+                         const uint8_t *in, size_t nblk, uint8_t ctr[16])
+{
+    uint8_t stream[16];
+    size_t off = 0;
+
+    mbedtls_aes_crypt_ctr(&aes_soft_keys(ctx)->enc, nblk * 16, &off,
+                          ctr, stream, in, out);
+}
+
+static const aes_kernel_t aes_soft = {
+    .setkey = aes_setkey_soft,
+    .free = aes_free_soft,
+    .cbc_enc = aes_cbc_enc_soft,
+    .cbc_dec = aes_cbc_dec_soft,
+    .ctr = aes_ctr_soft,
+};
+
+#if AES_X86
+/*
+ * AES-NI, ek are the round keys of the cipher, dk those of the equivalent
+ * inverse cipher that aesdec expects. The schedule follows FIPS-197 word
+ * by word, aeskeygenassist supplies SubWord, so one loop serves all three
+ * key sizes.
+ */
+typedef struct aes_ni_keys {
+    uint8_t ek[15][16];
+    uint8_t dk[15][16];
+} aes_ni_keys_t;
+
+#define aes_ni_keys(ctx)    ((aes_ni_keys_t *)(ctx)->priv)
+
+__attribute__((target("aes,sse2")))
+static uint32_t aes_ni_subword(uint32_t w, bool_t rot)
+{
+    /* dword 0 is SubWord(w), dword 1 RotWord(SubWord(w)) */
+    __m128i v = _mm_aeskeygenassist_si128(_mm_set_epi32(0, 0, w, 0), 0);
+
+    return _mm_cvtsi128_si32(rot ? _mm_srli_si128(v, 4) : v);
+}
+
+__attribute__((target("aes,sse2")))
+static int32_t aes_setkey_aesni(al_aes_ctx_t *ctx, const uint8_t *key,
+                                size_t keylen)
+{
+    static const uint8_t rcon[10] = {
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36,
+    };
+    aes_ni_keys_t *ks = aes_ni_keys(ctx);
+    uint32_t w[60], t;
+    int_t nk = keylen / 4, nr = nk + 6;
+    int_t i;
+
+    BUILD_BUG_ON(sizeof(aes_ni_keys_t) > sizeof(ctx->priv));
+
+    memcpy(w, key, keylen);
+
+    for (i = nk; i < 4 * (nr + 1); i++) {
+        t = w[i - 1];
+
+        if ((i % nk) == 0) {
+            t = aes_ni_subword(t, true) ^ rcon[i / nk - 1];
+        } else if ((nk > 6) && ((i % nk) == 4)) {
+            t = aes_ni_subword(t, false);
+        }
+
+        w[i] = w[i - nk] ^ t;
+    }
+
+    memcpy(ks->ek, w, (nr + 1) * 16);
+
+    memcpy(ks->dk[0], ks->ek[nr], 16);
+    memcpy(ks->dk[nr], ks->ek[0], 16);
+
+    for (i = 1; i < nr; i++) {
+        _mm_storeu_si128((__m128i *)ks->dk[i],
+                         _mm_aesimc_si128(_mm_loadu_si128((const __m128i *)ks->ek[nr - i])));
+    }
+
+    memset(w, 0, sizeof(w));
+
+    return 0;
+}
+
+static void aes_free_aesni(al_aes_ctx_t *ctx)
+{
+
+}
+
+__attribute__((target("aes,sse2")))
+static void aes_ni_load(__m128i k[15], const uint8_t rk[][16], int_t nr)
+{
+    int_t i;
+
+    for (i = 0; i <= nr; i++) {
+        k[i] = _mm_loadu_si128((const __m128i *)rk[i]);
+    }
+}
+
+__attribute__((target("aes,sse2")))
+static __m128i aes_ni_enc1(const __m128i k[15], int_t nr, __m128i b)
+{
+    int_t i;
+
+    b = _mm_xor_si128(b, k[0]);
+
+    for (i = 1; i < nr; i++) {
+        b = _mm_aesenc_si128(b, k[i]);
+    }
+
+    return _mm_aesenclast_si128(b, k[nr]);
+}
+
+/* CTR blocks are independent, eight in flight hide the latency of aesenc */
+__attribute__((target("aes,sse2")))
+static void aes_ni_enc8(const __m128i k[15], int_t nr, __m128i b[8])
+{
+    int_t i, j;
+
+    for (j = 0; j < 8; j++) {
+        b[j] = _mm_xor_si128(b[j], k[0]);
+    }
+
+    for (i = 1; i < nr; i++) {
+#pragma GCC unroll 8
+        for (j = 0; j < 8; j++) {
+            b[j] = _mm_aesenc_si128(b[j], k[i]);
+        }
+    }
+
+    for (j = 0; j < 8; j++) {
+        b[j] = _mm_aesenclast_si128(b[j], k[nr]);
+    }
+}
+
+__attribute__((target("aes,sse2")))
+static __m128i aes_ni_dec1(const __m128i k[15], int_t nr, __m128i b)
+{
+    int_t i;
+
+    b = _mm_xor_si128(b, k[0]);
+
+    for (i = 1; i < nr; i++) {
+        b = _mm_aesdec_si128(b, k[i]);
+    }
+
+    return _mm_aesdeclast_si128(b, k[nr]);
+}
+
+__attribute__((target("aes,sse2")))
+static void aes_ni_dec4(const __m128i k[15], int_t nr, __m128i b[4])
+{
+    int_t i;
+
+    b[0] = _mm_xor_si128(b[0], k[0]);
+    b[1] = _mm_xor_si128(b[1], k[0]);
+    b[2] = _mm_xor_si128(b[2], k[0]);
+    b[3] = _mm_xor_si128(b[3], k[0]);
+
+    for (i = 1; i < nr; i++) {
+        b[0] = _mm_aesdec_si128(b[0], k[i]);
+        b[1] = _mm_aesdec_si128(b[1], k[i]);
+        b[2] = _mm_aesdec_si128(b[2], k[i]);
+        b[3] = _mm_aesdec_si128(b[3], k[i]);
+    }
+
+    b[0] = _mm_aesdeclast_si128(b[0], k[nr]);
+    b[1] = _mm_aesdeclast_si128(b[1], k[nr]);
+    b[2] = _mm_aesdeclast_si128(b[2], k[nr]);
+    b[3] = _mm_aesdeclast_si128(b[3], k[nr]);
+}
+
+__attribute__((target("aes,sse2")))
+static void aes_cbc_enc_aesni(const al_aes_ctx_t *ctx, uint8_t *out,
+                              const uint8_t *in, size_t nblk, uint8_t iv[16])
+{
+    __m128i k[15], v;
+
+    aes_ni_load(k, aes_ni_keys(ctx)->ek, ctx->nr);
+
+    v = _mm_loadu_si128((const __m128i *)iv);
+
+    for (; nblk > 0; nblk--, in += 16, out += 16) {
+        v = _mm_xor_si128(v, _mm_loadu_si128((const __m128i *)in));
+        v = aes_ni_enc1(k, ctx->nr, v);
+        _mm_storeu_si128((__m128i *)out, v);
+    }
+
+    _mm_storeu_si128((__m128i *)iv, v);
+}
+
+__attribute__((target("aes,sse2")))
+static void aes_cbc_dec_aesni(const al_aes_ctx_t *ctx, uint8_t *out,
+                              const uint8_t *in, size_t nblk, uint8_t iv[16])
+{
+    __m128i k[15], v, c[4], b[4];
+    int_t i;
+
+    aes_ni_load(k, aes_ni_keys(ctx)->dk, ctx->nr);
+
+    v = _mm_loadu_si128((const __m128i *)iv);
+
+    /* all inputs are loaded before any output is stored, out may be in */
+    for (; nblk >= 4; nblk -= 4, in += 64, out += 64) {
+        for (i = 0; i < 4; i++) {
+            c[i] = _mm_loadu_si128((const __m128i *)(in + i * 16));
+            b[i] = c[i];
+        }
+
+        aes_ni_dec4(k, ctx->nr, b);
+
+        _mm_storeu_si128((__m128i *)out, _mm_xor_si128(b[0], v));
+        _mm_storeu_si128((__m128i *)(out + 16), _mm_xor_si128(b[1], c[0]));
+        _mm_storeu_si128((__m128i *)(out + 32), _mm_xor_si128(b[2], c[1]));
+        _mm_storeu_si128((__m128i *)(out + 48), _mm_xor_si128(b[3], c[2]));
+
+        v = c[3];
+    }
+
+    for (; nblk > 0; nblk--, in += 16, out += 16) {
+        c[0] = _mm_loadu_si128((const __m128i *)in);
+        _mm_storeu_si128((__m128i *)out,
+                         _mm_xor_si128(aes_ni_dec1(k, ctx->nr, c[0]), v));
+        v = c[0];
+    }
+
+    _mm_storeu_si128((__m128i *)iv, v);
+}
+
+static uint64_t aes_get_be64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    int_t i;
+
+    for (i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+
+    return v;
+}
+
+static void aes_put_be64(uint8_t *p, uint64_t v)
+{
+    int_t i;
+
+    for (i = 7; i >= 0; i--, v >>= 8) {
+        p[i] = (uint8_t)v;
+    }
+}
+
+/* the counter block of hi:lo, then hi:lo moves to the next one */
+#define aes_ni_ctr_next(hi, lo)                                             \
+    ({                                                                      \
+        __m128i __b = _mm_set_epi64x((int64_t)__builtin_bswap64(lo),       \
+                                     (int64_t)__builtin_bswap64(hi));       \
+        if (++(lo) == 0) {                                                  \
+            (hi)++;                                                         \
+        }                                                                   \
+        __b;                                                                \
+    })
+
+__attribute__((target("aes,sse2")))
+static void aes_ctr_aesni(const al_aes_ctx_t *ctx, uint8_t *out,
+                          const uint8_t *in, size_t nblk, uint8_t ctr[16])
+{
+    uint64_t hi = aes_get_be64(ctr), lo = aes_get_be64(ctr + 8);
+    __m128i k[15], b[8];
+    int_t i;
+
+    aes_ni_load(k, aes_ni_keys(ctx)->ek, ctx->nr);
+
+    for (; nblk >= 8; nblk -= 8, in += 128, out += 128) {
+        for (i = 0; i < 8; i++) {
+            b[i] = aes_ni_ctr_next(hi, lo);
+        }
+
+        aes_ni_enc8(k, ctx->nr, b);
+
+        for (i = 0; i < 8; i++) {
+            b[i] = _mm_xor_si128(b[i],
+                                 _mm_loadu_si128((const __m128i *)(in + i * 16)));
+            _mm_storeu_si128((__m128i *)(out + i * 16), b[i]);
+        }
+    }
+
+    for (; nblk > 0; nblk--, in += 16, out += 16) {
+        b[0] = aes_ni_enc1(k, ctx->nr, aes_ni_ctr_next(hi, lo));
+        b[0] = _mm_xor_si128(b[0], _mm_loadu_si128((const __m128i *)in));
+        _mm_storeu_si128((__m128i *)out, b[0]);
+    }
+
+    aes_put_be64(ctr, hi);
+    aes_put_be64(ctr + 8, lo);
+}
+
+static const aes_kernel_t aes_aesni = {
+    .setkey = aes_setkey_aesni,
+    .free = aes_free_aesni,
+    .cbc_enc = aes_cbc_enc_aesni,
+    .cbc_dec = aes_cbc_dec_aesni,
+    .ctr = aes_ctr_aesni,
+};
+#endif
+
+static al_aes_impl_t aes_impl = AL_AES_IMPL_AUTO;
+
+static const aes_kernel_t *aes_lookup(al_aes_impl_t impl)
+{
+    switch (impl) {
+    case AL_AES_IMPL_SOFT:
+        return &aes_soft;
+#if AES_X86
+    case AL_AES_IMPL_AESNI:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("aes") ? &aes_aesni : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+int32_t al_aes_set_impl(al_aes_impl_t impl)
+{
+    static const al_aes_impl_t order[] = {
+        AL_AES_IMPL_AESNI, AL_AES_IMPL_SOFT,
+    };
+    const aes_kernel_t *k = NULL;
+    int_t i;
+
+    if (impl == AL_AES_IMPL_AUTO) {
+        for (i = 0; (k == NULL) && (i < ARRAY_SIZE(order)); i++) {
+            k = aes_lookup(order[i]);
+            impl = order[i];
+        }
+    } else {
+        k = aes_lookup(impl);
+    }
+
+    if (k == NULL) {
+        set_errno(ENOTSUP);
+        return -1;
+    }
+
+    __atomic_store_n(&aes_impl, impl, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+al_aes_impl_t al_aes_get_impl(void)
+{
+    if (__atomic_load_n(&aes_impl, __ATOMIC_ACQUIRE) == AL_AES_IMPL_AUTO) {
+        /* first call picks the fastest implementation of this cpu */
+        al_aes_set_impl(AL_AES_IMPL_AUTO);
+    }
+
+    return aes_impl;
+}
+
+/* the kernel a context was keyed with, NULL if it is not keyed */
+static const aes_kernel_t *aes_ctx_kernel(const al_aes_ctx_t *ctx)
+{
+    switch (ctx->impl) {
+    case AL_AES_IMPL_SOFT:
+        return &aes_soft;
+#if AES_X86
+    case AL_AES_IMPL_AESNI:
+        return &aes_aesni;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+int32_t al_aes_setkey(al_aes_ctx_t *ctx, const void *key, size_t keylen)
+{
+    al_aes_impl_t impl = al_aes_get_impl();
+
+    AL_CHECK_RET((ctx != NULL) && (key != NULL), EINVAL, -1);
+    AL_CHECK_RET((keylen == 16) || (keylen == 24) || (keylen == 32),
+                 EINVAL, -1);
+
+    ctx->impl = AL_AES_IMPL_AUTO;
+
+    if (aes_lookup(impl)->setkey(ctx, (const uint8_t *)key, keylen) < 0) {
+        return -1;
+    }
+
+    ctx->impl = impl;
+    ctx->nr = keylen / 4 + 6;
+
+    return 0;
+}
+
+void al_aes_free(al_aes_ctx_t *ctx)
+{
+    const aes_kernel_t *k;
+
+    if (ctx == NULL) {
+        return;
+    }
+
+    k = aes_ctx_kernel(ctx);
+    if (k != NULL) {
+        k->free(ctx);
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+ssize_t al_aes_cbc_enc(const al_aes_ctx_t *ctx, void *out, size_t outsz,
+                       const void *in, size_t len, const void *iv)
+{
+    const aes_kernel_t *k;
+    size_t full = len & ~(size_t)15;
+    size_t padlen = 16 - (len - full);
+    uint8_t v[16], last[16];
+
+    AL_CHECK_RET((ctx != NULL) && (out != NULL) && (iv != NULL) &&
+                 ((in != NULL) || (len == 0)), EINVAL, -1);
+    AL_CHECK_RET(len + padlen <= outsz, ENOBUFS, -1);
+
+    k = aes_ctx_kernel(ctx);
+    AL_CHECK_RET(k != NULL, EINVAL, -1);
+
+    /* only the last partial block is copied to be padded */
+    memcpy(last, (const uint8_t *)in + full, len - full);
+    memset(last + len - full, padlen, padlen);
+    memcpy(v, iv, sizeof(v));
+
+    k->cbc_enc(ctx, (uint8_t *)out, (const uint8_t *)in, full / 16, v);
+    k->cbc_enc(ctx, (uint8_t *)out + full, last, 1, v);
+
+    return len + padlen;
+}
+
+ssize_t al_aes_cbc_dec(const al_aes_ctx_t *ctx, void *out, size_t outsz,
+                       const void *in, size_t len, const void *iv,
+                       bool_t check_pad)
+{
+    const aes_kernel_t *k;
+    const uint8_t *p = (const uint8_t *)out;
+    uint8_t v[16], pad, diff = 0;
+    size_t i;
+
+    AL_CHECK_RET((ctx != NULL) && (out != NULL) && (in != NULL) &&
+                 (iv != NULL), EINVAL, -1);
+    AL_CHECK_RET((len > 0) && AL_IS_ALIGNED(len, 16), EINVAL, -1);
+    AL_CHECK_RET(len <= outsz, ENOBUFS, -1);
+
+    k = aes_ctx_kernel(ctx);
+    AL_CHECK_RET(k != NULL, EINVAL, -1);
+
+    memcpy(v, iv, sizeof(v));
+
+    k->cbc_dec(ctx, (uint8_t *)out, (const uint8_t *)in, len / 16, v);
+
+    if (!check_pad) {
+        return len;
+    }
+
+    pad = p[len - 1];
+    AL_CHECK_RET((pad > 0) && (pad <= 16), EBADMSG, -1);
+
+    for (i = 1; i <= pad; i++) {
+        diff |= p[len - i] ^ pad;
+    }
+
+    AL_CHECK_RET(diff == 0, EBADMSG, -1);
+
+    return len - pad;
+}
+
+/* CTR from the counter block ctr on, a partial last block included */
+static void aes_ctr_crypt(const al_aes_ctx_t *ctx, const aes_kernel_t *k,
+                          uint8_t *out, const uint8_t *in, size_t len,
+                          uint8_t ctr[16])
+{
+    size_t full = len & ~(size_t)15;
+    uint8_t last[16];
+
+    k->ctr(ctx, out, in, full / 16, ctr);
+
+    if (len > full) {
+        memset(last, 0, sizeof(last));
+        memcpy(last, in + full, len - full);
+        k->ctr(ctx, last, last, 1, ctr);
+        memcpy(out + full, last, len - full);
+    }
+}
+
+ssize_t al_aes_ctr(const al_aes_ctx_t *ctx, void *out, size_t outsz,
+                   const void *in, size_t len, const void *iv)
+{
+    const aes_kernel_t *k;
+    uint8_t ctr[16];
+
+    AL_CHECK_RET((ctx != NULL) && (out != NULL) && (iv != NULL) &&
+                 ((in != NULL) || (len == 0)), EINVAL, -1);
+    AL_CHECK_RET(len <= outsz, ENOBUFS, -1);
+
+    k = aes_ctx_kernel(ctx);
+    AL_CHECK_RET(k != NULL, EINVAL, -1);
+
+    memcpy(ctr, iv, sizeof(ctr));
+
+    aes_ctr_crypt(ctx, k, (uint8_t *)out, (const uint8_t *)in, len, ctr);
+
+    return len;
+}
+
+#define AES_CTR_CHUNK       (64 * 1024)
+#define AES_CTR_JOBS        16
+
+typedef struct aes_ctr_job {
+    const al_aes_ctx_t *ctx;
+    const aes_kernel_t *k;
+    uint8_t *out;
+    const uint8_t *in;
+    size_t len;
+    uint8_t ctr[16];
+    al_os_sem_t done;
+} aes_ctr_job_t;
+
+/* ctr += n, big endian over all 16 bytes like the kernels count */
+static void aes_ctr_add(uint8_t ctr[16], uint64_t n)
+{
+    int_t i;
+
+    for (i = 15; (i >= 0) && (n != 0); i--) {
+        n += ctr[i];
+        ctr[i] = (uint8_t)n;
+        n >>= 8;
+    }
+}
+
+static void aes_ctr_job(void *arg)
+{
+    aes_ctr_job_t *job = (aes_ctr_job_t *)arg;
+
+    aes_ctr_crypt(job->ctx, job->k, job->out, job->in, job->len, job->ctr);
+    al_os_sem_give(job->done);
+}
+
+ssize_t al_aes_ctr_parallel(const al_aes_ctx_t *ctx, al_worker_pool_t *pool,
+                            void *out, size_t outsz,
+                            const void *in, size_t len, const void *iv,
+                            size_t chunk)
+{
+    aes_ctr_job_t job[AES_CTR_JOBS];
+    al_worker_item_t item[AES_CTR_JOBS];
+    const aes_kernel_t *k;
+    const uint8_t *src = (const uint8_t *)in;
+    uint8_t *dst = (uint8_t *)out;
+    uint8_t ctr[16];
+    al_os_sem_t done;
+    size_t left = len;
+    int_t i, n, queued;
+
+    AL_CHECK_RET((ctx != NULL) && (pool != NULL) && (out != NULL) &&
+                 (iv != NULL) && ((in != NULL) || (len == 0)), EINVAL, -1);
+    AL_CHECK_RET(len <= outsz, ENOBUFS, -1);
+
+    k = aes_ctx_kernel(ctx);
+    AL_CHECK_RET(k != NULL, EINVAL, -1);
+
+    chunk = (chunk == 0) ? AES_CTR_CHUNK : (chunk & ~(size_t)15);
+    AL_CHECK_RET(chunk > 0, EINVAL, -1);
+
+    memcpy(ctr, iv, sizeof(ctr));
+
+    /* not worth a round trip through the pool */
+    if (len <= chunk) {
+        aes_ctr_crypt(ctx, k, dst, src, len, ctr);
+        return len;
+    }
+
+    done = al_os_sem_count_create(AES_CTR_JOBS, 0);
+    AL_CHECK_RET(done != NULL, ENOMEM, -1);
+
+    while (left > 0) {
+        for (n = 0; (n < AES_CTR_JOBS) && (left > 0); n++) {
+            job[n].ctx = ctx;
+            job[n].k = k;
+            job[n].out = dst;
+            job[n].in = src;
+            job[n].len = min_t(size_t, chunk, left);
+            job[n].done = done;
+            memcpy(job[n].ctr, ctr, sizeof(ctr));
+            item[n].func = aes_ctr_job;
+            item[n].arg = &job[n];
+
+            aes_ctr_add(ctr, job[n].len / 16);
+            dst += job[n].len;
+            src += job[n].len;
+            left -= job[n].len;
+        }
+
+        queued = al_worker_pool_run_batch(pool, item, n, -1);
+        if (queued < 0) {
+            queued = 0;
+        }
+
+        /* whatever the pool did not take runs here */
+        for (i = queued; i < n; i++) {
+            aes_ctr_job(&job[i]);
+        }
+
+        for (i = 0; i < n; i++) {
+            al_os_sem_take(done, -1);
+        }
+    }
+
+    al_os_sem_count_del(done);
+
+    return len;
+}
+
+__END_DECLS
+
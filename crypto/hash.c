@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/bug.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/crypto/hash.h"
+#include "mbedtls/sha256.h"
+
+__BEGIN_DECLS
+
+#define hash_sha256(ctx)		((mbedtls_sha256_context *)(ctx)->priv)
+
+size_t al_hash_size(al_hash_type_t type)
+{
+	switch (type) {
+	case AL_HASH_MD5:
+		return 16;
+	case AL_HASH_SHA256:
+		return 32;
+	default:
+		return 0;
+	}
+}
+
+int32_t al_hash_init(al_hash_ctx_t *ctx, al_hash_type_t type)
+{
+	BUILD_BUG_ON(sizeof(mbedtls_sha256_context) > sizeof(ctx->priv));
+
+	AL_CHECK_RET(ctx != NULL, EINVAL, -1);
+
+	switch (type) {
+	case AL_HASH_MD5:
+		al_md5_init(&ctx->md5);
+		break;
+
+	case AL_HASH_SHA256:
+		mbedtls_sha256_init(hash_sha256(ctx));
+
+		if (mbedtls_sha256_starts(hash_sha256(ctx), 0) != 0) {
+			mbedtls_sha256_free(hash_sha256(ctx));
+			set_errno(EIO);
+			return -1;
+		}
+		break;
+
+	default:
+		set_errno(EINVAL);
+		return -1;
+	}
+
+	ctx->type = type;
+
+	return 0;
+}
+
+int32_t al_hash_update(al_hash_ctx_t *ctx, const void *data, size_t len)
+{
+	AL_CHECK_RET((ctx != NULL) && ((data != NULL) || (len == 0)), EINVAL, -1);
+
+	switch (ctx->type) {
+	case AL_HASH_MD5:
+		al_md5_update(&ctx->md5, data, len);
+		return 0;
+
+	case AL_HASH_SHA256:
+		AL_CHECK_RET(mbedtls_sha256_update(hash_sha256(ctx), data, len) == 0,
+					 EIO, -1);
+		return 0;
+
+	default:
+		set_errno(EINVAL);
+		return -1;
+	}
+}
+
+int32_t al_hash_final(al_hash_ctx_t *ctx, void *digest)
+{
+	int ret;
+
+	AL_CHECK_RET((ctx != NULL) && (digest != NULL), EINVAL, -1);
+
+	switch (ctx->type) {
+	case AL_HASH_MD5:
+		al_md5_final(&ctx->md5, digest);
+		return 0;
+
+	case AL_HASH_SHA256:
+		ret = mbedtls_sha256_finish(hash_sha256(ctx), digest);
+		mbedtls_sha256_free(hash_sha256(ctx));
+
+		AL_CHECK_RET(ret == 0, EIO, -1);
+		return 0;
+
+	default:
+		set_errno(EINVAL);
+		return -1;
+	}
+}
+
+int32_t al_hash(al_hash_type_t type, const void *data, size_t len, void *digest)
+{
+	al_hash_ctx_t ctx;
+
+	if (al_hash_init(&ctx, type) < 0) {
+		return -1;
+	}
+
+	if (al_hash_update(&ctx, data, len) < 0) {
+		al_hash_final(&ctx, digest);
+		return -1;
+	}
+
+	return al_hash_final(&ctx, digest);
+}
+
+__END_DECLS
+
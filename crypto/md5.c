@@ -3,6 +3,8 @@
 #include "alumy/config.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
 #include "alumy/crypto/md5.h"
 
 __BEGIN_DECLS
@@ -81,6 +83,81 @@ static void md5_decode(uint32_t *output, const uint8_t *input, size_t len)
     }
 }
 
+/* The 64 steps, shared by the one block and the multi-buffer transforms */
+#define MD5_ROUNDS(a, b, c, d, x)                         \
+    do {                                                  \
+        FF(a, b, c, d, x[0],   7, 0xd76aa478);  /* 1 */   \
+        FF(d, a, b, c, x[1],  12, 0xe8c7b756);  /* 2 */   \
+        FF(c, d, a, b, x[2],  17, 0x242070db);  /* 3 */   \
+        FF(b, c, d, a, x[3],  22, 0xc1bdceee);  /* 4 */   \
+        FF(a, b, c, d, x[4],   7, 0xf57c0faf);  /* 5 */   \
+        FF(d, a, b, c, x[5],  12, 0x4787c62a);  /* 6 */   \
+        FF(c, d, a, b, x[6],  17, 0xa8304613);  /* 7 */   \
+        FF(b, c, d, a, x[7],  22, 0xfd469501);  /* 8 */   \
+        FF(a, b, c, d, x[8],   7, 0x698098d8);  /* 9 */   \
+        FF(d, a, b, c, x[9],  12, 0x8b44f7af);  /* 10 */  \
+        FF(c, d, a, b, x[10], 17, 0xffff5bb1);  /* 11 */  \
+        FF(b, c, d, a, x[11], 22, 0x895cd7be);  /* 12 */  \
+        FF(a, b, c, d, x[12],  7, 0x6b901122);  /* 13 */  \
+        FF(d, a, b, c, x[13], 12, 0xfd987193);  /* 14 */  \
+        FF(c, d, a, b, x[14], 17, 0xa679438e);  /* 15 */  \
+        FF(b, c, d, a, x[15], 22, 0x49b40821);  /* 16 */  \
+                                                          \
+        /* Round 2 */                                     \
+        GG(a, b, c, d, x[1],   5, 0xf61e2562);  /* 17 */  \
+        GG(d, a, b, c, x[6],   9, 0xc040b340);  /* 18 */  \
+        GG(c, d, a, b, x[11], 14, 0x265e5a51);  /* 19 */  \
+        GG(b, c, d, a, x[0],  20, 0xe9b6c7aa);  /* 20 */  \
+        GG(a, b, c, d, x[5],   5, 0xd62f105d);  /* 21 */  \
+        GG(d, a, b, c, x[10],  9, 0x2441453);   /* 22 */  \
+        GG(c, d, a, b, x[15], 14, 0xd8a1e681);  /* 23 */  \
+        GG(b, c, d, a, x[4],  20, 0xe7d3fbc8);  /* 24 */  \
+        GG(a, b, c, d, x[9],   5, 0x21e1cde6);  /* 25 */  \
+        GG(d, a, b, c, x[14],  9, 0xc33707d6);  /* 26 */  \
+        GG(c, d, a, b, x[3],  14, 0xf4d50d87);  /* 27 */  \
+        GG(b, c, d, a, x[8],  20, 0x455a14ed);  /* 28 */  \
+        GG(a, b, c, d, x[13],  5, 0xa9e3e905);  /* 29 */  \
+        GG(d, a, b, c, x[2],   9, 0xfcefa3f8);  /* 30 */  \
+        GG(c, d, a, b, x[7],  14, 0x676f02d9);  /* 31 */  \
+        GG(b, c, d, a, x[12], 20, 0x8d2a4c8a);  /* 32 */  \
+                                                          \
+        /* Round 3 */                                     \
+        HH(a, b, c, d, x[5],   4, 0xfffa3942);  /* 33 */  \
+        HH(d, a, b, c, x[8],  11, 0x8771f681);  /* 34 */  \
+        HH(c, d, a, b, x[11], 16, 0x6d9d6122);  /* 35 */  \
+        HH(b, c, d, a, x[14], 23, 0xfde5380c);  /* 36 */  \
+        HH(a, b, c, d, x[1],   4, 0xa4beea44);  /* 37 */  \
+        HH(d, a, b, c, x[4],  11, 0x4bdecfa9);  /* 38 */  \
+        HH(c, d, a, b, x[7],  16, 0xf6bb4b60);  /* 39 */  \
+        HH(b, c, d, a, x[10], 23, 0xbebfbc70);  /* 40 */  \
+        HH(a, b, c, d, x[13],  4, 0x289b7ec6);  /* 41 */  \
+        HH(d, a, b, c, x[0],  11, 0xeaa127fa);  /* 42 */  \
+        HH(c, d, a, b, x[3],  16, 0xd4ef3085);  /* 43 */  \
+        HH(b, c, d, a, x[6],  23, 0x4881d05);   /* 44 */  \
+        HH(a, b, c, d, x[9],   4, 0xd9d4d039);  /* 45 */  \
+        HH(d, a, b, c, x[12], 11, 0xe6db99e5);  /* 46 */  \
+        HH(c, d, a, b, x[15], 16, 0x1fa27cf8);  /* 47 */  \
+        HH(b, c, d, a, x[2],  23, 0xc4ac5665);  /* 48 */  \
+                                                          \
+        /* Round 4 */                                     \
+        II(a, b, c, d, x[0],   6, 0xf4292244);   /* 49 */ \
+        II(d, a, b, c, x[7],  10, 0x432aff97);   /* 50 */ \
+        II(c, d, a, b, x[14], 15, 0xab9423a7);   /* 51 */ \
+        II(b, c, d, a, x[5],  21, 0xfc93a039);   /* 52 */ \
+        II(a, b, c, d, x[12],  6, 0x655b59c3);   /* 53 */ \
+        II(d, a, b, c, x[3],  10, 0x8f0ccc92);   /* 54 */ \
+        II(c, d, a, b, x[10], 15, 0xffeff47d);   /* 55 */ \
+        II(b, c, d, a, x[1],  21, 0x85845dd1);   /* 56 */ \
+        II(a, b, c, d, x[8],   6, 0x6fa87e4f);   /* 57 */ \
+        II(d, a, b, c, x[15], 10, 0xfe2ce6e0);   /* 58 */ \
+        II(c, d, a, b, x[6],  15, 0xa3014314);   /* 59 */ \
+        II(b, c, d, a, x[13], 21, 0x4e0811a1);   /* 60 */ \
+        II(a, b, c, d, x[4],   6, 0xf7537e82);   /* 61 */ \
+        II(d, a, b, c, x[11], 10, 0xbd3af235);   /* 62 */ \
+        II(c, d, a, b, x[2],  15, 0x2ad7d2bb);   /* 63 */ \
+        II(b, c, d, a, x[9],  21, 0xeb86d391);   /* 64 */ \
+    } while (0)
+
 static void md5_transform(uint32_t state[4], const uint8_t block[64])
 {
     uint32_t x[64] = {0};
@@ -91,76 +168,7 @@ static void md5_transform(uint32_t state[4], const uint8_t block[64])
     register uint32_t d = state[3];
 
     md5_decode(x, block, 64);
-    FF(a, b, c, d, x[0],   7, 0xd76aa478);  /* 1 */
-    FF(d, a, b, c, x[1],  12, 0xe8c7b756);  /* 2 */
-    FF(c, d, a, b, x[2],  17, 0x242070db);  /* 3 */
-    FF(b, c, d, a, x[3],  22, 0xc1bdceee);  /* 4 */
-    FF(a, b, c, d, x[4],   7, 0xf57c0faf);  /* 5 */
-    FF(d, a, b, c, x[5],  12, 0x4787c62a);  /* 6 */
-    FF(c, d, a, b, x[6],  17, 0xa8304613);  /* 7 */
-    FF(b, c, d, a, x[7],  22, 0xfd469501);  /* 8 */
-    FF(a, b, c, d, x[8],   7, 0x698098d8);  /* 9 */
-    FF(d, a, b, c, x[9],  12, 0x8b44f7af);  /* 10 */
-    FF(c, d, a, b, x[10], 17, 0xffff5bb1);  /* 11 */
-    FF(b, c, d, a, x[11], 22, 0x895cd7be);  /* 12 */
-    FF(a, b, c, d, x[12],  7, 0x6b901122);  /* 13 */
-    FF(d, a, b, c, x[13], 12, 0xfd987193);  /* 14 */
-    FF(c, d, a, b, x[14], 17, 0xa679438e);  /* 15 */
-    FF(b, c, d, a, x[15], 22, 0x49b40821);  /* 16 */
-
-    /* Round 2 */
-    GG(a, b, c, d, x[1],   5, 0xf61e2562);  /* 17 */
-    GG(d, a, b, c, x[6],   9, 0xc040b340);  /* 18 */
-    GG(c, d, a, b, x[11], 14, 0x265e5a51);  /* 19 */
-    GG(b, c, d, a, x[0],  20, 0xe9b6c7aa);  /* 20 */
-    GG(a, b, c, d, x[5],   5, 0xd62f105d);  /* 21 */
-    GG(d, a, b, c, x[10],  9, 0x2441453);   /* 22 */
-    GG(c, d, a, b, x[15], 14, 0xd8a1e681);  /* 23 */
-    GG(b, c, d, a, x[4],  20, 0xe7d3fbc8);  /* 24 */
-    GG(a, b, c, d, x[9],   5, 0x21e1cde6);  /* 25 */
-    GG(d, a, b, c, x[14],  9, 0xc33707d6);  /* 26 */
-    GG(c, d, a, b, x[3],  14, 0xf4d50d87);  /* 27 */
-    GG(b, c, d, a, x[8],  20, 0x455a14ed);  /* 28 */
-    GG(a, b, c, d, x[13],  5, 0xa9e3e905);  /* 29 */
-    GG(d, a, b, c, x[2],   9, 0xfcefa3f8);  /* 30 */
-    GG(c, d, a, b, x[7],  14, 0x676f02d9);  /* 31 */
-    GG(b, c, d, a, x[12], 20, 0x8d2a4c8a);  /* 32 */
-
-    /* Round 3 */
-    HH(a, b, c, d, x[5],   4, 0xfffa3942);  /* 33 */
-    HH(d, a, b, c, x[8],  11, 0x8771f681);  /* 34 */
-    HH(c, d, a, b, x[11], 16, 0x6d9d6122);  /* 35 */
-    HH(b, c, d, a, x[14], 23, 0xfde5380c);  /* 36 */
-    HH(a, b, c, d, x[1],   4, 0xa4beea44);  /* 37 */
-    HH(d, a, b, c, x[4],  11, 0x4bdecfa9);  /* 38 */
-    HH(c, d, a, b, x[7],  16, 0xf6bb4b60);  /* 39 */
-    HH(b, c, d, a, x[10], 23, 0xbebfbc70);  /* 40 */
-    HH(a, b, c, d, x[13],  4, 0x289b7ec6);  /* 41 */
-    HH(d, a, b, c, x[0],  11, 0xeaa127fa);  /* 42 */
-    HH(c, d, a, b, x[3],  16, 0xd4ef3085);  /* 43 */
-    HH(b, c, d, a, x[6],  23, 0x4881d05);   /* 44 */
-    HH(a, b, c, d, x[9],   4, 0xd9d4d039);  /* 45 */
-    HH(d, a, b, c, x[12], 11, 0xe6db99e5);  /* 46 */
-    HH(c, d, a, b, x[15], 16, 0x1fa27cf8);  /* 47 */
-    HH(b, c, d, a, x[2],  23, 0xc4ac5665);  /* 48 */
-
-    /* Round 4 */
-    II(a, b, c, d, x[0],   6, 0xf4292244);   /* 49 */
-    II(d, a, b, c, x[7],  10, 0x432aff97);   /* 50 */
-    II(c, d, a, b, x[14], 15, 0xab9423a7);   /* 51 */
-    II(b, c, d, a, x[5],  21, 0xfc93a039);   /* 52 */
-    II(a, b, c, d, x[12],  6, 0x655b59c3);   /* 53 */
-    II(d, a, b, c, x[3],  10, 0x8f0ccc92);   /* 54 */
-    II(c, d, a, b, x[10], 15, 0xffeff47d);   /* 55 */
-    II(b, c, d, a, x[1],  21, 0x85845dd1);   /* 56 */
-    II(a, b, c, d, x[8],   6, 0x6fa87e4f);   /* 57 */
-    II(d, a, b, c, x[15], 10, 0xfe2ce6e0);   /* 58 */
-    II(c, d, a, b, x[6],  15, 0xa3014314);   /* 59 */
-    II(b, c, d, a, x[13], 21, 0x4e0811a1);   /* 60 */
-    II(a, b, c, d, x[4],   6, 0xf7537e82);   /* 61 */
-    II(d, a, b, c, x[11], 10, 0xbd3af235);   /* 62 */
-    II(c, d, a, b, x[2],  15, 0x2ad7d2bb);   /* 63 */
-    II(b, c, d, a, x[9],  21, 0xeb86d391);   /* 64 */
+    MD5_ROUNDS(a, b, c, d, x);
 
     state[0] += a;
     state[1] += b;
@@ -168,7 +176,7 @@ static void md5_transform(uint32_t state[4], const uint8_t block[64])
     state[3] += d;
 }
 
-static void md5_init(al_md5_ctx_t *ctx)
+void al_md5_init(al_md5_ctx_t *ctx)
 {
     ctx->count[0] = 0;
     ctx->count[1] = 0;
@@ -178,41 +186,35 @@ static void md5_init(al_md5_ctx_t *ctx)
     ctx->state[3] = 0x10325476;
 }
 
-static void md5_update(al_md5_ctx_t *ctx, const void *input, size_t inputlen)
+void al_md5_update(al_md5_ctx_t *ctx, const void *input, size_t inputlen)
 {
-    uint32_t i = 0, index = 0, partlen = 0;
+    const uint8_t *in = (const uint8_t *)input;
+    uint64_t bits = ((uint64_t)ctx->count[1] << 32) | ctx->count[0];
+    size_t i = 0, index = 0, partlen = 0;
 
     index = (ctx->count[0] >> 3) & 0x3F;
     partlen = 64 - index;
 
-    ctx->count[0] += inputlen << 3;
-
-    if (ctx->count[0] < (inputlen << 3))
-        ctx->count[1]++;
-
-    ctx->count[1] += inputlen >> 29;
+    bits += (uint64_t)inputlen << 3;
+    ctx->count[0] = (uint32_t)bits;
+    ctx->count[1] = (uint32_t)(bits >> 32);
 
     if (inputlen >= partlen) {
-        memcpy(&ctx->buffer[index], input, partlen);
+        memcpy(&ctx->buffer[index], in, partlen);
         md5_transform(ctx->state, ctx->buffer);
 
         for (i = partlen; i + 64 <= inputlen; i += 64)
-            md5_transform(ctx->state, &((uint8_t *)input)[i]);
+            md5_transform(ctx->state, &in[i]);
 
         index = 0;
     } else {
         i = 0;
     }
 
-    memcpy(&ctx->buffer[index], &((uint8_t *)input)[i], inputlen - i);
-}
-
-static void md5_start(al_md5_ctx_t *ctx, const void *input, size_t len)
-{
-    md5_update(ctx, input, len);
+    memcpy(&ctx->buffer[index], &in[i], inputlen - i);
 }
 
-static void md5_process(al_md5_ctx_t *ctx)
+void al_md5_final(al_md5_ctx_t *ctx, void *digest)
 {
     uint32_t index = 0, padlen = 0;
     uint8_t bits[8];
@@ -221,23 +223,196 @@ static void md5_process(al_md5_ctx_t *ctx)
     padlen = (index < 56) ? (56 - index) : (120 - index);
 
     md5_encode(bits, ctx->count, 8);
-    md5_update(ctx, (uint8_t *)md5_padding, padlen);
-    md5_update(ctx, bits, 8);
-}
+    al_md5_update(ctx, md5_padding, padlen);
+    al_md5_update(ctx, bits, 8);
 
-static void md5_final(al_md5_ctx_t *ctx, uint8_t *digest)
-{
-    md5_encode(digest, ctx->state, 16);
+    md5_encode((uint8_t *)digest, ctx->state, 16);
 }
 
 void al_md5_sign(al_md5_ctx_t *ctx,
                  void *output, const void *input, size_t len)
 {
-    md5_init(ctx);
+    al_md5_init(ctx);
+    al_md5_update(ctx, input, len);
+    al_md5_final(ctx, output);
+}
+
+/*
+ * Multi-buffer hashing runs one message per lane of a GCC vector, the
+ * step macros work on vectors unchanged. Each lane walks the blocks of
+ * its message and then its one or two padding blocks, a lane that is done
+ * keeps its state while the longer messages of the group go on.
+ */
+#if defined(__GNUC__)
+#define MD5_MB      1
+#else
+#define MD5_MB      0
+#endif
+
+#if MD5_MB
+typedef struct md5_mb_lane {
+    const uint8_t *data;    /* the message */
+    size_t full;            /* blocks read from data directly */
+    size_t nblocks;         /* blocks including the padding */
+    uint8_t tail[128];      /* the last partial block and the padding */
+} md5_mb_lane_t;
+
+static const uint8_t md5_mb_zero[64];
+
+static void md5_mb_lane_init(md5_mb_lane_t *lane, const void *data, size_t len)
+{
+    uint64_t bits = (uint64_t)len << 3;
+    size_t rem = len & 63;
+    int_t i;
+
+    lane->data = (const uint8_t *)data;
+    lane->full = len >> 6;
+    lane->nblocks = lane->full + ((rem < 56) ? 1 : 2);
+
+    memset(lane->tail, 0, sizeof(lane->tail));
+    memcpy(lane->tail, lane->data + (lane->full << 6), rem);
+    lane->tail[rem] = 0x80;
+
+    for (i = 0; i < 8; i++) {
+        lane->tail[(lane->nblocks - lane->full) * 64 - 8 + i] = bits >> (i * 8);
+    }
+}
+
+static const uint8_t *md5_mb_lane_block(const md5_mb_lane_t *lane, size_t k)
+{
+    if (k < lane->full) {
+        return lane->data + (k << 6);
+    }
+
+    if (k < lane->nblocks) {
+        return lane->tail + ((k - lane->full) << 6);
+    }
+
+    return md5_mb_zero;
+}
+
+static uint32_t md5_mb_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#define MD5_MB_DEFINE(name, lanes, attr)                                    \
+typedef uint32_t name##_v __attribute__((vector_size((lanes) * 4)));       \
+                                                                            \
+attr static void name(md5_mb_lane_t *lane, int_t n, uint8_t (*digest)[16])  \
+{                                                                           \
+    name##_v st[4], x[16], a, b, c, d, live;                                \
+    const uint8_t *blk[lanes];                                              \
+    size_t k, nblocks = 0;                                                  \
+    int_t i, j;                                                             \
+                                                                            \
+    for (i = 0; i < (lanes); i++) {                                         \
+        st[0][i] = 0x67452301;                                              \
+        st[1][i] = 0xEFCDAB89;                                              \
+        st[2][i] = 0x98BADCFE;                                              \
+        st[3][i] = 0x10325476;                                              \
+                                                                            \
+        if ((i < n) && (lane[i].nblocks > nblocks)) {                       \
+            nblocks = lane[i].nblocks;                                      \
+        }                                                                   \
+    }                                                                       \
+                                                                            \
+    for (k = 0; k < nblocks; k++) {                                         \
+        for (i = 0; i < (lanes); i++) {                                     \
+            blk[i] = (i < n) ? md5_mb_lane_block(&lane[i], k) : md5_mb_zero; \
+            live[i] = ((i < n) && (k < lane[i].nblocks)) ? ~0U : 0;         \
+        }                                                                   \
+                                                                            \
+        for (j = 0; j < 16; j++) {                                          \
+            for (i = 0; i < (lanes); i++) {                                 \
+                x[j][i] = md5_mb_le32(blk[i] + j * 4);                      \
+            }                                                               \
+        }                                                                   \
+                                                                            \
+        a = st[0];                                                          \
+        b = st[1];                                                          \
+        c = st[2];                                                          \
+        d = st[3];                                                          \
+                                                                            \
+        MD5_ROUNDS(a, b, c, d, x);                                          \
+                                                                            \
+        st[0] += a & live;                                                  \
+        st[1] += b & live;                                                  \
+        st[2] += c & live;                                                  \
+        st[3] += d & live;                                                  \
+    }                                                                       \
+                                                                            \
+    for (i = 0; i < n; i++) {                                               \
+        uint32_t s[4] = { st[0][i], st[1][i], st[2][i], st[3][i] };         \
+                                                                            \
+        md5_encode(digest[i], s, 16);                                       \
+    }                                                                       \
+}
+
+MD5_MB_DEFINE(md5_mb4, 4, )
+
+#if defined(__x86_64__) || defined(__i386__)
+MD5_MB_DEFINE(md5_mb8, 8, __attribute__((target("avx2"))))
+
+static bool_t md5_mb8_supported(void)
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2");
+}
+#else
+#define md5_mb8(lane, n, digest)    md5_mb4(lane, n, digest)
+#define md5_mb8_supported()         false
+#endif
+#endif
+
+int_t al_md5_mb_lanes(void)
+{
+#if MD5_MB
+    return md5_mb8_supported() ? 8 : 4;
+#else
+    return 1;
+#endif
+}
+
+int32_t al_md5_mb(const void *const data[], const size_t len[],
+                  uint8_t digest[][16], int_t n)
+{
+#if MD5_MB
+    md5_mb_lane_t lane[8];
+    int_t lanes = al_md5_mb_lanes();
+    int_t i, m;
+
+    AL_CHECK_RET((data != NULL) && (len != NULL) && (digest != NULL) &&
+                 (n >= 0), EINVAL, -1);
+
+    for (; n > 0; n -= m, data += m, len += m, digest += m) {
+        m = min(n, lanes);
+
+        for (i = 0; i < m; i++) {
+            md5_mb_lane_init(&lane[i], data[i], len[i]);
+        }
+
+        if (lanes == 8) {
+            md5_mb8(lane, m, digest);
+        } else {
+            md5_mb4(lane, m, digest);
+        }
+    }
+#else
+    al_md5_ctx_t ctx;
+    int_t i;
+
+    AL_CHECK_RET((data != NULL) && (len != NULL) && (digest != NULL) &&
+                 (n >= 0), EINVAL, -1);
+
+    for (i = 0; i < n; i++) {
+        al_md5_sign(&ctx, digest[i], data[i], len[i]);
+    }
+#endif
 
-    md5_start(ctx, input, len);
-    md5_process(ctx);
-    md5_final(ctx, (uint8_t *)output);
+    return 0;
 }
 
 __END_DECLS
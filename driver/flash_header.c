@@ -3,6 +3,8 @@
 #include "alumy/errno.h"
 #include "alumy/crc.h"
 #include "alumy/bug.h"
+#include "alumy/check.h"
+#include "alumy/osal.h"
 
 __BEGIN_DECLS
 
@@ -67,5 +69,213 @@ int32_t al_flash_check(const void *ptr, size_t len)
     return 0;
 }
 
+int32_t al_flash_verify_init(al_flash_verify_ctx_t *ctx)
+{
+    AL_CHECK_RET(ctx != NULL, EINVAL, -1);
+
+    memset(ctx, 0, sizeof(*ctx));
+
+    return 0;
+}
+
+static int32_t flash_verify_fail(al_flash_verify_ctx_t *ctx, int32_t err)
+{
+    if (ctx->err == 0) {
+        ctx->err = err;
+    }
+
+    set_errno(ctx->err);
+    return -1;
+}
+
+static int32_t flash_verify_header(al_flash_verify_ctx_t *ctx)
+{
+    if (!al_flash_check_magic(&ctx->hdr)) {
+        AL_ERROR(1, "Bad Magic Number");
+        return flash_verify_fail(ctx, EPERM);
+    }
+
+    if (!al_flash_check_hcrc(&ctx->hdr)) {
+        AL_ERROR(1, "Has bad header checksum!");
+        return flash_verify_fail(ctx, EPERM);
+    }
+
+    return 0;
+}
+
+/* the data bytes of len still belonging to the image */
+static size_t flash_verify_clamp(const al_flash_verify_ctx_t *ctx, size_t len)
+{
+    uint32_t left = al_flash_get_data_size(&ctx->hdr) - ctx->dlen;
+
+    return (len > left) ? left : len;
+}
+
+int32_t al_flash_verify_update(al_flash_verify_ctx_t *ctx,
+                               const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t hsize = al_flash_get_header_size();
+    size_t n;
+
+    AL_CHECK_RET((ctx != NULL) && ((data != NULL) || (len == 0)), EINVAL, -1);
+
+    if (ctx->err != 0) {
+        return flash_verify_fail(ctx, ctx->err);
+    }
+
+    if (ctx->hlen < hsize) {
+        n = min_t(size_t, hsize - ctx->hlen, len);
+        memcpy((uint8_t *)&ctx->hdr + ctx->hlen, p, n);
+        ctx->hlen += n;
+        p += n;
+        len -= n;
+
+        if ((ctx->hlen == hsize) && (flash_verify_header(ctx) != 0)) {
+            return -1;
+        }
+    }
+
+    if (ctx->hlen == hsize) {
+        n = flash_verify_clamp(ctx, len);
+        ctx->dcrc = al_crc32(ctx->dcrc, p, n);
+        ctx->dlen += n;
+    }
+
+    return 0;
+}
+
+int32_t al_flash_verify_combine(al_flash_verify_ctx_t *ctx,
+                                uint32_t crc, size_t len)
+{
+    AL_CHECK_RET(ctx != NULL, EINVAL, -1);
+    AL_CHECK_RET(ctx->hlen == al_flash_get_header_size(), EINVAL, -1);
+
+    if (ctx->err != 0) {
+        return flash_verify_fail(ctx, ctx->err);
+    }
+
+    /* a chunk running past the image can't be trimmed afterwards */
+    if (flash_verify_clamp(ctx, len) != len) {
+        AL_ERROR(1, "Has corrupted size!");
+        return flash_verify_fail(ctx, EPERM);
+    }
+
+    ctx->dcrc = al_crc32_combine(ctx->dcrc, crc, len);
+    ctx->dlen += len;
+
+    return 0;
+}
+
+typedef struct flash_verify_job {
+    const uint8_t *data;
+    size_t len;
+    uint32_t crc;
+    al_os_sem_t done;
+} flash_verify_job_t;
+
+#define FLASH_VERIFY_JOBS       16
+#define FLASH_VERIFY_CHUNK      (64 * 1024)
+
+static void flash_verify_job(void *arg)
+{
+    flash_verify_job_t *job = (flash_verify_job_t *)arg;
+
+    job->crc = al_crc32(0, job->data, job->len);
+    al_os_sem_give(job->done);
+}
+
+int32_t al_flash_verify_parallel(al_flash_verify_ctx_t *ctx,
+                                 al_worker_pool_t *pool,
+                                 const void *data, size_t len, size_t chunk)
+{
+    flash_verify_job_t job[FLASH_VERIFY_JOBS];
+    al_worker_item_t item[FLASH_VERIFY_JOBS];
+    const uint8_t *p = (const uint8_t *)data;
+    al_os_sem_t done;
+    int32_t ret = 0;
+    int_t i, n, queued;
+
+    AL_CHECK_RET((ctx != NULL) && (pool != NULL), EINVAL, -1);
+    AL_CHECK_RET((data != NULL) || (len == 0), EINVAL, -1);
+    AL_CHECK_RET(ctx->hlen == al_flash_get_header_size(), EINVAL, -1);
+
+    if (ctx->err != 0) {
+        return flash_verify_fail(ctx, ctx->err);
+    }
+
+    if (chunk == 0) {
+        chunk = FLASH_VERIFY_CHUNK;
+    }
+
+    len = flash_verify_clamp(ctx, len);
+
+    done = al_os_sem_count_create(FLASH_VERIFY_JOBS, 0);
+    AL_CHECK_RET(done != NULL, ENOMEM, -1);
+
+    while ((len > 0) && (ret == 0)) {
+        for (n = 0; (n < FLASH_VERIFY_JOBS) && (len > 0); n++) {
+            job[n].data = p;
+            job[n].len = min_t(size_t, chunk, len);
+            job[n].done = done;
+            item[n].func = flash_verify_job;
+            item[n].arg = &job[n];
+            p += job[n].len;
+            len -= job[n].len;
+        }
+
+        queued = al_worker_pool_run_batch(pool, item, n, -1);
+        if (queued < 0) {
+            queued = 0;
+        }
+
+        /* whatever the pool did not take runs here */
+        for (i = queued; i < n; i++) {
+            flash_verify_job(&job[i]);
+        }
+
+        for (i = 0; i < n; i++) {
+            al_os_sem_take(done, -1);
+        }
+
+        for (i = 0; (i < n) && (ret == 0); i++) {
+            ret = al_flash_verify_combine(ctx, job[i].crc, job[i].len);
+        }
+    }
+
+    al_os_sem_count_del(done);
+
+    return ret;
+}
+
+int32_t al_flash_verify_final(al_flash_verify_ctx_t *ctx,
+                              al_flash_header_t *hdr)
+{
+    AL_CHECK_RET(ctx != NULL, EINVAL, -1);
+
+    if (ctx->err != 0) {
+        return flash_verify_fail(ctx, ctx->err);
+    }
+
+    if ((ctx->hlen < al_flash_get_header_size()) ||
+        (ctx->dlen < al_flash_get_data_size(&ctx->hdr))) {
+        AL_ERROR(1, "Has corrupted size!");
+        return flash_verify_fail(ctx, EPERM);
+    }
+
+    if (ctx->dcrc != al_flash_get_dcrc(&ctx->hdr)) {
+        AL_ERROR(1, "Has corrupted data!");
+        return flash_verify_fail(ctx, EPERM);
+    }
+
+    if (hdr != NULL) {
+        memcpy(hdr, &ctx->hdr, sizeof(*hdr));
+    }
+
+    set_errno(0);
+
+    return 0;
+}
+
 __END_DECLS
 
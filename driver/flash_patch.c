@@ -0,0 +1,278 @@
+#include <string.h>
+#include "alumy/driver/flash_patch.h"
+#include "alumy/errno.h"
+#include "alumy/bug.h"
+#include "alumy/check.h"
+
+__BEGIN_DECLS
+
+static int32_t flash_patch_fail(al_flash_patch_t *p, int32_t err)
+{
+    if (p->err == 0) {
+        p->err = err;
+    }
+
+    set_errno(p->err);
+    return -1;
+}
+
+/* the old image must be the one the patch was made from */
+static int32_t flash_patch_header(al_flash_patch_t *p)
+{
+    al_flash_header_t old;
+    uint32_t size;
+
+    if (al_be32_to_cpu(p->hdr.ph_magic) != AL_FLASH_PATCH_MAGIC) {
+        AL_ERROR(1, "Bad patch magic number");
+        return flash_patch_fail(p, EPERM);
+    }
+
+    if (p->opt.read(p->opt.old_addr, &old, sizeof(old)) != 0) {
+        return flash_patch_fail(p, EIO);
+    }
+
+    if (!al_flash_check_magic(&old) || !al_flash_check_hcrc(&old)) {
+        AL_ERROR(1, "Has no old image!");
+        return flash_patch_fail(p, EPERM);
+    }
+
+    size = al_flash_get_flash_size(&old);
+
+    if ((size > p->opt.old_size) ||
+        (size != al_be32_to_cpu(p->hdr.ph_old_size)) ||
+        (al_flash_get_dcrc(&old) != al_be32_to_cpu(p->hdr.ph_old_dcrc))) {
+        AL_ERROR(1, "Patch is for another image!");
+        return flash_patch_fail(p, EPERM);
+    }
+
+    if (al_be32_to_cpu(p->hdr.ph_new_size) < al_flash_get_header_size()) {
+        return flash_patch_fail(p, EINVAL);
+    }
+
+    p->old_size = size;
+
+    return 0;
+}
+
+static int64_t flash_patch_offset(const uint8_t *buf)
+{
+    uint64_t v = buf[7] & 0x7F;
+
+    for (int_t i = 6; i >= 0; i--) {
+        v = (v << 8) | buf[i];
+    }
+
+    return (buf[7] & 0x80) ? -(int64_t)v : (int64_t)v;
+}
+
+static int32_t flash_patch_ctrl(al_flash_patch_t *p)
+{
+    int64_t diff = flash_patch_offset(p->ctrl);
+    int64_t extra = flash_patch_offset(p->ctrl + 8);
+    uint32_t left = al_be32_to_cpu(p->hdr.ph_new_size) - p->new_pos;
+
+    if ((diff < 0) || (extra < 0) || ((uint64_t)diff > left) ||
+        ((uint64_t)extra > left - (uint64_t)diff)) {
+        AL_ERROR(1, "Has corrupted patch!");
+        return flash_patch_fail(p, EINVAL);
+    }
+
+    p->diff = diff;
+    p->extra = extra;
+    p->seek = flash_patch_offset(p->ctrl + 16);
+
+    return 0;
+}
+
+static int32_t flash_patch_flush(al_flash_patch_t *p)
+{
+    if (p->blen == 0) {
+        return 0;
+    }
+
+    /* a bad new header stops here, before the flash is touched */
+    if (al_flash_verify_update(&p->verify, p->opt.buf, p->blen) != 0) {
+        return flash_patch_fail(p, EPERM);
+    }
+
+    if (p->opt.write(p->opt.ctx, p->opt.buf, p->blen) != 0) {
+        return flash_patch_fail(p, EIO);
+    }
+
+    p->blen = 0;
+
+    return 0;
+}
+
+/* the old bytes under the next n of the new image, 0 outside the old image */
+static int32_t flash_patch_read_old(al_flash_patch_t *p, uint8_t *buf, size_t n)
+{
+    int64_t pos = p->old_pos;
+    int64_t end = pos + n;
+    int64_t lo = max_t(int64_t, pos, 0);
+    int64_t hi = min_t(int64_t, end, p->old_size);
+
+    if (lo >= hi) {
+        memset(buf, 0, n);
+        return 0;
+    }
+
+    memset(buf, 0, lo - pos);
+    memset(buf + (hi - pos), 0, end - hi);
+
+    if (p->opt.read(p->opt.old_addr + (uint32_t)lo, buf + (lo - pos), hi - lo) != 0) {
+        return flash_patch_fail(p, EIO);
+    }
+
+    return 0;
+}
+
+/* the decoded patch, records in any pieces */
+static int32_t flash_patch_write(void *ctx, const void *data, size_t len)
+{
+    al_flash_patch_t *p = (al_flash_patch_t *)ctx;
+    const uint8_t *src = (const uint8_t *)data;
+    uint8_t *buf = (uint8_t *)p->opt.buf;
+    size_t n;
+
+    while (len > 0) {
+        if (p->hlen < sizeof(p->hdr)) {
+            n = min_t(size_t, sizeof(p->hdr) - p->hlen, len);
+            memcpy((uint8_t *)&p->hdr + p->hlen, src, n);
+            p->hlen += n;
+
+            if ((p->hlen == sizeof(p->hdr)) && (flash_patch_header(p) != 0)) {
+                return -1;
+            }
+        } else if (p->clen < AL_FLASH_PATCH_CTRL_SIZE) {
+            /* nothing may follow the last record */
+            if (p->new_pos == al_be32_to_cpu(p->hdr.ph_new_size)) {
+                AL_ERROR(1, "Has corrupted patch!");
+                return flash_patch_fail(p, EINVAL);
+            }
+
+            n = min_t(size_t, AL_FLASH_PATCH_CTRL_SIZE - p->clen, len);
+            memcpy(p->ctrl + p->clen, src, n);
+            p->clen += n;
+
+            if ((p->clen == AL_FLASH_PATCH_CTRL_SIZE) && (flash_patch_ctrl(p) != 0)) {
+                return -1;
+            }
+        } else if (p->diff > 0) {
+            n = min_t(uint64_t, p->diff, min_t(size_t, len, p->opt.bufsz - p->blen));
+
+            if (flash_patch_read_old(p, buf + p->blen, n) != 0) {
+                return -1;
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                buf[p->blen + i] += src[i];
+            }
+
+            p->diff -= n;
+            p->old_pos += n;
+            p->new_pos += n;
+            p->blen += n;
+        } else {
+            n = min_t(uint64_t, p->extra, min_t(size_t, len, p->opt.bufsz - p->blen));
+            memcpy(buf + p->blen, src, n);
+
+            p->extra -= n;
+            p->new_pos += n;
+            p->blen += n;
+        }
+
+        /* the record is done once its bytes are out */
+        if ((p->clen == AL_FLASH_PATCH_CTRL_SIZE) && (p->diff == 0) && (p->extra == 0)) {
+            p->old_pos += p->seek;
+            p->clen = 0;
+        }
+
+        if ((p->blen == p->opt.bufsz) && (flash_patch_flush(p) != 0)) {
+            return -1;
+        }
+
+        src += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+int32_t al_flash_patch_init(al_flash_patch_t *p, const al_flash_patch_opt_t *opt)
+{
+    AL_CHECK_RET((p != NULL) && (opt != NULL), EINVAL, -1);
+    AL_CHECK_RET((opt->read != NULL) && (opt->write != NULL), EINVAL, -1);
+    AL_CHECK_RET((opt->buf != NULL) && (opt->bufsz > 0), EINVAL, -1);
+
+    memset(p, 0, sizeof(*p));
+    memcpy(&p->opt, opt, sizeof(p->opt));
+
+    if (al_lzma_stream_init(&p->lz, opt->mem, opt->memsz, flash_patch_write, p) != 0) {
+        return -1;
+    }
+
+    return al_flash_verify_init(&p->verify);
+}
+
+int32_t al_flash_patch_feed(al_flash_patch_t *p, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    size_t n;
+
+    AL_CHECK_RET((p != NULL) && ((data != NULL) || (len == 0)), EINVAL, -1);
+
+    if (p->err != 0) {
+        return flash_patch_fail(p, p->err);
+    }
+
+    /* the patch header is not compressed, it goes in front of the stream */
+    if (p->hlen < sizeof(p->hdr)) {
+        n = min_t(size_t, sizeof(p->hdr) - p->hlen, len);
+
+        if (flash_patch_write(p, src, n) != 0) {
+            return -1;
+        }
+
+        src += n;
+        len -= n;
+    }
+
+    /* the decoder reports EIO for whatever the records failed on */
+    if ((al_lzma_stream_feed(&p->lz, src, len) != 0) && (p->err == 0)) {
+        return flash_patch_fail(p, errno);
+    }
+
+    if (p->err != 0) {
+        return flash_patch_fail(p, p->err);
+    }
+
+    return 0;
+}
+
+int32_t al_flash_patch_final(al_flash_patch_t *p, al_flash_header_t *hdr)
+{
+    AL_CHECK_RET(p != NULL, EINVAL, -1);
+
+    if (p->err != 0) {
+        return flash_patch_fail(p, p->err);
+    }
+
+    if ((p->hlen < sizeof(p->hdr)) || (al_lzma_stream_end(&p->lz) != 0) ||
+        (p->clen != 0) || (p->new_pos != al_be32_to_cpu(p->hdr.ph_new_size))) {
+        AL_ERROR(1, "Has corrupted size!");
+        return flash_patch_fail(p, EINVAL);
+    }
+
+    if (flash_patch_flush(p) != 0) {
+        return -1;
+    }
+
+    if (al_flash_verify_final(&p->verify, hdr) != 0) {
+        return flash_patch_fail(p, EPERM);
+    }
+
+    return 0;
+}
+
+__END_DECLS
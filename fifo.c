@@ -4,6 +4,18 @@
 
 __BEGIN_DECLS
 
+/*
+ * The writer publishes in with a release store after the copy, the reader
+ * loads it with acquire before the copy, and the other way round for out.
+ */
+#if defined(__GNUC__)
+#define fifo_load_acquire(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define fifo_store_release(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define fifo_load_acquire(p)		(*(volatile uintptr_t *)(p))
+#define fifo_store_release(p, v)	(*(volatile uintptr_t *)(p) = (v))
+#endif
+
 /**
  * @brief Put data to fifo
  *
@@ -19,7 +31,7 @@ static size_t __fifo_put(al_fifo_t *fifo, const uint8_t *data, size_t len)
 {
 	size_t l;
 
-	len = min(len, fifo->size - fifo->in + fifo->out);
+	len = min(len, fifo->size - fifo->in + fifo_load_acquire(&fifo->out));
 
 	/* first put the data starting from fifo->in to buffer end */
 	l = min(len, fifo->size - (fifo->in & (fifo->size - 1)));
@@ -28,7 +40,7 @@ static size_t __fifo_put(al_fifo_t *fifo, const uint8_t *data, size_t len)
 	/* then put the rest (if any) at the beginning of the buffer */
 	memcpy(fifo->buf, data + l, len - l);
 
-	fifo->in += len;
+	fifo_store_release(&fifo->in, fifo->in + len);
 
 	return len;
 }
@@ -48,7 +60,7 @@ static size_t __fifo_get(al_fifo_t *fifo, uint8_t *data, size_t len)
 {
 	size_t l;
 
-	len = min(len, fifo->in - fifo->out);
+	len = min(len, fifo_load_acquire(&fifo->in) - fifo->out);
 
 	/* first get the data from fifo->out until the end of the buffer */
 	l = min(len, fifo->size - (fifo->out & (fifo->size - 1)));
@@ -57,7 +69,7 @@ static size_t __fifo_get(al_fifo_t *fifo, uint8_t *data, size_t len)
 	/* then get the rest (if any) from the beginning of the buffer */
 	memcpy(data + l, fifo->buf, len - l);
 
-	fifo->out += len;
+	fifo_store_release(&fifo->out, fifo->out + len);
 
 	return len;
 }
@@ -95,14 +107,65 @@ size_t al_fifo_get(al_fifo_t *fifo, uint8_t *data, size_t len)
 {
 	size_t ret;
 
+	/*
+	 * The indexes are left running when the fifo drains, rewinding them
+	 * here would race with a writer putting data at the same time.
+	 */
 	ret = __fifo_get(fifo, data, len);
-	if(fifo->in == fifo->out){
-		fifo->in = fifo->out = 0;
-	}
 
 	return ret;
 }
 
+/*
+ * Describe len bytes of the ring starting at index pos with up to two spans
+ */
+static size_t __fifo_span(al_fifo_t *fifo, al_fifo_span_t span[2],
+						  uintptr_t pos, size_t len)
+{
+	size_t off = pos & (fifo->size - 1);
+	size_t l = min(len, fifo->size - off);
+
+	span[0].buf = fifo->buf + off;
+	span[0].len = l;
+
+	span[1].buf = fifo->buf;
+	span[1].len = len - l;
+
+	return len;
+}
+
+size_t al_fifo_peek_linear(al_fifo_t *fifo, al_fifo_span_t span[2])
+{
+	size_t len = fifo_load_acquire(&fifo->in) - fifo->out;
+
+	return __fifo_span(fifo, span, fifo->out, len);
+}
+
+size_t al_fifo_consume(al_fifo_t *fifo, size_t len)
+{
+	len = min(len, (size_t)(fifo_load_acquire(&fifo->in) - fifo->out));
+
+	fifo_store_release(&fifo->out, fifo->out + len);
+
+	return len;
+}
+
+size_t al_fifo_reserve(al_fifo_t *fifo, al_fifo_span_t span[2], size_t len)
+{
+	len = min(len, fifo->size - fifo->in + fifo_load_acquire(&fifo->out));
+
+	return __fifo_span(fifo, span, fifo->in, len);
+}
+
+size_t al_fifo_commit(al_fifo_t *fifo, size_t len)
+{
+	len = min(len, fifo->size - fifo->in + fifo_load_acquire(&fifo->out));
+
+	fifo_store_release(&fifo->in, fifo->in + len);
+
+	return len;
+}
+
 void al_fifo_init(al_fifo_t *fifo, uint8_t *buf, size_t size)
 {
     BUG_ON(!is_power_of_2(size));
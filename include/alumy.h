@@ -42,13 +42,17 @@
 #include "alumy/version.h"
 #include "alumy/errno.h"
 #include "alumy/log.h"
+#include "alumy/log_ring.h"
 #include "alumy/list.h"
 #include "alumy/rbtree.h"
+#include "alumy/timer_wheel.h"
 #include "alumy/pool.h"
+#include "alumy/slab.h"
 #include "alumy/bcd.h"
 #include "alumy/filter.h"
 #include "alumy/driver.h"
 #include "alumy/mem.h"
+#include "alumy/mem_stat.h"
 #include "alumy/string.h"
 #include "alumy/ascii.h"
 #include "alumy/base64.h"
@@ -40,6 +40,38 @@ extern "C" {
 #define AL_LOG_CRYPTO		0
 #endif
 
+#ifndef AL_LOG_DEFER
+#define AL_LOG_DEFER			0		/* AL_DEBUG() and friends emit deferred format records */
+#endif
+
+#ifndef AL_LOG_TS_USEC
+#define AL_LOG_TS_USEC			1		/* log timestamps in microseconds, from al_tick_get_ns() */
+#endif
+
+#ifndef AL_LOG_RING_SHARDS
+#if defined(__linux__)
+#define AL_LOG_RING_SHARDS		4		/* rings of the async log, more than 1 needs thread locals */
+#else
+#define AL_LOG_RING_SHARDS		1
+#endif
+#endif
+
+#ifndef AL_LOG_RING_LINE_MAX
+#define AL_LOG_RING_LINE_MAX	256		/* longest message of the async log, longer ones are cut */
+#endif
+
+#ifndef AL_LOG_RING_BATCH
+#define AL_LOG_RING_BATCH		1024	/* bytes handed to the output at once by the log drain task */
+#endif
+
+#ifndef AL_LOG_BIN_BUF
+#if defined(__linux__)
+#define AL_LOG_BIN_BUF			1024	/* stack buffer of al_log_bin(), hexdump lines written at once */
+#else
+#define AL_LOG_BIN_BUF			256
+#endif
+#endif
+
 #ifndef AL_PROVIDE_ERRNO
 #define AL_PROVIDE_ERRNO	0
 #endif
@@ -68,6 +100,22 @@ extern "C" {
 #define AL_DYNAMIC_CRC_TABLE    0
 #endif
 
+#ifndef AL_CRC32_SLICE
+#if defined(__linux__)
+#define AL_CRC32_SLICE			16		/* CRC32 slicing tables, 1, 8 or 16 */
+#else
+#define AL_CRC32_SLICE			8
+#endif
+#endif
+
+#ifndef AL_CRC_SLICE
+#if defined(__linux__)
+#define AL_CRC_SLICE			8		/* tables of the CRC engine models, 1, 4 or 8 */
+#else
+#define AL_CRC_SLICE			4
+#endif
+#endif
+
 #ifndef AL_CONFIG_HW_WATCHDOG
 #define AL_CONFIG_HW_WATCHDOG		1		/* Hardware watchdog */
 #endif
@@ -80,6 +128,18 @@ extern "C" {
 #define AL_WATCHDOG_RESET()			al_watchdog_reset()
 #endif
 
+#ifndef AL_OS_HEAP_SIZE
+#define AL_OS_HEAP_SIZE			0		/* Heap budget of al_os_malloc(), 0 to only report */
+#endif
+
+#ifndef AL_SLAB_MAGAZINE
+#if defined(__linux__)
+#define AL_SLAB_MAGAZINE		8		/* Blocks per thread and slab class, 0 disables */
+#else
+#define AL_SLAB_MAGAZINE		0
+#endif
+#endif
+
 #ifndef AL_LIGHT_UPDATE_FREQ_HZ
 #define AL_LIGHT_UPDATE_FREQ_HZ	10 // How often al_light_routine() is called
 #endif
@@ -84,6 +84,10 @@
 #ifndef _BASE64_H_
 #define _BASE64_H_
 
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -94,6 +98,135 @@ int Base64encode(char * coded_dst, const char *plain_src,int len_plain_src);
 int Base64decode_len(const char * coded_src);
 int Base64decode(char * plain_dst, const char *coded_src);
 
+/* base64/codec.c */
+
+/**
+ * @brief base64 kernels, every one gives the same result
+ */
+typedef enum al_base64_impl {
+    AL_BASE64_IMPL_AUTO = 0,    /**< Fastest one this cpu supports */
+    AL_BASE64_IMPL_SCALAR,      /**< Portable C */
+    AL_BASE64_IMPL_SSSE3,       /**< x86 SSSE3, 12 bytes per step */
+    AL_BASE64_IMPL_AVX2,        /**< x86 AVX2, 24 bytes per step */
+    AL_BASE64_IMPL_NEON,        /**< AArch64 NEON, 48 bytes per step */
+} al_base64_impl_t;
+
+/**
+ * @brief Streaming base64 encoder
+ */
+typedef struct al_base64_enc {
+    uint8_t tail[2];            /**< Bytes waiting for a full group of 3 */
+    uint8_t ntail;              /**< Number of bytes in tail */
+} al_base64_enc_t;
+
+/**
+ * @brief Select the base64 kernel
+ *
+ * The fastest one is picked on first use anyway, this is meant for
+ * benchmarks and tests.
+ *
+ * @param impl The kernel
+ *
+ * @return int32_t Return 0 on success, -1 with errno set to ENOTSUP if
+ *         the kernel is not built in or the cpu lacks it
+ */
+int32_t al_base64_set_impl(al_base64_impl_t impl);
+
+/**
+ * @brief Get the base64 kernel in use
+ *
+ * @return al_base64_impl_t The kernel, never AL_BASE64_IMPL_AUTO
+ */
+al_base64_impl_t al_base64_get_impl(void);
+
+/**
+ * @brief Get the encoded length, padding included, NUL excluded
+ *
+ * @param len Length of the plain data
+ *
+ * @return size_t Number of base64 characters
+ */
+size_t al_base64_encode_len(size_t len);
+
+/**
+ * @brief Get the decoded length from the encoded length and padding
+ *
+ * Only the last two characters are looked at, the data is not validated.
+ *
+ * @param src The base64 text, not NUL terminated
+ * @param len Length of src
+ *
+ * @return size_t Number of plain bytes al_base64_decode() produces
+ */
+size_t al_base64_decode_len(const char *src, size_t len);
+
+/**
+ * @brief Encode data to base64, the result is not NUL terminated
+ *
+ * @param dst The output
+ * @param dstsz Size of dst, at least al_base64_encode_len(len)
+ * @param src The plain data
+ * @param len Length of src
+ *
+ * @return ssize_t Number of characters written, -1 with errno set on
+ *         failure
+ */
+ssize_t al_base64_encode(char *dst, size_t dstsz, const void *src, size_t len);
+
+/**
+ * @brief Decode base64 text
+ *
+ * The text may be padded or not, any character outside the alphabet
+ * fails the whole call.
+ *
+ * @param dst The output
+ * @param dstsz Size of dst, at least al_base64_decode_len(src, len)
+ * @param src The base64 text, not NUL terminated
+ * @param len Length of src
+ *
+ * @return ssize_t Number of bytes written, -1 with errno set to EINVAL on
+ *         malformed text or ENOBUFS if dst is too small
+ */
+ssize_t al_base64_decode(void *dst, size_t dstsz, const char *src, size_t len);
+
+/**
+ * @brief Start a streaming encode
+ *
+ * @param ctx The encoder
+ */
+void al_base64_enc_init(al_base64_enc_t *ctx);
+
+/**
+ * @brief Encode the next chunk of data
+ *
+ * Only whole groups of 3 bytes are encoded, up to 2 bytes are kept for
+ * the next call, so dst needs al_base64_encode_len(len + 2) characters at
+ * most.
+ *
+ * @param ctx The encoder
+ * @param dst The output
+ * @param dstsz Size of dst
+ * @param src The data
+ * @param len Length of src
+ *
+ * @return ssize_t Number of characters written, -1 with errno set to
+ *         ENOBUFS if dst is too small, nothing is consumed then
+ */
+ssize_t al_base64_enc_update(al_base64_enc_t *ctx, char *dst, size_t dstsz,
+                             const void *src, size_t len);
+
+/**
+ * @brief Finish a streaming encode, writes the padded last group
+ *
+ * @param ctx The encoder
+ * @param dst The output
+ * @param dstsz Size of dst, 4 is always enough
+ *
+ * @return ssize_t Number of characters written, 0 or 4, -1 with errno
+ *         set to ENOBUFS if dst is too small
+ */
+ssize_t al_base64_enc_final(al_base64_enc_t *ctx, char *dst, size_t dstsz);
+
 #ifdef __cplusplus
 }
 #endif
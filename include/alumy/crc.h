@@ -15,11 +15,44 @@
 #include "alumy/types.h"
 #include "alumy/base.h"
 #include "alumy/crc/crc8.h"
+#include "alumy/crc/engine.h"
 
 __BEGIN_DECLS
 
 /* crc/crc32.c */
 
+/**
+ * @brief CRC32 implementations, every one gives the same result
+ */
+typedef enum al_crc32_impl {
+	AL_CRC32_IMPL_AUTO = 0,     /**< Fastest one this cpu supports */
+	AL_CRC32_IMPL_TABLE,        /**< One table lookup per byte */
+	AL_CRC32_IMPL_SLICE8,       /**< Slicing-by-8, AL_CRC32_SLICE >= 8 */
+	AL_CRC32_IMPL_SLICE16,      /**< Slicing-by-16, AL_CRC32_SLICE >= 16 */
+	AL_CRC32_IMPL_PCLMUL,       /**< x86 carry-less multiply folding */
+	AL_CRC32_IMPL_ARMV8,        /**< ARMv8 CRC32 instructions */
+} al_crc32_impl_t;
+
+/**
+ * @brief Select the CRC32 implementation
+ *
+ * The fastest one is picked on the first call of al_crc32() anyway, this
+ * is meant for benchmarks and tests.
+ *
+ * @param impl The implementation
+ *
+ * @return int32_t Return 0 on success, -1 with errno set to ENOTSUP if
+ *         the implementation is not built in or the cpu lacks it
+ */
+int32_t al_crc32_set_impl(al_crc32_impl_t impl);
+
+/**
+ * @brief Get the CRC32 implementation in use
+ *
+ * @return al_crc32_impl_t The implementation, never AL_CRC32_IMPL_AUTO
+ */
+al_crc32_impl_t al_crc32_get_impl(void);
+
 /**
  * crc32 - Calculate the CRC32 for a block of data
  *
@@ -31,6 +64,21 @@ __BEGIN_DECLS
  */
 uint32_t al_crc32(uint32_t crc, const void *buf, uint32_t len);
 
+/**
+ * @brief Combine the CRC32 of two consecutive blocks
+ *
+ * Gives al_crc32(0, AB, len) from crc1 = al_crc32(0, A, ...) and
+ * crc2 = al_crc32(0, B, len2) without touching the data, so blocks can be
+ * checksummed in parallel. Costs O(log len2).
+ *
+ * @param crc1 CRC32 of the first block
+ * @param crc2 CRC32 of the second block
+ * @param len2 Length of the second block
+ *
+ * @return uint32_t CRC32 of both blocks
+ */
+uint32_t al_crc32_combine(uint32_t crc1, uint32_t crc2, size_t len2);
+
 /**
  * crc32_wd - Calculate the CRC32 for a block of data (watchdog version)
  *
@@ -76,8 +124,8 @@ void al_crc32_wd_buf(const uint8_t *input, uint32_t ilen,
 
 /* crc/mb_crc16.c */
 uint16_t mb_get_crc16(const void *data, size_t len);
-/* crc/mb_crc16.c */
 
+/* crc/crc16.c */
 uint16_t crc16_poly(uint16_t crc, uint16_t poly, const void *data, size_t len);
 
 __END_DECLS
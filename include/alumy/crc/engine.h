@@ -0,0 +1,118 @@
+/**
+ * @file    engine.h
+ * @author  alumy project
+ * @version v0.0.1
+ * @brief   Parameterised CRC engine
+ *
+ * One engine serves every CRC of 8, 16 or 32 bits, a CRC is described by
+ * an al_crc_model_t in the usual Rocksoft terms: width, poly, init,
+ * reflection and xorout. With slicing tables the engine consumes 4 or 8
+ * bytes per step, without them it falls back to the bitwise algorithm so
+ * a polynomial only known at runtime costs no table memory.
+ *
+ * The tables of the built-in models are const and generated by
+ * tools/crc_tables.py, al_crc_gen_table() builds them for other models.
+ *
+ * @copyright Copyright (c) 2026 alumy project
+ */
+
+#ifndef __AL_CRC_ENGINE_H
+#define __AL_CRC_ENGINE_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+
+__BEGIN_DECLS
+
+/** @brief Maximum number of slicing tables of a model */
+#define AL_CRC_SLICE_MAX		8
+
+/**
+ * @brief Description of one CRC algorithm
+ *
+ * The register passed to al_crc_update() is the raw register, already
+ * reflected for reflected models and before xorout.
+ */
+typedef struct al_crc_model {
+	uint8_t width;          /**< 8, 16 or 32 */
+	bool_t reflect;         /**< Input and output are reflected, lsb first */
+	uint32_t poly;          /**< Polynomial, normal msb first form */
+	uint32_t init;          /**< Initial register, normal form */
+	uint32_t xorout;        /**< Xored into the final register */
+	uint8_t slice;          /**< Rows of table, 1, 4 or 8 */
+	const void *table;      /**< slice x 256 entries of width bits, NULL for bitwise */
+	/** Optional faster update, used instead of the tables when set */
+	uint32_t (*update)(uint32_t crc, const void *data, size_t len);
+} al_crc_model_t;
+
+/** @brief CRC-8/MAXIM, 1-Wire, crc8_maxim() */
+extern const al_crc_model_t al_crc8_maxim_model;
+
+/** @brief CRC-16/MODBUS, mb_get_crc16() */
+extern const al_crc_model_t al_crc16_modbus_model;
+
+/** @brief CRC-16/XMODEM, the CRC of XMODEM and YMODEM */
+extern const al_crc_model_t al_crc16_xmodem_model;
+
+/** @brief CRC-32/ISO-HDLC, al_crc32() */
+extern const al_crc_model_t al_crc32_model;
+
+/**
+ * @brief Build the slicing tables of a model
+ *
+ * @param model The model, its table is ignored
+ * @param table slice x 256 entries of uint8_t, uint16_t or uint32_t as
+ *              the width requires
+ * @param slice Number of rows, 1 to AL_CRC_SLICE_MAX
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_crc_gen_table(const al_crc_model_t *model, void *table, int_t slice);
+
+/**
+ * @brief Get the initial register of a model
+ *
+ * @param model The model
+ *
+ * @return uint32_t The register to start al_crc_update() with
+ */
+uint32_t al_crc_init(const al_crc_model_t *model);
+
+/**
+ * @brief Feed data into a register
+ *
+ * @param model The model
+ * @param crc The register from al_crc_init() or a previous update
+ * @param data The data
+ * @param len Length of data in bytes
+ *
+ * @return uint32_t The new register
+ */
+uint32_t al_crc_update(const al_crc_model_t *model, uint32_t crc,
+					   const void *data, size_t len);
+
+/**
+ * @brief Turn a register into the CRC value
+ *
+ * @param model The model
+ * @param crc The register
+ *
+ * @return uint32_t The CRC
+ */
+uint32_t al_crc_final(const al_crc_model_t *model, uint32_t crc);
+
+/**
+ * @brief Calculate the CRC of one buffer
+ *
+ * @param model The model
+ * @param data The data
+ * @param len Length of data in bytes
+ *
+ * @return uint32_t The CRC
+ */
+uint32_t al_crc_calc(const al_crc_model_t *model, const void *data, size_t len);
+
+__END_DECLS
+
+#endif
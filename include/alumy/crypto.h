@@ -15,6 +15,9 @@
 #include "alumy/base.h"
 #include "alumy/byteorder.h"
 #include "alumy/crypto/md5.h"
+#include "alumy/crypto/hash.h"
+#include "alumy/crypto/aes.h"
+#include "alumy/crypto/aead.h"
 
 __BEGIN_DECLS
 
@@ -0,0 +1,162 @@
+/**
+ * @file    aead.h
+ * @author  alumy project
+ * @version v0.0.1
+ * @brief   Authenticated encryption, AES-GCM and ChaCha20-Poly1305
+ *
+ * Encryption and authentication run in one pass over the payload. A
+ * context is keyed once and then serves any number of messages, each one
+ * al_aead_starts(), al_aead_update() any number of times, al_aead_finish().
+ * al_aead_encrypt() and al_aead_decrypt() do a whole message in one call.
+ *
+ * Both ciphers are mbedtls. The context is preallocated by the caller,
+ * AES-GCM allocates its cipher context once in al_aead_setkey().
+ *
+ * @copyright Copyright (c) 2026 alumy project
+ */
+
+#ifndef __AL_CRYPTO_AEAD_H
+#define __AL_CRYPTO_AEAD_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+
+__BEGIN_DECLS
+
+/** @brief Full tag size in bytes */
+#define AL_AEAD_TAG_SIZE        16
+
+/** @brief Recommended nonce size in bytes, the only one of ChaCha20-Poly1305 */
+#define AL_AEAD_NONCE_SIZE      12
+
+typedef enum al_aead_type {
+    AL_AEAD_AES_GCM = 0,        /**< Key of 16, 24 or 32 bytes, tag of 4 to 16 */
+    AL_AEAD_CHACHAPOLY,         /**< Key of 32 bytes, tag of 16 */
+} al_aead_type_t;
+
+/**
+ * @brief AEAD context
+ */
+typedef struct al_aead_ctx {
+    uint8_t type;               /**< al_aead_type_t */
+    bool_t keyed;               /**< al_aead_setkey() succeeded */
+    bool_t enc;                 /**< Direction of the message in progress */
+    uint8_t priv[448] __aligned(16);    /**< mbedtls context */
+} al_aead_ctx_t;
+
+/**
+ * @brief Key a context
+ *
+ * @param ctx The context, al_aead_free() it before keying it again
+ * @param type The cipher
+ * @param key The key
+ * @param keylen Length of key in bytes
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_aead_setkey(al_aead_ctx_t *ctx, al_aead_type_t type,
+                       const void *key, size_t keylen);
+
+/**
+ * @brief Release a context and wipe its key
+ *
+ * @param ctx The context
+ */
+void al_aead_free(al_aead_ctx_t *ctx);
+
+/**
+ * @brief Start a message
+ *
+ * @param ctx The keyed context
+ * @param enc true to encrypt, false to decrypt
+ * @param nonce The nonce, never reused with the same key
+ * @param nonce_len Length of nonce, AL_AEAD_NONCE_SIZE for ChaCha20-Poly1305
+ * @param aad Additional data, authenticated but not encrypted
+ * @param aad_len Length of aad
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_aead_starts(al_aead_ctx_t *ctx, bool_t enc,
+                       const void *nonce, size_t nonce_len,
+                       const void *aad, size_t aad_len);
+
+/**
+ * @brief Encrypt or decrypt the next part of a message
+ *
+ * @param ctx The started context
+ * @param out The output, may be in
+ * @param outsz Size of out, at least len
+ * @param in The input
+ * @param len Length of the input
+ *
+ * @return ssize_t len on success, otherwise return -1 with errno set
+ */
+ssize_t al_aead_update(al_aead_ctx_t *ctx, void *out, size_t outsz,
+                       const void *in, size_t len);
+
+/**
+ * @brief Finish a message
+ *
+ * Encryption writes the tag, decryption checks it. Decrypted data must
+ * not be used before the tag is checked.
+ *
+ * @param ctx The started context
+ * @param tag The tag
+ * @param taglen Length of tag
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set,
+ *         EBADMSG when the tag does not match
+ */
+int32_t al_aead_finish(al_aead_ctx_t *ctx, void *tag, size_t taglen);
+
+/**
+ * @brief Encrypt and authenticate a whole message
+ *
+ * @param ctx The keyed context
+ * @param nonce The nonce
+ * @param nonce_len Length of nonce
+ * @param aad Additional data
+ * @param aad_len Length of aad
+ * @param out The cipher text, may be in
+ * @param outsz Size of out, at least len
+ * @param in The plain text
+ * @param len Length of the plain text
+ * @param tag The tag
+ * @param taglen Length of tag
+ *
+ * @return ssize_t len on success, otherwise return -1 with errno set
+ */
+ssize_t al_aead_encrypt(al_aead_ctx_t *ctx,
+                        const void *nonce, size_t nonce_len,
+                        const void *aad, size_t aad_len,
+                        void *out, size_t outsz, const void *in, size_t len,
+                        void *tag, size_t taglen);
+
+/**
+ * @brief Decrypt and verify a whole message
+ *
+ * @param ctx The keyed context
+ * @param nonce The nonce
+ * @param nonce_len Length of nonce
+ * @param aad Additional data
+ * @param aad_len Length of aad
+ * @param out The plain text, may be in, wiped when the tag does not match
+ * @param outsz Size of out, at least len
+ * @param in The cipher text
+ * @param len Length of the cipher text
+ * @param tag The tag
+ * @param taglen Length of tag
+ *
+ * @return ssize_t len on success, otherwise return -1 with errno set,
+ *         EBADMSG when the tag does not match
+ */
+ssize_t al_aead_decrypt(al_aead_ctx_t *ctx,
+                        const void *nonce, size_t nonce_len,
+                        const void *aad, size_t aad_len,
+                        void *out, size_t outsz, const void *in, size_t len,
+                        const void *tag, size_t taglen);
+
+__END_DECLS
+
+#endif
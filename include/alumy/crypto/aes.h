@@ -0,0 +1,160 @@
+/**
+ * @file    aes.h
+ * @author  alumy project
+ * @version v0.0.1
+ * @brief   Keyed AES context
+ *
+ * The key schedule is expanded once by al_aes_setkey() and reused by
+ * every message, the context is read only afterwards so one context may
+ * serve several threads. CBC pads in place, only the last block is copied,
+ * both CBC and CTR accept out == in.
+ *
+ * @copyright Copyright (c) 2026 alumy project
+ */
+
+#ifndef __AL_CRYPTO_AES_H
+#define __AL_CRYPTO_AES_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/thread/worker_pool.h"
+
+__BEGIN_DECLS
+
+/** @brief AES block size in bytes */
+#define AL_AES_BLOCK_SIZE       16
+
+/**
+ * @brief AES implementations, every one gives the same result
+ */
+typedef enum al_aes_impl {
+    AL_AES_IMPL_AUTO = 0,       /**< Fastest one this cpu supports */
+    AL_AES_IMPL_SOFT,           /**< mbedtls */
+    AL_AES_IMPL_AESNI,          /**< x86 AES-NI, CTR runs 8 blocks interleaved */
+} al_aes_impl_t;
+
+/**
+ * @brief Keyed AES context
+ *
+ * Holds the encryption and the decryption key schedule, the context must
+ * not be copied once keyed.
+ */
+typedef struct al_aes_ctx {
+    uint8_t impl;               /**< al_aes_impl_t, 0 when not keyed */
+    uint8_t nr;                 /**< Number of rounds, 10, 12 or 14 */
+    uint8_t priv[576] __aligned(16);    /**< Key schedules */
+} al_aes_ctx_t;
+
+/**
+ * @brief Select the implementation used by the following al_aes_setkey()
+ *
+ * @param impl The implementation
+ *
+ * @return int32_t Return 0 on success, -1 with errno set to ENOTSUP if
+ *         the implementation is not built in or the cpu lacks it
+ */
+int32_t al_aes_set_impl(al_aes_impl_t impl);
+
+/**
+ * @brief Get the implementation al_aes_setkey() selects
+ *
+ * @return al_aes_impl_t The implementation, never AL_AES_IMPL_AUTO
+ */
+al_aes_impl_t al_aes_get_impl(void);
+
+/**
+ * @brief Expand a key into a context
+ *
+ * @param ctx The context
+ * @param key The key
+ * @param keylen Length of key in bytes, 16, 24 or 32
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_aes_setkey(al_aes_ctx_t *ctx, const void *key, size_t keylen);
+
+/**
+ * @brief Wipe the key schedules of a context
+ *
+ * @param ctx The context
+ */
+void al_aes_free(al_aes_ctx_t *ctx);
+
+/**
+ * @brief AES CBC encryption with PKCS#7 padding
+ *
+ * @param ctx The keyed context
+ * @param out The cipher text, may be in
+ * @param outsz Size of out, at least len rounded up to the next block
+ * @param in The plain text
+ * @param len Length of the plain text
+ * @param iv 16 bytes of initialization vector
+ *
+ * @return ssize_t Length of the cipher text, otherwise return -1 with
+ *         errno set
+ */
+ssize_t al_aes_cbc_enc(const al_aes_ctx_t *ctx, void *out, size_t outsz,
+                       const void *in, size_t len, const void *iv);
+
+/**
+ * @brief AES CBC decryption
+ *
+ * @param ctx The keyed context
+ * @param out The plain text, may be in
+ * @param outsz Size of out, at least len
+ * @param in The cipher text
+ * @param len Length of the cipher text, a multiple of the block size
+ * @param iv 16 bytes of initialization vector
+ * @param check_pad Check and strip the PKCS#7 padding
+ *
+ * @return ssize_t Length of the plain text, otherwise return -1 with errno
+ *         set, EBADMSG for a bad padding
+ */
+ssize_t al_aes_cbc_dec(const al_aes_ctx_t *ctx, void *out, size_t outsz,
+                       const void *in, size_t len, const void *iv,
+                       bool_t check_pad);
+
+/**
+ * @brief AES CTR encryption and decryption
+ *
+ * The counter is the whole 16 bytes of iv, big endian.
+ *
+ * @param ctx The keyed context
+ * @param out The output, may be in
+ * @param outsz Size of out, at least len
+ * @param in The input
+ * @param len Length of the input
+ * @param iv 16 bytes of initial counter block
+ *
+ * @return ssize_t len on success, otherwise return -1 with errno set
+ */
+ssize_t al_aes_ctr(const al_aes_ctx_t *ctx, void *out, size_t outsz,
+                   const void *in, size_t len, const void *iv);
+
+/**
+ * @brief AES CTR over a large buffer, split across a worker pool
+ *
+ * Keystream blocks are independent, so every chunk starts at its own
+ * counter, iv plus its offset in blocks, and the result equals al_aes_ctr().
+ * Chunks the pool does not take are run by the caller.
+ *
+ * @param ctx The keyed context
+ * @param pool The worker pool
+ * @param out The output, may be in
+ * @param outsz Size of out, at least len
+ * @param in The input
+ * @param len Length of the input
+ * @param iv 16 bytes of initial counter block
+ * @param chunk Bytes per job, rounded down to whole blocks, 0 for 64KiB
+ *
+ * @return ssize_t len on success, otherwise return -1 with errno set
+ */
+ssize_t al_aes_ctr_parallel(const al_aes_ctx_t *ctx, al_worker_pool_t *pool,
+                            void *out, size_t outsz,
+                            const void *in, size_t len, const void *iv,
+                            size_t chunk);
+
+__END_DECLS
+
+#endif
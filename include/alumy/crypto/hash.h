@@ -0,0 +1,94 @@
+/**
+ * @file    hash.h
+ * @author  alumy project
+ * @version v0.0.1
+ * @brief   Message digests behind one streaming interface
+ *
+ * MD5 is the built-in implementation of md5.h, SHA-256 is mbedtls. The
+ * context is sized for the largest digest so it can live on the stack or
+ * in a structure without knowing which digest it holds.
+ *
+ * @copyright Copyright (c) 2026 alumy project
+ */
+
+#ifndef __AL_CRYPTO_HASH_H
+#define __AL_CRYPTO_HASH_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/crypto/md5.h"
+
+__BEGIN_DECLS
+
+/** @brief Largest digest size in bytes */
+#define AL_HASH_MAX_SIZE		32
+
+typedef enum al_hash_type {
+	AL_HASH_MD5 = 0,	/**< 16 bytes */
+	AL_HASH_SHA256,		/**< 32 bytes */
+} al_hash_type_t;
+
+typedef struct al_hash_ctx {
+	al_hash_type_t type;
+	union {
+		al_md5_ctx_t md5;
+		uint64_t priv[16];	/**< mbedtls_sha256_context */
+	};
+} al_hash_ctx_t;
+
+/**
+ * @brief Get the digest size of a hash
+ *
+ * @param type The hash
+ *
+ * @return size_t The digest size in bytes, 0 for an unknown hash
+ */
+size_t al_hash_size(al_hash_type_t type);
+
+/**
+ * @brief Start a new digest
+ *
+ * @param ctx The context
+ * @param type The hash
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_hash_init(al_hash_ctx_t *ctx, al_hash_type_t type);
+
+/**
+ * @brief Feed data into a digest, may be called any number of times
+ *
+ * @param ctx The context
+ * @param data The data
+ * @param len Length of data in bytes
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_hash_update(al_hash_ctx_t *ctx, const void *data, size_t len);
+
+/**
+ * @brief Finish a digest and release the context
+ *
+ * @param ctx The context
+ * @param digest al_hash_size() bytes of digest
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_hash_final(al_hash_ctx_t *ctx, void *digest);
+
+/**
+ * @brief Calculate the digest of one buffer
+ *
+ * @param type The hash
+ * @param data The data
+ * @param len Length of data in bytes
+ * @param digest al_hash_size() bytes of digest
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_hash(al_hash_type_t type, const void *data, size_t len, void *digest);
+
+__END_DECLS
+
+#endif
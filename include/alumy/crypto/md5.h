@@ -13,7 +13,64 @@ typedef struct al_md5_ctx {
     uint8_t buffer[64];
 } al_md5_ctx_t;
 
+/**
+ * @brief Start a new MD5 digest
+ *
+ * @param ctx The context
+ */
+void al_md5_init(al_md5_ctx_t *ctx);
+
+/**
+ * @brief Feed data into a MD5 digest, may be called any number of times
+ *
+ * @param ctx The context
+ * @param input The data
+ * @param inputlen Length of data in bytes
+ */
+void al_md5_update(al_md5_ctx_t *ctx, const void *input, size_t inputlen);
+
+/**
+ * @brief Finish a MD5 digest
+ *
+ * @param ctx The context, al_md5_init() it again before reuse
+ * @param digest 16 bytes of digest
+ */
+void al_md5_final(al_md5_ctx_t *ctx, void *digest);
+
+/**
+ * @brief Calculate the MD5 digest of one buffer
+ *
+ * @param ctx The context
+ * @param output 16 bytes of digest
+ * @param input The data
+ * @param len Length of data in bytes
+ */
 void al_md5_sign(al_md5_ctx_t *ctx,
                  void *output, const void *input, size_t len);
 
+/**
+ * @brief Get the number of messages al_md5_mb() hashes side by side
+ *
+ * @return int_t 8 with AVX2, 4 with GCC vectors, otherwise 1
+ */
+int_t al_md5_mb_lanes(void);
+
+/**
+ * @brief Calculate the MD5 digests of independent messages in parallel
+ *
+ * The messages are hashed in groups of al_md5_mb_lanes(), one message per
+ * SIMD lane, which pays off for many short messages of similar length.
+ *
+ * @param data The messages
+ * @param len Length of each message in bytes
+ * @param digest 16 bytes of digest for each message
+ * @param n Number of messages
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_md5_mb(const void *const data[], const size_t len[],
+                  uint8_t digest[][16], int_t n);
+
+__END_DECLS
+
 #endif
@@ -6,6 +6,7 @@
 #include "alumy/base.h"
 #include "alumy/byteorder.h"
 #include "alumy/byteswap.h"
+#include "alumy/thread/worker_pool.h"
 
 __BEGIN_DECLS
 
@@ -45,7 +46,7 @@ static inline uintptr_t al_flash_get_data(const al_flash_header_t *hdr)
     return ((uintptr_t)hdr + al_flash_get_header_size());
 }
 
-static inline uint16_t al_flash_get_flash_size(const al_flash_header_t *hdr)
+static inline uint32_t al_flash_get_flash_size(const al_flash_header_t *hdr)
 {
     return (al_flash_get_size(hdr) + al_flash_get_header_size());
 }
@@ -71,6 +72,92 @@ int32_t al_flash_check_hcrc(const al_flash_header_t *hdr);
 int32_t al_flash_check_dcrc(const al_flash_header_t *hdr);
 int32_t al_flash_check(const void *ptr, size_t len);
 
+/**
+ * @brief Streaming verification of a flash image
+ *
+ * The image is fed in any pieces as it arrives from SPI flash, an lfs file
+ * or a YMODEM transfer, the header is checked as soon as it is complete
+ * and the data CRC runs along, so the image never needs to be mapped.
+ */
+typedef struct al_flash_verify_ctx {
+    al_flash_header_t hdr;      /**< Header collected from the stream */
+    uint32_t hlen;              /**< Header bytes received */
+    uint32_t dlen;              /**< Data bytes received */
+    uint32_t dcrc;              /**< CRC32 of the data received */
+    int32_t err;                /**< errno of the first failure, 0 if none */
+} al_flash_verify_ctx_t;
+
+/**
+ * @brief Start verifying an image
+ *
+ * @param ctx The context
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_flash_verify_init(al_flash_verify_ctx_t *ctx);
+
+/**
+ * @brief Feed the next bytes of the image
+ *
+ * Bytes past the size recorded in the header are ignored, so whole flash
+ * sectors may be fed.
+ *
+ * @param ctx The context
+ * @param data The bytes
+ * @param len Number of bytes
+ *
+ * @return int32_t Return 0 on success, -1 with errno set to EPERM once
+ *         the header turned out bad, the image can be dropped early then
+ */
+int32_t al_flash_verify_update(al_flash_verify_ctx_t *ctx,
+                               const void *data, size_t len);
+
+/**
+ * @brief Append data whose CRC was computed elsewhere
+ *
+ * Lets chunks of the data be checksummed in parallel or by DMA, crc is
+ * al_crc32(0, chunk, len) and chunks must be appended in image order
+ * after the header was fed with al_flash_verify_update().
+ *
+ * @param ctx The context
+ * @param crc CRC32 of the chunk
+ * @param len Length of the chunk
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_flash_verify_combine(al_flash_verify_ctx_t *ctx,
+                                uint32_t crc, size_t len);
+
+/**
+ * @brief Checksum data on a worker pool and append it
+ *
+ * The data is split into chunks of chunk bytes, their CRCs are computed
+ * by the pool and combined in order.
+ *
+ * @param ctx The context, the header must be complete
+ * @param pool The worker pool
+ * @param data The data following what was fed so far
+ * @param len Length of data
+ * @param chunk Chunk size, 0 for 64KiB
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_flash_verify_parallel(al_flash_verify_ctx_t *ctx,
+                                 al_worker_pool_t *pool,
+                                 const void *data, size_t len, size_t chunk);
+
+/**
+ * @brief Finish verifying an image
+ *
+ * @param ctx The context
+ * @param hdr The verified header is copied here, may be NULL
+ *
+ * @return int32_t Return 0 if the image is complete and intact, otherwise
+ *         return -1 with errno set to EPERM
+ */
+int32_t al_flash_verify_final(al_flash_verify_ctx_t *ctx,
+                              al_flash_header_t *hdr);
+
 __END_DECLS
 
 #endif
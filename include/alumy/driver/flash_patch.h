@@ -0,0 +1,118 @@
+#ifndef __AL_DRV_FLASH_PATCH_H
+#define __AL_DRV_FLASH_PATCH_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/driver/flash_header.h"
+#include "alumy/lzma.h"
+
+__BEGIN_DECLS
+
+/*
+ * A delta patch turns the image in the old partition into a new image,
+ * both starting with an al_flash_header_t. The patch is the header below,
+ * big endian like the flash header, followed by a .lzma stream of bsdiff
+ * records:
+ *
+ *   diff_len, extra_len, seek      three 64 bit little endian integers,
+ *                                  sign and magnitude
+ *   diff_len bytes                 added to the old bytes at the old offset
+ *   extra_len bytes                copied as they are
+ *
+ * after which the old offset moves by seek. An old byte outside the old
+ * image counts as 0. The records are those of bsdiff 4.3 with one stream
+ * instead of three, so one decoder covers the whole patch.
+ */
+#define AL_FLASH_PATCH_MAGIC    0x42534C5Aul
+
+typedef struct al_flash_patch_header {
+    uint32_t ph_magic;
+    uint32_t ph_old_dcrc;       /**< dcrc of the image the patch applies to */
+    uint32_t ph_old_size;       /**< Its size with the header */
+    uint32_t ph_new_size;       /**< Size of the new image with the header */
+} al_flash_patch_header_t;
+
+/** @brief Size of a bsdiff control record */
+#define AL_FLASH_PATCH_CTRL_SIZE    24
+
+typedef struct al_flash_patch_opt {
+    uint32_t old_addr;          /**< Start of the old partition */
+    uint32_t old_size;          /**< Size of the old partition */
+    int32_t (*read)(uint32_t addr, void *buf, size_t len);
+    al_lzma_write_t write;      /**< Takes the new image, al_ymodem_sink_t::write fits */
+    void *ctx;                  /**< The first argument of write */
+    void *mem;                  /**< Memory of the decoder, see AL_LZMA_MEM_SIZE() */
+    size_t memsz;
+    void *buf;                  /**< The new image is written in runs of bufsz */
+    size_t bufsz;               /**< A multiple of the program unit of the flash */
+} al_flash_patch_opt_t;
+
+/**
+ * @brief Streaming application of a delta patch
+ *
+ * The patch is fed in any pieces as it arrives. The old image is read
+ * back as the records ask for it and the new image goes out through buf,
+ * so the memory in use is the decoder and buf whatever the image size.
+ * The new image is checked with al_flash_verify_*() on the way, a bad
+ * header stops the patch before anything is written.
+ */
+typedef struct al_flash_patch {
+    al_flash_patch_opt_t opt;
+    al_lzma_stream_t lz;
+    al_flash_verify_ctx_t verify;           /**< Of the new image */
+    al_flash_patch_header_t hdr;
+    uint32_t hlen;                          /**< Header bytes received */
+    uint8_t ctrl[AL_FLASH_PATCH_CTRL_SIZE];
+    uint32_t clen;                          /**< Control bytes received */
+    uint64_t diff;                          /**< Diff bytes left of the record */
+    uint64_t extra;                         /**< Extra bytes left of the record */
+    int64_t seek;
+    int64_t old_pos;                        /**< Offset into the old image */
+    uint32_t old_size;                      /**< Size of the old image */
+    uint32_t new_pos;                       /**< Bytes of the new image made */
+    size_t blen;                            /**< Bytes in buf */
+    int32_t err;                            /**< errno of the first failure, 0 if none */
+} al_flash_patch_t;
+
+/**
+ * @brief Start applying a patch
+ *
+ * @param p The context
+ * @param opt The partitions and the memory, copied
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_flash_patch_init(al_flash_patch_t *p, const al_flash_patch_opt_t *opt);
+
+/**
+ * @brief Feed the next bytes of the patch
+ *
+ * @param p The context
+ * @param data The bytes
+ * @param len Number of bytes
+ *
+ * @return int32_t Return 0 on success, -1 with errno set to EPERM if the
+ *         patch is for another image or the new header is bad, EINVAL for
+ *         a corrupt patch, ENOMEM if the dictionary does not fit, EIO if
+ *         the flash failed. The patch keeps failing after that.
+ */
+int32_t al_flash_patch_feed(al_flash_patch_t *p, const void *data, size_t len);
+
+/**
+ * @brief Finish applying a patch
+ *
+ * Writes out the rest of buf and checks the new image against its header.
+ *
+ * @param p The context
+ * @param hdr The header of the new image is copied here, may be NULL
+ *
+ * @return int32_t Return 0 if the new image is complete and intact, -1
+ *         with errno set to EINVAL if the patch was cut short, EPERM if the
+ *         image is corrupt, or the error of the patch
+ */
+int32_t al_flash_patch_final(al_flash_patch_t *p, al_flash_header_t *hdr);
+
+__END_DECLS
+
+#endif
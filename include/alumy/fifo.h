@@ -34,6 +34,17 @@ typedef struct al_fifo{
 	uintptr_t out;
 } al_fifo_t;
 
+/**
+ * @brief A contiguous piece of the fifo buffer
+ *
+ * @param buf Start of the piece
+ * @param len Length of the piece, 0 if unused
+ */
+typedef struct al_fifo_span {
+	uint8_t *buf;
+	size_t len;
+} al_fifo_span_t;
+
 /**
  * @brief Initialize a fifo
  *
@@ -65,6 +76,51 @@ size_t al_fifo_get(al_fifo_t *fifo, uint8_t *data, size_t len);
  */
 size_t al_fifo_put(al_fifo_t *fifo, const uint8_t *data, size_t len);
 
+/**
+ * @brief Look at the data in fifo without copying it
+ *
+ * The data is described by span[0] up to the end of the buffer and by
+ * span[1] from the start of the buffer, span[1].len is 0 when the data
+ * does not wrap. Release the data with al_fifo_consume().
+ *
+ * @param fifo The fifo handle
+ * @param span Two spans to fill
+ * @return Number of bytes described by the spans
+ */
+size_t al_fifo_peek_linear(al_fifo_t *fifo, al_fifo_span_t span[2]);
+
+/**
+ * @brief Drop data from fifo after al_fifo_peek_linear()
+ *
+ * @param fifo The fifo handle
+ * @param len Number of bytes to drop
+ * @return Number of bytes actually dropped
+ */
+size_t al_fifo_consume(al_fifo_t *fifo, size_t len);
+
+/**
+ * @brief Reserve free space in fifo to fill in place
+ *
+ * The free space is described by up to two spans like
+ * al_fifo_peek_linear(). The data becomes visible to the reader after
+ * al_fifo_commit().
+ *
+ * @param fifo The fifo handle
+ * @param span Two spans to fill
+ * @param len Maximum number of bytes to reserve
+ * @return Number of bytes described by the spans
+ */
+size_t al_fifo_reserve(al_fifo_t *fifo, al_fifo_span_t span[2], size_t len);
+
+/**
+ * @brief Publish data written after al_fifo_reserve()
+ *
+ * @param fifo The fifo handle
+ * @param len Number of bytes written
+ * @return Number of bytes actually published
+ */
+size_t al_fifo_commit(al_fifo_t *fifo, size_t len);
+
 /**
  * @brief Get the current length of data in fifo
  *
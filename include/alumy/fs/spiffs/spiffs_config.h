@@ -30,25 +30,36 @@
 
 // compile time switches
 
+// spiffs passes compound literals with bare commas, which the argument
+// counting of AL_LOGD() can't take, so its messages stay formatted.
+#if AL_LOG_DEFER
+#define SPIFFS_AL_DEBUG(_f, ...)	do {								\
+	if (AL_LOG_FS)														\
+		al_log(AL_LOG_DEBUG, AL_LOG_LINE, AL_LOG_FMT(D, _f), ## __VA_ARGS__); \
+} while (0)
+#else
+#define SPIFFS_AL_DEBUG(_f, ...)	AL_DEBUG(AL_LOG_FS, _f, ## __VA_ARGS__)
+#endif
+
 // Set generic spiffs debug output call.
 #ifndef SPIFFS_DBG
-#define SPIFFS_DBG(_f, ...) 		AL_DEBUG(AL_LOG_FS, _f, ## __VA_ARGS__)
+#define SPIFFS_DBG(_f, ...) 		SPIFFS_AL_DEBUG(_f, ## __VA_ARGS__)
 #endif
 // Set spiffs debug output call for garbage collecting.
 #ifndef SPIFFS_GC_DBG
-#define SPIFFS_GC_DBG(_f, ...)		AL_DEBUG(AL_LOG_FS, _f, ## __VA_ARGS__)
+#define SPIFFS_GC_DBG(_f, ...)		SPIFFS_AL_DEBUG(_f, ## __VA_ARGS__)
 #endif
 // Set spiffs debug output call for caching.
 #ifndef SPIFFS_CACHE_DBG
-#define SPIFFS_CACHE_DBG(_f, ...) 	AL_DEBUG(AL_LOG_FS, _f, ## __VA_ARGS__)
+#define SPIFFS_CACHE_DBG(_f, ...) 	SPIFFS_AL_DEBUG(_f, ## __VA_ARGS__)
 #endif
 // Set spiffs debug output call for system consistency checks.
 #ifndef SPIFFS_CHECK_DBG
-#define SPIFFS_CHECK_DBG(_f, ...)	AL_DEBUG(AL_LOG_FS, _f, ## __VA_ARGS__)
+#define SPIFFS_CHECK_DBG(_f, ...)	SPIFFS_AL_DEBUG(_f, ## __VA_ARGS__)
 #endif
 // Set spiffs debug output call for all api invocations.
 #ifndef SPIFFS_API_DBG
-#define SPIFFS_API_DBG(_f, ...)		AL_DEBUG(AL_LOG_FS, _f, ## __VA_ARGS__)
+#define SPIFFS_API_DBG(_f, ...)		SPIFFS_AL_DEBUG(_f, ## __VA_ARGS__)
 #endif
 
 
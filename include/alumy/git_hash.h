@@ -0,0 +1,7 @@
+#ifndef __AL_GIT_HASH_H
+#define __AL_GIT_HASH_H 1
+
+#define AL_GIT_HASH	"4bfd099"
+
+#endif
+
@@ -31,9 +31,17 @@
  * and one writer is using the fifo and no kfifo_reset() will be called.
  * kfifo_reset_out() can be safely used, until it will be only called
  * in the reader thread.
- * For multiple writer and one reader there is only a need to lock the writer.
+ * For multiple writer and one reader there is only a need to lock the writer,
+ * or use the kfifo_in_mp() family which reserves space with a compare and
+ * swap instead.
  * And vice versa for only one writer and multiple reader there is only a need
  * to lock the reader.
+ *
+ * Note about memory ordering: the writer publishes ->in with a release store
+ * after the data is copied and the reader loads ->in with acquire before it
+ * copies out, the same holds for ->out in the other direction. So a single
+ * reader and a single writer on different cores, or an isr and a task on a
+ * core with a write buffer, always see the data before the index.
  */
 
 #include "alumy/config.h"
@@ -48,11 +56,26 @@
 struct __kfifo {
     unsigned int    in;
     unsigned int    out;
+    unsigned int    head;   /* reserved by the kfifo_in_mp() writers */
     unsigned int    mask;
     unsigned int    esize;
     void        *data;
 };
 
+/*
+ * acquire/release accessors of the fifo indexes
+ */
+#define __kfifo_load_acquire(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define __kfifo_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/*
+ * one record of a kfifo_in_batch() submission
+ */
+struct kfifo_rec_vec {
+    const void      *buf;
+    unsigned int    len;
+};
+
 #define __STRUCT_KFIFO_COMMON(datatype, recsize, ptrtype) \
     union { \
         struct __kfifo  kfifo; \
@@ -131,6 +154,7 @@ struct kfifo_rec_ptr_2 __STRUCT_KFIFO_PTR(unsigned char, 2, void);
     struct __kfifo *__kfifo = &__tmp->kfifo; \
     __kfifo->in = 0; \
     __kfifo->out = 0; \
+    __kfifo->head = 0; \
     __kfifo->mask = __is_kfifo_ptr(__tmp) ? 0 : ARRAY_SIZE(__tmp->buf) - 1;\
     __kfifo->esize = sizeof(*__tmp->buf); \
     __kfifo->data = __is_kfifo_ptr(__tmp) ?  NULL : __tmp->buf; \
@@ -151,6 +175,7 @@ struct kfifo_rec_ptr_2 __STRUCT_KFIFO_PTR(unsigned char, 2, void);
             { \
             .in = 0, \
             .out    = 0, \
+            .head   = 0, \
             .mask   = __is_kfifo_ptr(&(fifo)) ? \
                   0 : \
                   ARRAY_SIZE((fifo).buf) - 1, \
@@ -213,7 +238,7 @@ __kfifo_int_must_check_helper(int val)
 #define kfifo_reset(fifo) \
 (void)({ \
     typeof((fifo) + 1) __tmp = (fifo); \
-    __tmp->kfifo.in = __tmp->kfifo.out = 0; \
+    __tmp->kfifo.in = __tmp->kfifo.out = __tmp->kfifo.head = 0; \
 })
 
 /**
@@ -227,7 +252,8 @@ __kfifo_int_must_check_helper(int val)
 #define kfifo_reset_out(fifo)   \
 (void)({ \
     typeof((fifo) + 1) __tmp = (fifo); \
-    __tmp->kfifo.out = __tmp->kfifo.in; \
+    __kfifo_store_release(&__tmp->kfifo.out, \
+        __kfifo_load_acquire(&__tmp->kfifo.in)); \
 })
 
 /**
@@ -247,7 +273,7 @@ __kfifo_int_must_check_helper(int val)
 #define kfifo_is_empty(fifo) \
 ({ \
     typeof((fifo) + 1) __tmpq = (fifo); \
-    __tmpq->kfifo.in == __tmpq->kfifo.out; \
+    __kfifo_load_acquire(&__tmpq->kfifo.in) == __tmpq->kfifo.out; \
 })
 
 /**
@@ -257,7 +283,8 @@ __kfifo_int_must_check_helper(int val)
 #define kfifo_is_full(fifo) \
 ({ \
     typeof((fifo) + 1) __tmpq = (fifo); \
-    kfifo_len(__tmpq) > __tmpq->kfifo.mask; \
+    (__tmpq->kfifo.in - __kfifo_load_acquire(&__tmpq->kfifo.out)) > \
+        __tmpq->kfifo.mask; \
 })
 
 /**
@@ -288,7 +315,7 @@ __kfifo_uint_must_check_helper( \
     if (__recsize) \
         __kfifo_skip_r(__kfifo, __recsize); \
     else \
-        __kfifo->out += (count); \
+        __kfifo_store_release(&__kfifo->out, __kfifo->out + (count)); \
 } while(0)
 
 /**
@@ -399,7 +426,7 @@ __kfifo_int_must_check_helper( \
             (__tmp->buf) \
             )[__kfifo->in & __tmp->kfifo.mask] = \
                 *(typeof(__tmp->type))&__val; \
-            __kfifo->in++; \
+            __kfifo_store_release(&__kfifo->in, __kfifo->in + 1); \
         } \
     } \
     __ret; \
@@ -436,7 +463,7 @@ __kfifo_uint_must_check_helper( \
                 ((typeof(__tmp->type))__kfifo->data) : \
                 (__tmp->buf) \
                 )[__kfifo->out & __tmp->kfifo.mask]; \
-            __kfifo->out++; \
+            __kfifo_store_release(&__kfifo->out, __kfifo->out + 1); \
         } \
     } \
     __ret; \
@@ -613,6 +640,128 @@ __kfifo_uint_must_check_helper( \
 )
 
 
+/**
+ * kfifo_in_mp - put data into the fifo from one of many writers
+ * @fifo: address of the fifo to be used
+ * @buf: the data to be added
+ * @n: number of elements to be added
+ *
+ * This macro works like kfifo_in(), but any number of writers may call it
+ * concurrently without a lock. Space is reserved with a compare and swap and
+ * the writers publish their data in the order of reservation. For a record
+ * fifo the record is stored entirely or not at all.
+ *
+ * Note that a writer which is preempted between reservation and publication
+ * holds back the writers which reserved after it, so an isr must not share
+ * a multi writer fifo with a task running on the same core. A held back
+ * writer spins a while and then yields the cpu, which only lets writers of
+ * the same or a higher priority run, so tasks of different priorities on
+ * one core must not share a multi writer fifo either.
+ * Don't mix kfifo_in_mp() with the single writer functions on one fifo.
+ */
+#define kfifo_in_mp(fifo, buf, n) \
+({ \
+    typeof((fifo) + 1) __tmp = (fifo); \
+    typeof(__tmp->ptr_const) __buf = (buf); \
+    unsigned long __n = (n); \
+    const size_t __recsize = sizeof(*__tmp->rectype); \
+    struct __kfifo *__kfifo = &__tmp->kfifo; \
+    (__recsize) ?\
+    __kfifo_in_r_mp(__kfifo, __buf, __n, __recsize) : \
+    __kfifo_in_mp(__kfifo, __buf, __n); \
+})
+
+/**
+ * kfifo_in_batch - put many records into the fifo at once
+ * @fifo: address of the record fifo to be used
+ * @vec: array of struct kfifo_rec_vec describing the records
+ * @cnt: number of records
+ *
+ * This macro stores the records in order until one does not fit and makes
+ * them visible to the reader with a single index update. It returns the
+ * number of records stored. Only valid for record fifos.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_in_batch(fifo, vec, cnt) \
+({ \
+    typeof((fifo) + 1) __tmp = (fifo); \
+    const size_t __recsize = sizeof(*__tmp->rectype); \
+    struct __kfifo *__kfifo = &__tmp->kfifo; \
+    (__recsize) ? \
+    __kfifo_in_rv(__kfifo, (vec), (cnt), __recsize) : 0; \
+})
+
+/**
+ * kfifo_in_linear - gets a head of/offset to the free space
+ * @fifo: address of the fifo to be used
+ * @head: pointer to an unsigned int to store the value of head
+ * @n: max. number of elements to reserve
+ *
+ * This macro obtains the offset (head) to the free space in the fifo buffer
+ * and returns the number of elements which can be written there without
+ * wrapping. The caller fills (@fifo->data + @head) directly, e.g. by dma,
+ * and publishes the data with kfifo_in_commit(). Not valid for record fifos.
+ *
+ * Note that with only one concurrent reader and one concurrent
+ * writer, you don't need extra locking to use these macro.
+ */
+#define kfifo_in_linear(fifo, head, n) \
+__kfifo_uint_must_check_helper( \
+({ \
+    typeof((fifo) + 1) __tmp = (fifo); \
+    unsigned int *__head = (head); \
+    unsigned long __n = (n); \
+    struct __kfifo *__kfifo = &__tmp->kfifo; \
+    __kfifo_in_linear(__kfifo, __head, __n); \
+}) \
+)
+
+/**
+ * kfifo_in_linear_ptr - gets a pointer to the free space
+ * @fifo: address of the fifo to be used
+ * @ptr: pointer to data to store the pointer to head
+ * @n: max. number of elements to reserve
+ *
+ * Similarly to kfifo_in_linear(), but returns a pointer to the free space.
+ */
+#define kfifo_in_linear_ptr(fifo, ptr, n) \
+__kfifo_uint_must_check_helper( \
+({ \
+    typeof((fifo) + 1) ___tmp = (fifo); \
+    unsigned int ___head; \
+    unsigned int ___n = kfifo_in_linear(___tmp, &___head, (n)); \
+    *(ptr) = ___tmp->kfifo.data + ___head * kfifo_esize(___tmp); \
+    ___n; \
+}) \
+)
+
+/**
+ * kfifo_in_commit - publish elements written after kfifo_in_linear()
+ * @fifo: address of the fifo to be used
+ * @n: number of elements written, at most the value kfifo_in_linear() gave
+ */
+#define kfifo_in_commit(fifo, n) \
+(void)({ \
+    typeof((fifo) + 1) __tmp = (fifo); \
+    __kfifo_in_commit(&__tmp->kfifo, (n)); \
+})
+
+/**
+ * kfifo_out_commit - release elements consumed after kfifo_out_linear()
+ * @fifo: address of the fifo to be used
+ * @n: number of elements consumed
+ *
+ * Not valid for record fifos, use kfifo_skip() there.
+ */
+#define kfifo_out_commit(fifo, n) \
+(void)({ \
+    typeof((fifo) + 1) __tmp = (fifo); \
+    __kfifo_out_commit(&__tmp->kfifo, (n)); \
+})
+
+
 extern int __kfifo_alloc(struct __kfifo *fifo, unsigned int size,
     size_t esize);
 
@@ -651,4 +800,20 @@ extern unsigned int __kfifo_out_linear_r(struct __kfifo *fifo,
 
 extern unsigned int __kfifo_max_r(unsigned int len, size_t recsize);
 
+extern unsigned int __kfifo_in_mp(struct __kfifo *fifo,
+    const void *buf, unsigned int len);
+
+extern unsigned int __kfifo_in_r_mp(struct __kfifo *fifo,
+    const void *buf, unsigned int len, size_t recsize);
+
+extern unsigned int __kfifo_in_rv(struct __kfifo *fifo,
+    const struct kfifo_rec_vec *vec, unsigned int cnt, size_t recsize);
+
+extern unsigned int __kfifo_in_linear(struct __kfifo *fifo,
+    unsigned int *head, unsigned int n);
+
+extern void __kfifo_in_commit(struct __kfifo *fifo, unsigned int n);
+
+extern void __kfifo_out_commit(struct __kfifo *fifo, unsigned int n);
+
 #endif
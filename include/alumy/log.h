@@ -7,6 +7,7 @@
 #include "alumy/types.h"
 #include "alumy/base.h"
 #include "alumy/format_color.h"
+#include "alumy/log_defer.h"
 
 __BEGIN_DECLS
 
@@ -45,44 +46,52 @@ __BEGIN_DECLS
 #define AL_LOG_FMT(letter, fmt)     \
     AL_LOG_COLOR_ ## letter fmt AL_PRI_RESET_COLOR "\r\n"
 
+#if AL_LOG_DEFER
+#define __AL_LOG(pri, letter, fmt, ...)     \
+    AL_LOGD(pri, fmt, ##__VA_ARGS__)
+#else
+#define __AL_LOG(pri, letter, fmt, ...)     \
+    al_log(pri, AL_LOG_LINE, AL_LOG_FMT(letter, fmt), ##__VA_ARGS__)
+#endif
+
 #define AL_DEBUG(type, fmt, ...)    do {                                    \
     if ((type))                                                               \
-        al_log(AL_LOG_DEBUG, AL_LOG_LINE, AL_LOG_FMT(D, fmt), ##__VA_ARGS__); \
+        __AL_LOG(AL_LOG_DEBUG, D, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_INFO(type, fmt, ...)	do {								\
 	if ((type))														\
-		al_log(AL_LOG_INFO, AL_LOG_LINE, AL_LOG_FMT(I, fmt), ##__VA_ARGS__); \
+		__AL_LOG(AL_LOG_INFO, I, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_NOTICE(type, fmt, ...)	do {							\
 	if ((type))														\
-		al_log(AL_LOG_NOTICE, AL_LOG_LINE, AL_LOG_FMT(N, fmt), ##__VA_ARGS__); \
+		__AL_LOG(AL_LOG_NOTICE, N, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_WARN(type, fmt, ...)	do {								\
 	if ((type))														\
-		al_log(AL_LOG_WARN, AL_LOG_LINE, AL_LOG_FMT(W, fmt), ##__VA_ARGS__); \
+		__AL_LOG(AL_LOG_WARN, W, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_ERROR(type, fmt, ...)	do {							\
 	if ((type))														\
-		al_log(AL_LOG_ERR, AL_LOG_LINE, AL_LOG_FMT(E, fmt), ##__VA_ARGS__); \
+		__AL_LOG(AL_LOG_ERR, E, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_CRIT(type, fmt, ...)	do {								\
 	if ((type))														\
-		al_log(AL_LOG_CRIT, AL_LOG_LINE, AL_LOG_FMT(C, fmt), ##__VA_ARGS__); \
+		__AL_LOG(AL_LOG_CRIT, C, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_ALERT(type, fmt, ...)	do {							\
 	if ((type))														\
-		al_log(AL_LOG_ALERT, AL_LOG_LINE, AL_LOG_FMT(A, fmt), ##__VA_ARGS__); \
+		__AL_LOG(AL_LOG_ALERT, A, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_EMERG(type, fmt, ...)	do {							\
 	if ((type))														\
-		al_log(AL_LOG_EMERG, AL_LOG_LINE, AL_LOG_FMT(A, fmt), ##__VA_ARGS__); \
+		__AL_LOG(AL_LOG_EMERG, A, fmt, ##__VA_ARGS__); \
 } while (0)
 
 #define AL_BIN_D(type, data, len)   do {                        \
@@ -141,15 +150,65 @@ __BEGIN_DECLS
 
 const char *al_log_timestamp(void);
 
+/** @brief Longest timestamp of al_log_stamp(), with the terminator */
+#define AL_LOG_STAMP_MAX    24
+
+/**
+ * @brief Format the timestamp of a message, "[    1.234567] "
+ *
+ * Taken from al_tick_get_ns() in one read, in microseconds with
+ * AL_LOG_TS_USEC and in milliseconds otherwise.
+ *
+ * @param buf The buffer, AL_LOG_STAMP_MAX bytes are enough
+ * @param bufsz Size of buf in bytes
+ *
+ * @return size_t Length of the timestamp
+ */
+size_t al_log_stamp(char *buf, size_t bufsz);
+
 void al_vlog(int32_t pri, const char *fmt, va_list ap);
 
 void al_log(int32_t pri, const char *file, int32_t line, const char *func,
 			const char *fmt, ...);
 
+/**
+ * @brief Write formatted log text as it is
+ *
+ * Weak, queues the text to the log ring when it runs and writes it
+ * through al_putc() otherwise.
+ *
+ * @param buf The text, complete lines
+ * @param len Length of buf in bytes
+ */
+void al_log_write(const void *buf, size_t len);
+
+/**
+ * @brief Hexdump a buffer, 16 bytes per line
+ *
+ * The mask is checked and the time stamped once per dump, the lines are
+ * formatted into a buffer of AL_LOG_BIN_BUF bytes and handed to
+ * al_log_write() a buffer at a time.
+ *
+ * @param pri The priority
+ * @param file
+ * @param line
+ * @param func
+ * @param data The buffer
+ * @param len Length of data in bytes
+ */
 void al_log_bin(int32_t pri,
 				const char *file, int32_t line, const char *func,
 				const void *data, size_t len);
 
+/**
+ * @brief Limit al_log_bin() for high rate tracing
+ *
+ * @param max Bytes dumped of a buffer, the rest is only counted in a
+ *            "... N more bytes" line, 0 for no limit
+ * @param every Dump one buffer in every, 0 or 1 to dump all
+ */
+void al_log_bin_set_limit(size_t max, uint32_t every);
+
 int32_t al_log_set_mask(int32_t mask);
 
 __END_DECLS
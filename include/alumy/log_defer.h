@@ -0,0 +1,150 @@
+/**
+ * @file log_defer.h
+ * @brief Deferred format log
+ *
+ * AL_LOGD() does not format on the target. The format string is placed in
+ * the .al_logd section, the record only carries its offset in that section,
+ * the tick and the raw arguments. The host extracts the section from the
+ * image at build time (al_logd_strtab() of cmake/log_defer.cmake) and
+ * tools/logd_decode.py turns the records back into text.
+ *
+ * The linker script provides __al_logd_start at the start of .al_logd. On
+ * a target the section is best an INFO section, the strings then cost no
+ * flash at all.
+ *
+ * A record is framed by its length and encoded as
+ *
+ *     varint  length of the rest
+ *     u8      priority | number of arguments << 3
+ *     varint  tick in ms
+ *     varint  offset of the format string
+ *     u8[]    argument types, a nibble per argument, low nibble first
+ *     ...     arguments, integers as zigzag varints, doubles as 8 bytes
+ *             little endian, strings as varint length and bytes
+ *
+ * With AL_LOG_DEFER the AL_DEBUG() family uses AL_LOGD(), so the format
+ * must be a string literal and take at most AL_LOGD_ARGS_MAX arguments.
+ * The argument types are classified with GNU builtins. Text written by
+ * al_log() and the drop notice of the log ring share the output, so the
+ * decoder expects an output that carries records only.
+ *
+ * @author Alumy Development Team
+ * @date 2026
+ */
+
+#ifndef __AL_LOG_DEFER_H
+#define __AL_LOG_DEFER_H 1
+
+#include <stdarg.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/bug.h"
+
+__BEGIN_DECLS
+
+/** @brief Section of the format strings */
+#define AL_LOGD_SECTION			".al_logd"
+
+/** @brief Most arguments of one record */
+#define AL_LOGD_ARGS_MAX		8
+
+/** @brief Longest record, with its length */
+#define AL_LOGD_REC_MAX			128
+
+/** @brief Longest string argument, longer ones are cut */
+#define AL_LOGD_STR_MAX			32
+
+/** @brief Argument types of a record */
+#define AL_LOGD_I32				1
+#define AL_LOGD_I64				2
+#define AL_LOGD_F64				3
+#define AL_LOGD_STR				4
+#define AL_LOGD_PTR				5
+
+extern const char __al_logd_start[];
+
+#define __al_logd_type(x)												\
+	((__builtin_types_compatible_p(typeof(x), char *) ||				\
+	  __builtin_types_compatible_p(typeof(x), const char *) ||			\
+	  __builtin_types_compatible_p(typeof(x), char []) ||				\
+	  __builtin_types_compatible_p(typeof(x), const char [])) ?			\
+	 AL_LOGD_STR :														\
+	 (__builtin_classify_type(x) == 8) ? AL_LOGD_F64 :					\
+	 (__builtin_classify_type(x) == 5) ? AL_LOGD_PTR :					\
+	 (sizeof(x) > 4) ? AL_LOGD_I64 : AL_LOGD_I32)
+
+#define __al_logd_nargs(...)											\
+	__al_logd_nargs_(, ##__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __al_logd_nargs_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, n, ...) n
+
+#define __al_logd_t0()			0
+#define __al_logd_t1(a)			__al_logd_type(a)
+#define __al_logd_t2(a, ...)	(__al_logd_type(a) | (__al_logd_t1(__VA_ARGS__) << 4))
+#define __al_logd_t3(a, ...)	(__al_logd_type(a) | (__al_logd_t2(__VA_ARGS__) << 4))
+#define __al_logd_t4(a, ...)	(__al_logd_type(a) | (__al_logd_t3(__VA_ARGS__) << 4))
+#define __al_logd_t5(a, ...)	(__al_logd_type(a) | (__al_logd_t4(__VA_ARGS__) << 4))
+#define __al_logd_t6(a, ...)	(__al_logd_type(a) | (__al_logd_t5(__VA_ARGS__) << 4))
+#define __al_logd_t7(a, ...)	(__al_logd_type(a) | (__al_logd_t6(__VA_ARGS__) << 4))
+#define __al_logd_t8(a, ...)	(__al_logd_type(a) | (__al_logd_t7(__VA_ARGS__) << 4))
+#define __al_logd_t9(...)		0
+
+#define __al_logd_cat(a, b)		__al_logd_cat_(a, b)
+#define __al_logd_cat_(a, b)	a ## b
+
+#define __al_logd_types(...)											\
+	((uint32_t)__al_logd_cat(__al_logd_t, __al_logd_nargs(__VA_ARGS__))(__VA_ARGS__))
+
+/**
+ * @brief Log a message as a deferred record
+ *
+ * @param pri The priority, AL_LOG_DEBUG and so on
+ * @param fmt The format, a string literal
+ */
+#define AL_LOGD(pri, fmt, ...)	do {									\
+	static const char __al_logd_fmt[] __section(AL_LOGD_SECTION) = fmt;	\
+																		\
+	BUILD_BUG_ON(__al_logd_nargs(__VA_ARGS__) > AL_LOGD_ARGS_MAX);		\
+	al_logd((pri), (uint32_t)(__al_logd_fmt - __al_logd_start),			\
+			__al_logd_types(__VA_ARGS__), ##__VA_ARGS__);				\
+} while (0)
+
+/**
+ * @brief Encode and emit one record, called by AL_LOGD()
+ *
+ * @param pri The priority
+ * @param id The offset of the format string in .al_logd
+ * @param types The argument types, a nibble per argument
+ */
+void al_logd(int32_t pri, uint32_t id, uint32_t types, ...);
+
+/**
+ * @brief Encode one record into a buffer
+ *
+ * @param buf The buffer, at most AL_LOGD_REC_MAX bytes
+ * @param bufsz Size of buf in bytes
+ * @param pri The priority
+ * @param tick The tick in ms
+ * @param id The offset of the format string in .al_logd
+ * @param types The argument types, a nibble per argument
+ * @param ap The arguments
+ *
+ * @return ssize_t The length of the record, -1 with errno set when it
+ *                 does not fit
+ */
+ssize_t al_logd_encode(void *buf, size_t bufsz, int32_t pri, uint32_t tick,
+					   uint32_t id, uint32_t types, va_list ap);
+
+/**
+ * @brief Output of the records
+ *
+ * Weak, hands the record to al_log_write().
+ *
+ * @param rec The record
+ * @param len Length of rec in bytes
+ */
+void al_logd_write(const void *rec, size_t len);
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file log_ring.h
+ * @brief Asynchronous ring backend of al_log
+ *
+ * Once started, al_vlog() no longer prints the message itself. The message
+ * is formatted into a record of a ring and a background task drains the
+ * rings in batches to the output, so a caller never waits for a slow UART
+ * or console. A ring is guarded by a mutex, don't log from an interrupt.
+ *
+ * There are AL_LOG_RING_SHARDS rings, a thread always writes to the same
+ * one so its own messages keep their order. The messages of different
+ * threads are interleaved at batch granularity. A message that finds its
+ * ring full is dropped and counted, the drain task reports the count.
+ *
+ * @author Alumy Development Team
+ * @date 2026
+ */
+
+#ifndef __AL_LOG_RING_H
+#define __AL_LOG_RING_H 1
+
+#include <stdarg.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+
+__BEGIN_DECLS
+
+/**
+ * @brief Output of the drain task
+ *
+ * @param buf A batch of complete messages
+ * @param len Length of buf in bytes
+ */
+typedef void (*al_log_ring_write_t)(const void *buf, size_t len);
+
+/**
+ * @brief Start the ring backend
+ *
+ * @param size The size of all rings in bytes, split over the shards
+ * @param write The output, NULL to write through al_putc()
+ * @param prio The priority of the drain task
+ * @param stack The stack size of the drain task in bytes
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_log_ring_init(uint32_t size, al_log_ring_write_t write,
+						 uint32_t prio, uint32_t stack);
+
+/**
+ * @brief Stop the ring backend
+ *
+ * The messages already queued are written before the drain task exits,
+ * al_vlog() prints synchronously again afterwards.
+ *
+ * @return int32_t Return 0 on success, otherwise return -1
+ */
+int32_t al_log_ring_deinit(void);
+
+/**
+ * @brief Queue one message
+ *
+ * Called by al_vlog(), the message gets the usual timestamp and is
+ * truncated to AL_LOG_RING_LINE_MAX bytes.
+ *
+ * @param pri The priority of the message
+ * @param fmt The format
+ * @param ap The arguments, untouched when the backend is not started
+ *
+ * @return int32_t Return 1 when queued, 0 when dropped, -1 when the
+ *                 backend is not started
+ */
+int32_t al_log_ring_vlog(int32_t pri, const char *fmt, va_list ap);
+
+/**
+ * @brief Queue one record as it is
+ *
+ * The record reaches the output unchanged and in one piece, used for the
+ * binary records of the deferred log and the hexdumps of al_log_bin().
+ *
+ * @param buf The record
+ * @param len Length of buf in bytes, at most AL_LOG_RING_BATCH
+ *
+ * @return int32_t Return 1 when queued, 0 when dropped, -1 when the
+ *                 backend is not started
+ */
+int32_t al_log_ring_write(const void *buf, size_t len);
+
+/**
+ * @brief Wait until every message queued before the call is written
+ *
+ * @param timeout Timeout in milliseconds, negative to wait forever
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_log_ring_flush(int_t timeout);
+
+/**
+ * @brief Get the number of messages dropped on a full ring
+ *
+ * @return uint32_t The count since al_log_ring_init()
+ */
+uint32_t al_log_ring_dropped(void);
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,192 @@
+/**
+ * @file lzma.h
+ * @brief Streaming LZMA decoder with bounded memory
+ *
+ * Decodes a .lzma stream, the 13 byte header of the 5 property bytes and
+ * the 64 bit little endian size followed by the LZMA data, as it arrives in
+ * chunks of any size. The probability model and the dictionary are carved
+ * out of one buffer of the caller, a static array or a block of an al_pool,
+ * nothing is allocated from the heap. The output is handed to the write
+ * callback straight from the dictionary, so no output buffer is needed,
+ * and its CRC32 is computed on the way.
+ *
+ * The write callback has the signature of al_ymodem_sink_t::write. The
+ * runs written are of any length, so a sink with a program unit, like the
+ * flash sink of ymodem_io.h with align > 1, needs them buffered to whole
+ * units as al_lzma_ymodem_sink() does.
+ *
+ * Not part of alumy.h, the LZMA SDK types come along with this header.
+ *
+ * @author Alumy Development Team
+ * @date 2026
+ */
+
+#ifndef __AL_LZMA_H
+#define __AL_LZMA_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/xyzmodem/ymodem.h"
+#include "alumy/lzma/LzmaDec.h"
+
+__BEGIN_DECLS
+
+/** @brief Size of the .lzma header */
+#define AL_LZMA_HEADER_SIZE		(LZMA_PROPS_SIZE + 8)
+
+/** @brief The header does not tell the size, the data ends with a mark */
+#define AL_LZMA_SIZE_UNKNOWN	UINT64_MAX
+
+/**
+ * @brief Memory a stream needs for a dictionary of up to 4 MB
+ *
+ * lc + lp is 3 for the default properties. The dictionary is rounded up
+ * to 4 KB by the decoder, the extra bytes cover the alignment.
+ */
+#define AL_LZMA_MEM_SIZE(dict, lclp)									\
+	(((1984 + (0x300 << (lclp))) * sizeof(CLzmaProb)) +					\
+	 (((size_t)(dict) + 4095) & ~(size_t)4095) + 2 * sizeof(void *))
+
+typedef int32_t (*al_lzma_write_t)(void *ctx, const void *data, size_t len);
+typedef ssize_t (*al_lzma_read_t)(void *ctx, void *buf, size_t len);
+
+typedef struct al_lzma_stream {
+	CLzmaDec dec;
+	ISzAlloc alloc;
+	uint8_t *mem;			/* the memory of the decoder */
+	size_t memsz;
+	size_t used;			/* bytes of mem handed out */
+	uint8_t hdr[AL_LZMA_HEADER_SIZE];
+	uint8_t hdr_len;		/* bytes of the header received */
+	uint64_t out_size;		/* from the header */
+	uint64_t out_len;		/* bytes written */
+	uint32_t crc;			/* CRC32 of the bytes written */
+	int32_t err;			/* errno of the first failure, sticky */
+	bool done;				/* the end of the stream was decoded */
+	al_lzma_write_t write;
+	void *ctx;
+} al_lzma_stream_t;
+
+/**
+ * @brief Initialize a stream
+ *
+ * @param s The stream
+ * @param mem The memory of the decoder, see AL_LZMA_MEM_SIZE()
+ * @param memsz Size of mem
+ * @param write Called with every run of bytes decoded, a failure stops
+ *        the stream with EIO
+ * @param ctx The first argument of write
+ *
+ * @return int32_t Return 0 on success, -1 with errno set on failure
+ */
+int32_t al_lzma_stream_init(al_lzma_stream_t *s, void *mem, size_t memsz,
+							al_lzma_write_t write, void *ctx);
+
+/**
+ * @brief Start the stream over, for the next file
+ *
+ * @param s The stream
+ */
+void al_lzma_stream_reset(al_lzma_stream_t *s);
+
+/**
+ * @brief Decode the next chunk of the stream
+ *
+ * Bytes after the end of the stream are ignored, so a stream read from a
+ * partition may carry the rest of the partition.
+ *
+ * @param s The stream
+ * @param data The chunk
+ * @param len Size of the chunk, any
+ *
+ * @return int32_t Return 0 on success, -1 with errno set to EINVAL for a
+ *         bad header or corrupt data, ENOMEM if the dictionary does not
+ *         fit the memory, EIO if write failed. The stream keeps failing
+ *         until it is reset.
+ */
+int32_t al_lzma_stream_feed(al_lzma_stream_t *s, const void *data, size_t len);
+
+/**
+ * @brief Check the stream ended where the input ended
+ *
+ * @param s The stream
+ *
+ * @return int32_t Return 0 if the whole stream was decoded, -1 with errno
+ *         set to EINVAL if it was cut short or the error of the stream
+ */
+int32_t al_lzma_stream_end(al_lzma_stream_t *s);
+
+/**
+ * @brief Decode a whole stream pulled from read
+ *
+ * @param s The stream, initialized or reset
+ * @param read Returns the bytes read, 0 at the end, -1 on failure
+ * @param ctx The first argument of read
+ * @param buf The buffer of the compressed chunks
+ * @param bufsz Size of buf
+ *
+ * @return int64_t Return the size of the output on success, -1 with errno
+ *         set on failure, EIO if read failed
+ */
+int64_t al_lzma_stream_decode(al_lzma_stream_t *s, al_lzma_read_t read,
+							  void *ctx, void *buf, size_t bufsz);
+
+/** @brief The size from the header, AL_LZMA_SIZE_UNKNOWN before it is read */
+static inline uint64_t al_lzma_stream_size(const al_lzma_stream_t *s)
+{
+	return s->out_size;
+}
+
+/** @brief Bytes written so far */
+static inline uint64_t al_lzma_stream_len(const al_lzma_stream_t *s)
+{
+	return s->out_len;
+}
+
+/** @brief CRC32 of the bytes written so far */
+static inline uint32_t al_lzma_stream_crc32(const al_lzma_stream_t *s)
+{
+	return s->crc;
+}
+
+/** @brief Longest file name the YMODEM sink keeps */
+#define AL_LZMA_NAME_MAX		64
+
+/*
+ * Decompresses the .lzma files received by YMODEM into another sink. The
+ * sink behind is opened with the name received and the size from the
+ * header, 0 when the header does not tell it. With a buffer it is written
+ * a full buffer at a time and the rest at the end of the file.
+ */
+typedef struct al_lzma_ymodem {
+	al_lzma_stream_t lz;
+	const al_ymodem_sink_t *out;
+	uint8_t *buf;			/* the output on its way to out, NULL for none */
+	size_t bufsz;
+	size_t blen;			/* bytes in buf */
+	char name[AL_LZMA_NAME_MAX];
+	bool open;				/* out was opened */
+} al_lzma_ymodem_t;
+
+/**
+ * @brief Make a YMODEM sink that decompresses into out
+ *
+ * @param sink The sink to give al_ymodem_set_sink()
+ * @param z The state of the sink
+ * @param out The sink of the output
+ * @param mem The memory of the decoder, see AL_LZMA_MEM_SIZE()
+ * @param memsz Size of mem
+ * @param buf The output buffer, a multiple of the program unit of out,
+ *        NULL to hand out the runs of the decoder as they come
+ * @param bufsz Size of buf
+ *
+ * @return int32_t Return 0 on success, -1 with errno set on failure
+ */
+int32_t al_lzma_ymodem_sink(al_ymodem_sink_t *sink, al_lzma_ymodem_t *z,
+							const al_ymodem_sink_t *out, void *mem, size_t memsz,
+							void *buf, size_t bufsz);
+
+__END_DECLS
+
+#endif
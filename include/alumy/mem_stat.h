@@ -0,0 +1,122 @@
+/**
+ * @file    mem_stat.h
+ * @author  alumy project
+ * @version v0.0.1
+ * @brief   Allocator statistics for the alumy library
+ *
+ * One statistics block shape is shared by the osal heaps, the slab
+ * allocator and call-site tags: allocation, free and failure counters,
+ * bytes in use with their high-water mark and a histogram of request
+ * sizes. All counters are updated atomically and may be read at runtime
+ * to size pools from real traces.
+ *
+ * @copyright Copyright (c) 2026 alumy project
+ */
+
+#ifndef __AL_MEM_STAT_H
+#define __AL_MEM_STAT_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+
+__BEGIN_DECLS
+
+/**
+ * @brief Number of histogram buckets, bucket i counts requests of up to
+ *        16 << i bytes, the last bucket counts everything larger
+ */
+#define AL_MEM_STAT_BUCKETS		16
+
+/**
+ * @brief Allocator statistics
+ */
+typedef struct al_mem_stat {
+	uint32_t nr_alloc;                  /*!< Successful allocations */
+	uint32_t nr_free;                   /*!< Released allocations */
+	uint32_t nr_fail;                   /*!< Failed allocations */
+	size_t cur;                         /*!< Bytes in use */
+	size_t peak;                        /*!< High-water mark of cur */
+	uint32_t hist[AL_MEM_STAT_BUCKETS]; /*!< Requests by size */
+} al_mem_stat_t;
+
+/**
+ * @brief Allocation statistics of one call site
+ */
+typedef struct al_mem_tag {
+	const char *name;                   /*!< Call site name */
+	al_mem_stat_t stat;                 /*!< Statistics of the call site */
+	struct al_mem_tag *next;            /*!< Next registered tag */
+	uint32_t linked;                    /*!< Registered in the tag list */
+} al_mem_tag_t;
+
+/**
+ * @brief Define a call-site tag
+ */
+#define AL_MEM_TAG_DEFINE(var, tag_name)	al_mem_tag_t var = { .name = (tag_name) }
+
+/**
+ * @brief Get the histogram bucket of a request size
+ *
+ * @param size The request size
+ *
+ * @return int_t The bucket index
+ */
+int_t al_mem_stat_bucket(size_t size);
+
+/**
+ * @brief Account an allocation
+ *
+ * @param stat The statistics
+ * @param size The requested size
+ * @param used The bytes taken from the allocator, 0 if it failed
+ */
+void al_mem_stat_alloc(al_mem_stat_t *stat, size_t size, size_t used);
+
+/**
+ * @brief Account a release
+ *
+ * @param stat The statistics
+ * @param used The bytes given back to the allocator
+ */
+void al_mem_stat_free(al_mem_stat_t *stat, size_t used);
+
+/**
+ * @brief Clear the statistics, the high-water mark restarts at cur
+ *
+ * @param stat The statistics
+ */
+void al_mem_stat_reset(al_mem_stat_t *stat);
+
+/**
+ * @brief Allocate memory accounted to a call site
+ *
+ * The tag registers itself in the tag list on first use. The memory is
+ * taken with al_heap_malloc() and must be released with al_mem_tag_free()
+ * on the same tag.
+ *
+ * @param tag The call-site tag
+ * @param size The size in bytes
+ *
+ * @return void* The memory, NULL on failure
+ */
+void *al_mem_tag_malloc(al_mem_tag_t *tag, size_t size);
+
+/**
+ * @brief Release memory from al_mem_tag_malloc()
+ *
+ * @param tag The call-site tag
+ * @param p The memory, may be NULL
+ */
+void al_mem_tag_free(al_mem_tag_t *tag, void *p);
+
+/**
+ * @brief Get the first registered tag, walk the others with tag->next
+ *
+ * @return al_mem_tag_t* The most recently registered tag, NULL if none
+ */
+al_mem_tag_t *al_mem_tag_first(void);
+
+__END_DECLS
+
+#endif
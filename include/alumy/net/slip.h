@@ -4,6 +4,11 @@
  * 
  * This file provides the SLIP protocol implementation for serial communication.
  * SLIP is a simple protocol for transmitting IP packets over serial connections.
+ *
+ * Besides the byte callbacks, frames are encoded into and decoded from whole
+ * buffers: the runs of bytes that need no escape are found a word at a time
+ * and copied at once, and sl_write() takes the encoded frame in chunks of
+ * AL_SLIP_WRITE_BUF bytes instead of a call per byte.
  */
 
 #ifndef __AL_NET_SLIP_H
@@ -16,13 +21,25 @@
 
 __BEGIN_DECLS
 
+#ifndef AL_SLIP_WRITE_BUF
+/** Chunk handed to sl_write(), on the stack of al_slip_write() */
+#define AL_SLIP_WRITE_BUF	128
+#endif
+
+/** Longest encoding of len bytes, every byte escaped and both delimiters */
+#define AL_SLIP_ENCODE_MAX(len)	(2 * (len) + 2)
+
 /**
  * SLIP protocol operation callbacks structure
+ *
+ * One of sl_putc and sl_write is needed, sl_write is used when set.
+ * sl_getc is only needed by al_slip_recv().
  */
 typedef struct al_slip_opt {
 	int_t (*sl_putc)(int_t c);		/* Function to send a single character */
 	int_t (*sl_getc)(void);			/* Function to receive a single character */
 	int_t (*sl_flush)(void);		/* Function to flush output buffer, set to NULL if not needed */
+	int_t (*sl_write)(const void *buf, size_t len);	/* Function to send a buffer, all of it or -1 */
 } al_slip_opt_t;
 
 /**
@@ -50,12 +67,24 @@ typedef struct al_slip {
 int_t al_slip_init(al_slip_t *slip, void *recv_buf, size_t recv_size,
 				   const al_slip_opt_t *opt);
 
+/**
+ * Encode a frame into a buffer, with the delimiters on both ends
+ *
+ * @param out The encoded frame
+ * @param outsz Size of out, AL_SLIP_ENCODE_MAX(len) always fits
+ * @param data Data to encode
+ * @param len Data length
+ * @return Length of the encoded frame, -1 with errno set to ENOBUFS when
+ *         it does not fit
+ */
+ssize_t al_slip_encode(void *out, size_t outsz, const void *data, size_t len);
+
 /**
  * Write data using SLIP protocol
  * @param slip SLIP context pointer
  * @param data Data to write
  * @param len Data length
- * @return Number of bytes written
+ * @return Number of bytes written, 0 when sl_write() failed
  */
 size_t al_slip_write(al_slip_t *slip, const void *data, size_t len);
 
@@ -70,14 +99,30 @@ int_t al_slip_flush(al_slip_t *slip);
  * Process a single received byte
  * @param slip SLIP context pointer
  * @param c Received byte
- * @return Number of complete packets received
+ * @return Length of the frame it completed, 0 when none
  */
 size_t al_slip_recv_byte(al_slip_t *slip, int_t c);
 
+/**
+ * Decode received bytes up to the end of the next frame
+ *
+ * A chunk may carry several frames: decoding stops behind the first one
+ * completed, so the caller takes it from al_slip_get_recv() and goes on
+ * with the rest of the chunk. A frame may as well span several chunks.
+ *
+ * @param slip SLIP context pointer
+ * @param data Received bytes
+ * @param len Length of data
+ * @param used Bytes of data consumed, may be NULL
+ * @return Length of the frame completed, 0 when data ends before a frame
+ */
+size_t al_slip_decode(al_slip_t *slip, const void *data, size_t len,
+					  size_t *used);
+
 /**
  * Receive data using SLIP protocol
  * @param slip SLIP context pointer
- * @return Number of complete packets received
+ * @return Length of the frame received, 0 when sl_getc() ran dry first
  */
 size_t al_slip_recv(al_slip_t *slip);
 
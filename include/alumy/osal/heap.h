@@ -5,6 +5,7 @@
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
+#include "alumy/mem_stat.h"
 
 __BEGIN_DECLS
 
@@ -16,10 +17,22 @@ void *al_os_calloc(size_t nmemb, size_t size);
 
 void *al_os_realloc(void *ptr, size_t size);
 
+/* Free heap size when the heap has no budget, AL_OS_HEAP_SIZE is 0 */
+#define AL_OS_HEAP_SIZE_UNKNOWN		SIZE_MAX
+
 size_t al_os_get_free_heap_size(void);
 
 size_t al_os_get_min_free_heap_size(void);
 
+/**
+ * @brief Get a snapshot of the heap statistics
+ *
+ * @param stat Filled with the counters, size histogram and bytes in use
+ *
+ * @return int32_t Return 0 on success, otherwise return -1
+ */
+int32_t al_os_get_heap_stat(al_mem_stat_t *stat);
+
 __END_DECLS
 
 #endif
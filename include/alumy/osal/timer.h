@@ -39,6 +39,17 @@ int_t al_os_timer_reset(al_os_timer_t *tmr);
 
 int_t al_os_timer_reset_isr(al_os_timer_t *tmr, bool_t *yield);
 
+/**
+ * @brief Run the due timers on an OSAL without a timer task
+ *
+ * The none OSAL runs its timers from here, the main loop calls it and may
+ * sleep for the returned time. The other OSALs run the timers in a task
+ * and only report the time.
+ *
+ * @return int32_t The ms until the next expiry, -1 when no timer runs
+ */
+int32_t al_os_timer_poll(void);
+
 __END_DECLS
 
 #endif
@@ -33,6 +33,8 @@ typedef struct al_pool {
     int32_t nr_free;        /*!< Number of currently free items in the pool */
     int32_t nr_used;        /*!< Number of currently used items in the pool */
     int32_t nr_total;       /*!< Total number of items in the pool (free + used) */
+    int32_t nr_peak;        /*!< High-water mark of nr_used */
+    int32_t nr_fail;        /*!< Number of allocations that found the pool empty */
 } al_pool_t;
 
 
@@ -0,0 +1,197 @@
+/**
+ * @file    slab.h
+ * @author  alumy project
+ * @version v0.0.1
+ * @brief   Slab allocator with power-of-two size classes
+ *
+ * The slab carves one memory region into size classes of 16, 32, 64 ...
+ * bytes, every class is a pool of fixed-size blocks chained on a singly
+ * linked intrusive free list. A request is served by the smallest class
+ * that fits, so mbedtls, cJSON or lwIP churn never fragments the heap.
+ *
+ * With AL_SLAB_F_LOCKFREE the free lists are pushed and popped with a
+ * compare-and-swap, with AL_SLAB_F_MAGAZINE every thread additionally
+ * keeps a small magazine of blocks per class so the hot path touches no
+ * shared state at all.
+ *
+ * @copyright Copyright (c) 2026 alumy project
+ */
+
+#ifndef __AL_SLAB_H
+#define __AL_SLAB_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/pool.h"
+#include "alumy/mem_stat.h"
+
+__BEGIN_DECLS
+
+/** @brief Block size of the first class */
+#define AL_SLAB_MIN_SHIFT		4
+#define AL_SLAB_MIN_SIZE		(1U << AL_SLAB_MIN_SHIFT)
+
+/** @brief Maximum number of classes, the largest block is 512KiB */
+#define AL_SLAB_NR_CLASSES		16
+
+/** @brief Free lists are updated with compare-and-swap */
+#define AL_SLAB_F_LOCKFREE		0x01
+
+/** @brief Cache blocks in per-thread magazines, implies AL_SLAB_F_LOCKFREE */
+#define AL_SLAB_F_MAGAZINE		0x02
+
+/**
+ * @brief One size class of the slab
+ */
+typedef struct al_slab_class {
+	uint8_t *base;          /*!< First block of the class */
+	uint32_t size;          /*!< Block size in bytes */
+	uint32_t nmemb;         /*!< Number of blocks */
+	uintptr_t head;         /*!< Free list head, ABA tag and block index + 1 */
+	al_pool_t pool;         /*!< Block accounting, the list is unused */
+	al_mem_stat_t stat;     /*!< Requests served by the class */
+} al_slab_class_t;
+
+/**
+ * @brief Slab allocator structure
+ */
+typedef struct al_slab {
+	uint32_t init;                              /*!< Initialization flag */
+	uint32_t id;                                /*!< Unique id, 0 when not initialized */
+	uint32_t flags;                             /*!< AL_SLAB_F_xxx */
+	int_t nr_classes;                           /*!< Number of classes */
+	uint8_t *buf;                               /*!< Start of the region */
+	uint8_t *end;                               /*!< End of the region */
+	bool_t own;                                 /*!< buf was allocated by the slab */
+	al_slab_class_t cls[AL_SLAB_NR_CLASSES];    /*!< The size classes */
+	al_mem_stat_t stat;                         /*!< All requests to the slab */
+} al_slab_t;
+
+/**
+ * @brief Get the region size needed by a slab
+ *
+ * @param nmemb Number of blocks of each class, class i holds blocks of
+ *              AL_SLAB_MIN_SIZE << i bytes
+ * @param nr_classes Number of classes
+ *
+ * @return size_t The region size in bytes
+ */
+size_t al_slab_region_size(const uint32_t *nmemb, int_t nr_classes);
+
+/**
+ * @brief Initialize a slab
+ *
+ * @param slab The slab to initialize
+ * @param buf The region, NULL to allocate it with al_os_malloc()
+ * @param size The region size, at least al_slab_region_size()
+ * @param nmemb Number of blocks of each class
+ * @param nr_classes Number of classes, at most AL_SLAB_NR_CLASSES
+ * @param flags AL_SLAB_F_xxx
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_slab_init(al_slab_t *slab, void *buf, size_t size,
+					 const uint32_t *nmemb, int_t nr_classes, uint32_t flags);
+
+/**
+ * @brief Release a slab
+ *
+ * Blocks cached in the magazines of other threads are dropped, the slab
+ * structure itself must stay valid while any thread may still use it.
+ *
+ * @param slab The slab
+ *
+ * @return int32_t Return 0 on success, otherwise return -1
+ */
+int32_t al_slab_deinit(al_slab_t *slab);
+
+/**
+ * @brief Allocate a block from the slab
+ *
+ * The smallest class that fits is used, a larger class when it ran out.
+ *
+ * @param slab The slab
+ * @param size Requested size in bytes
+ *
+ * @return void* The block, NULL with errno set to ENOMEM on failure, or
+ *         EINVAL when the slab is not initialized
+ */
+void *al_slab_alloc(al_slab_t *slab, size_t size);
+
+/**
+ * @brief Allocate from the slab, fall back to al_os_malloc()
+ *
+ * @param slab The slab
+ * @param size Requested size in bytes
+ *
+ * @return void* The memory, NULL on failure
+ */
+void *al_slab_malloc(al_slab_t *slab, size_t size);
+
+/**
+ * @brief Allocate zeroed memory from the slab, fall back to al_os_calloc()
+ *
+ * @param slab The slab
+ * @param nmemb Number of elements
+ * @param size Size of each element
+ *
+ * @return void* The memory, NULL on failure
+ */
+void *al_slab_calloc(al_slab_t *slab, size_t nmemb, size_t size);
+
+/**
+ * @brief Release memory from al_slab_alloc(), al_slab_malloc() or
+ *        al_slab_calloc()
+ *
+ * Memory outside the slab region is handed to al_os_free().
+ *
+ * @param slab The slab
+ * @param p The memory, may be NULL
+ */
+void al_slab_free(al_slab_t *slab, void *p);
+
+/**
+ * @brief Check whether memory belongs to the slab region
+ *
+ * @param slab The slab
+ * @param p The memory
+ *
+ * @return bool_t true if p is a slab block
+ */
+bool_t al_slab_owns(const al_slab_t *slab, const void *p);
+
+/**
+ * @brief Return the blocks of the calling thread's magazines
+ *
+ * Call it before a thread that used a AL_SLAB_F_MAGAZINE slab exits,
+ * otherwise the blocks cached by the thread are never reused.
+ *
+ * @param slab The slab
+ */
+void al_slab_flush(al_slab_t *slab);
+
+/**
+ * @brief Use a slab behind the heap hooks of mbedtls, cJSON and lwIP
+ *
+ * Must be called before alumy_init() and not changed while memory from
+ * the hooks is alive. NULL selects al_os_malloc() again.
+ *
+ * @param slab The slab, NULL for none
+ */
+void al_heap_set_slab(al_slab_t *slab);
+
+/**
+ * @brief Heap hooks, route through the slab set by al_heap_set_slab()
+ *
+ * lwIP picks them up with MEM_LIBC_MALLOC and
+ * mem_clib_malloc/mem_clib_calloc/mem_clib_free defined to these in
+ * lwipopts.h.
+ */
+void *al_heap_malloc(size_t size);
+void *al_heap_calloc(size_t nmemb, size_t size);
+void al_heap_free(void *p);
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef __SVN_REVISION_H
+#define __SVN_REVISION_H 1
+
+#define SVN_REVISION		0
+
+#endif
+
@@ -2,6 +2,7 @@
 #define __AL_THREAD_H 1
 
 #include "alumy/thread/worker.h"
+#include "alumy/thread/worker_pool.h"
 
 #endif
 
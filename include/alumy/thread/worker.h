@@ -20,6 +20,14 @@
 
 __BEGIN_DECLS
 
+/**
+ * @brief Work item executed by a worker thread
+ */
+typedef struct al_worker_item {
+	void (*func)(void *arg);    /**< Function to run */
+	void *arg;                  /**< Argument passed to func */
+} al_worker_item_t;
+
 /**
  * @brief Worker thread context structure
  * 
@@ -0,0 +1,112 @@
+/**
+ * @file worker_pool.h
+ * @brief Multi-threaded worker pool with work stealing
+ *
+ * The pool runs the same work items as al_worker_t on several worker
+ * threads. Every worker owns a bounded lock-free ring, submissions are
+ * spread over the rings round-robin and an idle worker steals from the
+ * rings of its peers, so a burst of jobs is drained by all cores.
+ *
+ * @author Alumy Development Team
+ * @date 2026
+ */
+
+#ifndef __AL_THREAD_WORKER_POOL_H
+#define __AL_THREAD_WORKER_POOL_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/osal.h"
+#include "alumy/thread/worker.h"
+
+__BEGIN_DECLS
+
+struct al_worker_pool_thread;
+
+/**
+ * @brief Worker pool context structure
+ */
+typedef struct al_worker_pool {
+	uint32_t init;                          /**< Initialization flag */
+	int_t nr_workers;                       /**< Number of worker threads */
+	struct al_worker_pool_thread *workers;  /**< Per worker state */
+	al_os_sem_t wake;                       /**< Wakes idle workers */
+	al_os_sem_t done;                       /**< Signalled by exiting workers */
+	uint32_t rr;                            /**< Round-robin submit cursor */
+	int32_t pending;                        /**< Items queued, not yet taken */
+	int32_t idle;                           /**< Workers waiting on wake */
+	bool_t stop;                            /**< Set by al_worker_pool_deinit */
+} al_worker_pool_t;
+
+/**
+ * @brief Initialize the worker pool
+ *
+ * The pool must be zeroed before the first init, a static pool or one
+ * cleared with memset(). The init flag guards against a second init, so
+ * a pool on the stack with a stale flag fails with EEXIST.
+ *
+ * @param pool The pool context to initialize
+ * @param nr_workers The number of worker threads
+ * @param cnt The capacity of each worker ring, rounded up to a power of 2
+ * @param name The name of the worker tasks
+ * @param prio The priority of the worker tasks
+ * @param stack The stack size for the worker tasks in bytes
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_worker_pool_init(al_worker_pool_t *pool, int_t nr_workers,
+							int_t cnt, const char *name,
+							uint32_t prio, uint32_t stack);
+
+/**
+ * @brief Stop the worker pool
+ *
+ * The items already queued are run before the workers exit.
+ *
+ * @param pool The pool context
+ *
+ * @return int32_t Return 0 on success, otherwise return -1
+ */
+int32_t al_worker_pool_deinit(al_worker_pool_t *pool);
+
+/**
+ * @brief Submit a work item to the pool
+ *
+ * Same call shape as al_worker_run().
+ *
+ * @param pool The pool context
+ * @param func The function to execute in a worker thread
+ * @param arg The argument to pass to the function
+ * @param timeout Timeout in milliseconds to wait for ring space,
+ *                negative to wait forever
+ *
+ * @return int32_t Return 0 on success, negative error code on failure
+ */
+int32_t al_worker_pool_run(al_worker_pool_t *pool,
+						   void (*func)(void *arg), void *arg,
+						   int32_t timeout);
+
+/**
+ * @brief Submit many work items with a single wakeup
+ *
+ * One idle worker is woken for the whole batch, every worker that takes
+ * an item wakes the next one while items are left.
+ *
+ * @param pool The pool context
+ * @param items The work items
+ * @param n The number of items
+ * @param timeout Timeout in milliseconds to wait for ring space,
+ *                negative to wait forever
+ *
+ * @return int32_t The number of items queued, less than n when the rings
+ *         stayed full until the timeout, -1 on invalid arguments
+ */
+int32_t al_worker_pool_run_batch(al_worker_pool_t *pool,
+								 const al_worker_item_t *items, int_t n,
+								 int32_t timeout);
+
+__END_DECLS
+
+#endif
+
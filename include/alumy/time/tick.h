@@ -5,6 +5,13 @@
  * This module provides system tick functionality for time tracking and timing operations.
  * It maintains a millisecond-resolution tick counter that can be used for timeouts,
  * delays, and general time measurement in embedded systems.
+ *
+ * The counter is 64 bits wide and double buffered, so a reader never sees
+ * a torn value, even in an interrupt. The 32-bit getters are views of it.
+ * al_tick_get_ns() adds a nanosecond clock: CLOCK_MONOTONIC on Linux, the
+ * generic timer on AArch64, the tick refined by the DWT cycle counter on
+ * Cortex-M3 and above once al_tick_hires_init() is called, and the tick
+ * alone elsewhere.
  * 
  * @author Alumy Development Team
  * @date 2024
@@ -41,6 +48,33 @@ void al_tick_inc(void);
  */
 void al_tick_adj(uint32_t tick_elapsed);
 
+/**
+ * @brief Start the high resolution source of al_tick_get_ns()
+ *
+ * @param hz The core clock in Hz, used by the DWT cycle counter only
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno
+ *                 set to ENOTSUP when the target has no such source
+ */
+int32_t al_tick_hires_init(uint32_t hz);
+
+/**
+ * @brief Get the tick count without wrap
+ *
+ * @return Current tick count in 64 bits
+ */
+uint64_t al_tick_get_tick64(void);
+
+/**
+ * @brief Get the monotonic time in nanoseconds
+ *
+ * Counts from the boot on Linux and AArch64 and from al_tick_init()
+ * elsewhere, only differences are meaningful.
+ *
+ * @return The time in nanoseconds
+ */
+uint64_t al_tick_get_ns(void);
+
 /**
  * @brief Get the current time in seconds since system start
  *
@@ -0,0 +1,141 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timing wheel
+ *
+ * A timer hangs in one slot of one level of the wheel, so adding and
+ * cancelling it is O(1) however many timers run. Level 0 has a slot per
+ * tick, each higher level a slot per AL_TIMER_WHEEL_SLOTS slots of the
+ * level below. When level 0 wraps, the due slot of the level above is
+ * cascaded down, so a timer moves at most AL_TIMER_WHEEL_LEVELS times.
+ * Timers further out than the wheel covers wait in its last level and
+ * are placed again as the wheel turns.
+ *
+ * The wheel has no time source and no lock. The owner advances it to the
+ * current tick, al_timer_wheel_next() tells how long the owner may sleep.
+ * The callbacks run from al_timer_wheel_advance() and may add or cancel
+ * any timer, themselves included.
+ *
+ * @author Alumy Development Team
+ * @date 2026
+ */
+
+#ifndef __AL_TIMER_WHEEL_H
+#define __AL_TIMER_WHEEL_H 1
+
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/list.h"
+
+__BEGIN_DECLS
+
+/** @brief log2 of the slots of a level, 64 slots for a bitmap of 64 bits */
+#define AL_TIMER_WHEEL_BITS		6
+#define AL_TIMER_WHEEL_SLOTS	(1 << AL_TIMER_WHEEL_BITS)
+
+#ifndef AL_TIMER_WHEEL_LEVELS
+/** @brief Levels of the wheel, 4 levels cover 2^24 ticks, 4.6 hours in ms */
+#define AL_TIMER_WHEEL_LEVELS	4
+#endif
+
+/** @brief No timer is pending */
+#define AL_TIMER_NEVER			UINT64_MAX
+
+struct al_timer;
+typedef struct al_timer al_timer_t;
+
+typedef void (*al_timer_func_t)(al_timer_t *tmr, void *arg);
+
+struct al_timer {
+	struct list_head node;
+	uint64_t expires;		/* tick of the expiry */
+	uint32_t period;		/* 0 for a one-shot timer */
+	uint16_t slot;			/* level * AL_TIMER_WHEEL_SLOTS + slot */
+	al_timer_func_t func;
+	void *arg;
+};
+
+typedef struct al_timer_wheel {
+	uint64_t clk;			/* the next tick to process */
+	uint32_t count;			/* pending timers */
+	uint64_t bitmap[AL_TIMER_WHEEL_LEVELS];
+	struct list_head slot[AL_TIMER_WHEEL_LEVELS][AL_TIMER_WHEEL_SLOTS];
+} al_timer_wheel_t;
+
+/**
+ * @brief Initialize a wheel
+ *
+ * @param wheel The wheel
+ * @param now The current tick
+ */
+void al_timer_wheel_init(al_timer_wheel_t *wheel, uint64_t now);
+
+/**
+ * @brief Initialize a timer, not pending
+ *
+ * @param tmr The timer
+ * @param func The callback
+ * @param arg The argument of func
+ */
+void al_timer_init(al_timer_t *tmr, al_timer_func_t func, void *arg);
+
+/**
+ * @brief Add a timer, or move it when it is pending already
+ *
+ * A timer whose tick has passed runs on the next advance. A periodic
+ * timer is added again period ticks after its expiry, before it runs.
+ *
+ * @param wheel The wheel
+ * @param tmr The timer
+ * @param expires The tick of the expiry
+ * @param period The period in ticks, 0 for a one-shot timer
+ *
+ * @return int32_t Return 0 on success, otherwise return -1 with errno set
+ */
+int32_t al_timer_add(al_timer_wheel_t *wheel, al_timer_t *tmr,
+					 uint64_t expires, uint32_t period);
+
+/**
+ * @brief Cancel a timer
+ *
+ * @param wheel The wheel
+ * @param tmr The timer
+ *
+ * @return int32_t Return 1 when it was pending, 0 when not
+ */
+int32_t al_timer_del(al_timer_wheel_t *wheel, al_timer_t *tmr);
+
+/**
+ * @brief Check whether a timer is pending
+ *
+ * @param tmr The timer
+ *
+ * @return bool_t true when pending
+ */
+__static_inline__ bool_t al_timer_pending(const al_timer_t *tmr)
+{
+	return !list_empty(&tmr->node);
+}
+
+/**
+ * @brief Run the timers due up to a tick
+ *
+ * @param wheel The wheel
+ * @param now The current tick, a tick before the wheel does nothing
+ *
+ * @return uint32_t The number of callbacks run
+ */
+uint32_t al_timer_wheel_advance(al_timer_wheel_t *wheel, uint64_t now);
+
+/**
+ * @brief Get the tick of the next expiry, without walking every tick
+ *
+ * @param wheel The wheel
+ *
+ * @return uint64_t The tick, AL_TIMER_NEVER when no timer is pending
+ */
+uint64_t al_timer_wheel_next(const al_timer_wheel_t *wheel);
+
+__END_DECLS
+
+#endif
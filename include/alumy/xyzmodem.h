@@ -2,6 +2,7 @@
 #define __AL_XYZMODEM_H 1
 
 #include "alumy/xyzmodem/ymodem.h"
+#include "alumy/xyzmodem/ymodem_io.h"
 
 #endif
 
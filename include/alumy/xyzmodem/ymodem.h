@@ -57,6 +57,7 @@ typedef enum al_ymodem_finish_reason {
     AL_YM_FINISH_HEADER_PROC_ERR = -4,      /* Header processing error */
     AL_YM_FINISH_PACKET_PROC_ERR = -5,      /* Packet processing error */
     AL_YM_FINISH_END_RECV_ERR = -6,         /* End reception error */
+    AL_YM_FINISH_PACKET_RECV_ERR = -7,      /* Corrupted packet in a stream */
 } al_ymodem_finish_reason_t;
 
 /* YMODEM callback functions structure */
@@ -69,6 +70,30 @@ typedef struct al_ymodem_callback {
     int32_t (*recv_finish)(al_ymodem_finish_reason_t reason);
 } al_ymodem_callback_t;
 
+/*
+ * Source of the file sent by al_ymodem_send_source(). read() fills buf
+ * with the next len bytes of the file and returns how many it read, the
+ * file is read in order and only once.
+ */
+typedef struct al_ymodem_source {
+    ssize_t (*read)(void *ctx, void *buf, size_t len);
+    int32_t (*close)(void *ctx);            /* Called at the end, optional */
+    void *ctx;
+} al_ymodem_source_t;
+
+/*
+ * Sink of the file received, used instead of recv_header and recv_packet
+ * when set. write() gets the data in order, without the padding of the
+ * last packet. close() is called with ok false when the transfer failed
+ * after open(), so the sink can drop what it wrote.
+ */
+typedef struct al_ymodem_sink {
+    int32_t (*open)(void *ctx, const char *filename, size_t filesize);
+    int32_t (*write)(void *ctx, const void *data, size_t len);
+    int32_t (*close)(void *ctx, bool ok);
+    void *ctx;
+} al_ymodem_sink_t;
+
 /* YMODEM operation functions structure */
 typedef struct al_ymodem_opt {
     int32_t (*ym_putc)(int32_t c);          /* Send a single character */
@@ -81,6 +106,8 @@ typedef struct al_ymodem_opt {
 	uint32_t (*tick_ms)(void);              /* Get system tick in ms */
     /* Delay for specified milliseconds */
     void (*delay_ms)(int32_t ms);
+    /* Send a whole packet, optional, needs a send buffer of a packet */
+    ssize_t (*ym_write)(const void *buf, size_t len);
 } al_ymodem_opt_t;
 
 /* YMODEM context structure */
@@ -104,6 +131,11 @@ typedef struct al_ymodem {
 	uint32_t wait_ack_timeout;              /* ACK wait timeout in ms */
 	uint32_t getc_timeout;                  /* Character receive timeout in ms */
 	bool send_packet_1k;                    /* Use 1K packets for sending */
+	bool stream;                            /* YMODEM-g, data is not ACKed */
+    const al_ymodem_sink_t *sink;           /* Sink of the file received */
+    bool sink_open;                         /* The sink is open */
+    size_t file_size;                       /* Size of the file received */
+    size_t file_off;                        /* Bytes of it received */
     /* Transfer completion reason */
     al_ymodem_finish_reason_t finish_reason;
     const al_ymodem_callback_t *callback;  /* Callback functions */
@@ -133,12 +165,35 @@ int32_t al_ymodem_wait_send(al_ymodem_t *ym);
 int32_t al_ymodem_send_file(al_ymodem_t *ym, const char *file_name,
                             const void *data, size_t file_size);
 
+/*
+ * Send a file read from a source, in constant memory: every packet is
+ * read into the send buffer, which needs room for a whole packet with its
+ * header (YMODEM_TOTAL_LEN(YMODEM_PACKET_SIZE_1K) for 1K packets).
+ */
+int32_t al_ymodem_send_source(al_ymodem_t *ym, const char *file_name,
+                              size_t file_size, const al_ymodem_source_t *src);
+
+/*
+ * Set the sink of the files received, NULL for the callbacks. A packet
+ * is acknowledged before it is written to the sink, so the sender sends
+ * the next one while the sink programs flash.
+ */
+int32_t al_ymodem_set_sink(al_ymodem_t *ym, const al_ymodem_sink_t *sink);
+
 /* Set ACK wait timeout value */
 int32_t al_ymodem_set_ack_wait_timeout(al_ymodem_t *ym, uint32_t timeout);
 
 /* Set character receive timeout value */
 int32_t al_ymodem_set_getc_timeout(al_ymodem_t *ym, uint32_t timeout);
 
+/*
+ * Set whether the receiver asks for YMODEM-g with 'G' instead of 'C'. The
+ * data packets then come without waiting for an ACK, for links that do
+ * not lose or corrupt bytes, and a bad packet cancels the transfer. The
+ * sender follows the 'G' seen by al_ymodem_wait_send().
+ */
+int32_t al_ymodem_set_stream(al_ymodem_t *ym, bool stream);
+
 /* Set whether to use 1K packets for sending */
 int32_t al_ymodem_set_send_packet_1k(al_ymodem_t *ym, bool send_1k);
 
@@ -0,0 +1,67 @@
+#ifndef __AL_YMODEM_IO_H
+#define __AL_YMODEM_IO_H 1
+
+#include "alumy/config.h"
+#include "alumy/base.h"
+#include "alumy/types.h"
+#include "alumy/xyzmodem/ymodem.h"
+#if !defined(__ICCRL78__)
+#include "lfs.h"
+#endif
+
+__BEGIN_DECLS
+
+/* Longest program unit of a flash partition */
+#define AL_YMODEM_FLASH_ALIGN_MAX   32
+
+/*
+ * A raw flash partition. The sink erases a sector when the file reaches
+ * it, programs in units of align and pads the tail of the file with 0xFF.
+ * The addresses passed to the callbacks are absolute.
+ */
+typedef struct al_ymodem_flash {
+    uint32_t addr;                          /* Start of the partition */
+    uint32_t size;                          /* Size of the partition */
+    uint32_t sector_size;                   /* Erase unit, a power of 2 */
+    uint32_t align;                         /* Program unit, 1 for any */
+    int32_t (*read)(uint32_t addr, void *buf, size_t len);
+    int32_t (*prog)(uint32_t addr, const void *buf, size_t len);
+    int32_t (*erase)(uint32_t addr, size_t len);
+    uint32_t off;                           /* Bytes read or written */
+    uint32_t erased;                        /* Bytes erased */
+} al_ymodem_flash_t;
+
+/* Read the partition from its start, for al_ymodem_send_source() */
+int32_t al_ymodem_flash_source(al_ymodem_source_t *src, al_ymodem_flash_t *flash);
+
+/* Write a file received to the partition from its start */
+int32_t al_ymodem_flash_sink(al_ymodem_sink_t *sink, al_ymodem_flash_t *flash);
+
+#if !defined(__ICCRL78__)
+/* A file of littlefs */
+typedef struct al_ymodem_lfs {
+    lfs_t *lfs;
+    lfs_file_t file;
+    const char *path;                       /* NULL for the name received */
+    char name[64];                          /* The path opened */
+    bool open;
+} al_ymodem_lfs_t;
+
+/*
+ * Open path for al_ymodem_send_source(), return the size of the file, -1
+ * with errno set on failure. The file is closed by the source at the end.
+ */
+ssize_t al_ymodem_lfs_source(al_ymodem_source_t *src, al_ymodem_lfs_t *f,
+                             lfs_t *lfs, const char *path);
+
+/*
+ * Write a file received to littlefs, to path or to the name received when
+ * path is NULL. A file of a failed transfer is removed.
+ */
+int32_t al_ymodem_lfs_sink(al_ymodem_sink_t *sink, al_ymodem_lfs_t *f,
+                           lfs_t *lfs, const char *path);
+#endif
+
+__END_DECLS
+
+#endif
@@ -17,7 +17,15 @@ __BEGIN_DECLS
  */
 static inline unsigned int kfifo_unused(struct __kfifo *fifo)
 {
-    return (fifo->mask + 1) - (fifo->in - fifo->out);
+    return (fifo->mask + 1) - (fifo->in - __kfifo_load_acquire(&fifo->out));
+}
+
+/*
+ * internal helper to calculate the used elements, seen from the reader
+ */
+static inline unsigned int kfifo_used(struct __kfifo *fifo)
+{
+    return __kfifo_load_acquire(&fifo->in) - fifo->out;
 }
 
 int __kfifo_alloc(struct __kfifo *fifo, unsigned int size,
@@ -31,6 +39,7 @@ int __kfifo_alloc(struct __kfifo *fifo, unsigned int size,
 
     fifo->in = 0;
     fifo->out = 0;
+    fifo->head = 0;
     fifo->esize = esize;
 
     if (size < 2) {
@@ -55,6 +64,7 @@ void __kfifo_free(struct __kfifo *fifo)
     al_os_free(fifo->data);
     fifo->in = 0;
     fifo->out = 0;
+    fifo->head = 0;
     fifo->esize = 0;
     fifo->data = NULL;
     fifo->mask = 0;
@@ -70,6 +80,7 @@ int __kfifo_init(struct __kfifo *fifo, void *buffer,
 
     fifo->in = 0;
     fifo->out = 0;
+    fifo->head = 0;
     fifo->esize = esize;
     fifo->data = buffer;
 
@@ -111,7 +122,7 @@ unsigned int __kfifo_in(struct __kfifo *fifo,
         len = l;
 
     kfifo_copy_in(fifo, buf, len, fifo->in);
-    fifo->in += len;
+    __kfifo_store_release(&fifo->in, fifo->in + len);
     return len;
 }
 
@@ -139,7 +150,7 @@ unsigned int __kfifo_out_peek(struct __kfifo *fifo,
 {
     unsigned int l;
 
-    l = fifo->in - fifo->out;
+    l = kfifo_used(fifo);
     if (len > l)
         len = l;
 
@@ -156,14 +167,14 @@ unsigned int __kfifo_out_linear(struct __kfifo *fifo,
     if (tail)
         *tail = off;
 
-    return min3(n, fifo->in - fifo->out, size - off);
+    return min3(n, kfifo_used(fifo), size - off);
 }
 
 unsigned int __kfifo_out(struct __kfifo *fifo,
         void *buf, unsigned int len)
 {
     len = __kfifo_out_peek(fifo, buf, len);
-    fifo->out += len;
+    __kfifo_store_release(&fifo->out, fifo->out + len);
     return len;
 }
 
@@ -205,15 +216,16 @@ static unsigned int __kfifo_peek_n(struct __kfifo *fifo, size_t recsize)
  * __kfifo_poke_n internal helper function for storing the length of
  * the record into the fifo
  */
-static void __kfifo_poke_n(struct __kfifo *fifo, unsigned int n, size_t recsize)
+static void __kfifo_poke_n(struct __kfifo *fifo, unsigned int in,
+        unsigned int n, size_t recsize)
 {
     unsigned int mask = fifo->mask;
     unsigned char *data = fifo->data;
 
-    __KFIFO_POKE(data, fifo->in, mask, n);
+    __KFIFO_POKE(data, in, mask, n);
 
     if (recsize > 1)
-        __KFIFO_POKE(data, fifo->in + 1, mask, n >> 8);
+        __KFIFO_POKE(data, in + 1, mask, n >> 8);
 }
 
 unsigned int __kfifo_len_r(struct __kfifo *fifo, size_t recsize)
@@ -227,10 +239,10 @@ unsigned int __kfifo_in_r(struct __kfifo *fifo, const void *buf,
     if (len + recsize > kfifo_unused(fifo))
         return 0;
 
-    __kfifo_poke_n(fifo, len, recsize);
+    __kfifo_poke_n(fifo, fifo->in, len, recsize);
 
     kfifo_copy_in(fifo, buf, len, fifo->in + recsize);
-    fifo->in += len + recsize;
+    __kfifo_store_release(&fifo->in, fifo->in + len + recsize);
     return len;
 }
 
@@ -251,7 +263,7 @@ unsigned int __kfifo_out_peek_r(struct __kfifo *fifo, void *buf,
 {
     unsigned int n;
 
-    if (fifo->in == fifo->out)
+    if (!kfifo_used(fifo))
         return 0;
 
     return kfifo_out_copy_r(fifo, buf, len, recsize, &n);
@@ -260,7 +272,7 @@ unsigned int __kfifo_out_peek_r(struct __kfifo *fifo, void *buf,
 unsigned int __kfifo_out_linear_r(struct __kfifo *fifo,
         unsigned int *tail, unsigned int n, size_t recsize)
 {
-    if (fifo->in == fifo->out)
+    if (!kfifo_used(fifo))
         return 0;
 
     if (tail)
@@ -274,11 +286,11 @@ unsigned int __kfifo_out_r(struct __kfifo *fifo, void *buf,
 {
     unsigned int n;
 
-    if (fifo->in == fifo->out)
+    if (!kfifo_used(fifo))
         return 0;
 
     len = kfifo_out_copy_r(fifo, buf, len, recsize, &n);
-    fifo->out += n + recsize;
+    __kfifo_store_release(&fifo->out, fifo->out + n + recsize);
     return len;
 }
 
@@ -287,7 +299,150 @@ void __kfifo_skip_r(struct __kfifo *fifo, size_t recsize)
     unsigned int n;
 
     n = __kfifo_peek_n(fifo, recsize);
-    fifo->out += n + recsize;
+    __kfifo_store_release(&fifo->out, fifo->out + n + recsize);
+}
+
+unsigned int __kfifo_in_rv(struct __kfifo *fifo,
+        const struct kfifo_rec_vec *vec, unsigned int cnt, size_t recsize)
+{
+    unsigned int in = fifo->in;
+    unsigned int unused = kfifo_unused(fifo);
+    unsigned int i;
+
+    for (i = 0; i < cnt; i++) {
+        if (vec[i].len + recsize > unused)
+            break;
+
+        __kfifo_poke_n(fifo, in, vec[i].len, recsize);
+        kfifo_copy_in(fifo, vec[i].buf, vec[i].len, in + recsize);
+
+        in += vec[i].len + recsize;
+        unused -= vec[i].len + recsize;
+    }
+
+    /* one index update makes the whole batch visible */
+    if (i)
+        __kfifo_store_release(&fifo->in, in);
+
+    return i;
+}
+
+unsigned int __kfifo_in_linear(struct __kfifo *fifo,
+        unsigned int *head, unsigned int n)
+{
+    unsigned int size = fifo->mask + 1;
+    unsigned int off = fifo->in & fifo->mask;
+
+    if (head)
+        *head = off;
+
+    return min3(n, kfifo_unused(fifo), size - off);
+}
+
+void __kfifo_in_commit(struct __kfifo *fifo, unsigned int n)
+{
+    __kfifo_store_release(&fifo->in, fifo->in + n);
+}
+
+void __kfifo_out_commit(struct __kfifo *fifo, unsigned int n)
+{
+    __kfifo_store_release(&fifo->out, fifo->out + n);
+}
+
+/* spins of a writer waiting for an earlier one before it yields the cpu */
+#define KFIFO_MP_SPINS  64
+
+static inline void kfifo_cpu_relax(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/*
+ * internal helper of the multi writer functions: reserve len elements at
+ * ->head, or less if @exact is false and the fifo has less room
+ */
+static unsigned int kfifo_reserve_mp(struct __kfifo *fifo, unsigned int len,
+        bool exact, unsigned int *pos)
+{
+    unsigned int head = __atomic_load_n(&fifo->head, __ATOMIC_RELAXED);
+    unsigned int unused;
+    unsigned int n;
+
+    do {
+        unused = (fifo->mask + 1) -
+            (head - __kfifo_load_acquire(&fifo->out));
+
+        n = len;
+        if (n > unused) {
+            if (exact)
+                return 0;
+            n = unused;
+        }
+
+        if (n == 0)
+            return 0;
+    } while (!__atomic_compare_exchange_n(&fifo->head, &head, head + n,
+            true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    *pos = head;
+    return n;
+}
+
+/*
+ * internal helper of the multi writer functions: publish a reservation
+ * once every earlier reservation is published
+ */
+static void kfifo_commit_mp(struct __kfifo *fifo, unsigned int pos,
+        unsigned int len)
+{
+    unsigned int spins = 0;
+
+    /*
+     * acquire the index of the earlier writer, so its data happens before
+     * our release below and a reader acquiring our index sees both
+     */
+    while (__kfifo_load_acquire(&fifo->in) != pos) {
+        if (++spins < KFIFO_MP_SPINS)
+            kfifo_cpu_relax();
+        else
+            al_os_delay(0);
+    }
+
+    __kfifo_store_release(&fifo->in, pos + len);
+}
+
+unsigned int __kfifo_in_mp(struct __kfifo *fifo,
+        const void *buf, unsigned int len)
+{
+    unsigned int pos;
+
+    len = kfifo_reserve_mp(fifo, len, false, &pos);
+    if (len == 0)
+        return 0;
+
+    kfifo_copy_in(fifo, buf, len, pos);
+    kfifo_commit_mp(fifo, pos, len);
+    return len;
+}
+
+unsigned int __kfifo_in_r_mp(struct __kfifo *fifo, const void *buf,
+        unsigned int len, size_t recsize)
+{
+    unsigned int pos;
+
+    if (kfifo_reserve_mp(fifo, len + recsize, true, &pos) == 0)
+        return 0;
+
+    __kfifo_poke_n(fifo, pos, len, recsize);
+    kfifo_copy_in(fifo, buf, len, pos + recsize);
+    kfifo_commit_mp(fifo, pos, len + recsize);
+    return len;
 }
 
 __END_DECLS
@@ -11,6 +11,7 @@
 #include "alumy/types.h"
 #include "alumy/base.h"
 #include "alumy/log.h"
+#include "alumy/log_ring.h"
 #include "alumy/time.h"
 #include "alumy/osal/putc.h"
 #include "tinyprintf.h"
@@ -18,17 +19,49 @@
 __BEGIN_DECLS
 
 #define BIN_LINE_SIZE	16
+/* "00000000: ", 16 "XX ", "; " and 16 characters */
+#define BIN_LINE_LEN	(8 + 2 + BIN_LINE_SIZE * 3 + 2 + BIN_LINE_SIZE)
+
+#if AL_LOG_BIN_BUF < 128
+#error "AL_LOG_BIN_BUF must hold a hexdump line"
+#endif
 
 static const char hex[] = "0123456789ABCDEF";
 
 static int32_t logmask = 0xFF;
 
+static size_t bin_max = 0;
+static uint32_t bin_every = 1;
+static uint32_t bin_count = 0;
+
+size_t al_log_stamp(char *buf, size_t bufsz)
+{
+#if AL_LOG_TS_USEC
+    uint64_t ns = al_tick_get_ns();
+
+    return tfp_snprintf(buf, bufsz, "[%5lu.%06lu] ",
+                        (unsigned long)(ns / 1000000000),
+                        (unsigned long)(ns % 1000000000 / 1000));
+#else
+    uint64_t ms = al_tick_get_tick64();
+
+    return tfp_snprintf(buf, bufsz, "[%5lu.%03lu] ",
+                        (unsigned long)(ms / 1000), (unsigned long)(ms % 1000));
+#endif
+}
+
 __weak void al_vlog(int32_t pri, const char *fmt, va_list ap)
 {
-    long tv_sec = al_tick_get_sec();
-    int tv_msec = al_tick_get_msec();
+    char ts[AL_LOG_STAMP_MAX];
+
+    /* queued when the ring backend runs, ap is untouched otherwise */
+    if (al_log_ring_vlog(pri, fmt, ap) >= 0) {
+        return;
+    }
 
-    tfp_printf("[%5ld.%03d] ", (long)tv_sec, (int)tv_msec);
+    al_log_stamp(ts, sizeof(ts));
+
+    tfp_printf("%s", ts);
     tfp_vprintf(fmt, ap);
 }
 
@@ -83,112 +116,213 @@ static size_t hex_addr_fmt(char buf[8], intptr_t addr)
 	return 8;
 }
 
+#if defined(__GNUC__) && !defined(__clang__) && \
+	(defined(__SSE2__) || defined(__ARM_NEON) || defined(__aarch64__))
+typedef uint8_t hex_v16 __attribute__((vector_size(16)));
+
+/* character p of "XX XX ...", the high nibbles are 0-15, the low 16-31 */
+#define HEX_SEL(p)		((p) % 3 == 2 ? 0 : (p) / 3 + (p) % 3 * 16)
+#define HEX_KEEP(p)		((p) % 3 == 2 ? 0 : 0xFF)
+#define HEX_V16(f, o)	{															\
+	f((o) + 0), f((o) + 1), f((o) + 2), f((o) + 3), f((o) + 4), f((o) + 5),		\
+	f((o) + 6), f((o) + 7), f((o) + 8), f((o) + 9), f((o) + 10), f((o) + 11),	\
+	f((o) + 12), f((o) + 13), f((o) + 14), f((o) + 15) }
+
 /**
- * @brief Format a line
+ * @brief Format 16 bytes as "XX " and as characters, with vector operations
+ *
+ * @param hexs 48 characters of hex
+ * @param chars 16 printable characters, '.' for the others
+ * @param data 16 bytes
+ */
+static void hex_fmt_16(char *hexs, char *chars, const uint8_t *data)
+{
+	static const hex_v16 sel[3] = {
+		HEX_V16(HEX_SEL, 0), HEX_V16(HEX_SEL, 16), HEX_V16(HEX_SEL, 32),
+	};
+	static const hex_v16 keep[3] = {
+		HEX_V16(HEX_KEEP, 0), HEX_V16(HEX_KEEP, 16), HEX_V16(HEX_KEEP, 32),
+	};
+	hex_v16 v, hi, lo, pr;
+	int_t i;
+
+	memcpy(&v, data, sizeof(v));
+
+	/* '0' + n, 7 more to reach 'A' above 9 */
+	hi = v >> 4;
+	lo = v & 0x0F;
+	hi += '0' + ((hex_v16)(hi > 9) & 7);
+	lo += '0' + ((hex_v16)(lo > 9) & 7);
+
+	for (i = 0; i < 3; i++) {
+		pr = __builtin_shuffle(hi, lo, sel[i]);
+		pr = (pr & keep[i]) | (' ' & ~keep[i]);
+		memcpy(hexs + i * sizeof(pr), &pr, sizeof(pr));
+	}
+
+	pr = (hex_v16)((v >= 0x20) & (v < 0x7F));
+	pr = (v & pr) | ('.' & ~pr);
+	memcpy(chars, &pr, sizeof(pr));
+}
+#else
+static void hex_fmt_16(char *hexs, char *chars, const uint8_t *data)
+{
+	int_t i;
+
+	for (i = 0; i < BIN_LINE_SIZE; i++) {
+		*hexs++ = hex[data[i] >> 4];
+		*hexs++ = hex[data[i] & 0x0F];
+		*hexs++ = ' ';
+		*chars++ = ((data[i] >= 0x20) && (data[i] < 0x7F)) ? data[i] : '.';
+	}
+}
+#endif
+
+/**
+ * @brief Format a line, without terminator
  *  A line format:
  * 00000000: 00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F ;
- * 000000000000000000\n
+ * 000000000000000000
  *
  * @author jack (4/27/2018)
  *
- * @param buf
+ * @param buf At least BIN_LINE_LEN characters
+ * @param addr
  * @param data
- * @param len
- *
- * @return size_t
+ * @param len At most BIN_LINE_SIZE
  */
-static ssize_t hex_raw_fmt_line(char *buf, size_t bufsz, intptr_t addr,
-								const void *data, size_t len)
+static void hex_fmt_line(char *buf, intptr_t addr, const uint8_t *data,
+						 size_t len)
 {
-    size_t line_size = 8 + 2 + 16 * 3 + 2 + 16 + 1;
-    size_t i;
+	uint8_t tail[BIN_LINE_SIZE];
+
+	hex_addr_fmt(buf, addr);
+	buf[8] = ':';
+	buf[9] = ' ';
+	buf[58] = ';';
+	buf[59] = ' ';
+
+	if (len < BIN_LINE_SIZE) {
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, data, len);
+		data = tail;
+	}
 
-    if ((len > BIN_LINE_SIZE) || (bufsz < line_size)) {
-        return -1;
-    }
+	hex_fmt_16(&buf[10], &buf[60], data);
+
+	if (len < BIN_LINE_SIZE) {
+		memset(&buf[10 + len * 3], ' ', (BIN_LINE_SIZE - len) * 3);
+		memset(&buf[60 + len], ' ', BIN_LINE_SIZE - len);
+	}
+}
 
-	char *_buf = buf;
+__weak void al_log_write(const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)buf;
 
-	/**
-	 * Add address and other fixed characters
-	 */
-	hex_addr_fmt(_buf, addr);
-	_buf[8] = ':';
-	_buf[9] = ' ';
-	_buf[58] = ';';
-	_buf[59] = ' ';
+	if (al_log_ring_write(buf, len) >= 0) {
+		return;
+	}
 
-	char *h_wp = &_buf[10];
-	char *c_wp = &_buf[60];
+	while (len--) {
+		al_putc(*p++);
+	}
+}
 
+void al_log_bin(int32_t pri,
+				const char *file, int32_t line, const char *func,
+				const void *data, size_t len)
+{
+	static const char *const color_tab[] = {
+		[AL_LOG_DEBUG] = AL_LOG_COLOR_D "",
+		[AL_LOG_INFO] = AL_LOG_COLOR_I,
+		[AL_LOG_NOTICE] = AL_LOG_COLOR_N,
+		[AL_LOG_WARN] = AL_LOG_COLOR_W,
+		[AL_LOG_ERR] = AL_LOG_COLOR_E,
+		[AL_LOG_CRIT] = AL_LOG_COLOR_C,
+		[AL_LOG_ALERT] = AL_LOG_COLOR_A,
+		[AL_LOG_EMERG] = AL_LOG_COLOR_E,
+	};
+	static const char reset[] = AL_PRI_RESET_COLOR "\r\n";
+
+	char buf[AL_LOG_BIN_BUF];
+	char ts[AL_LOG_STAMP_MAX];
+	const char *color;
 	const uint8_t *rp = (const uint8_t *)data;
+	size_t tslen, clen, llen, dump, n;
+	size_t blen = 0;
+	intptr_t addr = 0;
+	char *wp;
 
-	for (i = 0; i < len; ++i) {
-        *h_wp++ = hex[(*rp >> 4) & 0x0F];
-        *h_wp++ = hex[*rp & 0x0F];
-        *h_wp++ = ' ';
-
-#if defined (__GNUC__)
-        *c_wp++ = isprint(*rp) ? (char)*rp : '.';
-#elif defined (__CC_ARM)
-        *c_wp++ = ((*rp <= 0x7F) && isprint(*rp)) ? *rp : '.';
-#else
-        *c_wp++ = ((*rp <= 0x7F) && isprint(*rp)) ? *rp : '.';
-#endif
+	UNUSED(file);
+	UNUSED(line);
+	UNUSED(func);
 
-        ++rp;
-    }
+	pri = AL_LOG_PRI(pri);
 
-	for (i = len; i < BIN_LINE_SIZE; ++i) {
-		*h_wp++ = ' ';
-		*h_wp++ = ' ';
-		*h_wp++ = ' ';
-		*c_wp++ = ' ';
+	if ((AL_LOG_MASK(pri) & logmask) == 0) {
+		return;
 	}
 
-    _buf[76] = 0;
+	/* a lost count under a race only shifts the sample */
+	if ((bin_every > 1) && (bin_count++ % bin_every != 0)) {
+		return;
+	}
 
-	return (ssize_t)line_size - 1;
-}
+	dump = len;
+	if ((bin_max > 0) && (dump > bin_max)) {
+		dump = bin_max;
+	}
 
-void al_log_bin(int32_t pri,
-				const char *file, int32_t line, const char *func,
-				const void *data, size_t len)
-{
-    static const char *fmt_tab[] = {
-        [AL_LOG_DEBUG] = AL_LOG_FMT(D, "%s"),
-        [AL_LOG_INFO] = AL_LOG_FMT(I, "%s"),
-        [AL_LOG_NOTICE] = AL_LOG_FMT(N, "%s"),
-        [AL_LOG_WARN] = AL_LOG_FMT(W, "%s"),
-        [AL_LOG_ERR] = AL_LOG_FMT(E, "%s"),
-        [AL_LOG_CRIT] = AL_LOG_FMT(C, "%s"),
-        [AL_LOG_ALERT] = AL_LOG_FMT(A, "%s"),
-        [AL_LOG_EMERG] = AL_LOG_FMT(E, "%s"),
-    };
-
-    char buf[80];
-    const char *fmt = AL_LOG_FMT(D, "%s");
-    int32_t nline = len >> 4;
-    int32_t remain = len & 0x0F;
-    intptr_t addr = 0;
-    const uint8_t *rp = (const uint8_t *)data;
-
-    if (pri < ARRAY_SIZE(fmt_tab)) {
-        fmt = fmt_tab[pri];
-    }
+	/* the lines of one dump share the timestamp */
+	tslen = al_log_stamp(ts, sizeof(ts));
+	color = color_tab[pri];
+	clen = strlen(color);
+	llen = tslen + clen + BIN_LINE_LEN + sizeof(reset) - 1;
+
+	while ((size_t)addr < dump) {
+		if (blen + llen > sizeof(buf)) {
+			al_log_write(buf, blen);
+			blen = 0;
+		}
+
+		n = min_t(size_t, dump - addr, BIN_LINE_SIZE);
+		wp = buf + blen;
+
+		memcpy(wp, ts, tslen);
+		wp += tslen;
+		memcpy(wp, color, clen);
+		wp += clen;
+		hex_fmt_line(wp, addr, rp + addr, n);
+		wp += BIN_LINE_LEN;
+		memcpy(wp, reset, sizeof(reset) - 1);
+		wp += sizeof(reset) - 1;
+
+		blen = wp - buf;
+		addr += n;
+	}
 
-    while (nline--) {
-        hex_raw_fmt_line(buf, sizeof(buf), addr, rp + addr, BIN_LINE_SIZE);
-        addr += BIN_LINE_SIZE;
+	if (dump < len) {
+		if (blen + llen > sizeof(buf)) {
+			al_log_write(buf, blen);
+			blen = 0;
+		}
 
-        al_log(pri, file, line, func, fmt, buf);
-    }
+		blen += tfp_snprintf(buf + blen, sizeof(buf) - blen,
+							 "%s%s... %lu more bytes%s", ts, color,
+							 (unsigned long)(len - dump), reset);
+	}
 
-    if (remain > 0) {
-        hex_raw_fmt_line(buf, sizeof(buf), addr, rp + addr, (size_t)remain);
+	if (blen > 0) {
+		al_log_write(buf, blen);
+	}
+}
 
-        al_log(pri, file, line, func, fmt, buf);
-    }
+void al_log_bin_set_limit(size_t max, uint32_t every)
+{
+	bin_max = max;
+	bin_every = every;
+	bin_count = 0;
 }
 
 int32_t al_log_set_mask(int32_t mask)
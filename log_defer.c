@@ -0,0 +1,143 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/log.h"
+#include "alumy/log_defer.h"
+#include "alumy/time.h"
+
+__BEGIN_DECLS
+
+/* a varint of 64 bits */
+#define LOGD_VARINT_MAX		10
+
+static uint8_t *logd_varint(uint8_t *p, uint64_t v)
+{
+	while (v >= 0x80) {
+		*p++ = (uint8_t)v | 0x80;
+		v >>= 7;
+	}
+
+	*p++ = (uint8_t)v;
+
+	return p;
+}
+
+static uint64_t logd_zigzag(int64_t v)
+{
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+ssize_t al_logd_encode(void *buf, size_t bufsz, int32_t pri, uint32_t tick,
+					   uint32_t id, uint32_t types, va_list ap)
+{
+	uint8_t *rec = (uint8_t *)buf;
+	uint8_t *p, *end;
+	const char *s;
+	uint64_t u;
+	double d;
+	size_t len;
+	int_t n, i;
+
+	AL_CHECK_RET(buf != NULL, EINVAL, -1);
+	/* the length prefix is a single byte */
+	AL_CHECK_RET((bufsz >= 16) && (bufsz <= AL_LOGD_REC_MAX), EINVAL, -1);
+
+	for (n = 0; (n < AL_LOGD_ARGS_MAX) && ((types >> (n * 4)) & 0x0F); n++) {
+		;
+	}
+
+	end = rec + bufsz;
+	p = rec + 1;
+
+	*p++ = AL_LOG_PRI(pri) | (n << 3);
+	p = logd_varint(p, tick);
+	p = logd_varint(p, id);
+
+	for (i = 0; i < n; i += 2) {
+		*p++ = (types >> (i * 4)) & 0xFF;
+	}
+
+	for (i = 0; i < n; i++) {
+		AL_CHECK_RET(end - p >= LOGD_VARINT_MAX, ENOBUFS, -1);
+
+		switch ((types >> (i * 4)) & 0x0F) {
+		case AL_LOGD_I32:
+			p = logd_varint(p, logd_zigzag(va_arg(ap, int)));
+			break;
+
+		case AL_LOGD_I64:
+			/* long and long long of 8 bytes are passed alike */
+			p = logd_varint(p, logd_zigzag(va_arg(ap, long long)));
+			break;
+
+		case AL_LOGD_F64:
+			d = va_arg(ap, double);
+			memcpy(&u, &d, sizeof(u));
+
+			for (len = 0; len < 8; len++, u >>= 8) {
+				*p++ = (uint8_t)u;
+			}
+			break;
+
+		case AL_LOGD_STR:
+			s = va_arg(ap, const char *);
+			if (s == NULL) {
+				s = "(null)";
+			}
+
+			len = strnlen(s, AL_LOGD_STR_MAX);
+			len = min_t(size_t, len, end - p - 1);
+
+			*p++ = len;
+			memcpy(p, s, len);
+			p += len;
+			break;
+
+		case AL_LOGD_PTR:
+			p = logd_varint(p, (uintptr_t)va_arg(ap, void *));
+			break;
+
+		default:
+			set_errno(EINVAL);
+			return -1;
+		}
+	}
+
+	AL_CHECK_RET(p <= end, ENOBUFS, -1);
+
+	rec[0] = p - rec - 1;
+
+	return p - rec;
+}
+
+__weak void al_logd_write(const void *rec, size_t len)
+{
+	al_log_write(rec, len);
+}
+
+void al_logd(int32_t pri, uint32_t id, uint32_t types, ...)
+{
+	uint8_t rec[AL_LOGD_REC_MAX];
+	ssize_t len;
+	va_list ap;
+
+	/* al_log_set_mask(0) only reads the mask */
+	if ((AL_LOG_MASK(AL_LOG_PRI(pri)) & al_log_set_mask(0)) == 0) {
+		return;
+	}
+
+	va_start(ap, types);
+	len = al_logd_encode(rec, sizeof(rec), pri, al_tick_get_tick(),
+						 id, types, ap);
+	va_end(ap);
+
+	/* a record that does not fit is lost like one on a full ring */
+	if (len > 0) {
+		al_logd_write(rec, len);
+	}
+}
+
+__END_DECLS
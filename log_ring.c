@@ -0,0 +1,374 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/initialized.h"
+#include "alumy/kfifo.h"
+#include "alumy/time.h"
+#include "alumy/osal.h"
+#include "alumy/osal/putc.h"
+#include "alumy/log_ring.h"
+#include "tinyprintf.h"
+
+__BEGIN_DECLS
+
+#if AL_LOG_RING_BATCH < AL_LOG_RING_LINE_MAX
+#error "AL_LOG_RING_BATCH must hold a message of AL_LOG_RING_LINE_MAX"
+#endif
+
+/*
+ * The writers of a ring take its mutex around kfifo_in(), the drain task is
+ * the only reader and needs no lock. A lock-free kfifo_in_mp() would let a
+ * high priority writer spin forever on a lower one preempted in the middle
+ * of its record, the mutex lends the holder its priority instead. Counters
+ * and flags are shared with the writers, the idle and run handshakes rely on
+ * sequentially consistent accesses on both sides.
+ */
+#define atomic_load(p)			__atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define atomic_store(p, v)		__atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define atomic_add(p, v)		__atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+
+typedef struct al_log_ring {
+	uint32_t init;
+	bool_t run;                 /* writers are admitted */
+	bool_t stop;                /* the drain task exits after a last drain */
+	int32_t users;              /* writers inside al_log_ring_vlog() */
+	int32_t idle;               /* the drain task waits on wake */
+	uint32_t queued;            /* records stored */
+	uint32_t written;           /* records handed to the output */
+	uint32_t dropped;           /* records that found their ring full */
+	uint32_t reported;          /* drops already reported */
+	al_os_sem_t wake;
+	al_os_sem_t done;
+	al_os_task_t task;
+	al_log_ring_write_t write;
+	char *batch;
+	struct kfifo_rec_ptr_2 ring[AL_LOG_RING_SHARDS];
+	al_os_mutex_t lock[AL_LOG_RING_SHARDS];
+} al_log_ring_t;
+
+static al_log_ring_t lr;
+
+#if AL_LOG_RING_SHARDS > 1
+static __thread int_t log_ring_id = -1;
+static uint32_t log_ring_next;
+
+/* a thread keeps its ring, so its messages stay in order */
+static int_t log_ring_shard(void)
+{
+	if (log_ring_id < 0) {
+		log_ring_id = (atomic_add(&log_ring_next, 1) - 1) % AL_LOG_RING_SHARDS;
+	}
+
+	return log_ring_id;
+}
+#else
+#define log_ring_shard()		0
+#endif
+
+static void log_ring_putc(const void *buf, size_t len)
+{
+	const char *p = (const char *)buf;
+
+	while (len--) {
+		al_putc(*p++);
+	}
+}
+
+static bool_t log_ring_pending(void)
+{
+	return (atomic_load(&lr.queued) != lr.written) ||
+		   (atomic_load(&lr.dropped) != lr.reported);
+}
+
+static void log_ring_output(size_t len, uint32_t n)
+{
+	if (len > 0) {
+		lr.write(lr.batch, len);
+	}
+
+	/* al_log_ring_flush() waits for this */
+	atomic_add(&lr.written, n);
+}
+
+static void log_ring_drain(void)
+{
+	struct kfifo_rec_ptr_2 *ring;
+	uint32_t dropped, n = 0;
+	size_t blen = 0, len;
+	int_t i;
+
+	for (i = 0; i < AL_LOG_RING_SHARDS; i++) {
+		ring = &lr.ring[i];
+
+		while (!kfifo_is_empty(ring)) {
+			len = kfifo_peek_len(ring);
+
+			if (blen + len > AL_LOG_RING_BATCH) {
+				log_ring_output(blen, n);
+				blen = 0;
+				n = 0;
+			}
+
+			blen += kfifo_out(ring, lr.batch + blen, len);
+			n++;
+		}
+	}
+
+	dropped = atomic_load(&lr.dropped);
+
+	if (dropped != lr.reported) {
+		if (blen + 64 > AL_LOG_RING_BATCH) {
+			log_ring_output(blen, n);
+			blen = 0;
+			n = 0;
+		}
+
+		blen += tfp_snprintf(lr.batch + blen, AL_LOG_RING_BATCH - blen,
+							 "[log] %lu messages dropped\r\n",
+							 (unsigned long)(dropped - lr.reported));
+		lr.reported = dropped;
+	}
+
+	log_ring_output(blen, n);
+}
+
+static void log_ring_task(void *arg)
+{
+	bool_t stop;
+
+	UNUSED(arg);
+
+	for (;;) {
+		stop = atomic_load(&lr.stop);
+
+		log_ring_drain();
+
+		if (stop) {
+			break;
+		}
+
+		atomic_add(&lr.idle, 1);
+
+		/* recheck after publishing idle, a writer may have missed us */
+		if (!log_ring_pending()) {
+			al_os_sem_take(lr.wake, -1);
+		}
+
+		atomic_add(&lr.idle, -1);
+	}
+
+	al_os_sem_give(lr.done);
+
+	/* al_log_ring_deinit() deletes the task */
+	al_os_delay(-1);
+}
+
+static void log_ring_free(void)
+{
+	int_t i;
+
+	for (i = 0; i < AL_LOG_RING_SHARDS; i++) {
+		if (kfifo_initialized(&lr.ring[i])) {
+			kfifo_free(&lr.ring[i]);
+		}
+
+		if (lr.lock[i]) {
+			al_os_mutex_del(lr.lock[i]);
+			lr.lock[i] = NULL;
+		}
+	}
+
+	if (lr.batch) {
+		al_os_free(lr.batch);
+		lr.batch = NULL;
+	}
+
+	if (lr.wake) {
+		al_os_sem_bin_del(lr.wake);
+		lr.wake = NULL;
+	}
+
+	if (lr.done) {
+		al_os_sem_bin_del(lr.done);
+		lr.done = NULL;
+	}
+}
+
+int32_t al_log_ring_init(uint32_t size, al_log_ring_write_t write,
+						 uint32_t prio, uint32_t stack)
+{
+	int_t i;
+
+	/* a shard must hold at least one full message and its header */
+	AL_CHECK_RET(size / AL_LOG_RING_SHARDS >= AL_LOG_RING_LINE_MAX + 2,
+				 EINVAL, -1);
+
+	if (!al_initialized_init(&lr.init)) {
+		/* the counter is a reference count, drop the one just taken */
+		al_initialized_cleanup(&lr.init);
+		set_errno(EEXIST);
+		return -1;
+	}
+
+	lr.stop = false;
+	lr.users = 0;
+	lr.idle = 0;
+	lr.queued = 0;
+	lr.written = 0;
+	lr.dropped = 0;
+	lr.reported = 0;
+	lr.write = write ? write : log_ring_putc;
+
+	lr.wake = al_os_sem_bin_create();
+	lr.done = al_os_sem_bin_create();
+	lr.batch = (char *)al_os_malloc(AL_LOG_RING_BATCH);
+	if (!lr.wake || !lr.done || !lr.batch) {
+		goto err;
+	}
+
+	for (i = 0; i < AL_LOG_RING_SHARDS; i++) {
+		if (kfifo_alloc(&lr.ring[i], size / AL_LOG_RING_SHARDS) != 0) {
+			goto err;
+		}
+
+		lr.lock[i] = al_os_mutex_create();
+		if (lr.lock[i] == NULL) {
+			goto err;
+		}
+	}
+
+	lr.task = al_os_task_create("log", prio, stack, log_ring_task, NULL);
+	if (lr.task == NULL) {
+		goto err;
+	}
+
+	atomic_store(&lr.run, true);
+
+	return 0;
+
+err:
+	log_ring_free();
+	al_initialized_cleanup(&lr.init);
+	set_errno(ENOMEM);
+	return -1;
+}
+
+int32_t al_log_ring_deinit(void)
+{
+	AL_CHECK_RET(al_initialized_is_init(&lr.init), EPERM, -1);
+
+	/* turn new writers away and let the ones inside finish */
+	atomic_store(&lr.run, false);
+
+	while (atomic_load(&lr.users) > 0) {
+		al_os_delay(1);
+	}
+
+	atomic_store(&lr.stop, true);
+	al_os_sem_give(lr.wake);
+	al_os_sem_take(lr.done, -1);
+	al_os_task_delete(lr.task);
+	lr.task = NULL;
+
+	log_ring_free();
+	al_initialized_cleanup(&lr.init);
+
+	return 0;
+}
+
+int32_t al_log_ring_write(const void *buf, size_t len)
+{
+	int32_t ret = 0;
+	size_t n = 0;
+	int_t i;
+
+	atomic_add(&lr.users, 1);
+
+	if (!atomic_load(&lr.run)) {
+		atomic_add(&lr.users, -1);
+		return -1;
+	}
+
+	/* a longer record would not fit the batch of the drain task */
+	if (len <= AL_LOG_RING_BATCH) {
+		i = log_ring_shard();
+
+		al_os_mutex_take(lr.lock[i], -1);
+		n = kfifo_in(&lr.ring[i], buf, len);
+		al_os_mutex_give(lr.lock[i]);
+	}
+
+	if (n == len) {
+		atomic_add(&lr.queued, 1);
+		ret = 1;
+	} else {
+		atomic_add(&lr.dropped, 1);
+	}
+
+	if (atomic_load(&lr.idle) > 0) {
+		al_os_sem_give(lr.wake);
+	}
+
+	atomic_add(&lr.users, -1);
+
+	return ret;
+}
+
+int32_t al_log_ring_vlog(int32_t pri, const char *fmt, va_list ap)
+{
+	char buf[AL_LOG_RING_LINE_MAX];
+	size_t len;
+
+	UNUSED(pri);
+
+	/* don't format for nothing, the check is repeated under users */
+	if (!atomic_load(&lr.run)) {
+		return -1;
+	}
+
+	len = al_log_stamp(buf, sizeof(buf));
+	len += tfp_vsnprintf(buf + len, sizeof(buf) - len, fmt, ap);
+
+	if (len > sizeof(buf) - 1) {
+		/* cut, but keep the line break */
+		len = sizeof(buf) - 1;
+		buf[len - 2] = '\r';
+		buf[len - 1] = '\n';
+	}
+
+	return al_log_ring_write(buf, len);
+}
+
+int32_t al_log_ring_flush(int_t timeout)
+{
+	uint32_t target;
+
+	AL_CHECK_RET(al_initialized_is_init(&lr.init), EPERM, -1);
+
+	target = atomic_load(&lr.queued);
+
+	while ((int32_t)(atomic_load(&lr.written) - target) < 0) {
+		if (timeout == 0) {
+			set_errno(ETIMEDOUT);
+			return -1;
+		}
+
+		al_os_delay(1);
+
+		if (timeout > 0) {
+			timeout--;
+		}
+	}
+
+	return 0;
+}
+
+uint32_t al_log_ring_dropped(void)
+{
+	return atomic_load(&lr.dropped);
+}
+
+__END_DECLS
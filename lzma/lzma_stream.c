@@ -0,0 +1,335 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/crc.h"
+#include "alumy/lzma.h"
+
+__BEGIN_DECLS
+
+/* a bump allocator over the memory of the stream, freed all at once by reset */
+static void *lzma_stream_alloc(ISzAllocPtr p, size_t size)
+{
+	al_lzma_stream_t *s = container_of(p, al_lzma_stream_t, alloc);
+	size_t off = (s->used + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+	if ((off > s->memsz) || (size > s->memsz - off)) {
+		return NULL;
+	}
+
+	s->used = off + size;
+
+	return s->mem + off;
+}
+
+static void lzma_stream_free(ISzAllocPtr p, void *addr)
+{
+
+}
+
+int32_t al_lzma_stream_init(al_lzma_stream_t *s, void *mem, size_t memsz,
+							al_lzma_write_t write, void *ctx)
+{
+	AL_CHECK_RET((s != NULL) && (mem != NULL) && (write != NULL), EINVAL, -1);
+
+	s->alloc.Alloc = lzma_stream_alloc;
+	s->alloc.Free = lzma_stream_free;
+	s->mem = (uint8_t *)mem;
+	s->memsz = memsz;
+	s->write = write;
+	s->ctx = ctx;
+
+	al_lzma_stream_reset(s);
+
+	return 0;
+}
+
+void al_lzma_stream_reset(al_lzma_stream_t *s)
+{
+	LzmaDec_Construct(&s->dec);
+
+	s->used = 0;
+	s->hdr_len = 0;
+	s->out_size = AL_LZMA_SIZE_UNKNOWN;
+	s->out_len = 0;
+	s->crc = 0;
+	s->err = 0;
+	s->done = false;
+}
+
+static int32_t lzma_stream_fail(al_lzma_stream_t *s, int32_t err)
+{
+	s->err = err;
+	set_errno(err);
+
+	return -1;
+}
+
+static int32_t lzma_stream_header(al_lzma_stream_t *s)
+{
+	uint64_t size = 0;
+	SRes res;
+
+	for (int_t i = AL_LZMA_HEADER_SIZE - 1; i >= LZMA_PROPS_SIZE; i--) {
+		size = (size << 8) | s->hdr[i];
+	}
+
+	res = LzmaDec_Allocate(&s->dec, s->hdr, LZMA_PROPS_SIZE, &s->alloc);
+	if (res != SZ_OK) {
+		return lzma_stream_fail(s, (res == SZ_ERROR_MEM) ? ENOMEM : EINVAL);
+	}
+
+	LzmaDec_Init(&s->dec);
+
+	s->out_size = size;
+	s->done = (size == 0);
+
+	return 0;
+}
+
+int32_t al_lzma_stream_feed(al_lzma_stream_t *s, const void *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	ELzmaStatus status;
+	SizeT start, limit, in;
+	size_t n;
+	SRes res;
+
+	AL_CHECK_RET((s != NULL) && ((data != NULL) || (len == 0)), EINVAL, -1);
+
+	if (s->err != 0) {
+		set_errno(s->err);
+		return -1;
+	}
+
+	if (s->hdr_len < AL_LZMA_HEADER_SIZE) {
+		n = min_t(size_t, len, AL_LZMA_HEADER_SIZE - s->hdr_len);
+
+		memcpy(s->hdr + s->hdr_len, p, n);
+		s->hdr_len += n;
+		p += n;
+		len -= n;
+
+		if ((s->hdr_len == AL_LZMA_HEADER_SIZE) && (lzma_stream_header(s) != 0)) {
+			return -1;
+		}
+	}
+
+	while ((len > 0) && !s->done) {
+		if (s->dec.dicPos == s->dec.dicBufSize) {
+			s->dec.dicPos = 0;
+		}
+
+		/* never decode past the size the header tells */
+		start = s->dec.dicPos;
+		limit = s->dec.dicBufSize;
+		if ((s->out_size != AL_LZMA_SIZE_UNKNOWN) &&
+			(s->out_size - s->out_len < limit - start)) {
+			limit = start + (SizeT)(s->out_size - s->out_len);
+		}
+
+		in = len;
+		res = LzmaDec_DecodeToDic(&s->dec, limit, p, &in, LZMA_FINISH_ANY, &status);
+		p += in;
+		len -= in;
+
+		n = s->dec.dicPos - start;
+		if (n > 0) {
+			s->crc = al_crc32(s->crc, s->dec.dic + start, n);
+			s->out_len += n;
+
+			if (s->write(s->ctx, s->dec.dic + start, n) != 0) {
+				return lzma_stream_fail(s, EIO);
+			}
+		}
+
+		if (res != SZ_OK) {
+			return lzma_stream_fail(s, EINVAL);
+		}
+
+		if (status == LZMA_STATUS_FINISHED_WITH_MARK) {
+			/* an end mark before the size is a corrupt stream */
+			if ((s->out_size != AL_LZMA_SIZE_UNKNOWN) && (s->out_len != s->out_size)) {
+				return lzma_stream_fail(s, EINVAL);
+			}
+
+			s->done = true;
+		} else if (s->out_len == s->out_size) {
+			s->done = true;
+		} else if ((in == 0) && (n == 0)) {
+			return lzma_stream_fail(s, EINVAL);
+		}
+	}
+
+	return 0;
+}
+
+int32_t al_lzma_stream_end(al_lzma_stream_t *s)
+{
+	AL_CHECK_RET(s != NULL, EINVAL, -1);
+
+	if (s->err != 0) {
+		set_errno(s->err);
+		return -1;
+	}
+
+	AL_CHECK_RET(s->done, EINVAL, -1);
+
+	return 0;
+}
+
+int64_t al_lzma_stream_decode(al_lzma_stream_t *s, al_lzma_read_t read,
+							  void *ctx, void *buf, size_t bufsz)
+{
+	ssize_t n;
+
+	AL_CHECK_RET((s != NULL) && (read != NULL), EINVAL, -1);
+	AL_CHECK_RET((buf != NULL) && (bufsz > 0), EINVAL, -1);
+
+	do {
+		n = read(ctx, buf, bufsz);
+		if (n < 0) {
+			return lzma_stream_fail(s, EIO);
+		}
+
+		if (al_lzma_stream_feed(s, buf, n) != 0) {
+			return -1;
+		}
+	} while ((n > 0) && !s->done);
+
+	if (al_lzma_stream_end(s) != 0) {
+		return -1;
+	}
+
+	return s->out_len;
+}
+
+static int32_t lzma_ymodem_out(void *ctx, const void *data, size_t len)
+{
+	al_lzma_ymodem_t *z = (al_lzma_ymodem_t *)ctx;
+	uint64_t size = al_lzma_stream_size(&z->lz);
+	const uint8_t *src = (const uint8_t *)data;
+	size_t n;
+
+	if (!z->open) {
+		if ((z->out->open != NULL) &&
+			(z->out->open(z->out->ctx, z->name,
+						  (size == AL_LZMA_SIZE_UNKNOWN) ? 0 : (size_t)size) != 0)) {
+			return -1;
+		}
+
+		z->open = true;
+	}
+
+	if (z->buf == NULL) {
+		return (len > 0) ? z->out->write(z->out->ctx, data, len) : 0;
+	}
+
+	/* only whole buffers, the sink behind may program in units */
+	while (len > 0) {
+		n = min_t(size_t, len, z->bufsz - z->blen);
+		memcpy(z->buf + z->blen, src, n);
+		z->blen += n;
+		src += n;
+		len -= n;
+
+		if (z->blen == z->bufsz) {
+			if (z->out->write(z->out->ctx, z->buf, z->blen) != 0) {
+				return -1;
+			}
+
+			z->blen = 0;
+		}
+	}
+
+	return 0;
+}
+
+/* the tail of the file, the last write may leave a partial unit */
+static int32_t lzma_ymodem_flush(al_lzma_ymodem_t *z)
+{
+	if (lzma_ymodem_out(z, NULL, 0) != 0) {
+		return -1;
+	}
+
+	if ((z->blen > 0) && (z->out->write(z->out->ctx, z->buf, z->blen) != 0)) {
+		return -1;
+	}
+
+	z->blen = 0;
+
+	return 0;
+}
+
+static int32_t lzma_ymodem_open(void *ctx, const char *filename, size_t filesize)
+{
+	al_lzma_ymodem_t *z = (al_lzma_ymodem_t *)ctx;
+
+	AL_CHECK_RET(strlen(filename) < sizeof(z->name), ENAMETOOLONG, -1);
+
+	strcpy(z->name, filename);
+	z->open = false;
+	z->blen = 0;
+
+	al_lzma_stream_reset(&z->lz);
+
+	return 0;
+}
+
+static int32_t lzma_ymodem_write(void *ctx, const void *data, size_t len)
+{
+	al_lzma_ymodem_t *z = (al_lzma_ymodem_t *)ctx;
+
+	return al_lzma_stream_feed(&z->lz, data, len);
+}
+
+static int32_t lzma_ymodem_close(void *ctx, bool ok)
+{
+	al_lzma_ymodem_t *z = (al_lzma_ymodem_t *)ctx;
+	int32_t ret = 0;
+
+	/* an empty output still makes a file */
+	if (ok && ((al_lzma_stream_end(&z->lz) != 0) || (lzma_ymodem_flush(z) != 0))) {
+		ok = false;
+		ret = -1;
+	}
+
+	if (z->open && (z->out->close != NULL) && (z->out->close(z->out->ctx, ok) != 0)) {
+		ret = -1;
+	}
+
+	z->open = false;
+
+	return ret;
+}
+
+int32_t al_lzma_ymodem_sink(al_ymodem_sink_t *sink, al_lzma_ymodem_t *z,
+							const al_ymodem_sink_t *out, void *mem, size_t memsz,
+							void *buf, size_t bufsz)
+{
+	AL_CHECK_RET((sink != NULL) && (z != NULL), EINVAL, -1);
+	AL_CHECK_RET((out != NULL) && (out->write != NULL), EINVAL, -1);
+	AL_CHECK_RET((buf == NULL) || (bufsz > 0), EINVAL, -1);
+
+	if (al_lzma_stream_init(&z->lz, mem, memsz, lzma_ymodem_out, z) != 0) {
+		return -1;
+	}
+
+	z->out = out;
+	z->buf = (uint8_t *)buf;
+	z->bufsz = bufsz;
+	z->blen = 0;
+	z->name[0] = '\0';
+	z->open = false;
+
+	sink->open = lzma_ymodem_open;
+	sink->write = lzma_ymodem_write;
+	sink->close = lzma_ymodem_close;
+	sink->ctx = z;
+
+	return 0;
+}
+
+__END_DECLS
@@ -0,0 +1,152 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/log2.h"
+#include "alumy/slab.h"
+#include "alumy/mem_stat.h"
+
+__BEGIN_DECLS
+
+#if defined(__GNUC__)
+#define stat_add(p, v)			__atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+#define stat_sub(p, v)			__atomic_sub_fetch((p), (v), __ATOMIC_RELAXED)
+#define stat_load(p)			__atomic_load_n((p), __ATOMIC_RELAXED)
+#define stat_cas(p, o, n)		__atomic_compare_exchange_n((p), (o), (n), \
+									true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#else
+#define stat_add(p, v)			(*(p) += (v))
+#define stat_sub(p, v)			(*(p) -= (v))
+#define stat_load(p)			(*(p))
+#define stat_cas(p, o, n)		((*(p) = (n)), true)
+#endif
+
+/* Keeps the memory behind it aligned like malloc() does */
+typedef union al_mem_tag_hdr {
+	size_t size;
+	long double ld;
+	void *p;
+	uint64_t u64;
+} al_mem_tag_hdr_t;
+
+static al_mem_tag_t *mem_tags = NULL;
+
+int_t al_mem_stat_bucket(size_t size)
+{
+	if (size <= 16) {
+		return 0;
+	}
+
+	if (size > ((size_t)16 << (AL_MEM_STAT_BUCKETS - 2))) {
+		return AL_MEM_STAT_BUCKETS - 1;
+	}
+
+	return order_base_2(size) - 4;
+}
+
+void al_mem_stat_alloc(al_mem_stat_t *stat, size_t size, size_t used)
+{
+	size_t cur, peak;
+
+	stat_add(&stat->hist[al_mem_stat_bucket(size)], 1);
+
+	if (used == 0) {
+		stat_add(&stat->nr_fail, 1);
+		return;
+	}
+
+	stat_add(&stat->nr_alloc, 1);
+	cur = stat_add(&stat->cur, used);
+
+	peak = stat_load(&stat->peak);
+	while ((cur > peak) && !stat_cas(&stat->peak, &peak, cur)) {
+		;
+	}
+}
+
+void al_mem_stat_free(al_mem_stat_t *stat, size_t used)
+{
+	stat_add(&stat->nr_free, 1);
+	stat_sub(&stat->cur, used);
+}
+
+void al_mem_stat_reset(al_mem_stat_t *stat)
+{
+	size_t cur = stat_load(&stat->cur);
+
+	stat->nr_alloc = 0;
+	stat->nr_free = 0;
+	stat->nr_fail = 0;
+	stat->peak = cur;
+	memset(stat->hist, 0, sizeof(stat->hist));
+}
+
+static void mem_tag_link(al_mem_tag_t *tag)
+{
+	uint32_t linked = 0;
+	al_mem_tag_t *head;
+
+	if (stat_load(&tag->linked) ||
+		!stat_cas(&tag->linked, &linked, 1)) {
+		return;
+	}
+
+	head = stat_load(&mem_tags);
+
+	do {
+		tag->next = head;
+#if defined(__GNUC__)
+	} while (!__atomic_compare_exchange_n(&mem_tags, &head, tag, true,
+										  __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+#else
+		mem_tags = tag;
+	} while (0);
+#endif
+}
+
+void *al_mem_tag_malloc(al_mem_tag_t *tag, size_t size)
+{
+	al_mem_tag_hdr_t *hdr = NULL;
+
+	mem_tag_link(tag);
+
+	if (size <= SIZE_MAX - sizeof(*hdr)) {
+		hdr = (al_mem_tag_hdr_t *)al_heap_malloc(sizeof(*hdr) + size);
+	}
+
+	if (hdr == NULL) {
+		al_mem_stat_alloc(&tag->stat, size, 0);
+		return NULL;
+	}
+
+	hdr->size = size;
+	al_mem_stat_alloc(&tag->stat, size, size);
+
+	return hdr + 1;
+}
+
+void al_mem_tag_free(al_mem_tag_t *tag, void *p)
+{
+	al_mem_tag_hdr_t *hdr;
+
+	if (p == NULL) {
+		return;
+	}
+
+	hdr = (al_mem_tag_hdr_t *)p - 1;
+	al_mem_stat_free(&tag->stat, hdr->size);
+
+	al_heap_free(hdr);
+}
+
+al_mem_tag_t *al_mem_tag_first(void)
+{
+#if defined(__GNUC__)
+	return __atomic_load_n(&mem_tags, __ATOMIC_ACQUIRE);
+#else
+	return mem_tags;
+#endif
+}
+
+__END_DECLS
+
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "alumy/config.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
@@ -19,6 +20,63 @@ enum {
   SLIP_RECV_ESCAPE
 };
 
+/* a word of the byte c in every lane, and a test for a zero lane */
+#define SLIP_ONES			((size_t)-1 / 0xFF)
+#define SLIP_LANES(c)		(SLIP_ONES * (c))
+#define SLIP_ZERO(w)		(((w) - SLIP_ONES) & ~(w) & (SLIP_ONES << 7))
+
+/* the length of the run before the first END or ESC, n for none */
+static size_t slip_scan(const uint8_t *p, size_t n)
+{
+	size_t i = 0, w;
+
+	/* a word at a time, the bytes to escape are rare in most payloads */
+	for (; i + sizeof(w) <= n; i += sizeof(w)) {
+		memcpy(&w, p + i, sizeof(w));
+
+		if (SLIP_ZERO(w ^ SLIP_LANES(SLIP_END)) |
+			SLIP_ZERO(w ^ SLIP_LANES(SLIP_ESC))) {
+			break;
+		}
+	}
+
+	for (; i < n; i++) {
+		if ((p[i] == SLIP_END) || (p[i] == SLIP_ESC)) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* escape from *in on until out is full, return the bytes put to out */
+static size_t slip_escape(uint8_t *out, size_t outsz,
+						  const uint8_t **in, const uint8_t *end)
+{
+	const uint8_t *p = *in;
+	size_t o = 0, run;
+
+	while (p < end) {
+		run = slip_scan(p, min_t(size_t, end - p, outsz - o));
+
+		memcpy(out + o, p, run);
+		o += run;
+		p += run;
+
+		/* done, out is full, or *p needs an escape that does not fit */
+		if ((p == end) || (o + 2 > outsz)) {
+			break;
+		}
+
+		out[o++] = SLIP_ESC;
+		out[o++] = (*p++ == SLIP_END) ? SLIP_ESC_END : SLIP_ESC_ESC;
+	}
+
+	*in = p;
+
+	return o;
+}
+
 int_t al_slip_init(al_slip_t *slip, void *recv_buf, size_t recv_size,
 				   const al_slip_opt_t *opt)
 {
@@ -26,8 +84,7 @@ int_t al_slip_init(al_slip_t *slip, void *recv_buf, size_t recv_size,
 	AL_CHECK_RET(recv_buf != NULL, EINVAL, -1);
 	AL_CHECK_RET(recv_size > 0, EINVAL, -1);
 	AL_CHECK_RET(opt != NULL, EINVAL, -1);
-	AL_CHECK_RET(opt->sl_putc != NULL, EINVAL, -1);
-	AL_CHECK_RET(opt->sl_getc != NULL, EINVAL, -1);
+	AL_CHECK_RET((opt->sl_putc != NULL) || (opt->sl_write != NULL), EINVAL, -1);
 
 	slip->recv_len = 0;
 	slip->recv_wp = 0;
@@ -41,11 +98,66 @@ int_t al_slip_init(al_slip_t *slip, void *recv_buf, size_t recv_size,
 	return 0;
 }
 
+ssize_t al_slip_encode(void *out, size_t outsz, const void *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	uint8_t *o = (uint8_t *)out;
+	size_t n;
+
+	AL_CHECK_RET((out != NULL) && ((data != NULL) || (len == 0)), EINVAL, -1);
+	AL_CHECK_RET(outsz >= 2, ENOBUFS, -1);
+
+	/* the delimiters take the first and the last byte */
+	n = 1 + slip_escape(o + 1, outsz - 2, &p, p + len);
+	AL_CHECK_RET(p == (const uint8_t *)data + len, ENOBUFS, -1);
+
+	o[0] = SLIP_END;
+	o[n++] = SLIP_END;
+
+	return n;
+}
+
+static size_t slip_write_bulk(al_slip_t *slip, const void *data, size_t len)
+{
+	uint8_t buf[AL_SLIP_WRITE_BUF];
+	const uint8_t *p = (const uint8_t *)data;
+	const uint8_t *end = p + len;
+	size_t n = 1;
+
+	buf[0] = SLIP_END;
+
+	for (;;) {
+		n += slip_escape(buf + n, sizeof(buf) - n, &p, end);
+
+		if ((p == end) && (n < sizeof(buf))) {
+			buf[n++] = SLIP_END;
+			break;
+		}
+
+		if (slip->opt->sl_write(buf, n) < 0) {
+			return 0;
+		}
+
+		n = 0;
+	}
+
+	if (slip->opt->sl_write(buf, n) < 0) {
+		return 0;
+	}
+
+	set_errno(0);
+	return len;
+}
+
 size_t al_slip_write(al_slip_t *slip, const void *data, size_t len)
 {
 	size_t i;
 	int_t c;
 
+	if (slip->opt->sl_write != NULL) {
+		return slip_write_bulk(slip, data, len);
+	}
+
 	/* Start with packet delimiter. */
 	slip->opt->sl_putc(SLIP_END);
 
@@ -134,7 +246,7 @@ size_t al_slip_recv_byte(al_slip_t *slip, int_t c)
 		break;
 	}
 
-	if (slip->recv_len <= slip->recv_size) {
+	if (slip->recv_len < slip->recv_size) {
 		((uint8_t *)slip->recv_buf)[slip->recv_wp] = c;
 
 		slip->recv_len++;
@@ -144,11 +256,47 @@ size_t al_slip_recv_byte(al_slip_t *slip, int_t c)
 	return 0;
 }
 
+size_t al_slip_decode(al_slip_t *slip, const void *data, size_t len,
+					  size_t *used)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	const uint8_t *end = p + len;
+	size_t run, n, frame = 0;
+
+	while ((p < end) && (frame == 0)) {
+		if (slip->recv_state == SLIP_RECV_NORMAL) {
+			run = slip_scan(p, end - p);
+
+			/* a frame longer than the buffer is cut, as byte by byte */
+			n = min_t(size_t, run, slip->recv_size - slip->recv_len);
+			memcpy((uint8_t *)slip->recv_buf + slip->recv_wp, p, n);
+			slip->recv_len += n;
+			slip->recv_wp += n;
+
+			p += run;
+			if (p == end) {
+				break;
+			}
+		}
+
+		/* a delimiter, an escape or the byte escaped */
+		frame = al_slip_recv_byte(slip, *p++);
+	}
+
+	if (used != NULL) {
+		*used = p - (const uint8_t *)data;
+	}
+
+	return frame;
+}
+
 size_t al_slip_recv(al_slip_t *slip)
 {
 	int_t c;
 	size_t len = 0;
 
+	AL_CHECK_RET(slip->opt->sl_getc != NULL, EINVAL, 0);
+
 	while (((c = slip->opt->sl_getc()) != EOF)) {
 		len = al_slip_recv_byte(slip, c);
 		if (len != 0) {
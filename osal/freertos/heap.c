@@ -1,3 +1,4 @@
+#include <string.h>
 #include "FreeRTOS.h"
 #include "task.h"
 #include "timers.h"
@@ -10,24 +11,47 @@
 
 __BEGIN_DECLS
 
+/*
+ * The port heap knows the bytes in use, only the request counters and the
+ * size histogram are kept here, cur and peak are filled in on query.
+ */
+static al_mem_stat_t heap_stat;
+
+static void *heap_done(void *p, size_t size)
+{
+	al_mem_stat_alloc(&heap_stat, size, p ? size : 0);
+
+	return p;
+}
+
 void *al_os_malloc(size_t size)
 {
-	return pvPortMalloc(size);
+	return heap_done(pvPortMalloc(size), size);
 }
 
 void al_os_free(void *p)
 {
+	if (p) {
+		al_mem_stat_free(&heap_stat, 0);
+	}
+
 	vPortFree(p);
 }
 
 void *al_os_calloc(size_t nmemb, size_t size)
 {
-    return pvPortCalloc(nmemb, size);
+    return heap_done(pvPortCalloc(nmemb, size), nmemb * size);
 }
 
 void *al_os_realloc(void *ptr, size_t size)
 {
-    return pvPortRealloc(ptr, size);
+	void *p = pvPortRealloc(ptr, size);
+
+	if (p && ptr) {
+		al_mem_stat_free(&heap_stat, 0);
+	}
+
+    return heap_done(p, size);
 }
 
 size_t al_os_get_free_heap_size(void)
@@ -40,5 +64,15 @@ size_t al_os_get_min_free_heap_size(void)
 	return xPortGetMinimumEverFreeHeapSize();
 }
 
+int32_t al_os_get_heap_stat(al_mem_stat_t *stat)
+{
+	memcpy(stat, &heap_stat, sizeof(*stat));
+
+	stat->cur = configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize();
+	stat->peak = configTOTAL_HEAP_SIZE - xPortGetMinimumEverFreeHeapSize();
+
+	return 0;
+}
+
 __END_DECLS
 
@@ -41,8 +41,7 @@ void al_vlog(int32_t pri, const char *fmt, va_list ap)
     static char buf[VLOG_SIZE];
     ssize_t n;
 
-    n = tfp_snprintf(
-            buf, sizeof(buf), "[%5u.%03u]", al_uptime(), al_tick_get_msec());
+    n = al_log_stamp(buf, sizeof(buf));
 
     SEGGER_RTT_Write(0, buf, n);
 
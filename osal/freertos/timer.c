@@ -156,5 +156,10 @@ int_t al_os_timer_reset_isr(al_os_timer_t *tmr, bool_t *yield)
 	return 0;
 }
 
-__END_DECLS
+int32_t al_os_timer_poll(void)
+{
+	/* the timer daemon task runs the timers and sleeps by itself */
+	return -1;
+}
 
+__END_DECLS
@@ -1,11 +1,67 @@
+#include <errno.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
 #include "alumy/osal.h"
+#include "osal_linux.h"
 
 __BEGIN_DECLS
 
+void al_os_linux_abstime(struct timespec *ts, int_t timeout)
+{
+	clock_gettime(AL_OS_LINUX_CLOCK, ts);
+
+	ts->tv_sec += timeout / 1000;
+	ts->tv_nsec += (long)(timeout % 1000) * 1000000L;
+
+	if (ts->tv_nsec >= 1000000000L) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000L;
+	}
+}
+
+int_t al_os_linux_cond_init(pthread_cond_t *cond)
+{
+	pthread_condattr_t attr;
+	int ret;
+
+	if (pthread_condattr_init(&attr) != 0) {
+		return -1;
+	}
+
+	pthread_condattr_setclock(&attr, AL_OS_LINUX_CLOCK);
+
+	ret = pthread_cond_init(cond, &attr);
+
+	pthread_condattr_destroy(&attr);
+
+	return (ret == 0) ? 0 : -1;
+}
+
+/* a task deleted in the wait unwinds with the mutex held, let it go */
+static void linux_cond_unlock(void *mutex)
+{
+	pthread_mutex_unlock((pthread_mutex_t *)mutex);
+}
+
+int_t al_os_linux_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+							const struct timespec *abstime)
+{
+	int ret = 0;
+
+	pthread_cleanup_push(linux_cond_unlock, mutex);
+
+	if (abstime == NULL) {
+		pthread_cond_wait(cond, mutex);
+	} else {
+		ret = pthread_cond_timedwait(cond, mutex, abstime);
+	}
+
+	pthread_cleanup_pop(0);
+
+	return (ret == ETIMEDOUT) ? -1 : 0;
+}
 
 __END_DECLS
 
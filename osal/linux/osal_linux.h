@@ -0,0 +1,55 @@
+#ifndef __AL_OSAL_LINUX_H
+#define __AL_OSAL_LINUX_H 1
+
+#include <time.h>
+#include <pthread.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+
+__BEGIN_DECLS
+
+/*
+ * All blocking primitives of the linux osal wait on CLOCK_MONOTONIC, so
+ * a wall clock step (ntp, date -s) never shortens or stretches a timeout.
+ */
+#define AL_OS_LINUX_CLOCK		CLOCK_MONOTONIC
+
+/**
+ * @brief Convert a relative timeout in ms to an absolute monotonic time
+ *
+ * @param ts The absolute time to fill
+ * @param timeout The relative timeout in ms, must be positive
+ */
+void al_os_linux_abstime(struct timespec *ts, int_t timeout);
+
+/**
+ * @brief Initialize a condition variable waiting on AL_OS_LINUX_CLOCK
+ *
+ * @param cond The condition variable to initialize
+ *
+ * @return int_t Return 0 on success, otherwise return -1
+ */
+int_t al_os_linux_cond_init(pthread_cond_t *cond);
+
+/**
+ * @brief Wait on a condition variable with the osal timeout semantic
+ *
+ * The mutex must be held by the caller. A negative timeout waits forever,
+ * a positive timeout is an absolute deadline computed by
+ * al_os_linux_abstime(). The wait is a cancellation point, a task deleted
+ * in it releases the mutex on the way out.
+ *
+ * @param cond The condition variable
+ * @param mutex The mutex protecting the condition
+ * @param abstime The deadline, NULL to wait forever
+ *
+ * @return int_t Return 0 on wakeup, return -1 on timeout
+ */
+int_t al_os_linux_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+							const struct timespec *abstime);
+
+__END_DECLS
+
+#endif
+
@@ -1,89 +1,301 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
+#include "alumy/errno.h"
 #include "alumy/osal.h"
+#include "osal_linux.h"
 
 __BEGIN_DECLS
 
+typedef struct al_os_queue_linux {
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+	uint_t num;
+	uint_t head;
+	uint_t count;
+	size_t size;
+	uint8_t *buf;
+} al_os_queue_linux_t;
+
+__static_inline__ uint8_t *queue_slot(al_os_queue_linux_t *q, uint_t idx)
+{
+	return q->buf + (size_t)(idx % q->num) * q->size;
+}
+
+/*
+ * Wait with the queue lock held while blocked() is true, return 0 when the
+ * queue becomes usable and -1 when the timeout expired first.
+ */
+static int_t queue_wait(al_os_queue_linux_t *q, pthread_cond_t *cond,
+						bool_t (*blocked)(al_os_queue_linux_t *q),
+						int_t timeout)
+{
+	struct timespec ts;
+
+	if (!blocked(q)) {
+		return 0;
+	}
+
+	if (timeout == 0) {
+		return -1;
+	}
+
+	if (timeout > 0) {
+		al_os_linux_abstime(&ts, timeout);
+	}
+
+	while (blocked(q)) {
+		if (al_os_linux_cond_wait(cond, &q->lock,
+								  (timeout > 0) ? &ts : NULL) != 0) {
+			return blocked(q) ? -1 : 0;
+		}
+	}
+
+	return 0;
+}
+
+static bool_t queue_is_full(al_os_queue_linux_t *q)
+{
+	return q->count >= q->num;
+}
+
+static bool_t queue_is_empty(al_os_queue_linux_t *q)
+{
+	return q->count == 0;
+}
+
+static int_t queue_send(al_os_queue_t queue, const void *data,
+						int_t timeout, bool_t front)
+{
+	al_os_queue_linux_t *q = (al_os_queue_linux_t *)queue;
+
+	if (q == NULL) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&q->lock);
+
+	if (queue_wait(q, &q->not_full, queue_is_full, timeout) != 0) {
+		pthread_mutex_unlock(&q->lock);
+		return -1;
+	}
+
+	if (front) {
+		q->head = (q->head + q->num - 1) % q->num;
+		memcpy(queue_slot(q, q->head), data, q->size);
+	} else {
+		memcpy(queue_slot(q, q->head + q->count), data, q->size);
+	}
+
+	q->count++;
+
+	pthread_cond_signal(&q->not_empty);
+	pthread_mutex_unlock(&q->lock);
+
+	return 0;
+}
+
+static int_t queue_recv(al_os_queue_t queue, void *data,
+						int_t timeout, bool_t peek)
+{
+	al_os_queue_linux_t *q = (al_os_queue_linux_t *)queue;
+
+	if (q == NULL) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&q->lock);
+
+	if (queue_wait(q, &q->not_empty, queue_is_empty, timeout) != 0) {
+		pthread_mutex_unlock(&q->lock);
+		return -1;
+	}
+
+	memcpy(data, queue_slot(q, q->head), q->size);
+
+	if (!peek) {
+		q->head = (q->head + 1) % q->num;
+		q->count--;
+
+		pthread_cond_signal(&q->not_full);
+	} else {
+		/* the item is still there, pass the wakeup on to a receiver */
+		pthread_cond_signal(&q->not_empty);
+	}
+
+	pthread_mutex_unlock(&q->lock);
+
+	return 0;
+}
+
 al_os_queue_t al_os_queue_create(uint_t num, size_t size)
 {
-	return NULL;
+	al_os_queue_linux_t *q;
+
+	if ((num == 0) || (size == 0)) {
+		set_errno(EINVAL);
+		return NULL;
+	}
+
+	q = (al_os_queue_linux_t *)calloc(1, sizeof(*q));
+	if (q == NULL) {
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	q->buf = (uint8_t *)malloc((size_t)num * size);
+	if (q->buf == NULL) {
+		free(q);
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	q->num = num;
+	q->size = size;
+
+	pthread_mutex_init(&q->lock, NULL);
+	al_os_linux_cond_init(&q->not_empty);
+	al_os_linux_cond_init(&q->not_full);
+
+	return (al_os_queue_t)q;
 }
 
 int_t al_os_queue_del(al_os_queue_t queue)
 {
+	al_os_queue_linux_t *q = (al_os_queue_linux_t *)queue;
+
+	if (q == NULL) {
+		return -1;
+	}
+
+	pthread_cond_destroy(&q->not_full);
+	pthread_cond_destroy(&q->not_empty);
+	pthread_mutex_destroy(&q->lock);
+
+	free(q->buf);
+	free(q);
+
 	return 0;
 }
 
 int_t al_os_queue_send(al_os_queue_t queue, const void *data, int_t timeout)
 {
-	return 0;
+	return queue_send(queue, data, timeout, false);
 }
 
 int_t al_os_queue_send_isr(al_os_queue_t queue, const void *data,
 						   bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return queue_send(queue, data, 0, false);
 }
 
 int_t al_os_queue_send_back(al_os_queue_t queue,
 							const void *data, int_t timeout)
 {
-	return 0;
+	return queue_send(queue, data, timeout, false);
 }
 
 int_t al_os_queue_send_back_isr(al_os_queue_t queue,
 								const void *data, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return queue_send(queue, data, 0, false);
 }
 
 int_t al_os_queue_send_front(al_os_queue_t queue,
 							 const void *data, int_t timeout)
 {
-	return 0;
+	return queue_send(queue, data, timeout, true);
 }
 
 int_t al_os_queue_send_front_isr(al_os_queue_t queue,
 								 const void *data, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return queue_send(queue, data, 0, true);
 }
 
 int_t al_os_queue_recv(al_os_queue_t queue, void *data, int_t timeout)
 {
-	return 0;
+	return queue_recv(queue, data, timeout, false);
 }
 
 int_t al_os_queue_recv_isr(al_os_queue_t queue, void *data, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return queue_recv(queue, data, 0, false);
 }
 
 int_t al_os_queue_count(al_os_queue_t queue)
 {
-	return 0;
+	al_os_queue_linux_t *q = (al_os_queue_linux_t *)queue;
+	int_t count;
+
+	if (q == NULL) {
+		return 0;
+	}
+
+	pthread_mutex_lock(&q->lock);
+	count = (int_t)q->count;
+	pthread_mutex_unlock(&q->lock);
+
+	return count;
 }
 
 int_t al_os_queue_count_isr(al_os_queue_t queue, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_queue_count(queue);
 }
 
 int_t al_os_queue_reset(al_os_queue_t queue)
 {
+	al_os_queue_linux_t *q = (al_os_queue_linux_t *)queue;
+
+	if (q == NULL) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&q->lock);
+
+	q->head = 0;
+	q->count = 0;
+
+	pthread_cond_broadcast(&q->not_full);
+	pthread_mutex_unlock(&q->lock);
+
 	return 0;
 }
 
 int_t al_os_queue_peek(al_os_queue_t queue, void *data, int_t timeout)
 {
-	return 0;
+	return queue_recv(queue, data, timeout, true);
 }
 
 int_t al_os_queue_peek_isr(al_os_queue_t queue, void *data)
 {
-	return 0;
+	return queue_recv(queue, data, 0, true);
 }
 
 __END_DECLS
@@ -1,79 +1,229 @@
+#include <stdlib.h>
+#include <pthread.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
+#include "alumy/errno.h"
 #include "alumy/osal.h"
+#include "osal_linux.h"
 
 __BEGIN_DECLS
 
+/*
+ * Semaphores and mutexes share one counting object. A mutex is a semaphore
+ * with max_count 1 which starts available, as the FreeRTOS port does.
+ */
+typedef struct al_os_sem_linux {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint_t count;
+	uint_t max_count;
+} al_os_sem_linux_t;
+
+static al_os_sem_linux_t *sem_create(uint_t max_count, uint_t init_count)
+{
+	al_os_sem_linux_t *s;
+
+	if ((max_count == 0) || (init_count > max_count)) {
+		set_errno(EINVAL);
+		return NULL;
+	}
+
+	s = (al_os_sem_linux_t *)malloc(sizeof(*s));
+	if (s == NULL) {
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	pthread_mutex_init(&s->lock, NULL);
+
+	if (al_os_linux_cond_init(&s->cond) != 0) {
+		pthread_mutex_destroy(&s->lock);
+		free(s);
+		return NULL;
+	}
+
+	s->count = init_count;
+	s->max_count = max_count;
+
+	return s;
+}
+
+static void sem_del(al_os_sem_linux_t *s)
+{
+	if (s == NULL) {
+		return;
+	}
+
+	pthread_cond_destroy(&s->cond);
+	pthread_mutex_destroy(&s->lock);
+
+	free(s);
+}
+
+static int_t sem_take(al_os_sem_linux_t *s, int_t timeout)
+{
+	struct timespec ts;
+	int_t ret = 0;
+
+	if (s == NULL) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&s->lock);
+
+	if ((s->count == 0) && (timeout > 0)) {
+		al_os_linux_abstime(&ts, timeout);
+	}
+
+	while (s->count == 0) {
+		if (timeout == 0) {
+			ret = -1;
+			break;
+		}
+
+		if ((al_os_linux_cond_wait(&s->cond, &s->lock,
+								   (timeout > 0) ? &ts : NULL) != 0) &&
+			(s->count == 0)) {
+			ret = -1;
+			break;
+		}
+	}
+
+	if (ret == 0) {
+		s->count--;
+	}
+
+	pthread_mutex_unlock(&s->lock);
+
+	return ret;
+}
+
+static int_t sem_give(al_os_sem_linux_t *s)
+{
+	int_t ret = 0;
+
+	if (s == NULL) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&s->lock);
+
+	if (s->count < s->max_count) {
+		s->count++;
+		pthread_cond_signal(&s->cond);
+	} else {
+		ret = -1;
+	}
+
+	pthread_mutex_unlock(&s->lock);
+
+	return ret;
+}
+
 al_os_mutex_t al_os_mutex_create(void)
 {
-	return NULL;
+	return (al_os_mutex_t)sem_create(1, 1);
 }
 
 void al_os_mutex_del(al_os_mutex_t mutex)
 {
-
+	sem_del((al_os_sem_linux_t *)mutex);
 }
 
 al_os_sem_t al_os_sem_bin_create(void)
 {
-	return NULL;
+	return (al_os_sem_t)sem_create(1, 0);
 }
 
 void al_os_sem_bin_del(al_os_sem_t sem)
 {
-
+	sem_del((al_os_sem_linux_t *)sem);
 }
 
 al_os_sem_t al_os_sem_count_create(uint_t max_count, uint_t init_count)
 {
-	return NULL;
+	return (al_os_sem_t)sem_create(max_count, init_count);
 }
 
 void al_os_sem_count_del(al_os_sem_t sem)
 {
-
+	sem_del((al_os_sem_linux_t *)sem);
 }
 
 int_t al_os_sem_take(al_os_sem_t sem, int_t timeout)
 {
-	return 0;
+	return sem_take((al_os_sem_linux_t *)sem, timeout);
 }
 
 int_t al_os_sem_take_isr(al_os_sem_t sem, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return sem_take((al_os_sem_linux_t *)sem, 0);
 }
 
 int_t al_os_sem_give(al_os_sem_t sem)
 {
-	return 0;
+	return sem_give((al_os_sem_linux_t *)sem);
 }
 
 int_t al_os_sem_give_isr(al_os_sem_t sem, bool_t *yield)
 {
+	if (yield) {
+		*yield = false;
+	}
+
+	return sem_give((al_os_sem_linux_t *)sem);
+}
+
+int_t al_os_sem_reset(al_os_sem_t sem)
+{
+	while (al_os_sem_take(sem, 0) == 0) {
+		;
+	}
+
 	return 0;
 }
 
-int_t al_os_mutex_take(al_os_mutex_t mutex, int_t timeout)
+int_t al_os_sem_reset_isr(al_os_sem_t sem)
 {
+	while (al_os_sem_take_isr(sem, NULL) == 0) {
+		;
+	}
+
 	return 0;
 }
 
+int_t al_os_mutex_take(al_os_mutex_t mutex, int_t timeout)
+{
+	return sem_take((al_os_sem_linux_t *)mutex, timeout);
+}
+
 int_t al_os_mutex_take_isr(al_os_mutex_t mutex, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return sem_take((al_os_sem_linux_t *)mutex, 0);
 }
 
 int_t al_os_mutex_give(al_os_mutex_t mutex)
 {
-	return 0;
+	return sem_give((al_os_sem_linux_t *)mutex);
 }
 
 int_t al_os_mutex_give_isr(al_os_mutex_t mutex, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return sem_give((al_os_sem_linux_t *)mutex);
 }
 
 __END_DECLS
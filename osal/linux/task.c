@@ -1,3 +1,11 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
@@ -5,20 +13,128 @@
 #include "alumy/bug.h"
 #include "alumy/check.h"
 #include "alumy/osal.h"
+#include "osal_linux.h"
 
 __BEGIN_DECLS
 
+/*
+ * The handle given back to the caller points at the first member, so
+ * al_os_task_delete() can find the thread with container_of(). The thread
+ * and the handle each hold a reference, the structure is freed when both
+ * are gone, so the handle stays valid after the thread returned until it
+ * is deleted. A task deleting itself gives up its handle as well, like
+ * vTaskDelete(NULL) does.
+ */
+typedef struct al_os_task_linux {
+	al_os_task_t handle;
+	pthread_t tid;
+	uint32_t prio;
+	void (*func)(void *arg);
+	void *arg;
+	int_t refs;			/* the thread and the handle, under task_lock */
+	bool exited;		/* tid is gone, never cancel it */
+	char name[16];
+} al_os_task_linux_t;
+
+static pthread_mutex_t task_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread al_os_task_linux_t *task_self;
+
+/* drop a reference, the last one frees the task */
+static void task_put(al_os_task_linux_t *task, bool exited)
+{
+	int_t refs;
+
+	pthread_mutex_lock(&task_lock);
+
+	if (exited) {
+		task->exited = true;
+	}
+
+	refs = --task->refs;
+
+	pthread_mutex_unlock(&task_lock);
+
+	if (refs == 0) {
+		free(task);
+	}
+}
+
+static void task_cleanup(void *arg)
+{
+	task_put((al_os_task_linux_t *)arg, true);
+}
+
+static void *task_entry(void *arg)
+{
+	al_os_task_linux_t *task = (al_os_task_linux_t *)arg;
+
+	task_self = task;
+
+	pthread_cleanup_push(task_cleanup, task);
+
+#if defined(__GLIBC__)
+	if (task->name[0] != '\0') {
+		pthread_setname_np(pthread_self(), task->name);
+	}
+#endif
+
+	task->func(task->arg);
+
+	pthread_cleanup_pop(1);
+
+	return NULL;
+}
+
+static void delay_ms(int32_t ms)
+{
+	struct timespec ts;
+
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+
+	while (clock_nanosleep(AL_OS_LINUX_CLOCK, 0, &ts, &ts) == EINTR) {
+		;
+	}
+}
+
 void al_os_delay(int32_t ms)
 {
+	if (ms < 0) {
+		for (;;) {
+			pause();
+		}
+	}
+
+	if (ms == 0) {
+		sched_yield();
+		return;
+	}
+
+	delay_ms(ms);
 }
 
 void al_os_delay_until(al_os_tick_t *prev, int32_t ms)
 {
+	int32_t remain;
+
+	if (ms < 0) {
+		al_os_delay(ms);
+		return;
+	}
+
+	*prev += al_os_ms2tick(ms);
+
+	remain = (int32_t)(*prev - al_os_get_tick());
+	if (remain > 0) {
+		delay_ms((int32_t)al_os_tick2ms(remain));
+	}
 }
 
 void al_os_yield_isr(bool_t yield)
 {
-
+	if (yield) {
+		sched_yield();
+	}
 }
 
 al_os_task_t *al_os_task_create(const char *name,
@@ -27,25 +143,120 @@ al_os_task_t *al_os_task_create(const char *name,
                                 void (*func)(void *arg),
                                 void *arg)
 {
-	return 0;
+	al_os_task_linux_t *task;
+	pthread_attr_t attr;
+	size_t dft_stack;
+	int ret;
+
+	AL_CHECK_RET(func, EINVAL, NULL);
+
+	task = (al_os_task_linux_t *)calloc(1, sizeof(*task));
+	if (task == NULL) {
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	task->handle = task;
+	task->refs = 2;
+	task->prio = prio;
+	task->func = func;
+	task->arg = arg;
+
+	if (name) {
+		strncpy(task->name, name, sizeof(task->name) - 1);
+	}
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+	/*
+	 * Stack sizes are tuned for mcu targets, only grow the default stack
+	 * of the host, never shrink it below what libc needs.
+	 */
+	if ((pthread_attr_getstacksize(&attr, &dft_stack) == 0) &&
+		(stack > dft_stack)) {
+		pthread_attr_setstacksize(&attr, stack);
+	}
+
+	ret = pthread_create(&task->tid, &attr, task_entry, task);
+
+	pthread_attr_destroy(&attr);
+
+	if (ret != 0) {
+		free(task);
+		set_errno(EPERM);
+		return NULL;
+	}
+
+	return &task->handle;
 }
 
 int32_t al_os_task_delete(al_os_task_t *handle)
 {
+	al_os_task_linux_t *task;
+	int_t ret = 0;
+
+	if ((handle == NULL) ||
+		(container_of(handle, al_os_task_linux_t, handle) == task_self)) {
+		/* the thread reference goes in task_cleanup() */
+		if (task_self != NULL) {
+			task_put(task_self, false);
+		}
+
+		pthread_exit(NULL);
+	}
+
+	task = container_of(handle, al_os_task_linux_t, handle);
+
+	pthread_mutex_lock(&task_lock);
+
+	/* the thread can't finish exiting while the lock is held */
+	if (!task->exited && (pthread_cancel(task->tid) != 0)) {
+		ret = -1;
+	}
+
+	pthread_mutex_unlock(&task_lock);
+
+	task_put(task, false);
+
+	if (ret != 0) {
+		set_errno(ESRCH);
+		return -1;
+	}
+
 	return 0;
 }
 
 uint32_t al_os_task_get_prio(al_os_task_t handle)
 {
-	return 0;
+	al_os_task_linux_t *task = (al_os_task_linux_t *)handle;
+
+	return task ? task->prio : 0;
 }
 
 void al_os_set_timeout_state(al_os_timeout_t *timeout)
 {
+	*timeout = al_os_get_tick();
 }
 
 bool_t al_os_check_timeout(al_os_timeout_t *timeout, al_os_tick_t *tick)
 {
+	al_os_tick_t now = al_os_get_tick();
+	al_os_tick_t elapsed = now - (al_os_tick_t)*timeout;
+
+	if (*tick == (al_os_tick_t)-1) {
+		/* wait forever */
+		return false;
+	}
+
+	if (elapsed >= *tick) {
+		*tick = 0;
+		return true;
+	}
+
+	*tick -= elapsed;
+	*timeout = now;
+
 	return false;
 }
 
@@ -1,19 +1,26 @@
+#include <time.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
 #include "alumy/osal.h"
+#include "osal_linux.h"
 
 __BEGIN_DECLS
 
+/* The linux osal runs with a 1 ms tick taken from CLOCK_MONOTONIC */
 al_os_tick_t al_os_get_tick(void)
 {
-	return 0;
+	struct timespec ts;
+
+	clock_gettime(AL_OS_LINUX_CLOCK, &ts);
+
+	return (al_os_tick_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
 }
 
 al_os_tick_t al_os_get_tick_isr(void)
 {
-	return 0;
+	return al_os_get_tick();
 }
 
 al_os_tick_t al_os_ms2tick(uint32_t ms)
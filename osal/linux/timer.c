@@ -1,63 +1,282 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
+#include "alumy/errno.h"
 #include "alumy/osal.h"
+#include "alumy/timer_wheel.h"
+#include "osal_linux.h"
 
 __BEGIN_DECLS
 
+/*
+ * The timers hang in one timer wheel, one service thread sleeps until the
+ * next expiry and runs the callbacks, like the FreeRTOS timer daemon task
+ * does. The callbacks run under the recursive lock, so a timer deleted by
+ * another thread is never freed under a running callback.
+ */
+typedef struct al_os_timer_linux {
+	al_os_timer_t tmr;
+	al_timer_t t;
+	uint_t period;
+	bool_t auto_reload;
+} al_os_timer_linux_t;
+
+static struct {
+	pthread_once_t once;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t tid;
+	int_t err;
+	al_timer_wheel_t wheel;
+} timer_svc = {
+	.once = PTHREAD_ONCE_INIT,
+	.lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP,
+};
+
+static uint64_t timer_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(AL_OS_LINUX_CLOCK, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void *timer_svc_task(void *arg)
+{
+	struct timespec ts;
+	uint64_t next;
+
+	UNUSED(arg);
+
+	pthread_mutex_lock(&timer_svc.lock);
+
+	for (;;) {
+		al_timer_wheel_advance(&timer_svc.wheel, timer_now());
+
+		next = al_timer_wheel_next(&timer_svc.wheel);
+
+		if (next == AL_TIMER_NEVER) {
+			al_os_linux_cond_wait(&timer_svc.cond, &timer_svc.lock, NULL);
+		} else {
+			ts.tv_sec = next / 1000;
+			ts.tv_nsec = (long)(next % 1000) * 1000000L;
+
+			al_os_linux_cond_wait(&timer_svc.cond, &timer_svc.lock, &ts);
+		}
+	}
+
+	return NULL;
+}
+
+static void timer_svc_init(void)
+{
+	pthread_attr_t attr;
+
+	al_timer_wheel_init(&timer_svc.wheel, timer_now());
+
+	if (al_os_linux_cond_init(&timer_svc.cond) != 0) {
+		goto err;
+	}
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+	if (pthread_create(&timer_svc.tid, &attr, timer_svc_task, NULL) != 0) {
+		pthread_attr_destroy(&attr);
+		goto err;
+	}
+
+	pthread_attr_destroy(&attr);
+
+	return;
+
+err:
+	timer_svc.err = -1;
+}
+
+static void timer_svc_func(al_timer_t *t, void *arg)
+{
+	al_os_timer_linux_t *l = (al_os_timer_linux_t *)arg;
+
+	UNUSED(t);
+
+	if (l->tmr.cb) {
+		l->tmr.cb(l->tmr.arg);
+	}
+}
+
+static int_t timer_arm(al_os_timer_linux_t *t, uint_t period)
+{
+	int_t ret = 0;
+
+	pthread_mutex_lock(&timer_svc.lock);
+
+	if (period) {
+		ret = al_timer_add(&timer_svc.wheel, &t->t, timer_now() + period,
+						   t->auto_reload ? period : 0);
+
+		/* the service thread may sleep past the new expiry */
+		pthread_cond_signal(&timer_svc.cond);
+	} else {
+		al_timer_del(&timer_svc.wheel, &t->t);
+	}
+
+	pthread_mutex_unlock(&timer_svc.lock);
+
+	return ret;
+}
+
 al_os_timer_t *al_os_timer_create(const char *name,
 								  uint_t period, bool_t auto_reload,
 								  al_os_timer_cb cb, void *arg)
 {
-	return NULL;
+	al_os_timer_linux_t *t;
+
+	UNUSED(name);
+
+	if (period == 0) {
+		set_errno(EINVAL);
+		return NULL;
+	}
+
+	pthread_once(&timer_svc.once, timer_svc_init);
+	if (timer_svc.err) {
+		set_errno(EPERM);
+		return NULL;
+	}
+
+	t = (al_os_timer_linux_t *)calloc(1, sizeof(*t));
+	if (t == NULL) {
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	t->tmr.handle = t;
+	t->tmr.cb = cb;
+	t->tmr.arg = arg;
+	t->period = period;
+	t->auto_reload = auto_reload;
+
+	al_timer_init(&t->t, timer_svc_func, t);
+
+	return &t->tmr;
 }
 
 int_t al_os_timer_del(al_os_timer_t *tmr)
 {
+	al_os_timer_linux_t *t = (al_os_timer_linux_t *)tmr->handle;
+
+	pthread_mutex_lock(&timer_svc.lock);
+
+	al_timer_del(&timer_svc.wheel, &t->t);
+	free(t);
+
+	pthread_mutex_unlock(&timer_svc.lock);
+
 	return 0;
 }
 
 int_t al_os_timer_start(al_os_timer_t *tmr)
 {
-	return 0;
+	al_os_timer_linux_t *t = (al_os_timer_linux_t *)tmr->handle;
+
+	return timer_arm(t, t->period);
 }
 
 int_t al_os_timer_stop(al_os_timer_t *tmr)
 {
-	return 0;
+	al_os_timer_linux_t *t = (al_os_timer_linux_t *)tmr->handle;
+
+	return timer_arm(t, 0);
 }
 
 int_t al_os_timer_start_isr(al_os_timer_t *tmr, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_start(tmr);
 }
 
 int_t al_os_timer_stop_isr(al_os_timer_t *tmr, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_stop(tmr);
 }
 
 int_t al_os_timer_set_period(al_os_timer_t *tmr, uint_t period)
 {
-	return 0;
+	al_os_timer_linux_t *t = (al_os_timer_linux_t *)tmr->handle;
+
+	if (period == 0) {
+		return -1;
+	}
+
+	t->period = period;
+
+	/* changing the period also starts the timer */
+	return timer_arm(t, period);
 }
 
 int_t al_os_timer_set_period_isr(al_os_timer_t *tmr,
 								 uint_t period, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_set_period(tmr, period);
 }
 
 int_t al_os_timer_reset(al_os_timer_t *tmr)
 {
-	return 0;
+	return al_os_timer_start(tmr);
 }
 
 int_t al_os_timer_reset_isr(al_os_timer_t *tmr, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_reset(tmr);
 }
 
-__END_DECLS
+int32_t al_os_timer_poll(void)
+{
+	uint64_t now, next;
+
+	/* the service thread runs the timers, only report the next expiry */
+	pthread_once(&timer_svc.once, timer_svc_init);
+	if (timer_svc.err) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&timer_svc.lock);
+	next = al_timer_wheel_next(&timer_svc.wheel);
+	pthread_mutex_unlock(&timer_svc.lock);
+
+	now = timer_now();
 
+	if (next == AL_TIMER_NEVER) {
+		return -1;
+	}
+
+	if (next <= now) {
+		return 0;
+	}
+
+	return (int32_t)min_t(uint64_t, next - now, INT32_MAX);
+}
+
+__END_DECLS
@@ -1,39 +1,152 @@
 #include <stdlib.h>
+#include <string.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
+#include "alumy/errno.h"
 #include "alumy/osal.h"
 
 __BEGIN_DECLS
 
+/*
+ * Every block carries its size in front so the heap can account what is
+ * in use. The union keeps the memory behind it aligned like malloc().
+ */
+typedef union heap_hdr {
+	size_t size;
+	long double ld;
+	void *p;
+	uint64_t u64;
+} heap_hdr_t;
+
+static al_mem_stat_t heap_stat;
+
+static bool_t heap_fits(size_t size)
+{
+	if (size > SIZE_MAX - sizeof(heap_hdr_t)) {
+		return false;
+	}
+
+#if AL_OS_HEAP_SIZE > 0
+	if (size > AL_OS_HEAP_SIZE - min_t(size_t, AL_OS_HEAP_SIZE,
+									   __atomic_load_n(&heap_stat.cur,
+													   __ATOMIC_RELAXED))) {
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+static void *heap_done(heap_hdr_t *hdr, size_t size)
+{
+	if (hdr == NULL) {
+		al_mem_stat_alloc(&heap_stat, size, 0);
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	hdr->size = size;
+	al_mem_stat_alloc(&heap_stat, size, size);
+
+	return hdr + 1;
+}
+
 void *al_os_malloc(size_t size)
 {
-	return malloc(size);
+	heap_hdr_t *hdr = NULL;
+
+	if (heap_fits(size)) {
+		hdr = (heap_hdr_t *)malloc(sizeof(*hdr) + size);
+	}
+
+	return heap_done(hdr, size);
 }
 
 void al_os_free(void *p)
 {
-	free(p);
+	heap_hdr_t *hdr;
+
+	if (p == NULL) {
+		return;
+	}
+
+	hdr = (heap_hdr_t *)p - 1;
+	al_mem_stat_free(&heap_stat, hdr->size);
+
+	free(hdr);
 }
 
 void *al_os_calloc(size_t nmemb, size_t size)
 {
-    return calloc(nmemb, size);
+	heap_hdr_t *hdr = NULL;
+
+	if ((size == 0) || (nmemb <= SIZE_MAX / size)) {
+		if (heap_fits(nmemb * size)) {
+			hdr = (heap_hdr_t *)calloc(1, sizeof(*hdr) + nmemb * size);
+		}
+	}
+
+	return heap_done(hdr, nmemb * size);
 }
 
 void *al_os_realloc(void *ptr, size_t size)
 {
-    return realloc(ptr, size);
+	heap_hdr_t *hdr;
+	size_t old;
+
+	if (ptr == NULL) {
+		return al_os_malloc(size);
+	}
+
+	hdr = (heap_hdr_t *)ptr - 1;
+	old = hdr->size;
+
+	if ((size > old) && !heap_fits(size - old)) {
+		al_mem_stat_alloc(&heap_stat, size, 0);
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	hdr = (heap_hdr_t *)realloc(hdr, sizeof(*hdr) + size);
+	if (hdr == NULL) {
+		al_mem_stat_alloc(&heap_stat, size, 0);
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	al_mem_stat_free(&heap_stat, old);
+
+	return heap_done(hdr, size);
 }
 
 size_t al_os_get_free_heap_size(void)
 {
-	return 0;
+#if AL_OS_HEAP_SIZE > 0
+	size_t cur = __atomic_load_n(&heap_stat.cur, __ATOMIC_RELAXED);
+
+	return AL_OS_HEAP_SIZE - min_t(size_t, AL_OS_HEAP_SIZE, cur);
+#else
+	return AL_OS_HEAP_SIZE_UNKNOWN;
+#endif
 }
 
 size_t al_os_get_min_free_heap_size(void)
 {
+#if AL_OS_HEAP_SIZE > 0
+	size_t peak = __atomic_load_n(&heap_stat.peak, __ATOMIC_RELAXED);
+
+	return AL_OS_HEAP_SIZE - min_t(size_t, AL_OS_HEAP_SIZE, peak);
+#else
+	return AL_OS_HEAP_SIZE_UNKNOWN;
+#endif
+}
+
+int32_t al_os_get_heap_stat(al_mem_stat_t *stat)
+{
+	memcpy(stat, &heap_stat, sizeof(*stat));
+
 	return 0;
 }
 
@@ -2,62 +2,179 @@
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
 #include "alumy/osal.h"
+#include "alumy/time/tick.h"
+#include "alumy/timer_wheel.h"
 
 __BEGIN_DECLS
 
+/*
+ * The timers hang in one timer wheel, the main loop runs them with
+ * al_os_timer_poll(). Nothing guards the wheel, so the _isr variants may
+ * only be used from an interrupt that cannot preempt al_os_timer_poll().
+ */
+typedef struct al_os_timer_none {
+	al_os_timer_t tmr;
+	al_timer_t t;
+	uint_t period;
+	bool_t auto_reload;
+} al_os_timer_none_t;
+
+static al_timer_wheel_t timer_wheel;
+static bool_t timer_wheel_ready = false;
+
+static void timer_none_func(al_timer_t *t, void *arg)
+{
+	al_os_timer_none_t *n = (al_os_timer_none_t *)arg;
+
+	UNUSED(t);
+
+	if (n->tmr.cb) {
+		n->tmr.cb(n->tmr.arg);
+	}
+}
+
+static int_t timer_arm(al_os_timer_none_t *n)
+{
+	return al_timer_add(&timer_wheel, &n->t, al_tick_get_tick64() + n->period,
+						n->auto_reload ? n->period : 0);
+}
+
 al_os_timer_t *al_os_timer_create(const char *name,
 								  uint_t period, bool_t auto_reload,
 								  al_os_timer_cb cb, void *arg)
 {
-	return NULL;
+	al_os_timer_none_t *n;
+
+	UNUSED(name);
+
+	AL_CHECK_RET(period > 0, EINVAL, NULL);
+
+	if (!timer_wheel_ready) {
+		al_timer_wheel_init(&timer_wheel, al_tick_get_tick64());
+		timer_wheel_ready = true;
+	}
+
+	n = (al_os_timer_none_t *)al_os_malloc(sizeof(*n));
+	if (n == NULL) {
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	n->tmr.handle = n;
+	n->tmr.cb = cb;
+	n->tmr.arg = arg;
+	n->period = period;
+	n->auto_reload = auto_reload;
+
+	al_timer_init(&n->t, timer_none_func, n);
+
+	return &n->tmr;
 }
 
 int_t al_os_timer_del(al_os_timer_t *tmr)
 {
+	al_os_timer_none_t *n = (al_os_timer_none_t *)tmr->handle;
+
+	al_timer_del(&timer_wheel, &n->t);
+	al_os_free(n);
+
 	return 0;
 }
 
 int_t al_os_timer_start(al_os_timer_t *tmr)
 {
-	return 0;
+	return timer_arm((al_os_timer_none_t *)tmr->handle);
 }
 
 int_t al_os_timer_stop(al_os_timer_t *tmr)
 {
+	al_os_timer_none_t *n = (al_os_timer_none_t *)tmr->handle;
+
+	al_timer_del(&timer_wheel, &n->t);
+
 	return 0;
 }
 
 int_t al_os_timer_start_isr(al_os_timer_t *tmr, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_start(tmr);
 }
 
 int_t al_os_timer_stop_isr(al_os_timer_t *tmr, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_stop(tmr);
 }
 
 int_t al_os_timer_set_period(al_os_timer_t *tmr, uint_t period)
 {
-	return 0;
+	al_os_timer_none_t *n = (al_os_timer_none_t *)tmr->handle;
+
+	if (period == 0) {
+		return -1;
+	}
+
+	n->period = period;
+
+	/* changing the period also starts the timer */
+	return timer_arm(n);
 }
 
 int_t al_os_timer_set_period_isr(al_os_timer_t *tmr,
 								 uint_t period, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_set_period(tmr, period);
 }
 
 int_t al_os_timer_reset(al_os_timer_t *tmr)
 {
-	return 0;
+	return al_os_timer_start(tmr);
 }
 
 int_t al_os_timer_reset_isr(al_os_timer_t *tmr, bool_t *yield)
 {
-	return 0;
+	if (yield) {
+		*yield = false;
+	}
+
+	return al_os_timer_reset(tmr);
 }
 
-__END_DECLS
+int32_t al_os_timer_poll(void)
+{
+	uint64_t now, next;
+
+	if (!timer_wheel_ready) {
+		return -1;
+	}
+
+	now = al_tick_get_tick64();
+	al_timer_wheel_advance(&timer_wheel, now);
 
+	next = al_timer_wheel_next(&timer_wheel);
+	if (next == AL_TIMER_NEVER) {
+		return -1;
+	}
+
+	if (next <= now) {
+		return 0;
+	}
+
+	return (int32_t)min_t(uint64_t, next - now, INT32_MAX);
+}
+
+__END_DECLS
@@ -17,6 +17,8 @@ void al_create_pool(al_pool_t * po,
     po->nr_free = nmemb;
     po->nr_total = nmemb;
     po->nr_used = 0;
+    po->nr_peak = 0;
+    po->nr_fail = 0;
     INIT_LIST_HEAD(&po->free);
 
     p = (uint8_t *)buf;
@@ -33,6 +35,7 @@ void *al_get_from_pool(al_pool_t *po, int32_t offset)
     list_head_t *link;
 
     if (list_empty(&po->free)) {
+        ++po->nr_fail;
         return NULL;
     }
 
@@ -41,6 +44,10 @@ void *al_get_from_pool(al_pool_t *po, int32_t offset)
     --po->nr_free;
     ++po->nr_used;
 
+    if (po->nr_used > po->nr_peak) {
+        po->nr_peak = po->nr_used;
+    }
+
     return ((uint8_t *)link - offset);
 }
 
@@ -0,0 +1,450 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/log2.h"
+#include "alumy/mem.h"
+#include "alumy/initialized.h"
+#include "alumy/osal.h"
+#include "alumy/slab.h"
+
+__BEGIN_DECLS
+
+/*
+ * A free block stores the index + 1 of the next free block in its first
+ * word, 0 ends the list. The head packs the index + 1 of the first free
+ * block in the low half and a tag in the high half, the tag is bumped by
+ * every update so a lock-free pop can not be fooled by a block that was
+ * popped and pushed back in between (ABA).
+ */
+#define SLAB_IDX_BITS		(sizeof(uintptr_t) * 4)
+#define SLAB_IDX_MASK		(((uintptr_t)1 << SLAB_IDX_BITS) - 1)
+#define SLAB_TAG_ONE		((uintptr_t)1 << SLAB_IDX_BITS)
+
+static uint32_t slab_next_id = 0;
+
+__static_inline__ bool_t slab_lockfree(const al_slab_t *slab)
+{
+	return (slab->flags & (AL_SLAB_F_LOCKFREE | AL_SLAB_F_MAGAZINE)) != 0;
+}
+
+__static_inline__ uintptr_t *slab_link(al_slab_class_t *c, uintptr_t idx)
+{
+	return (uintptr_t *)(c->base + (idx - 1) * c->size);
+}
+
+static void slab_count(const al_slab_t *slab, al_slab_class_t *c, int32_t n)
+{
+	int32_t used, peak;
+
+	if (!slab_lockfree(slab)) {
+		c->pool.nr_free -= n;
+		c->pool.nr_used += n;
+		c->pool.nr_peak = max(c->pool.nr_peak, c->pool.nr_used);
+		return;
+	}
+
+	__atomic_add_fetch(&c->pool.nr_free, -n, __ATOMIC_RELAXED);
+	used = __atomic_add_fetch(&c->pool.nr_used, n, __ATOMIC_RELAXED);
+
+	peak = __atomic_load_n(&c->pool.nr_peak, __ATOMIC_RELAXED);
+	while ((used > peak) &&
+		   !__atomic_compare_exchange_n(&c->pool.nr_peak, &peak, used, true,
+										__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		;
+	}
+}
+
+static void *slab_class_empty(const al_slab_t *slab, al_slab_class_t *c)
+{
+	if (slab_lockfree(slab)) {
+		__atomic_add_fetch(&c->pool.nr_fail, 1, __ATOMIC_RELAXED);
+	} else {
+		c->pool.nr_fail++;
+	}
+
+	return NULL;
+}
+
+static void *class_pop(const al_slab_t *slab, al_slab_class_t *c)
+{
+	uintptr_t old, new, idx;
+	uintptr_t *link;
+
+	if (!slab_lockfree(slab)) {
+		idx = c->head;
+		if (idx == 0) {
+			return slab_class_empty(slab, c);
+		}
+
+		link = slab_link(c, idx);
+		c->head = *link;
+		slab_count(slab, c, 1);
+
+		return link;
+	}
+
+	old = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+
+	do {
+		idx = old & SLAB_IDX_MASK;
+		if (idx == 0) {
+			return slab_class_empty(slab, c);
+		}
+
+		/* the block may be taken meanwhile, the tag fails the CAS then */
+		link = slab_link(c, idx);
+		new = ((old & ~SLAB_IDX_MASK) + SLAB_TAG_ONE) |
+			  __atomic_load_n(link, __ATOMIC_RELAXED);
+	} while (!__atomic_compare_exchange_n(&c->head, &old, new, false,
+										  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	slab_count(slab, c, 1);
+
+	return link;
+}
+
+static void class_push(const al_slab_t *slab, al_slab_class_t *c, void *p)
+{
+	uintptr_t idx = ((uint8_t *)p - c->base) / c->size + 1;
+	uintptr_t *link = (uintptr_t *)p;
+	uintptr_t old, new;
+
+	slab_count(slab, c, -1);
+
+	if (!slab_lockfree(slab)) {
+		*link = c->head;
+		c->head = idx;
+		return;
+	}
+
+	old = __atomic_load_n(&c->head, __ATOMIC_RELAXED);
+
+	do {
+		__atomic_store_n(link, old & SLAB_IDX_MASK, __ATOMIC_RELAXED);
+		new = ((old & ~SLAB_IDX_MASK) + SLAB_TAG_ONE) | idx;
+	} while (!__atomic_compare_exchange_n(&c->head, &old, new, false,
+										  __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+#if AL_SLAB_MAGAZINE > 0
+/*
+ * Every thread caches up to AL_SLAB_MAGAZINE blocks per class. A magazine
+ * serves one slab at a time and remembers the slab id, blocks of a slab
+ * that was released or initialized again are dropped instead of returned.
+ */
+typedef struct al_slab_mag {
+	al_slab_t *slab;
+	uint32_t id;
+	uint32_t count;
+	void *blk[AL_SLAB_MAGAZINE];
+} al_slab_mag_t;
+
+static __thread al_slab_mag_t slab_mags[AL_SLAB_NR_CLASSES];
+
+static void mag_drain(al_slab_mag_t *mag, int_t i)
+{
+	al_slab_t *slab = mag->slab;
+
+	if (slab && (__atomic_load_n(&slab->id, __ATOMIC_RELAXED) == mag->id)) {
+		while (mag->count) {
+			class_push(slab, &slab->cls[i], mag->blk[--mag->count]);
+		}
+	}
+
+	mag->slab = NULL;
+	mag->count = 0;
+}
+
+static al_slab_mag_t *mag_get(al_slab_t *slab, int_t i)
+{
+	al_slab_mag_t *mag = &slab_mags[i];
+
+	if ((mag->slab != slab) || (mag->id != slab->id)) {
+		mag_drain(mag, i);
+		mag->slab = slab;
+		mag->id = slab->id;
+	}
+
+	return mag;
+}
+
+static void *mag_alloc(al_slab_t *slab, int_t i)
+{
+	al_slab_mag_t *mag = mag_get(slab, i);
+	void *p;
+
+	/* refill half of the magazine, the other half absorbs frees */
+	while (mag->count < (AL_SLAB_MAGAZINE + 1) / 2) {
+		p = class_pop(slab, &slab->cls[i]);
+		if (p == NULL) {
+			break;
+		}
+
+		mag->blk[mag->count++] = p;
+	}
+
+	return mag->count ? mag->blk[--mag->count] : NULL;
+}
+
+static void mag_free(al_slab_t *slab, int_t i, void *p)
+{
+	al_slab_mag_t *mag = mag_get(slab, i);
+
+	if (mag->count == AL_SLAB_MAGAZINE) {
+		while (mag->count > AL_SLAB_MAGAZINE / 2) {
+			class_push(slab, &slab->cls[i], mag->blk[--mag->count]);
+		}
+	}
+
+	mag->blk[mag->count++] = p;
+}
+#endif
+
+static void *slab_class_alloc(al_slab_t *slab, int_t i)
+{
+#if AL_SLAB_MAGAZINE > 0
+	if (slab->flags & AL_SLAB_F_MAGAZINE) {
+		return mag_alloc(slab, i);
+	}
+#endif
+
+	return class_pop(slab, &slab->cls[i]);
+}
+
+static void slab_class_free(al_slab_t *slab, int_t i, void *p)
+{
+#if AL_SLAB_MAGAZINE > 0
+	if (slab->flags & AL_SLAB_F_MAGAZINE) {
+		mag_free(slab, i, p);
+		return;
+	}
+#endif
+
+	class_push(slab, &slab->cls[i], p);
+}
+
+size_t al_slab_region_size(const uint32_t *nmemb, int_t nr_classes)
+{
+	size_t size = AL_SLAB_MIN_SIZE - 1;
+	int_t i;
+
+	for (i = 0; i < nr_classes; i++) {
+		size += (size_t)nmemb[i] << (AL_SLAB_MIN_SHIFT + i);
+	}
+
+	return size;
+}
+
+int32_t al_slab_init(al_slab_t *slab, void *buf, size_t size,
+					 const uint32_t *nmemb, int_t nr_classes, uint32_t flags)
+{
+	al_slab_class_t *c;
+	uint8_t *p;
+	uint32_t id;
+	int_t i;
+
+	AL_CHECK_RET(nmemb && (nr_classes > 0) &&
+				 (nr_classes <= AL_SLAB_NR_CLASSES), EINVAL, -1);
+
+	for (i = 0; i < nr_classes; i++) {
+		AL_CHECK_RET(nmemb[i] < SLAB_IDX_MASK, EINVAL, -1);
+	}
+
+	if (buf == NULL) {
+		size = al_slab_region_size(nmemb, nr_classes);
+	}
+
+	AL_CHECK_RET(size >= al_slab_region_size(nmemb, nr_classes), EINVAL, -1);
+
+	if (!al_initialized_init(&slab->init)) {
+		set_errno(EEXIST);
+		return -1;
+	}
+
+	slab->own = (buf == NULL);
+
+	if (slab->own) {
+		buf = al_os_malloc(size);
+		if (buf == NULL) {
+			al_initialized_cleanup(&slab->init);
+			set_errno(ENOMEM);
+			return -1;
+		}
+	}
+
+	slab->flags = flags;
+	slab->nr_classes = nr_classes;
+	slab->buf = (uint8_t *)buf;
+
+	p = AL_PTR_ALIGN((uint8_t *)buf, AL_SLAB_MIN_SIZE);
+
+	for (i = 0; i < nr_classes; i++) {
+		c = &slab->cls[i];
+
+		c->base = p;
+		c->size = AL_SLAB_MIN_SIZE << i;
+		c->nmemb = nmemb[i];
+		c->head = 0;
+
+		INIT_LIST_HEAD(&c->pool.free);
+		c->pool.nr_free = 0;
+		c->pool.nr_used = nmemb[i];
+		c->pool.nr_total = nmemb[i];
+		c->pool.nr_peak = 0;
+		c->pool.nr_fail = 0;
+		memset(&c->stat, 0, sizeof(c->stat));
+
+		p += (size_t)c->nmemb * c->size;
+	}
+
+	slab->end = p;
+
+	memset(&slab->stat, 0, sizeof(slab->stat));
+
+	/* chain the blocks so the lowest address is handed out first */
+	for (i = 0; i < nr_classes; i++) {
+		c = &slab->cls[i];
+
+		for (p = c->base + (size_t)c->nmemb * c->size; p > c->base; ) {
+			p -= c->size;
+			class_push(slab, c, p);
+		}
+
+		c->pool.nr_peak = 0;
+	}
+
+	do {
+		id = __atomic_add_fetch(&slab_next_id, 1, __ATOMIC_RELAXED);
+	} while (id == 0);
+
+	__atomic_store_n(&slab->id, id, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int32_t al_slab_deinit(al_slab_t *slab)
+{
+	if (!al_initialized_cleanup(&slab->init)) {
+		return -1;
+	}
+
+	__atomic_store_n(&slab->id, 0, __ATOMIC_RELEASE);
+
+	al_slab_flush(slab);
+
+	if (slab->own) {
+		al_os_free(slab->buf);
+	}
+
+	slab->buf = NULL;
+	slab->end = NULL;
+
+	return 0;
+}
+
+void *al_slab_alloc(al_slab_t *slab, size_t size)
+{
+	void *p;
+	int_t i;
+
+	AL_CHECK_RET((slab != NULL) && (slab->nr_classes > 0), EINVAL, NULL);
+
+	if (size > ((size_t)AL_SLAB_MIN_SIZE << (slab->nr_classes - 1))) {
+		al_mem_stat_alloc(&slab->stat, size, 0);
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	i = (size <= AL_SLAB_MIN_SIZE) ? 0 : order_base_2(size) - AL_SLAB_MIN_SHIFT;
+
+	for (; i < slab->nr_classes; i++) {
+		p = slab_class_alloc(slab, i);
+		if (p) {
+			al_mem_stat_alloc(&slab->stat, size, slab->cls[i].size);
+			al_mem_stat_alloc(&slab->cls[i].stat, size, slab->cls[i].size);
+			return p;
+		}
+	}
+
+	al_mem_stat_alloc(&slab->stat, size, 0);
+	set_errno(ENOMEM);
+	return NULL;
+}
+
+void *al_slab_malloc(al_slab_t *slab, size_t size)
+{
+	void *p = al_slab_alloc(slab, size);
+
+	return p ? p : al_os_malloc(size);
+}
+
+void *al_slab_calloc(al_slab_t *slab, size_t nmemb, size_t size)
+{
+	void *p;
+
+	if (size && (nmemb > SIZE_MAX / size)) {
+		set_errno(ENOMEM);
+		return NULL;
+	}
+
+	p = al_slab_alloc(slab, nmemb * size);
+	if (p == NULL) {
+		return al_os_calloc(nmemb, size);
+	}
+
+	memset(p, 0, nmemb * size);
+
+	return p;
+}
+
+void al_slab_free(al_slab_t *slab, void *p)
+{
+	al_slab_class_t *c;
+	int_t i;
+
+	if (p == NULL) {
+		return;
+	}
+
+	if (!al_slab_owns(slab, p)) {
+		al_os_free(p);
+		return;
+	}
+
+	for (i = 0; i < slab->nr_classes; i++) {
+		c = &slab->cls[i];
+
+		if ((uint8_t *)p < c->base + (size_t)c->nmemb * c->size) {
+			al_mem_stat_free(&slab->stat, c->size);
+			al_mem_stat_free(&c->stat, c->size);
+			slab_class_free(slab, i, p);
+			return;
+		}
+	}
+}
+
+bool_t al_slab_owns(const al_slab_t *slab, const void *p)
+{
+	return ((const uint8_t *)p >= slab->buf) && ((const uint8_t *)p < slab->end);
+}
+
+void al_slab_flush(al_slab_t *slab)
+{
+#if AL_SLAB_MAGAZINE > 0
+	int_t i;
+
+	for (i = 0; i < AL_SLAB_NR_CLASSES; i++) {
+		if (slab_mags[i].slab == slab) {
+			mag_drain(&slab_mags[i], i);
+		}
+	}
+#else
+	UNUSED(slab);
+#endif
+}
+
+__END_DECLS
+
@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+/* The Galois/Counter Mode of Operation, test case 4 */
+static const uint8_t gcm_key[16] = {
+	0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+	0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08,
+};
+
+static const uint8_t gcm_iv[12] = {
+	0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+	0xde, 0xca, 0xf8, 0x88,
+};
+
+static const uint8_t gcm_aad[20] = {
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xab, 0xad, 0xda, 0xd2,
+};
+
+static const uint8_t gcm_plain[60] = {
+	0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,
+	0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+	0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+	0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+	0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+	0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+	0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,
+	0xba, 0x63, 0x7b, 0x39,
+};
+
+static const uint8_t gcm_cipher[60] = {
+	0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+	0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+	0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+	0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+	0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+	0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+	0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+	0x3d, 0x58, 0xe0, 0x91,
+};
+
+static const uint8_t gcm_tag[16] = {
+	0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb,
+	0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47,
+};
+
+/* RFC 8439, 2.8.2 */
+static const uint8_t chachapoly_key[32] = {
+	0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+	0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+	0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+	0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+};
+
+static const uint8_t chachapoly_nonce[12] = {
+	0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43,
+	0x44, 0x45, 0x46, 0x47,
+};
+
+static const uint8_t chachapoly_aad[12] = {
+	0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3,
+	0xc4, 0xc5, 0xc6, 0xc7,
+};
+
+static const char chachapoly_plain[] =
+	"Ladies and Gentlemen of the class of '99: If I could offer you only "
+	"one tip for the future, sunscreen would be it.";
+
+static const uint8_t chachapoly_cipher[114] = {
+	0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb,
+	0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+	0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe,
+	0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+	0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12,
+	0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+	0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29,
+	0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+	0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c,
+	0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+	0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94,
+	0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+	0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d,
+	0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+	0x61, 0x16,
+};
+
+static const uint8_t chachapoly_tag[16] = {
+	0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a,
+	0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91,
+};
+
+#define AEAD_BUF_SIZE		(16 * 1024)
+
+static uint8_t aead_plain[AEAD_BUF_SIZE];
+static uint8_t aead_buf[AEAD_BUF_SIZE + 16];
+static uint8_t aead_ref[AEAD_BUF_SIZE + 16];
+
+TEST_GROUP(aead);
+
+TEST_SETUP(aead)
+{
+	for (size_t i = 0; i < sizeof(aead_plain); i++) {
+		aead_plain[i] = (uint8_t)(i * 59 + (i >> 10));
+	}
+}
+
+TEST_TEAR_DOWN(aead)
+{
+
+}
+
+TEST(aead, vectors)
+{
+	static const struct {
+		al_aead_type_t type;
+		const uint8_t *key, *nonce, *aad, *plain, *cipher, *tag;
+		size_t keylen, nonce_len, aad_len, len;
+	} v[] = {
+		{
+			AL_AEAD_AES_GCM, gcm_key, gcm_iv, gcm_aad, gcm_plain,
+			gcm_cipher, gcm_tag, sizeof(gcm_key), sizeof(gcm_iv),
+			sizeof(gcm_aad), sizeof(gcm_plain),
+		},
+		{
+			AL_AEAD_CHACHAPOLY, chachapoly_key, chachapoly_nonce,
+			chachapoly_aad, (const uint8_t *)chachapoly_plain,
+			chachapoly_cipher, chachapoly_tag, sizeof(chachapoly_key),
+			sizeof(chachapoly_nonce), sizeof(chachapoly_aad),
+			sizeof(chachapoly_plain) - 1,
+		},
+	};
+	uint8_t tag[AL_AEAD_TAG_SIZE];
+	al_aead_ctx_t ctx;
+
+	for (size_t i = 0; i < ARRAY_SIZE(v); i++) {
+		memset(&ctx, 0, sizeof(ctx));
+		TEST_ASSERT_EQUAL(0, al_aead_setkey(&ctx, v[i].type, v[i].key,
+											v[i].keylen));
+
+		TEST_ASSERT_EQUAL(v[i].len,
+						  al_aead_encrypt(&ctx, v[i].nonce, v[i].nonce_len,
+										  v[i].aad, v[i].aad_len, aead_buf,
+										  sizeof(aead_buf), v[i].plain,
+										  v[i].len, tag, sizeof(tag)));
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(v[i].cipher, aead_buf, v[i].len);
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(v[i].tag, tag, sizeof(tag));
+
+		/* in place */
+		TEST_ASSERT_EQUAL(v[i].len,
+						  al_aead_decrypt(&ctx, v[i].nonce, v[i].nonce_len,
+										  v[i].aad, v[i].aad_len, aead_buf,
+										  sizeof(aead_buf), aead_buf,
+										  v[i].len, tag, sizeof(tag)));
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(v[i].plain, aead_buf, v[i].len);
+
+		/* a flipped bit of the cipher text fails and wipes the output */
+		memcpy(aead_ref, v[i].cipher, v[i].len);
+		aead_ref[7] ^= 0x10;
+		TEST_ASSERT_EQUAL(-1, al_aead_decrypt(&ctx, v[i].nonce, v[i].nonce_len,
+											  v[i].aad, v[i].aad_len, aead_buf,
+											  sizeof(aead_buf), aead_ref,
+											  v[i].len, tag, sizeof(tag)));
+		TEST_ASSERT_EQUAL(EBADMSG, errno);
+		TEST_ASSERT_EACH_EQUAL_HEX8(0, aead_buf, v[i].len);
+
+		/* so does a different aad */
+		TEST_ASSERT_EQUAL(-1, al_aead_decrypt(&ctx, v[i].nonce, v[i].nonce_len,
+											  v[i].aad, v[i].aad_len - 1,
+											  aead_buf, sizeof(aead_buf),
+											  v[i].cipher, v[i].len, tag,
+											  sizeof(tag)));
+		TEST_ASSERT_EQUAL(EBADMSG, errno);
+
+		al_aead_free(&ctx);
+	}
+
+	memset(&ctx, 0, sizeof(ctx));
+	TEST_ASSERT_EQUAL(-1, al_aead_setkey(&ctx, AL_AEAD_CHACHAPOLY, gcm_key,
+										 sizeof(gcm_key)));
+	TEST_ASSERT_EQUAL(-1, al_aead_starts(&ctx, true, gcm_iv, sizeof(gcm_iv),
+										 NULL, 0));
+}
+
+TEST(aead, stream)
+{
+	static const al_aead_type_t types[] = {
+		AL_AEAD_AES_GCM, AL_AEAD_CHACHAPOLY,
+	};
+	static const size_t steps[] = { 1, 15, 16, 17, 64, 1000 };
+	uint8_t tag[AL_AEAD_TAG_SIZE], ref_tag[AL_AEAD_TAG_SIZE];
+	al_aead_ctx_t ctx;
+	size_t off, n;
+
+	for (size_t t = 0; t < ARRAY_SIZE(types); t++) {
+		memset(&ctx, 0, sizeof(ctx));
+		TEST_ASSERT_EQUAL(0, al_aead_setkey(&ctx, types[t], chachapoly_key, 32));
+
+		TEST_ASSERT_EQUAL(sizeof(aead_plain),
+						  al_aead_encrypt(&ctx, gcm_iv, sizeof(gcm_iv),
+										  gcm_aad, sizeof(gcm_aad), aead_ref,
+										  sizeof(aead_ref), aead_plain,
+										  sizeof(aead_plain), ref_tag,
+										  sizeof(ref_tag)));
+
+		for (size_t s = 0; s < ARRAY_SIZE(steps); s++) {
+			TEST_ASSERT_EQUAL(0, al_aead_starts(&ctx, true, gcm_iv,
+												sizeof(gcm_iv), gcm_aad,
+												sizeof(gcm_aad)));
+
+			for (off = 0; off < sizeof(aead_plain); off += n) {
+				n = min(steps[s], sizeof(aead_plain) - off);
+				TEST_ASSERT_EQUAL(n, al_aead_update(&ctx, aead_buf + off, n,
+													aead_plain + off, n));
+			}
+
+			TEST_ASSERT_EQUAL(0, al_aead_finish(&ctx, tag, sizeof(tag)));
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(ref_tag, tag, sizeof(tag));
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(aead_ref, aead_buf, sizeof(aead_plain));
+
+			/* decrypt in the same steps, in place */
+			TEST_ASSERT_EQUAL(0, al_aead_starts(&ctx, false, gcm_iv,
+												sizeof(gcm_iv), gcm_aad,
+												sizeof(gcm_aad)));
+
+			for (off = 0; off < sizeof(aead_plain); off += n) {
+				n = min(steps[s], sizeof(aead_plain) - off);
+				TEST_ASSERT_EQUAL(n, al_aead_update(&ctx, aead_buf + off, n,
+													aead_buf + off, n));
+			}
+
+			TEST_ASSERT_EQUAL(0, al_aead_finish(&ctx, tag, sizeof(tag)));
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(aead_plain, aead_buf, sizeof(aead_plain));
+		}
+
+		al_aead_free(&ctx);
+	}
+}
+
+TEST_GROUP_RUNNER(aead)
+{
+	RUN_TEST_CASE(aead, vectors);
+	RUN_TEST_CASE(aead, stream);
+}
+
+static int32_t __add_aead_tests(void)
+{
+	RUN_TEST_GROUP(aead);
+	return 0;
+}
+
+al_test_suite_init(__add_aead_tests);
+
+__END_DECLS
@@ -58,16 +58,113 @@ static const uint8_t proverb_enc[] = {
 	0x5C,
 };
 
+static const al_aes_impl_t aes_impls[] = {
+	AL_AES_IMPL_SOFT, AL_AES_IMPL_AESNI,
+};
+
+/* NIST SP 800-38A, F.2 and F.5 */
+static const uint8_t sp800_key128[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+static const uint8_t sp800_key192[24] = {
+	0x8e, 0x73, 0xb0, 0xf7, 0xda, 0x0e, 0x64, 0x52,
+	0xc8, 0x10, 0xf3, 0x2b, 0x80, 0x90, 0x79, 0xe5,
+	0x62, 0xf8, 0xea, 0xd2, 0x52, 0x2c, 0x6b, 0x7b,
+};
+
+static const uint8_t sp800_key256[32] = {
+	0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe,
+	0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+	0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7,
+	0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4,
+};
+
+static const uint8_t sp800_iv[16] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+static const uint8_t sp800_ctr[16] = {
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+	0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff,
+};
+
+static const uint8_t sp800_plain[64] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+	0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+	0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+};
+
+static const uint8_t sp800_cbc128[64] = {
+	0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46,
+	0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+	0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee,
+	0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+	0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b,
+	0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+	0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09,
+	0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7,
+};
+
+static const uint8_t sp800_cbc192[64] = {
+	0x4f, 0x02, 0x1d, 0xb2, 0x43, 0xbc, 0x63, 0x3d,
+	0x71, 0x78, 0x18, 0x3a, 0x9f, 0xa0, 0x71, 0xe8,
+	0xb4, 0xd9, 0xad, 0xa9, 0xad, 0x7d, 0xed, 0xf4,
+	0xe5, 0xe7, 0x38, 0x76, 0x3f, 0x69, 0x14, 0x5a,
+	0x57, 0x1b, 0x24, 0x20, 0x12, 0xfb, 0x7a, 0xe0,
+	0x7f, 0xa9, 0xba, 0xac, 0x3d, 0xf1, 0x02, 0xe0,
+	0x08, 0xb0, 0xe2, 0x79, 0x88, 0x59, 0x88, 0x81,
+	0xd9, 0x20, 0xa9, 0xe6, 0x4f, 0x56, 0x15, 0xcd,
+};
+
+static const uint8_t sp800_cbc256[64] = {
+	0xf5, 0x8c, 0x4c, 0x04, 0xd6, 0xe5, 0xf1, 0xba,
+	0x77, 0x9e, 0xab, 0xfb, 0x5f, 0x7b, 0xfb, 0xd6,
+	0x9c, 0xfc, 0x4e, 0x96, 0x7e, 0xdb, 0x80, 0x8d,
+	0x67, 0x9f, 0x77, 0x7b, 0xc6, 0x70, 0x2c, 0x7d,
+	0x39, 0xf2, 0x33, 0x69, 0xa9, 0xd9, 0xba, 0xcf,
+	0xa5, 0x30, 0xe2, 0x63, 0x04, 0x23, 0x14, 0x61,
+	0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9, 0xfc,
+	0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b,
+};
+
+static const uint8_t sp800_ctr128[64] = {
+	0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26,
+	0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+	0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff,
+	0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+	0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e,
+	0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+	0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1,
+	0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee,
+};
+
+#define AES_BUF_SIZE		(64 * 1024)
+#define AES_BIG_SIZE		(4 * 1024 * 1024 + 13)
+
+static uint8_t aes_plain[AES_BUF_SIZE];
+static uint8_t aes_buf[AES_BUF_SIZE + 16];
+static uint8_t aes_ref[AES_BUF_SIZE + 16];
+
 TEST_GROUP(aes);
 
 TEST_SETUP(aes)
 {
-
+	for (size_t i = 0; i < sizeof(aes_plain); i++) {
+		aes_plain[i] = (uint8_t)(i * 73 + (i >> 8));
+	}
 }
 
 TEST_TEAR_DOWN(aes)
 {
-
+	al_aes_set_impl(AL_AES_IMPL_AUTO);
 }
 
 TEST(aes, aes_128_ctr)
@@ -101,9 +198,172 @@ al_os_free(enc);
 al_os_free(dec);
 }
 
+TEST(aes, ctx_vectors)
+{
+	static const struct {
+		const uint8_t *key;
+		size_t keylen;
+		const uint8_t *cipher;
+	} cbc[] = {
+		{ sp800_key128, sizeof(sp800_key128), sp800_cbc128 },
+		{ sp800_key192, sizeof(sp800_key192), sp800_cbc192 },
+		{ sp800_key256, sizeof(sp800_key256), sp800_cbc256 },
+	};
+	uint8_t buf[80];
+	al_aes_ctx_t ctx;
+
+	for (size_t i = 0; i < ARRAY_SIZE(aes_impls); i++) {
+		if (al_aes_set_impl(aes_impls[i]) != 0) {
+			continue;
+		}
+
+		for (size_t j = 0; j < ARRAY_SIZE(cbc); j++) {
+			TEST_ASSERT_EQUAL(0, al_aes_setkey(&ctx, cbc[j].key, cbc[j].keylen));
+			TEST_ASSERT_EQUAL(aes_impls[i], ctx.impl);
+
+			TEST_ASSERT_EQUAL(80, al_aes_cbc_enc(&ctx, buf, sizeof(buf),
+												 sp800_plain, 64, sp800_iv));
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(cbc[j].cipher, buf, 64);
+
+			TEST_ASSERT_EQUAL(64, al_aes_cbc_dec(&ctx, buf, sizeof(buf),
+												 buf, 80, sp800_iv, true));
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(sp800_plain, buf, 64);
+
+			al_aes_free(&ctx);
+		}
+
+		TEST_ASSERT_EQUAL(0, al_aes_setkey(&ctx, sp800_key128, 16));
+
+		memcpy(buf, sp800_plain, 64);
+		TEST_ASSERT_EQUAL(64, al_aes_ctr(&ctx, buf, 64, buf, 64, sp800_ctr));
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(sp800_ctr128, buf, 64);
+
+		al_aes_free(&ctx);
+		TEST_ASSERT_EQUAL(-1, al_aes_ctr(&ctx, buf, 64, buf, 64, sp800_ctr));
+	}
+}
+
+TEST(aes, ctx_impls)
+{
+	static const uint8_t ctr_wrap[16] = {
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+	};
+	al_aes_ctx_t ctx, soft;
+	ssize_t n, m;
+
+	TEST_ASSERT_EQUAL(0, al_aes_set_impl(AL_AES_IMPL_SOFT));
+	TEST_ASSERT_EQUAL(0, al_aes_setkey(&soft, sp800_key256, 32));
+
+	for (size_t i = 0; i < ARRAY_SIZE(aes_impls); i++) {
+		if (al_aes_set_impl(aes_impls[i]) != 0) {
+			continue;
+		}
+
+		TEST_ASSERT_EQUAL(0, al_aes_setkey(&ctx, sp800_key256, 32));
+
+		/* every tail length, in place against out of place */
+		for (size_t len = 0; len < 200; len += 7) {
+			memcpy(aes_buf, aes_plain, len);
+
+			n = al_aes_cbc_enc(&ctx, aes_buf, sizeof(aes_buf), aes_buf, len,
+							   sp800_iv);
+			m = al_aes_cbc_enc(&soft, aes_ref, sizeof(aes_ref), aes_plain, len,
+							   sp800_iv);
+			TEST_ASSERT_EQUAL((len & ~15) + 16, n);
+			TEST_ASSERT_EQUAL(n, m);
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(aes_ref, aes_buf, n);
+
+			TEST_ASSERT_EQUAL(len, al_aes_cbc_dec(&ctx, aes_buf, sizeof(aes_buf),
+												  aes_buf, n, sp800_iv, true));
+			if (len > 0) {
+				TEST_ASSERT_EQUAL_HEX8_ARRAY(aes_plain, aes_buf, len);
+
+				memcpy(aes_buf, aes_plain, len);
+				TEST_ASSERT_EQUAL(len, al_aes_ctr(&ctx, aes_buf, len, aes_buf,
+												  len, ctr_wrap));
+				TEST_ASSERT_EQUAL(len, al_aes_ctr(&soft, aes_ref, len, aes_plain,
+												  len, ctr_wrap));
+				TEST_ASSERT_EQUAL_HEX8_ARRAY(aes_ref, aes_buf, len);
+			}
+		}
+
+		/* a corrupted padding is refused */
+		n = al_aes_cbc_enc(&ctx, aes_buf, sizeof(aes_buf), aes_plain, 20,
+						   sp800_iv);
+		aes_buf[n - 17] ^= 0x01;
+		TEST_ASSERT_EQUAL(-1, al_aes_cbc_dec(&ctx, aes_ref, sizeof(aes_ref),
+											 aes_buf, n, sp800_iv, true));
+		TEST_ASSERT_EQUAL(EBADMSG, errno);
+
+		TEST_ASSERT_EQUAL(-1, al_aes_cbc_enc(&ctx, aes_buf, 32, aes_plain, 32,
+											 sp800_iv));
+		TEST_ASSERT_EQUAL(ENOBUFS, errno);
+
+		al_aes_free(&ctx);
+	}
+
+	al_aes_free(&soft);
+}
+
+TEST(aes, ctr_parallel)
+{
+	static const uint8_t ctr_wrap[16] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0,
+	};
+	static const size_t chunks[] = { 0, 16, 4096 + 5, 100000 };
+	static al_worker_pool_t pool;
+	al_aes_ctx_t ctx;
+	uint8_t *big, *out, *ref;
+	size_t len;
+
+	big = al_os_malloc(AES_BIG_SIZE);
+	out = al_os_malloc(AES_BIG_SIZE);
+	ref = al_os_malloc(AES_BIG_SIZE);
+	TEST_ASSERT((big != NULL) && (out != NULL) && (ref != NULL));
+
+	for (size_t i = 0; i < AES_BIG_SIZE; i++) {
+		big[i] = (uint8_t)(i * 29 + (i >> 11));
+	}
+
+	TEST_ASSERT_EQUAL(0, al_worker_pool_init(&pool, 4, 64, "aes", 1, 4096));
+	TEST_ASSERT_EQUAL(0, al_aes_setkey(&ctx, sp800_key128, 16));
+
+	for (size_t i = 0; i < ARRAY_SIZE(chunks); i++) {
+		len = (chunks[i] == 16) ? 70001 : AES_BIG_SIZE;
+
+		TEST_ASSERT_EQUAL(len, al_aes_ctr(&ctx, ref, len, big, len, ctr_wrap));
+		TEST_ASSERT_EQUAL(len, al_aes_ctr_parallel(&ctx, &pool, out, len, big,
+												   len, ctr_wrap, chunks[i]));
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, out, len);
+	}
+
+	/* in place back to the plain text */
+	TEST_ASSERT_EQUAL(AES_BIG_SIZE,
+					  al_aes_ctr_parallel(&ctx, &pool, out, AES_BIG_SIZE, out,
+										  AES_BIG_SIZE, ctr_wrap, 0));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(big, out, AES_BIG_SIZE);
+
+	memcpy(out, proverb, sizeof(proverb) - 1);
+	al_aes128_ctr_encrypt(out, sizeof(proverb) - 1, (const uint8_t *)AES_KEY,
+						  (const uint8_t *)AES_IV);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(proverb_enc, out, sizeof(proverb) - 1);
+
+	al_aes_free(&ctx);
+	TEST_ASSERT_EQUAL(0, al_worker_pool_deinit(&pool));
+
+	al_os_free(big);
+	al_os_free(out);
+	al_os_free(ref);
+}
+
 TEST_GROUP_RUNNER(aes)
 {
     RUN_TEST_CASE(aes, aes_128_ctr);
+    RUN_TEST_CASE(aes, ctx_vectors);
+    RUN_TEST_CASE(aes, ctx_impls);
+    RUN_TEST_CASE(aes, ctr_parallel);
 }
 
 static int32_t __add_aes_tests(void)
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+static const al_base64_impl_t base64_impls[] = {
+	AL_BASE64_IMPL_SCALAR, AL_BASE64_IMPL_SSSE3,
+	AL_BASE64_IMPL_AVX2, AL_BASE64_IMPL_NEON,
+};
+
+static const char *base64_impl_names[] = {
+	"auto", "scalar", "ssse3", "avx2", "neon",
+};
+
+#define BASE64_BUF_SIZE		(64 * 1024)
+
+static uint8_t base64_plain[BASE64_BUF_SIZE];
+static uint8_t base64_out[BASE64_BUF_SIZE];
+static char base64_text[BASE64_BUF_SIZE / 3 * 4 + 8];
+static char base64_ref[BASE64_BUF_SIZE / 3 * 4 + 8];
+
+TEST_GROUP(base64);
+
+TEST_SETUP(base64)
+{
+	for (size_t i = 0; i < sizeof(base64_plain); i++) {
+		base64_plain[i] = (uint8_t)(i * 131 + (i >> 7));
+	}
+}
+
+TEST_TEAR_DOWN(base64)
+{
+	al_base64_set_impl(AL_BASE64_IMPL_AUTO);
+}
+
+TEST(base64, rfc4648)
+{
+	static const char *vec[][2] = {
+		{ "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+		{ "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" },
+		{ "foobar", "Zm9vYmFy" },
+	};
+	char legacy[16];
+	size_t n;
+
+	/* the empty vector only checks the lengths */
+	TEST_ASSERT_EQUAL(0, al_base64_encode(base64_text, 0, "", 0));
+	TEST_ASSERT_EQUAL(0, al_base64_decode(base64_out, 0, "", 0));
+
+	for (size_t i = 1; i < ARRAY_SIZE(vec); i++) {
+		n = strlen(vec[i][0]);
+
+		TEST_ASSERT_EQUAL(strlen(vec[i][1]), al_base64_encode_len(n));
+		TEST_ASSERT_EQUAL(strlen(vec[i][1]),
+						  al_base64_encode(base64_text, sizeof(base64_text),
+										   vec[i][0], n));
+		TEST_ASSERT_EQUAL_MEMORY(vec[i][1], base64_text, strlen(vec[i][1]));
+
+		TEST_ASSERT_EQUAL(n, al_base64_decode_len(vec[i][1], strlen(vec[i][1])));
+		TEST_ASSERT_EQUAL(n, al_base64_decode(base64_out, n, vec[i][1],
+											  strlen(vec[i][1])));
+		TEST_ASSERT_EQUAL_MEMORY(vec[i][0], base64_out, n);
+
+		TEST_ASSERT_EQUAL(strlen(vec[i][1]) + 1, Base64encode(legacy, vec[i][0], n));
+		TEST_ASSERT_EQUAL_STRING(vec[i][1], legacy);
+	}
+
+	TEST_ASSERT_EQUAL(-1, Base64encode(legacy, "foo", -1));
+
+	/* unpadded input */
+	TEST_ASSERT_EQUAL(4, al_base64_decode(base64_out, 4, "Zm9vYg", 6));
+	TEST_ASSERT_EQUAL_MEMORY("foob", base64_out, 4);
+	TEST_ASSERT_EQUAL(5, al_base64_decode(base64_out, 5, "Zm9vYmE", 7));
+	TEST_ASSERT_EQUAL_MEMORY("fooba", base64_out, 5);
+
+	/* malformed input and short buffers */
+	TEST_ASSERT_EQUAL(-1, al_base64_decode(base64_out, 8, "Zm9vY", 5));
+	TEST_ASSERT_EQUAL(EINVAL, errno);
+	TEST_ASSERT_EQUAL(-1, al_base64_decode(base64_out, 8, "Zm9v Zm9v", 9));
+	TEST_ASSERT_EQUAL(-1, al_base64_decode(base64_out, 8, "Zm=vZm9v", 8));
+	TEST_ASSERT_EQUAL(-1, al_base64_decode(base64_out, 5, "Zm9vYmFy", 8));
+	TEST_ASSERT_EQUAL(ENOBUFS, errno);
+	TEST_ASSERT_EQUAL(-1, al_base64_encode(base64_text, 7, "foobar", 6));
+}
+
+TEST(base64, impl)
+{
+	static const size_t lens[] = {
+		1, 2, 3, 11, 12, 13, 15, 16, 17, 24, 28, 29, 47, 48, 49, 63,
+		64, 65, 100, 255, 1000, 4096,
+	};
+	ssize_t tlen, n;
+
+	for (size_t i = 0; i < ARRAY_SIZE(base64_impls); i++) {
+		if (al_base64_set_impl(base64_impls[i]) != 0) {
+			continue;
+		}
+
+		for (size_t l = 0; l < ARRAY_SIZE(lens); l++) {
+			al_base64_set_impl(AL_BASE64_IMPL_SCALAR);
+			tlen = al_base64_encode(base64_ref, sizeof(base64_ref),
+									base64_plain + 1, lens[l]);
+			al_base64_set_impl(base64_impls[i]);
+
+			/* output buffers sized exactly */
+			TEST_ASSERT_EQUAL(tlen, al_base64_encode(base64_text, tlen,
+													 base64_plain + 1, lens[l]));
+			TEST_ASSERT_EQUAL_MEMORY_MESSAGE(base64_ref, base64_text, tlen,
+									base64_impl_names[base64_impls[i]]);
+
+			n = al_base64_decode(base64_out, lens[l], base64_text, tlen);
+			TEST_ASSERT_EQUAL_MESSAGE(lens[l], n,
+									  base64_impl_names[base64_impls[i]]);
+			TEST_ASSERT_EQUAL_MEMORY(base64_plain + 1, base64_out, lens[l]);
+		}
+
+		/* every byte value at every position of a vector is rejected */
+		tlen = al_base64_encode(base64_text, sizeof(base64_text),
+								base64_plain, 96);
+
+		for (int_t c = 0; c < 256; c++) {
+			if (memchr("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+					   "0123456789+/", c, 64) && (c != 0)) {
+				continue;
+			}
+
+			for (ssize_t pos = 0; pos < tlen; pos += 7) {
+				char save = base64_text[pos];
+
+				base64_text[pos] = c;
+				n = al_base64_decode(base64_out, sizeof(base64_out),
+									 base64_text, tlen);
+				base64_text[pos] = save;
+
+				if ((c == '=') && (pos >= tlen - 2)) {
+					continue;
+				}
+
+				TEST_ASSERT_EQUAL_MESSAGE(-1, n,
+										  base64_impl_names[base64_impls[i]]);
+			}
+		}
+	}
+}
+
+TEST(base64, stream)
+{
+	al_base64_enc_t enc;
+	size_t off, n, chunk = 1;
+	ssize_t w, total = 0;
+
+	TEST_ASSERT_EQUAL(4096 / 3 * 4 + 4,
+					  al_base64_encode(base64_ref, sizeof(base64_ref),
+									   base64_plain, 4096));
+
+	al_base64_enc_init(&enc);
+
+	for (off = 0; off < 4096; off += n, chunk = chunk * 3 % 97 + 1) {
+		n = min_t(size_t, chunk, 4096 - off);
+		w = al_base64_enc_update(&enc, base64_text + total,
+								 sizeof(base64_text) - total,
+								 base64_plain + off, n);
+		TEST_ASSERT_TRUE(w >= 0);
+		TEST_ASSERT_EQUAL(0, w % 4);
+		total += w;
+	}
+
+	w = al_base64_enc_final(&enc, base64_text + total, 4);
+	TEST_ASSERT_EQUAL(4, w);
+	total += w;
+
+	TEST_ASSERT_EQUAL(4096 / 3 * 4 + 4, total);
+	TEST_ASSERT_EQUAL_MEMORY(base64_ref, base64_text, total);
+
+	/* a short buffer consumes nothing */
+	al_base64_enc_init(&enc);
+	TEST_ASSERT_EQUAL(0, al_base64_enc_update(&enc, base64_text, 0, "ab", 2));
+	TEST_ASSERT_EQUAL(-1, al_base64_enc_update(&enc, base64_text, 3, "c", 1));
+	TEST_ASSERT_EQUAL(4, al_base64_enc_update(&enc, base64_text, 4, "c", 1));
+	TEST_ASSERT_EQUAL_MEMORY("YWJj", base64_text, 4);
+	TEST_ASSERT_EQUAL(0, al_base64_enc_final(&enc, base64_text, 0));
+}
+
+TEST(base64, aes)
+{
+	char *b64;
+	char out[64];
+
+	b64 = aes_cbc_enc_base64("hello, base64", 13, "0123456789abcdef", 16,
+							 "fedcba9876543210", 16);
+	TEST_ASSERT_NOT_NULL(b64);
+	TEST_ASSERT_EQUAL(24, strlen(b64));
+
+	TEST_ASSERT_EQUAL(13, aes_cbc_dec_base64(out, sizeof(out), b64,
+											 "0123456789abcdef", 16,
+											 "fedcba9876543210", 16, true));
+	TEST_ASSERT_EQUAL_MEMORY("hello, base64", out, 13);
+
+	b64[3] = '*';
+	TEST_ASSERT_TRUE(aes_cbc_dec_base64(out, sizeof(out), b64,
+										"0123456789abcdef", 16,
+										"fedcba9876543210", 16, true) < 0);
+
+	al_os_free(b64);
+}
+
+TEST_GROUP_RUNNER(base64)
+{
+	RUN_TEST_CASE(base64, rfc4648);
+	RUN_TEST_CASE(base64, impl);
+	RUN_TEST_CASE(base64, stream);
+	RUN_TEST_CASE(base64, aes);
+}
+
+static int32_t __add_base64_tests(void)
+{
+	RUN_TEST_GROUP(base64);
+	return 0;
+}
+
+al_test_suite_init(__add_base64_tests);
+
+__END_DECLS
+
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+static const al_crc32_impl_t crc32_impls[] = {
+	AL_CRC32_IMPL_TABLE,
+	AL_CRC32_IMPL_SLICE8,
+	AL_CRC32_IMPL_SLICE16,
+	AL_CRC32_IMPL_PCLMUL,
+	AL_CRC32_IMPL_ARMV8,
+};
+
+static const char *crc32_impl_names[] = {
+	"auto", "table", "slice8", "slice16", "pclmul", "armv8",
+};
+
+static uint8_t crc_buf[64 * 1024 + 16];
+
+TEST_GROUP(crc);
+
+TEST_SETUP(crc)
+{
+	for (size_t i = 0; i < sizeof(crc_buf); i++) {
+		crc_buf[i] = (uint8_t)(i * 31 + (i >> 8));
+	}
+}
+
+TEST_TEAR_DOWN(crc)
+{
+	al_crc32_set_impl(AL_CRC32_IMPL_AUTO);
+}
+
+TEST(crc, crc32)
+{
+	uint8_t out[4];
+
+	TEST_ASSERT_EQUAL(0, al_crc32_set_impl(AL_CRC32_IMPL_AUTO));
+	TEST_ASSERT_NOT_EQUAL(AL_CRC32_IMPL_AUTO, al_crc32_get_impl());
+
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926, al_crc32(0, "123456789", 9));
+	TEST_ASSERT_EQUAL_HEX32(0, al_crc32(0, "", 0));
+
+	/* chaining gives the same as one call */
+	TEST_ASSERT_EQUAL_HEX32(al_crc32(0, crc_buf, 1000),
+							al_crc32(al_crc32(0, crc_buf, 333),
+									 crc_buf + 333, 667));
+
+	al_crc32_wd_buf((const uint8_t *)"123456789", 9, out, 4);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY("\xCB\xF4\x39\x26", out, 4);
+}
+
+TEST(crc, crc32_combine)
+{
+	static const size_t lens[] = { 0, 1, 3, 100, 4096, 65536 - 9 };
+	uint32_t crc1, crc2;
+
+	for (size_t i = 0; i < ARRAY_SIZE(lens); i++) {
+		crc1 = al_crc32(0, crc_buf, 9);
+		crc2 = al_crc32(0, crc_buf + 9, lens[i]);
+
+		TEST_ASSERT_EQUAL_HEX32(al_crc32(0, crc_buf, 9 + lens[i]),
+								al_crc32_combine(crc1, crc2, lens[i]));
+	}
+
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926,
+							al_crc32_combine(0, al_crc32(0, "123456789", 9), 9));
+}
+
+TEST(crc, crc32_impl)
+{
+	static const uint32_t lens[] = {
+		0, 1, 7, 8, 15, 16, 63, 64, 65, 127, 128, 200, 1000, 4096, 65536,
+	};
+	uint32_t ref, crc;
+
+	for (size_t l = 0; l < ARRAY_SIZE(lens); l++) {
+		for (size_t off = 0; off < 16; off += 5) {
+			TEST_ASSERT_EQUAL(0, al_crc32_set_impl(AL_CRC32_IMPL_TABLE));
+			ref = al_crc32(0x12345678, crc_buf + off, lens[l]);
+
+			for (size_t i = 0; i < ARRAY_SIZE(crc32_impls); i++) {
+				if (al_crc32_set_impl(crc32_impls[i]) != 0) {
+					continue;
+				}
+
+				crc = al_crc32(0x12345678, crc_buf + off, lens[l]);
+				TEST_ASSERT_EQUAL_HEX32_MESSAGE(ref, crc,
+										crc32_impl_names[crc32_impls[i]]);
+			}
+		}
+	}
+}
+
+TEST(crc, engine)
+{
+	const uint8_t *chk = (const uint8_t *)"123456789";
+
+	TEST_ASSERT_EQUAL_HEX8(0xA1, crc8_maxim(chk, 9));
+	TEST_ASSERT_EQUAL_HEX8(crc8_maxim_calc(crc_buf, 1000),
+						   crc8_maxim(crc_buf, 1000));
+	TEST_ASSERT_EQUAL_HEX16(0x4B37, mb_get_crc16(chk, 9));
+	TEST_ASSERT_EQUAL_HEX16(0x31C3, crc16_poly(0, 0x1021, chk, 9));
+	TEST_ASSERT_EQUAL_HEX16(0xFEE8, crc16_poly(0, 0x8005, chk, 9));
+	TEST_ASSERT_EQUAL_HEX16(0x31C3, al_crc_calc(&al_crc16_xmodem_model, chk, 9));
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926, al_crc_calc(&al_crc32_model, chk, 9));
+
+	/* a modbus frame followed by its little endian crc leaves 0 */
+	memcpy(crc_buf, "\x01\x03\x00\x00\x00\x0A\xC5\xCD", 8);
+	TEST_ASSERT_EQUAL_HEX16(0, mb_get_crc16(crc_buf, 8));
+}
+
+TEST(crc, engine_table)
+{
+	static const struct {
+		al_crc_model_t model;
+		uint32_t check;
+	} models[] = {
+		{ { .width = 8, .poly = 0x07 }, 0xF4 },
+		{ { .width = 8, .reflect = true, .poly = 0x31 }, 0xA1 },
+		{ { .width = 16, .poly = 0x1021, .init = 0xFFFF }, 0x29B1 },
+		{ { .width = 16, .reflect = true, .poly = 0x8005 }, 0xBB3D },
+		{ { .width = 32, .poly = 0x04C11DB7, .init = 0xFFFFFFFF,
+			.xorout = 0xFFFFFFFF }, 0xFC891918 },
+		{ { .width = 32, .reflect = true, .poly = 0x1EDC6F41,
+			.init = 0xFFFFFFFF, .xorout = 0xFFFFFFFF }, 0xE3069283 },
+	};
+	static const int_t slices[] = { 1, 4, 8 };
+	static uint32_t table[AL_CRC_SLICE_MAX * 256];
+	static const size_t lens[] = { 0, 1, 3, 4, 7, 8, 9, 31, 1000 };
+	al_crc_model_t m;
+	uint32_t ref, crc;
+
+	for (size_t i = 0; i < ARRAY_SIZE(models); i++) {
+		TEST_ASSERT_EQUAL_HEX32(models[i].check,
+								al_crc_calc(&models[i].model, "123456789", 9));
+
+		for (size_t s = 0; s < ARRAY_SIZE(slices); s++) {
+			m = models[i].model;
+			TEST_ASSERT_EQUAL(0, al_crc_gen_table(&m, table, slices[s]));
+			m.table = table;
+			m.slice = slices[s];
+
+			for (size_t l = 0; l < ARRAY_SIZE(lens); l++) {
+				ref = al_crc_calc(&models[i].model, crc_buf + 3, lens[l]);
+				TEST_ASSERT_EQUAL_HEX32(ref, al_crc_calc(&m, crc_buf + 3, lens[l]));
+
+				/* chaining the register */
+				crc = al_crc_update(&m, al_crc_init(&m), crc_buf + 3, lens[l] / 2);
+				crc = al_crc_update(&m, crc, crc_buf + 3 + lens[l] / 2,
+									lens[l] - lens[l] / 2);
+				TEST_ASSERT_EQUAL_HEX32(ref, al_crc_final(&m, crc));
+			}
+		}
+	}
+
+	/* the built-in tables match the generated ones */
+	m = al_crc16_modbus_model;
+	TEST_ASSERT_EQUAL(0, al_crc_gen_table(&m, table, m.slice));
+	TEST_ASSERT_EQUAL_HEX16_ARRAY(al_crc16_modbus_model.table, table, m.slice * 256);
+
+	TEST_ASSERT_EQUAL(-1, al_crc_gen_table(&m, table, 0));
+	m.width = 12;
+	TEST_ASSERT_EQUAL(-1, al_crc_gen_table(&m, table, 1));
+}
+
+TEST_GROUP_RUNNER(crc)
+{
+	RUN_TEST_CASE(crc, crc32);
+	RUN_TEST_CASE(crc, crc32_combine);
+	RUN_TEST_CASE(crc, crc32_impl);
+	RUN_TEST_CASE(crc, engine);
+	RUN_TEST_CASE(crc, engine_table);
+}
+
+static int32_t __add_crc_tests(void)
+{
+	RUN_TEST_GROUP(crc);
+	return 0;
+}
+
+al_test_suite_init(__add_crc_tests);
+
+__END_DECLS
+
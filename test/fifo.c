@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+TEST_GROUP(fifo);
+
+TEST_SETUP(fifo)
+{
+
+}
+
+TEST_TEAR_DOWN(fifo)
+{
+
+}
+
+TEST(fifo, span)
+{
+	al_fifo_t fifo;
+	al_fifo_span_t span[2];
+	uint8_t mem[16];
+	uint8_t buf[16];
+
+	al_fifo_init(&fifo, mem, sizeof(mem));
+
+	/* move the indexes close to the end of the buffer */
+	memset(buf, 0, sizeof(buf));
+	TEST_ASSERT_EQUAL(12, al_fifo_put(&fifo, buf, 12));
+	TEST_ASSERT_EQUAL(12, al_fifo_get(&fifo, buf, 12));
+
+	TEST_ASSERT_EQUAL(10, al_fifo_reserve(&fifo, span, 10));
+	TEST_ASSERT_EQUAL_PTR(mem + 12, span[0].buf);
+	TEST_ASSERT_EQUAL(4, span[0].len);
+	TEST_ASSERT_EQUAL_PTR(mem, span[1].buf);
+	TEST_ASSERT_EQUAL(6, span[1].len);
+
+	memcpy(span[0].buf, "0123", 4);
+	memcpy(span[1].buf, "456789", 6);
+
+	/* nothing visible before the commit */
+	TEST_ASSERT_EQUAL(0, al_fifo_peek_linear(&fifo, span));
+	TEST_ASSERT_EQUAL(10, al_fifo_commit(&fifo, 10));
+
+	TEST_ASSERT_EQUAL(6, al_fifo_reserve(&fifo, span, 100));
+	TEST_ASSERT_EQUAL(6, span[0].len);
+	TEST_ASSERT_EQUAL(0, span[1].len);
+
+	TEST_ASSERT_EQUAL(10, al_fifo_peek_linear(&fifo, span));
+	TEST_ASSERT_EQUAL(4, span[0].len);
+	TEST_ASSERT_EQUAL_MEMORY("0123", span[0].buf, 4);
+	TEST_ASSERT_EQUAL(6, span[1].len);
+	TEST_ASSERT_EQUAL_MEMORY("456789", span[1].buf, 6);
+
+	TEST_ASSERT_EQUAL(5, al_fifo_consume(&fifo, 5));
+	TEST_ASSERT_EQUAL(5, al_fifo_get(&fifo, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_MEMORY("56789", buf, 5);
+
+	TEST_ASSERT_EQUAL(0, al_fifo_consume(&fifo, 1));
+	TEST_ASSERT_EQUAL(0, al_fifo_peek_linear(&fifo, span));
+}
+
+#define FIFO_SPSC_COUNT		100000
+
+static void fifo_spsc_writer(void *arg)
+{
+	al_fifo_t *fifo = (al_fifo_t *)((void **)arg)[0];
+	al_os_sem_t done = (al_os_sem_t)((void **)arg)[1];
+	al_fifo_span_t span[2];
+	uint32_t v = 0;
+	size_t n, i;
+
+	while (v < FIFO_SPSC_COUNT) {
+		n = al_fifo_reserve(fifo, span, FIFO_SPSC_COUNT - v);
+		if (n == 0) {
+			al_os_delay(0);
+			continue;
+		}
+
+		for (i = 0; i < span[0].len; i++) {
+			span[0].buf[i] = (uint8_t)(v++);
+		}
+
+		for (i = 0; i < span[1].len; i++) {
+			span[1].buf[i] = (uint8_t)(v++);
+		}
+
+		al_fifo_commit(fifo, n);
+	}
+
+	al_os_sem_give(done);
+	al_os_task_delete(NULL);
+}
+
+TEST(fifo, spsc)
+{
+	static uint8_t mem[64];
+	al_fifo_t fifo;
+	al_fifo_span_t span[2];
+	al_os_sem_t done;
+	void *args[2];
+	uint32_t v = 0;
+	size_t n, i;
+
+	al_fifo_init(&fifo, mem, sizeof(mem));
+
+	done = al_os_sem_bin_create();
+	TEST_ASSERT_NOT_NULL(done);
+
+	args[0] = &fifo;
+	args[1] = done;
+	TEST_ASSERT_NOT_NULL(al_os_task_create("fifo", 1, 0,
+										   fifo_spsc_writer, args));
+
+	while (v < FIFO_SPSC_COUNT) {
+		n = al_fifo_peek_linear(&fifo, span);
+		if (n == 0) {
+			al_os_delay(0);
+			continue;
+		}
+
+		for (i = 0; i < span[0].len; i++) {
+			TEST_ASSERT_EQUAL_UINT8((uint8_t)(v++), span[0].buf[i]);
+		}
+
+		for (i = 0; i < span[1].len; i++) {
+			TEST_ASSERT_EQUAL_UINT8((uint8_t)(v++), span[1].buf[i]);
+		}
+
+		TEST_ASSERT_EQUAL(n, al_fifo_consume(&fifo, n));
+	}
+
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(done, 1000));
+	TEST_ASSERT_EQUAL(0, al_fifo_len(&fifo));
+
+	al_os_sem_bin_del(done);
+}
+
+TEST_GROUP_RUNNER(fifo)
+{
+	RUN_TEST_CASE(fifo, span);
+	RUN_TEST_CASE(fifo, spsc);
+}
+
+static int32_t __add_fifo_tests(void)
+{
+	RUN_TEST_GROUP(fifo);
+	return 0;
+}
+
+al_test_suite_init(__add_fifo_tests);
+
+__END_DECLS
+
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "alumy/driver/flash_header.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define FLASH_IMAGE_SIZE	(300 * 1024 + 7)
+
+static uint8_t *flash_image;
+
+static void flash_image_make(uint8_t *img, uint32_t size)
+{
+	al_flash_header_t *hdr = (al_flash_header_t *)img;
+	uint8_t *data = img + al_flash_get_header_size();
+
+	for (uint32_t i = 0; i < size; i++) {
+		data[i] = (uint8_t)(i * 7 + (i >> 9));
+	}
+
+	al_flash_set_magic(hdr, AL_FLASH_MAGIC);
+	al_flash_set_size(hdr, size);
+	al_flash_set_dcrc(hdr, al_crc32(0, data, size));
+	al_flash_set_version(hdr, 1);
+	al_flash_set_hcrc(hdr, 0);
+	al_flash_set_hcrc(hdr, al_crc32(0, hdr, al_flash_get_header_size()));
+}
+
+TEST_GROUP(flash_header);
+
+TEST_SETUP(flash_header)
+{
+	/* room for a sector of trailing bytes */
+	flash_image = malloc(FLASH_IMAGE_SIZE + 4096);
+	TEST_ASSERT_NOT_NULL(flash_image);
+
+	memset(flash_image, 0xFF, FLASH_IMAGE_SIZE + 4096);
+	flash_image_make(flash_image, FLASH_IMAGE_SIZE - al_flash_get_header_size());
+}
+
+TEST_TEAR_DOWN(flash_header)
+{
+	free(flash_image);
+}
+
+TEST(flash_header, stream)
+{
+	al_flash_verify_ctx_t ctx;
+	al_flash_header_t hdr;
+	size_t off, n;
+
+	TEST_ASSERT_EQUAL(0, al_flash_check(flash_image, FLASH_IMAGE_SIZE));
+
+	/* odd pieces split the header too, trailing bytes are ignored */
+	TEST_ASSERT_EQUAL(0, al_flash_verify_init(&ctx));
+
+	for (off = 0; off < FLASH_IMAGE_SIZE + 4096; off += n) {
+		n = min_t(size_t, 3 + (off % 1021), FLASH_IMAGE_SIZE + 4096 - off);
+		TEST_ASSERT_EQUAL(0, al_flash_verify_update(&ctx, flash_image + off, n));
+	}
+
+	TEST_ASSERT_EQUAL(0, al_flash_verify_final(&ctx, &hdr));
+	TEST_ASSERT_EQUAL(FLASH_IMAGE_SIZE, al_flash_get_flash_size(&hdr));
+
+	/* truncated */
+	al_flash_verify_init(&ctx);
+	al_flash_verify_update(&ctx, flash_image, FLASH_IMAGE_SIZE - 1);
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_final(&ctx, NULL));
+	TEST_ASSERT_EQUAL(EPERM, errno);
+
+	/* corrupted data */
+	flash_image[1000] ^= 0x10;
+	al_flash_verify_init(&ctx);
+	TEST_ASSERT_EQUAL(0, al_flash_verify_update(&ctx, flash_image, FLASH_IMAGE_SIZE));
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_final(&ctx, NULL));
+
+	/* a bad header fails as soon as it is complete */
+	flash_image[5] ^= 0x01;
+	al_flash_verify_init(&ctx);
+	TEST_ASSERT_EQUAL(0, al_flash_verify_update(&ctx, flash_image, 10));
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_update(&ctx, flash_image + 10, 10));
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_update(&ctx, flash_image + 20, 10));
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_final(&ctx, NULL));
+}
+
+TEST(flash_header, parallel)
+{
+	uint32_t hsize = al_flash_get_header_size();
+	al_flash_verify_ctx_t ctx;
+	static al_worker_pool_t pool;
+
+	TEST_ASSERT_EQUAL(0, al_worker_pool_init(&pool, 4, 64, "verify", 1, 4096));
+
+	/* header and a few bytes streamed, the rest checksummed on the pool */
+	al_flash_verify_init(&ctx);
+	TEST_ASSERT_EQUAL(0, al_flash_verify_update(&ctx, flash_image, hsize + 13));
+	TEST_ASSERT_EQUAL(0, al_flash_verify_parallel(&ctx, &pool, flash_image + hsize + 13,
+												  FLASH_IMAGE_SIZE + 4096 - hsize - 13,
+												  4096));
+	TEST_ASSERT_EQUAL(0, al_flash_verify_final(&ctx, NULL));
+
+	/* precomputed chunks */
+	al_flash_verify_init(&ctx);
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_combine(&ctx, 0, 0));
+	al_flash_verify_update(&ctx, flash_image, hsize);
+	TEST_ASSERT_EQUAL(0, al_flash_verify_combine(&ctx,
+						al_crc32(0, flash_image + hsize, 1000), 1000));
+	TEST_ASSERT_EQUAL(0, al_flash_verify_combine(&ctx,
+						al_crc32(0, flash_image + hsize + 1000,
+								 FLASH_IMAGE_SIZE - hsize - 1000),
+						FLASH_IMAGE_SIZE - hsize - 1000));
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_combine(&ctx, 0, 1));
+	TEST_ASSERT_EQUAL(-1, al_flash_verify_final(&ctx, NULL));
+
+	al_flash_verify_init(&ctx);
+	al_flash_verify_update(&ctx, flash_image, hsize);
+	TEST_ASSERT_EQUAL(0, al_flash_verify_combine(&ctx,
+						al_crc32(0, flash_image + hsize, FLASH_IMAGE_SIZE - hsize),
+						FLASH_IMAGE_SIZE - hsize));
+	TEST_ASSERT_EQUAL(0, al_flash_verify_final(&ctx, NULL));
+
+	TEST_ASSERT_EQUAL(0, al_worker_pool_deinit(&pool));
+}
+
+TEST_GROUP_RUNNER(flash_header)
+{
+	RUN_TEST_CASE(flash_header, stream);
+	RUN_TEST_CASE(flash_header, parallel);
+}
+
+static int32_t __add_flash_header_tests(void)
+{
+	RUN_TEST_GROUP(flash_header);
+	return 0;
+}
+
+al_test_suite_init(__add_flash_header_tests);
+
+__END_DECLS
+
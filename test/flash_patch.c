@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "alumy/driver/flash_patch.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define PATCH_OLD_SIZE		8192
+#define PATCH_NEW_SIZE		8000
+#define PATCH_PART_SIZE		(16 * 1024)
+#define PATCH_BUF_SIZE		256
+
+/*
+ * Turns the image of patch_make_old() into that of patch_make_new(), made
+ * by hand and compressed by python lzma, FORMAT_ALONE, dict_size 4096.
+ */
+static const uint8_t patch_vec[] = {
+	0x42, 0x53, 0x4c, 0x5a, 0xcb, 0x74, 0x67, 0x92, 0x00, 0x00, 0x20, 0x14,
+	0x00, 0x00, 0x1f, 0x54, 0x5d, 0x00, 0x10, 0x00, 0x00, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x5a, 0x03, 0xbc, 0x19, 0x90, 0xe7,
+	0xc2, 0xd4, 0x61, 0xc7, 0x19, 0x54, 0x63, 0x9d, 0x54, 0xd7, 0x05, 0x1f,
+	0x97, 0x22, 0xa5, 0x90, 0x3d, 0x5a, 0x38, 0x5c, 0x0b, 0x8a, 0xc8, 0xeb,
+	0xdb, 0x1f, 0xaa, 0x78, 0xd4, 0x08, 0x2d, 0x56, 0x8c, 0x48, 0xe8, 0xab,
+	0x28, 0xe0, 0xb3, 0xce, 0x96, 0x89, 0x1e, 0xfe, 0x37, 0xa6, 0x3a, 0xc5,
+	0x87, 0xe7, 0x26, 0xf0, 0x7c, 0x99, 0x92, 0x57, 0xb8, 0x03, 0xa1, 0xad,
+	0x10, 0x1d, 0x81, 0x60, 0x40, 0x69, 0xb0, 0x72, 0x5f, 0xc9, 0x79, 0x5d,
+	0xa0, 0xce, 0xa3, 0x12, 0x22, 0xb0, 0x2e, 0x2c, 0xaf, 0x73, 0x41, 0xd4,
+	0xf2, 0xee, 0xb1, 0xb2, 0xd6, 0x3f, 0xd8, 0xf1, 0xb1, 0x8a, 0xd3, 0x27,
+	0x80, 0x9f, 0xa2, 0x91, 0x3a, 0xb2, 0xde, 0xc6, 0x13, 0x5e, 0xee, 0x4c,
+	0xee, 0x3e, 0x76, 0x20, 0xd7, 0x70, 0x79, 0x55, 0x8e, 0x4b, 0xb6, 0x6b,
+	0xd5, 0x39, 0xb0, 0x40, 0xe4, 0xbc, 0x50, 0x01, 0xdd, 0x11, 0x6f, 0x03,
+	0x0b, 0xda, 0xe0, 0x2b, 0x1a, 0x57, 0xf8, 0x26, 0x7f, 0x5f, 0xff, 0xcb,
+	0x15, 0x35, 0xc0,
+};
+
+static uint8_t patch_old[PATCH_PART_SIZE];
+static uint8_t patch_new[PATCH_PART_SIZE];
+static uint8_t patch_out[PATCH_PART_SIZE];
+static size_t patch_out_len;
+static uint32_t patch_writes;
+static size_t patch_short_writes;
+static uint8_t patch_mem[AL_LZMA_MEM_SIZE(4096, 3)];
+static uint8_t patch_buf[PATCH_BUF_SIZE];
+
+static void patch_make_header(uint8_t *img, uint32_t size, uint32_t version)
+{
+	al_flash_header_t *hdr = (al_flash_header_t *)img;
+
+	al_flash_set_magic(hdr, AL_FLASH_MAGIC);
+	al_flash_set_size(hdr, size);
+	al_flash_set_dcrc(hdr, al_crc32(0, img + al_flash_get_header_size(), size));
+	al_flash_set_version(hdr, version);
+	al_flash_set_hcrc(hdr, 0);
+	al_flash_set_hcrc(hdr, al_crc32(0, hdr, al_flash_get_header_size()));
+}
+
+static void patch_make_old(uint8_t *img)
+{
+	uint8_t *data = img + al_flash_get_header_size();
+
+	for (uint32_t i = 0; i < PATCH_OLD_SIZE; i++) {
+		data[i] = (uint8_t)(i * 7 + (i >> 9));
+	}
+
+	patch_make_header(img, PATCH_OLD_SIZE, 1);
+}
+
+/* a few bytes changed, 64 inserted, the tail dropped and the head again */
+static void patch_make_new(uint8_t *img, const uint8_t *old)
+{
+	const uint8_t *od = old + al_flash_get_header_size();
+	uint8_t *data = img + al_flash_get_header_size();
+
+	memcpy(data, od, 4000);
+	for (uint32_t i = 1000; i < 1016; i++) {
+		data[i]++;
+	}
+
+	for (uint32_t i = 0; i < 64; i++) {
+		data[4000 + i] = (uint8_t)(i * 13 + 5);
+	}
+
+	memcpy(data + 4064, od + 4000, 3680);
+	memcpy(data + 7744, od, 256);
+
+	patch_make_header(img, PATCH_NEW_SIZE, 2);
+}
+
+static int32_t patch_read(uint32_t addr, void *buf, size_t len)
+{
+	TEST_ASSERT_TRUE(addr + len <= sizeof(patch_old));
+	memcpy(buf, patch_old + addr, len);
+	return 0;
+}
+
+static int32_t patch_write(void *ctx, const void *data, size_t len)
+{
+	TEST_ASSERT_TRUE(patch_out_len + len <= sizeof(patch_out));
+	memcpy(patch_out + patch_out_len, data, len);
+	patch_out_len += len;
+	patch_writes++;
+
+	if (len < PATCH_BUF_SIZE) {
+		patch_short_writes++;
+	}
+
+	return 0;
+}
+
+static const al_flash_patch_opt_t patch_opt = {
+	.old_addr = 0,
+	.old_size = PATCH_PART_SIZE,
+	.read = patch_read,
+	.write = patch_write,
+	.mem = patch_mem,
+	.memsz = sizeof(patch_mem),
+	.buf = patch_buf,
+	.bufsz = sizeof(patch_buf),
+};
+
+static int32_t patch_apply(const uint8_t *vec, size_t len, size_t chunk)
+{
+	al_flash_patch_t p;
+	size_t n;
+
+	TEST_ASSERT_EQUAL(0, al_flash_patch_init(&p, &patch_opt));
+
+	for (size_t off = 0; off < len; off += n) {
+		n = min_t(size_t, chunk, len - off);
+		if (al_flash_patch_feed(&p, vec + off, n) != 0) {
+			return -1;
+		}
+	}
+
+	return al_flash_patch_final(&p, NULL);
+}
+
+TEST_GROUP(flash_patch);
+
+TEST_SETUP(flash_patch)
+{
+	memset(patch_old, 0xFF, sizeof(patch_old));
+	patch_make_old(patch_old);
+	patch_make_new(patch_new, patch_old);
+
+	patch_out_len = 0;
+	patch_writes = 0;
+	patch_short_writes = 0;
+}
+
+TEST_TEAR_DOWN(flash_patch)
+{
+
+}
+
+TEST(flash_patch, apply)
+{
+	static const size_t chunks[] = { sizeof(patch_vec), 100, 16, 7, 1 };
+	uint32_t size = al_flash_get_header_size() + PATCH_NEW_SIZE;
+	al_flash_header_t hdr;
+	al_flash_patch_t p;
+
+	TEST_ASSERT_EQUAL(0, al_flash_patch_init(&p, &patch_opt));
+	TEST_ASSERT_EQUAL(0, al_flash_patch_feed(&p, patch_vec, sizeof(patch_vec)));
+	TEST_ASSERT_EQUAL(0, al_flash_patch_final(&p, &hdr));
+	TEST_ASSERT_EQUAL(2, al_flash_get_version(&hdr));
+	TEST_ASSERT_EQUAL(size, patch_out_len);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(patch_new, patch_out, size);
+
+	/* whole runs of buf but the last one, as flash programming wants */
+	TEST_ASSERT_EQUAL(DIV_ROUND_UP(size, PATCH_BUF_SIZE), patch_writes);
+	TEST_ASSERT_EQUAL(1, patch_short_writes);
+
+	for (size_t i = 1; i < ARRAY_SIZE(chunks); i++) {
+		patch_out_len = 0;
+		TEST_ASSERT_EQUAL(0, patch_apply(patch_vec, sizeof(patch_vec), chunks[i]));
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(patch_new, patch_out, size);
+	}
+}
+
+TEST(flash_patch, other_image)
+{
+	/* another old image is refused before anything is written */
+	patch_old[al_flash_get_header_size() + 10] ^= 1;
+	patch_make_header(patch_old, PATCH_OLD_SIZE, 1);
+
+	TEST_ASSERT_EQUAL(-1, patch_apply(patch_vec, sizeof(patch_vec), sizeof(patch_vec)));
+	TEST_ASSERT_EQUAL(EPERM, errno);
+	TEST_ASSERT_EQUAL(0, patch_writes);
+
+	/* and so is no image at all */
+	memset(patch_old, 0xFF, sizeof(patch_old));
+	TEST_ASSERT_EQUAL(-1, patch_apply(patch_vec, sizeof(patch_vec), sizeof(patch_vec)));
+	TEST_ASSERT_EQUAL(EPERM, errno);
+}
+
+TEST(flash_patch, corrupt_old)
+{
+	/* the header still matches, the new image does not */
+	patch_old[al_flash_get_header_size() + 2000] ^= 0x10;
+
+	TEST_ASSERT_EQUAL(-1, patch_apply(patch_vec, sizeof(patch_vec), sizeof(patch_vec)));
+	TEST_ASSERT_EQUAL(EPERM, errno);
+}
+
+TEST(flash_patch, corrupt_patch)
+{
+	uint8_t vec[sizeof(patch_vec)];
+	int32_t ret;
+
+	/* cut short */
+	TEST_ASSERT_EQUAL(-1, patch_apply(patch_vec, sizeof(patch_vec) - 10, 16));
+	TEST_ASSERT_EQUAL(EINVAL, errno);
+
+	/* a bad magic number */
+	memcpy(vec, patch_vec, sizeof(vec));
+	vec[0] ^= 1;
+	TEST_ASSERT_EQUAL(-1, patch_apply(vec, sizeof(vec), sizeof(vec)));
+	TEST_ASSERT_EQUAL(EPERM, errno);
+
+	/* a flipped bit anywhere in the stream never passes */
+	for (size_t i = sizeof(al_flash_patch_header_t) + AL_LZMA_HEADER_SIZE;
+		 i < sizeof(vec); i += 11) {
+		memcpy(vec, patch_vec, sizeof(vec));
+		vec[i] ^= 0x08;
+		patch_out_len = 0;
+
+		ret = patch_apply(vec, sizeof(vec), 64);
+		TEST_ASSERT_EQUAL(-1, ret);
+		TEST_ASSERT_TRUE((errno == EINVAL) || (errno == EPERM));
+	}
+}
+
+TEST_GROUP_RUNNER(flash_patch)
+{
+	RUN_TEST_CASE(flash_patch, apply);
+	RUN_TEST_CASE(flash_patch, other_image);
+	RUN_TEST_CASE(flash_patch, corrupt_old);
+	RUN_TEST_CASE(flash_patch, corrupt_patch);
+}
+
+static int32_t __add_flash_patch_tests(void)
+{
+	RUN_TEST_GROUP(flash_patch);
+	return 0;
+}
+
+al_test_suite_init(__add_flash_patch_tests);
+
+__END_DECLS
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define HASH_BUF_SIZE		(16 * 1024)
+#define HASH_MB_MSGS		19
+
+static uint8_t hash_buf[HASH_BUF_SIZE];
+
+TEST_GROUP(hash);
+
+TEST_SETUP(hash)
+{
+	for (size_t i = 0; i < sizeof(hash_buf); i++) {
+		hash_buf[i] = (uint8_t)(i * 167 + (i >> 9));
+	}
+}
+
+TEST_TEAR_DOWN(hash)
+{
+
+}
+
+TEST(hash, vectors)
+{
+	static const uint8_t md5_empty[16] = {
+		0xd4, 0x1d, 0x8c, 0xd9, 0x8f, 0x00, 0xb2, 0x04,
+		0xe9, 0x80, 0x09, 0x98, 0xec, 0xf8, 0x42, 0x7e,
+	};
+	static const uint8_t md5_abc[16] = {
+		0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0,
+		0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72,
+	};
+	static const uint8_t sha256_abc[32] = {
+		0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+		0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+		0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+	};
+	uint8_t digest[AL_HASH_MAX_SIZE];
+	al_md5_ctx_t md5;
+
+	al_md5_sign(&md5, digest, "", 0);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(md5_empty, digest, 16);
+
+	al_md5_sign(&md5, digest, "abc", 3);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(md5_abc, digest, 16);
+
+	TEST_ASSERT_EQUAL(0, al_hash(AL_HASH_MD5, "abc", 3, digest));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(md5_abc, digest, 16);
+
+	TEST_ASSERT_EQUAL(0, al_hash(AL_HASH_SHA256, "abc", 3, digest));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(sha256_abc, digest, 32);
+
+	TEST_ASSERT_EQUAL(16, al_hash_size(AL_HASH_MD5));
+	TEST_ASSERT_EQUAL(32, al_hash_size(AL_HASH_SHA256));
+	TEST_ASSERT_EQUAL(-1, al_hash((al_hash_type_t)99, "abc", 3, digest));
+}
+
+TEST(hash, stream)
+{
+	static const al_hash_type_t types[] = { AL_HASH_MD5, AL_HASH_SHA256 };
+	static const size_t steps[] = { 1, 3, 55, 56, 63, 64, 65, 1000 };
+	uint8_t ref[AL_HASH_MAX_SIZE], digest[AL_HASH_MAX_SIZE];
+	al_hash_ctx_t ctx;
+	size_t off, n;
+
+	for (size_t t = 0; t < ARRAY_SIZE(types); t++) {
+		TEST_ASSERT_EQUAL(0, al_hash(types[t], hash_buf, sizeof(hash_buf), ref));
+
+		for (size_t s = 0; s < ARRAY_SIZE(steps); s++) {
+			TEST_ASSERT_EQUAL(0, al_hash_init(&ctx, types[t]));
+
+			for (off = 0; off < sizeof(hash_buf); off += n) {
+				n = min(steps[s], sizeof(hash_buf) - off);
+				TEST_ASSERT_EQUAL(0, al_hash_update(&ctx, hash_buf + off, n));
+			}
+
+			TEST_ASSERT_EQUAL(0, al_hash_final(&ctx, digest));
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, digest, al_hash_size(types[t]));
+		}
+	}
+}
+
+TEST(hash, md5_mb)
+{
+	const void *data[HASH_MB_MSGS];
+	size_t len[HASH_MB_MSGS];
+	uint8_t digest[HASH_MB_MSGS][16], ref[16];
+	al_md5_ctx_t ctx;
+
+	/* lengths around the one and two padding block boundaries */
+	for (int_t i = 0; i < HASH_MB_MSGS; i++) {
+		data[i] = hash_buf + i * 7;
+		len[i] = (i * 61) % 200;
+	}
+
+	len[HASH_MB_MSGS - 1] = 4096;
+
+	TEST_ASSERT_EQUAL(0, al_md5_mb(data, len, digest, HASH_MB_MSGS));
+
+	for (int_t i = 0; i < HASH_MB_MSGS; i++) {
+		al_md5_sign(&ctx, ref, data[i], len[i]);
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, digest[i], 16);
+	}
+
+	TEST_ASSERT_EQUAL(0, al_md5_mb(data, len, digest, 0));
+	TEST_ASSERT_EQUAL(-1, al_md5_mb(NULL, len, digest, 1));
+}
+
+TEST_GROUP_RUNNER(hash)
+{
+	RUN_TEST_CASE(hash, vectors);
+	RUN_TEST_CASE(hash, stream);
+	RUN_TEST_CASE(hash, md5_mb);
+}
+
+static int32_t __add_hash_tests(void)
+{
+	RUN_TEST_GROUP(hash);
+	return 0;
+}
+
+al_test_suite_init(__add_hash_tests);
+
+__END_DECLS
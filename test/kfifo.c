@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+TEST_GROUP(kfifo);
+
+TEST_SETUP(kfifo)
+{
+
+}
+
+TEST_TEAR_DOWN(kfifo)
+{
+
+}
+
+TEST(kfifo, linear)
+{
+	DEFINE_KFIFO(fifo, uint8_t, 16);
+	uint8_t *ptr;
+	uint8_t buf[16];
+	unsigned int n;
+
+	/* move the indexes close to the end of the buffer */
+	memset(buf, 0, sizeof(buf));
+	TEST_ASSERT_EQUAL(12, kfifo_in(&fifo, buf, 12));
+	TEST_ASSERT_EQUAL(12, kfifo_out(&fifo, buf, 12));
+
+	n = kfifo_in_linear_ptr(&fifo, &ptr, 10);
+	TEST_ASSERT_EQUAL(4, n);
+
+	for (unsigned int i = 0; i < n; i++) {
+		ptr[i] = i;
+	}
+
+	/* nothing visible before the commit */
+	TEST_ASSERT_TRUE(kfifo_is_empty(&fifo));
+	kfifo_in_commit(&fifo, n);
+	TEST_ASSERT_EQUAL(4, kfifo_len(&fifo));
+
+	n = kfifo_in_linear_ptr(&fifo, &ptr, 10);
+	TEST_ASSERT_EQUAL(10, n);
+
+	for (unsigned int i = 0; i < n; i++) {
+		ptr[i] = 4 + i;
+	}
+
+	kfifo_in_commit(&fifo, n);
+
+	n = kfifo_out_linear_ptr(&fifo, &ptr, 16);
+	TEST_ASSERT_EQUAL(4, n);
+	TEST_ASSERT_EQUAL(3, ptr[3]);
+	kfifo_out_commit(&fifo, n);
+
+	TEST_ASSERT_EQUAL(10, kfifo_out(&fifo, buf, sizeof(buf)));
+
+	for (unsigned int i = 0; i < 10; i++) {
+		TEST_ASSERT_EQUAL(4 + i, buf[i]);
+	}
+}
+
+TEST(kfifo, batch)
+{
+	STRUCT_KFIFO_REC_1(32) fifo;
+	struct kfifo_rec_vec vec[4] = {
+		{ "abc", 3 },
+		{ "de", 2 },
+		{ "fghijklmnopq", 12 },
+		{ "rstuvwxyz0123", 13 },
+	};
+	char buf[16];
+
+	INIT_KFIFO(fifo);
+
+	/* 4 + 3 + 13 bytes fit, the last record does not */
+	TEST_ASSERT_EQUAL(3, kfifo_in_batch(&fifo, vec, ARRAY_SIZE(vec)));
+
+	TEST_ASSERT_EQUAL(3, kfifo_out(&fifo, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_MEMORY("abc", buf, 3);
+	TEST_ASSERT_EQUAL(2, kfifo_out(&fifo, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_MEMORY("de", buf, 2);
+	TEST_ASSERT_EQUAL(12, kfifo_out(&fifo, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_MEMORY("fghijklmnopq", buf, 12);
+	TEST_ASSERT_TRUE(kfifo_is_empty(&fifo));
+
+	/* single and multi writer functions don't mix without a reset */
+	kfifo_reset(&fifo);
+
+	TEST_ASSERT_EQUAL(3, kfifo_in_mp(&fifo, "xyz", 3));
+	TEST_ASSERT_EQUAL(3, kfifo_out(&fifo, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_MEMORY("xyz", buf, 3);
+}
+
+#define KFIFO_MP_WRITERS	4
+#define KFIFO_MP_COUNT		2000
+
+static DECLARE_KFIFO(kfifo_mp, uint32_t, 64);
+
+static void kfifo_mp_writer(void *arg)
+{
+	al_os_sem_t done = (al_os_sem_t)((void **)arg)[0];
+	uint32_t id = (uint32_t)(uintptr_t)((void **)arg)[1];
+	uint32_t v;
+
+	for (uint32_t i = 0; i < KFIFO_MP_COUNT; i++) {
+		v = (id << 16) | i;
+
+		while (kfifo_in_mp(&kfifo_mp, &v, 1) != 1) {
+			al_os_delay(0);
+		}
+	}
+
+	al_os_sem_give(done);
+	al_os_task_delete(NULL);
+}
+
+TEST(kfifo, mp)
+{
+	void *args[KFIFO_MP_WRITERS][2];
+	uint32_t next[KFIFO_MP_WRITERS] = { 0 };
+	al_os_sem_t done;
+	uint32_t v, total = 0;
+
+	INIT_KFIFO(kfifo_mp);
+
+	done = al_os_sem_count_create(KFIFO_MP_WRITERS, 0);
+	TEST_ASSERT_NOT_NULL(done);
+
+	for (uintptr_t i = 0; i < KFIFO_MP_WRITERS; i++) {
+		args[i][0] = done;
+		args[i][1] = (void *)i;
+		TEST_ASSERT_NOT_NULL(al_os_task_create("kfifo", 1, 0,
+											   kfifo_mp_writer, args[i]));
+	}
+
+	while (total < KFIFO_MP_WRITERS * KFIFO_MP_COUNT) {
+		if (kfifo_get(&kfifo_mp, &v) == 0) {
+			al_os_delay(0);
+			continue;
+		}
+
+		/* every writer's values arrive in order and none is lost */
+		TEST_ASSERT_EQUAL(next[v >> 16], v & 0xFFFF);
+		next[v >> 16]++;
+		total++;
+	}
+
+	for (int_t i = 0; i < KFIFO_MP_WRITERS; i++) {
+		TEST_ASSERT_EQUAL(0, al_os_sem_take(done, 1000));
+	}
+
+	TEST_ASSERT_TRUE(kfifo_is_empty(&kfifo_mp));
+
+	al_os_sem_count_del(done);
+}
+
+TEST_GROUP_RUNNER(kfifo)
+{
+	RUN_TEST_CASE(kfifo, linear);
+	RUN_TEST_CASE(kfifo, batch);
+	RUN_TEST_CASE(kfifo, mp);
+}
+
+static int32_t __add_kfifo_tests(void)
+{
+	RUN_TEST_GROUP(kfifo);
+	return 0;
+}
+
+al_test_suite_init(__add_kfifo_tests);
+
+__END_DECLS
+
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+static char bin_cap[64 * 1024];
+static size_t bin_cap_len;
+
+static void log_bin_capture(const void *buf, size_t len)
+{
+	if (bin_cap_len + len <= sizeof(bin_cap)) {
+		memcpy(bin_cap + bin_cap_len, buf, len);
+		bin_cap_len += len;
+	}
+}
+
+/* the hexdump line as the former formatter made it */
+static void log_bin_line(char *buf, uint32_t addr, const uint8_t *data,
+						 size_t len)
+{
+	size_t i;
+
+	buf += sprintf(buf, "%08X: ", (unsigned int)addr);
+
+	for (i = 0; i < 16; i++) {
+		buf += (i < len) ? sprintf(buf, "%02X ", data[i]) : sprintf(buf, "   ");
+	}
+
+	buf += sprintf(buf, "; ");
+
+	for (i = 0; i < 16; i++) {
+		*buf++ = (i >= len) ? ' ' : isprint(data[i]) ? (char)data[i] : '.';
+	}
+
+	*buf = 0;
+}
+
+static int_t log_bin_lines(void)
+{
+	int_t n = 0;
+	size_t i;
+
+	for (i = 0; i + 1 < bin_cap_len; i++) {
+		if ((bin_cap[i] == '\r') && (bin_cap[i + 1] == '\n')) {
+			n++;
+		}
+	}
+
+	return n;
+}
+
+static void log_bin_flush(void)
+{
+	TEST_ASSERT_EQUAL(0, al_log_ring_flush(1000));
+	bin_cap[bin_cap_len] = 0;
+}
+
+TEST_GROUP(log_bin);
+
+TEST_SETUP(log_bin)
+{
+	bin_cap_len = 0;
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_init(256 * 1024, log_bin_capture, 1, 0));
+}
+
+TEST_TEAR_DOWN(log_bin)
+{
+	al_log_bin_set_limit(0, 1);
+	al_log_ring_deinit();
+}
+
+TEST(log_bin, format)
+{
+	uint8_t data[256 + 5];
+	char line[96];
+	const char *p;
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t)i;
+	}
+
+	al_log_bin(AL_LOG_DEBUG, AL_LOG_LINE, data, sizeof(data));
+	log_bin_flush();
+
+	TEST_ASSERT_EQUAL(17, log_bin_lines());
+
+	p = bin_cap;
+	for (i = 0; i < sizeof(data); i += 16) {
+		log_bin_line(line, i, data + i, min_t(size_t, sizeof(data) - i, 16));
+
+		/* "[    0.000] " and the reset after the line */
+		p = strchr(p, ']');
+		TEST_ASSERT_NOT_NULL(p);
+		TEST_ASSERT_EQUAL_MEMORY(line, p + 2, strlen(line));
+		TEST_ASSERT_EQUAL_MEMORY(AL_PRI_RESET_COLOR "\r\n",
+								 p + 2 + strlen(line), 6);
+		p += 2 + strlen(line);
+	}
+}
+
+TEST(log_bin, color)
+{
+	uint8_t data[4] = { 'a', 'b', 'c', 'd' };
+	int32_t omask;
+
+	al_log_bin(AL_LOG_WARN, AL_LOG_LINE, data, sizeof(data));
+
+	omask = al_log_set_mask(AL_LOG_UPTO(AL_LOG_INFO));
+	al_log_bin(AL_LOG_DEBUG, AL_LOG_LINE, data, sizeof(data));
+	al_log_set_mask(omask);
+
+	log_bin_flush();
+
+	TEST_ASSERT_EQUAL(1, log_bin_lines());
+	TEST_ASSERT_NOT_NULL(strstr(bin_cap, "] " AL_LOG_COLOR_W "00000000: 61 62 "));
+}
+
+TEST(log_bin, truncate)
+{
+	uint8_t data[100];
+
+	memset(data, 0x55, sizeof(data));
+
+	al_log_bin_set_limit(32, 1);
+	al_log_bin(AL_LOG_DEBUG, AL_LOG_LINE, data, sizeof(data));
+	al_log_bin(AL_LOG_DEBUG, AL_LOG_LINE, data, 20);
+	log_bin_flush();
+
+	TEST_ASSERT_EQUAL(2 + 1 + 2, log_bin_lines());
+	TEST_ASSERT_NOT_NULL(strstr(bin_cap, "] ... 68 more bytes" AL_PRI_RESET_COLOR));
+	TEST_ASSERT_NULL(strstr(bin_cap, "00000020: "));
+}
+
+TEST(log_bin, sample)
+{
+	uint8_t data[16] = { 0 };
+	int_t i;
+
+	al_log_bin_set_limit(0, 4);
+
+	for (i = 0; i < 10; i++) {
+		al_log_bin(AL_LOG_DEBUG, AL_LOG_LINE, data, sizeof(data));
+	}
+
+	log_bin_flush();
+
+	/* the 1st, 5th and 9th */
+	TEST_ASSERT_EQUAL(3, log_bin_lines());
+}
+
+TEST(log_bin, large)
+{
+	static uint8_t data[4096];
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t)(i * 7);
+	}
+
+	al_log_bin(AL_LOG_DEBUG, AL_LOG_LINE, data, sizeof(data));
+	log_bin_flush();
+
+	TEST_ASSERT_EQUAL(256, log_bin_lines());
+}
+
+TEST_GROUP_RUNNER(log_bin)
+{
+	RUN_TEST_CASE(log_bin, format);
+	RUN_TEST_CASE(log_bin, color);
+	RUN_TEST_CASE(log_bin, truncate);
+	RUN_TEST_CASE(log_bin, sample);
+	RUN_TEST_CASE(log_bin, large);
+}
+
+static int32_t __add_log_bin_tests(void)
+{
+	RUN_TEST_GROUP(log_bin);
+	return 0;
+}
+
+al_test_suite_init(__add_log_bin_tests);
+
+__END_DECLS
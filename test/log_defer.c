@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+static uint8_t logd_cap[4096];
+static size_t logd_cap_len;
+
+static void log_defer_capture(const void *buf, size_t len)
+{
+	if (logd_cap_len + len <= sizeof(logd_cap)) {
+		memcpy(logd_cap + logd_cap_len, buf, len);
+		logd_cap_len += len;
+	}
+}
+
+static uint64_t log_defer_varint(const uint8_t **p)
+{
+	uint64_t v = 0;
+	int_t shift = 0;
+
+	while (**p & 0x80) {
+		v |= (uint64_t)(*(*p)++ & 0x7F) << shift;
+		shift += 7;
+	}
+
+	return v | ((uint64_t)*(*p)++ << shift);
+}
+
+static int64_t log_defer_sint(const uint8_t **p)
+{
+	uint64_t v = log_defer_varint(p);
+
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static ssize_t log_defer_encode(void *buf, size_t bufsz, uint32_t types, ...)
+{
+	ssize_t len;
+	va_list ap;
+
+	va_start(ap, types);
+	len = al_logd_encode(buf, bufsz, AL_LOG_INFO, 1234, 0, types, ap);
+	va_end(ap);
+
+	return len;
+}
+
+TEST_GROUP(log_defer);
+
+TEST_SETUP(log_defer)
+{
+	logd_cap_len = 0;
+}
+
+TEST_TEAR_DOWN(log_defer)
+{
+	al_log_ring_deinit();
+}
+
+TEST(log_defer, types)
+{
+	const char *s = "s";
+	char a[4] = "abc";
+	uint8_t u8 = 1;
+	int16_t i16 = 1;
+	uint64_t u64 = 1;
+	size_t sz = 1;
+	float f = 1;
+	void *p = NULL;
+
+	TEST_ASSERT_EQUAL_HEX32(0, __al_logd_types());
+	TEST_ASSERT_EQUAL_HEX32(AL_LOGD_I32, __al_logd_types(u8));
+	TEST_ASSERT_EQUAL_HEX32(AL_LOGD_I32 | AL_LOGD_I64 << 4,
+							__al_logd_types(i16, u64));
+	TEST_ASSERT_EQUAL_HEX32(AL_LOGD_STR | AL_LOGD_STR << 4 | AL_LOGD_STR << 8,
+							__al_logd_types(s, a, "lit"));
+	TEST_ASSERT_EQUAL_HEX32(AL_LOGD_F64 | AL_LOGD_F64 << 4 | AL_LOGD_PTR << 8,
+							__al_logd_types(f, 2.0, p));
+	TEST_ASSERT_EQUAL_HEX32(sizeof(size_t) > 4 ? AL_LOGD_I64 : AL_LOGD_I32,
+							__al_logd_types(sz));
+	TEST_ASSERT_EQUAL(8, __al_logd_nargs(1, 2, 3, 4, 5, 6, 7, 8));
+	TEST_ASSERT_EQUAL(0x11111111, __al_logd_types(1, 2, 3, 4, 5, 6, 7, 8));
+}
+
+TEST(log_defer, record)
+{
+	static const char fmt[] = "adc %d/%u big %lld %s %f at %p\r\n";
+	const uint8_t *p = logd_cap;
+	uint64_t u;
+	double d;
+	size_t len;
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_init(4096, log_defer_capture, 1, 0));
+
+	AL_LOGD(AL_LOG_WARN, "adc %d/%u big %lld %s %f at %p\r\n",
+			-5, 7u, -(1LL << 40), "volt", 1.5, (void *)0x1234);
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_flush(1000));
+	TEST_ASSERT_EQUAL(0, al_log_ring_deinit());
+
+	len = *p++;
+	TEST_ASSERT_EQUAL(len + 1, logd_cap_len);
+
+	TEST_ASSERT_EQUAL_HEX8(AL_LOG_WARN | 6 << 3, *p++);
+	log_defer_varint(&p);
+	TEST_ASSERT_EQUAL_STRING(fmt, __al_logd_start + log_defer_varint(&p));
+
+	TEST_ASSERT_EQUAL_HEX8(AL_LOGD_I32 | AL_LOGD_I32 << 4, *p++);
+	TEST_ASSERT_EQUAL_HEX8(AL_LOGD_I64 | AL_LOGD_STR << 4, *p++);
+	TEST_ASSERT_EQUAL_HEX8(AL_LOGD_F64 | AL_LOGD_PTR << 4, *p++);
+
+	TEST_ASSERT_EQUAL(-5, log_defer_sint(&p));
+	TEST_ASSERT_EQUAL(7, log_defer_sint(&p));
+	TEST_ASSERT_TRUE(log_defer_sint(&p) == -(1LL << 40));
+	TEST_ASSERT_EQUAL(4, *p++);
+	TEST_ASSERT_EQUAL_MEMORY("volt", p, 4);
+	p += 4;
+
+	u = 0;
+	for (int_t i = 0; i < 8; i++) {
+		u |= (uint64_t)*p++ << (i * 8);
+	}
+	memcpy(&d, &u, sizeof(d));
+	TEST_ASSERT_TRUE(d == 1.5);
+
+	TEST_ASSERT_EQUAL(0x1234, log_defer_varint(&p));
+	TEST_ASSERT_EQUAL_PTR(logd_cap + logd_cap_len, p);
+}
+
+TEST(log_defer, mask)
+{
+	int32_t omask;
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_init(4096, log_defer_capture, 1, 0));
+
+	omask = al_log_set_mask(AL_LOG_UPTO(AL_LOG_INFO));
+	AL_LOGD(AL_LOG_DEBUG, "hidden %d", 1);
+	AL_LOGD(AL_LOG_INFO, "shown %d", 2);
+	al_log_set_mask(omask);
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_flush(1000));
+	TEST_ASSERT_EQUAL(0, al_log_ring_deinit());
+
+	TEST_ASSERT_EQUAL(logd_cap[0] + 1, logd_cap_len);
+	TEST_ASSERT_EQUAL_HEX8(AL_LOG_INFO | 1 << 3, logd_cap[1]);
+}
+
+TEST(log_defer, limits)
+{
+	uint8_t rec[AL_LOGD_REC_MAX];
+	char big[64];
+
+	memset(big, 'x', sizeof(big) - 1);
+	big[sizeof(big) - 1] = 0;
+
+	/* strings are cut to AL_LOGD_STR_MAX */
+	TEST_ASSERT_EQUAL(1 + 1 + 2 + 1 + 1 + 1 + AL_LOGD_STR_MAX,
+					  log_defer_encode(rec, sizeof(rec), AL_LOGD_STR, big));
+
+	/* a record that does not fit is refused */
+	TEST_ASSERT_EQUAL(-1, log_defer_encode(rec, 16, AL_LOGD_F64 | AL_LOGD_F64 << 4,
+										   1.0, 2.0));
+	TEST_ASSERT_EQUAL(ENOBUFS, errno);
+
+	TEST_ASSERT_EQUAL(-1, log_defer_encode(rec, sizeof(rec), 0x0F, 1));
+	TEST_ASSERT_EQUAL(EINVAL, errno);
+}
+
+TEST_GROUP_RUNNER(log_defer)
+{
+	RUN_TEST_CASE(log_defer, types);
+	RUN_TEST_CASE(log_defer, record);
+	RUN_TEST_CASE(log_defer, mask);
+	RUN_TEST_CASE(log_defer, limits);
+}
+
+static int32_t __add_log_defer_tests(void)
+{
+	RUN_TEST_GROUP(log_defer);
+	return 0;
+}
+
+al_test_suite_init(__add_log_defer_tests);
+
+__END_DECLS
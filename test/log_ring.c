@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define LOG_RING_WRITERS	4
+#define LOG_RING_COUNT		500
+
+static char log_cap[256 * 1024];
+static size_t log_cap_len;
+static uint32_t log_cap_calls;
+static bool_t log_gate;
+
+static void log_ring_capture(const void *buf, size_t len)
+{
+	/* hold the drain task until the test opens the gate */
+	while (!__atomic_load_n(&log_gate, __ATOMIC_ACQUIRE)) {
+		al_os_delay(1);
+	}
+
+	if (log_cap_len + len <= sizeof(log_cap)) {
+		memcpy(log_cap + log_cap_len, buf, len);
+		log_cap_len += len;
+	}
+
+	log_cap_calls++;
+}
+
+/* the messages of one writer, in the order they were written */
+static int_t log_ring_scan(int_t id, int_t *lines)
+{
+	const char *p = log_cap, *end = log_cap + log_cap_len;
+	int t, n, next = 0;
+
+	*lines = 0;
+
+	while (p < end) {
+		const char *eol = memchr(p, '\n', end - p);
+		const char *msg = memchr(p, ']', end - p);
+
+		TEST_ASSERT_NOT_NULL(eol);
+		(*lines)++;
+
+		if ((msg != NULL) && (msg < eol) &&
+			(sscanf(msg + 1, " t%d %d", &t, &n) == 2) && (t == id)) {
+			TEST_ASSERT_EQUAL(next, n);
+			next++;
+		}
+
+		p = eol + 1;
+	}
+
+	return next;
+}
+
+TEST_GROUP(log_ring);
+
+TEST_SETUP(log_ring)
+{
+	log_cap_len = 0;
+	log_cap_calls = 0;
+	__atomic_store_n(&log_gate, true, __ATOMIC_RELEASE);
+}
+
+TEST_TEAR_DOWN(log_ring)
+{
+	/* a failed test must not leave al_log on the ring */
+	__atomic_store_n(&log_gate, true, __ATOMIC_RELEASE);
+	al_log_ring_deinit();
+}
+
+TEST(log_ring, order)
+{
+	int_t lines;
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_init(64 * 1024, log_ring_capture, 1, 0));
+	TEST_ASSERT_EQUAL(-1, al_log_ring_init(64 * 1024, log_ring_capture, 1, 0));
+	TEST_ASSERT_EQUAL(EEXIST, errno);
+
+	for (int_t i = 0; i < 200; i++) {
+		al_log(AL_LOG_INFO, AL_LOG_LINE, "t0 %d\r\n", i);
+	}
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_flush(1000));
+	TEST_ASSERT_EQUAL(200, log_ring_scan(0, &lines));
+	TEST_ASSERT_EQUAL(200, lines);
+	TEST_ASSERT_EQUAL(0, al_log_ring_dropped());
+
+	/* batched, far fewer writes than messages */
+	TEST_ASSERT_TRUE(log_cap_calls < 200);
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_deinit());
+	TEST_ASSERT_EQUAL(-1, al_log_ring_deinit());
+	TEST_ASSERT_EQUAL(-1, al_log_ring_flush(0));
+}
+
+TEST(log_ring, drop)
+{
+	uint32_t dropped;
+	int_t lines, n;
+
+	TEST_ASSERT_EQUAL(-1, al_log_ring_init(AL_LOG_RING_SHARDS, NULL, 1, 0));
+	TEST_ASSERT_EQUAL(EINVAL, errno);
+
+	__atomic_store_n(&log_gate, false, __ATOMIC_RELEASE);
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_init(512 * AL_LOG_RING_SHARDS,
+										  log_ring_capture, 1, 0));
+
+	/* the output is stuck, a small ring fills up quickly */
+	for (int_t i = 0; i < 100; i++) {
+		al_log(AL_LOG_INFO, AL_LOG_LINE, "t0 %d\r\n", i);
+	}
+
+	TEST_ASSERT_EQUAL(-1, al_log_ring_flush(10));
+	TEST_ASSERT_EQUAL(ETIMEDOUT, errno);
+
+	dropped = al_log_ring_dropped();
+	TEST_ASSERT_TRUE(dropped > 0);
+
+	__atomic_store_n(&log_gate, true, __ATOMIC_RELEASE);
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_flush(1000));
+	TEST_ASSERT_EQUAL(0, al_log_ring_deinit());
+
+	/* a message is lost entirely or not at all, and the loss is reported */
+	n = log_ring_scan(0, &lines);
+	TEST_ASSERT_EQUAL(100 - dropped, n);
+	TEST_ASSERT_TRUE(lines > n);
+	TEST_ASSERT_NOT_NULL(strstr(log_cap, "messages dropped"));
+}
+
+TEST(log_ring, truncate)
+{
+	char msg[AL_LOG_RING_LINE_MAX * 2];
+
+	memset(msg, 'x', sizeof(msg) - 1);
+	msg[sizeof(msg) - 1] = 0;
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_init(8 * 1024, log_ring_capture, 1, 0));
+
+	al_log(AL_LOG_INFO, AL_LOG_LINE, "%s\r\n", msg);
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_flush(1000));
+	TEST_ASSERT_EQUAL(0, al_log_ring_deinit());
+
+	TEST_ASSERT_EQUAL(AL_LOG_RING_LINE_MAX - 1, log_cap_len);
+	TEST_ASSERT_EQUAL('\n', log_cap[log_cap_len - 1]);
+}
+
+static void log_ring_writer(void *arg)
+{
+	al_os_sem_t done = (al_os_sem_t)((void **)arg)[0];
+	int_t id = (int_t)(uintptr_t)((void **)arg)[1];
+
+	for (int_t i = 0; i < LOG_RING_COUNT; i++) {
+		al_log(AL_LOG_INFO, AL_LOG_LINE, "t%d %d\r\n", id, i);
+	}
+
+	al_os_sem_give(done);
+	al_os_task_delete(NULL);
+}
+
+TEST(log_ring, threads)
+{
+	void *args[LOG_RING_WRITERS][2];
+	al_os_sem_t done;
+	int_t lines;
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_init(256 * 1024, log_ring_capture, 1, 0));
+
+	done = al_os_sem_count_create(LOG_RING_WRITERS, 0);
+	TEST_ASSERT_NOT_NULL(done);
+
+	for (uintptr_t i = 0; i < LOG_RING_WRITERS; i++) {
+		args[i][0] = done;
+		args[i][1] = (void *)i;
+		TEST_ASSERT_NOT_NULL(al_os_task_create("log", 1, 0,
+											   log_ring_writer, args[i]));
+	}
+
+	for (int_t i = 0; i < LOG_RING_WRITERS; i++) {
+		TEST_ASSERT_EQUAL(0, al_os_sem_take(done, 5000));
+	}
+
+	TEST_ASSERT_EQUAL(0, al_log_ring_flush(1000));
+	TEST_ASSERT_EQUAL(0, al_log_ring_deinit());
+
+	/* nothing lost and every writer's messages in order */
+	TEST_ASSERT_EQUAL(0, al_log_ring_dropped());
+
+	for (int_t i = 0; i < LOG_RING_WRITERS; i++) {
+		TEST_ASSERT_EQUAL(LOG_RING_COUNT, log_ring_scan(i, &lines));
+	}
+
+	TEST_ASSERT_EQUAL(LOG_RING_WRITERS * LOG_RING_COUNT, lines);
+
+	al_os_sem_count_del(done);
+}
+
+TEST_GROUP_RUNNER(log_ring)
+{
+	RUN_TEST_CASE(log_ring, order);
+	RUN_TEST_CASE(log_ring, drop);
+	RUN_TEST_CASE(log_ring, truncate);
+	RUN_TEST_CASE(log_ring, threads);
+}
+
+static int32_t __add_log_ring_tests(void)
+{
+	RUN_TEST_GROUP(log_ring);
+	return 0;
+}
+
+al_test_suite_init(__add_log_ring_tests);
+
+__END_DECLS
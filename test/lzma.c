@@ -0,0 +1,498 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "alumy/lzma.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define LZMA_TEST_LEN		12000
+#define LZMA_TEST_CRC		0xd29a8bb2
+#define LZMA_TEST_DICT		4096
+
+/* lzma_test_text() compressed by python lzma, FORMAT_ALONE, dict_size 4096 */
+static const uint8_t lzma_test_vec[] = {
+	0x5d, 0x00, 0x10, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x00, 0x39, 0x99, 0x48, 0x92, 0x17, 0xd8, 0x6e, 0xa3, 0x89, 0xc6,
+	0x66, 0x8c, 0xe0, 0xd9, 0xe7, 0x9a, 0xed, 0xde, 0xf0, 0x36, 0x92, 0x10,
+	0x7a, 0x21, 0x5b, 0x41, 0x97, 0xbb, 0xd8, 0x87, 0x8c, 0x53, 0x3a, 0x5b,
+	0xa4, 0xb5, 0xf5, 0x77, 0x96, 0xce, 0x6e, 0x69, 0x91, 0x33, 0x0d, 0xbb,
+	0xbb, 0xad, 0x30, 0xef, 0x99, 0xf2, 0xa4, 0x86, 0xc3, 0x7c, 0xeb, 0x8d,
+	0x32, 0x79, 0x4a, 0xb5, 0xcc, 0x93, 0x91, 0x1c, 0xec, 0x99, 0x93, 0x2d,
+	0xb0, 0x96, 0x8b, 0x0f, 0x9a, 0x8c, 0x93, 0xc6, 0xac, 0xb7, 0xe4, 0x1b,
+	0x83, 0xe0, 0x40, 0x41, 0xbb, 0xf1, 0xef, 0xf4, 0x15, 0xc0, 0xd6, 0xa1,
+	0x3d, 0x52, 0x1f, 0x62, 0x0a, 0x14, 0xfe, 0x67, 0x09, 0x2a, 0x6c, 0x96,
+	0x0e, 0x78, 0x12, 0xd2, 0xeb, 0x06, 0xc3, 0xf0, 0x63, 0x3d, 0xa9, 0x5e,
+	0xca, 0x6b, 0xa7, 0xb0, 0xc3, 0x31, 0x7d, 0x41, 0x14, 0xde, 0x35, 0x24,
+	0x2b, 0xdd, 0xe6, 0x0d, 0x07, 0x10, 0x1d, 0x0d, 0xff, 0x7a, 0x39, 0x51,
+	0x5f, 0x2f, 0x69, 0x48, 0xfa, 0x17, 0x9a, 0xf0, 0xfd, 0x81, 0x98, 0xc3,
+	0x49, 0xc2, 0xe3, 0x22, 0x50, 0xe5, 0xef, 0xef, 0xd5, 0xb8, 0x49, 0x3b,
+	0x19, 0x98, 0xc7, 0x38, 0xe8, 0x88, 0x8d, 0x8d, 0x95, 0xeb, 0x60, 0x34,
+	0x6c, 0xca, 0x97, 0x33, 0x8c, 0x49, 0xfe, 0x94, 0x73, 0xc2, 0xbf, 0x92,
+	0x8e, 0xe4, 0xa5, 0xd2, 0xf9, 0x9a, 0x7b, 0x17, 0xe0, 0xed, 0x15, 0xc4,
+	0xe0, 0xc8, 0x90, 0x21, 0x91, 0xde, 0xcc, 0x49, 0x12, 0x9b, 0x97, 0x66,
+	0xe2, 0xe5, 0x4b, 0xdf, 0x56, 0x19, 0xef, 0x37, 0x30, 0x9b, 0x99, 0x8f,
+	0xca, 0x5c, 0x1a, 0x52, 0xad, 0x98, 0x30, 0xe8, 0x24, 0xe1, 0x59, 0x51,
+	0x6c, 0x5a, 0x27, 0x77, 0x56, 0x76, 0x41, 0xc4, 0xc8, 0xc3, 0x49, 0x45,
+	0x03, 0x13, 0x16, 0x25, 0xfc, 0xc1, 0xe6, 0xff, 0xb3, 0x2a, 0x61, 0xe3,
+	0xa6, 0x50, 0xab, 0xc2, 0x0f, 0x85, 0xf8, 0xf5, 0x6e, 0x97, 0x4a, 0xf9,
+	0x16, 0x47, 0x1d, 0x04, 0x65, 0x56, 0xdd, 0x07, 0x58, 0x08, 0x04, 0x67,
+	0x37, 0xe1, 0xdb, 0xdf, 0xfa, 0xe8, 0xcc, 0x2c, 0x68, 0x20, 0x57, 0x44,
+	0x0c, 0x53, 0xe5, 0x84, 0x3b, 0xc2, 0x69, 0x1d, 0xc4, 0x8a, 0x7c, 0x36,
+	0x2e, 0x37, 0xb9, 0x9e, 0xc2, 0x04, 0xa7, 0x17, 0xfe, 0x78, 0x10, 0xaf,
+	0x64, 0xd1, 0x5d, 0x8a, 0xe4, 0xad, 0x67, 0xb5, 0xfb, 0x84, 0xcb, 0xc8,
+	0xfd, 0xe2, 0x0f, 0x97, 0x42, 0xa8, 0xdb, 0x11, 0x97, 0x39, 0x2a, 0xbe,
+	0x7d, 0xfc, 0x69, 0x71, 0x6b, 0x1d, 0xe6, 0xae, 0xf9, 0x98, 0x37, 0x1e,
+	0x3d, 0xf7, 0xe9, 0x90, 0x94, 0x41, 0x31, 0xfd, 0xf2, 0x80, 0x86, 0x84,
+	0x9c, 0x07, 0x90, 0xdb, 0xe1, 0x7e, 0x70, 0x81, 0x6d, 0x62, 0x87, 0xf2,
+	0x6a, 0x90, 0x17, 0xd8, 0x4c, 0x35, 0xf7, 0x17, 0xa3, 0x7b, 0xb9, 0xcd,
+	0xd1, 0x4c, 0xb5, 0x59, 0x88, 0xff, 0x04, 0x11, 0x6e, 0xfb, 0x35, 0xe4,
+	0xbb, 0xee, 0xec, 0x43, 0x29, 0xa4, 0x83, 0x55, 0x17, 0x46, 0x77, 0x1c,
+	0x57, 0x6b, 0xbb, 0x4d, 0xcf, 0x09, 0x08, 0xd7, 0x89, 0x37, 0x72, 0xb0,
+	0x91, 0xda, 0x28, 0x4c, 0x17, 0x16, 0xee, 0xac, 0xff, 0xc5, 0xe7, 0xd1,
+	0x53, 0x43, 0xb4, 0x9d, 0xeb, 0x94, 0x05, 0xa6, 0x7b, 0x08, 0x89, 0xec,
+	0x52, 0x55, 0x3f, 0xd4, 0xb1, 0x52, 0xb2, 0xdc, 0x3f, 0xa1, 0x43, 0x24,
+	0x81, 0x41, 0x6b, 0x62, 0xe5, 0xe8, 0x0a, 0xec, 0x2d, 0xba, 0x1f, 0xf7,
+	0x28, 0x9d, 0x1c, 0x85, 0x58, 0xa4, 0xe6, 0x0c, 0x47, 0x27, 0xe7, 0x39,
+	0xd8, 0x87, 0x78, 0x6c, 0x1c, 0x6f, 0xbf, 0x28, 0x99, 0x5d, 0x68, 0x0b,
+	0x1a, 0xce, 0x50, 0xea, 0x9d, 0x76, 0xb6, 0xb8, 0x8e, 0xec, 0x5b, 0x5c,
+	0x3f, 0xe3, 0xfe, 0x13, 0xc5, 0xb1, 0x9e, 0xb9, 0xf2, 0x04, 0x32, 0xe7,
+	0x2b, 0x01, 0x53, 0xb4, 0xb2, 0x82, 0xba, 0x44, 0x42, 0xde, 0x75, 0x1d,
+	0x85, 0x76, 0xa1, 0xdc, 0x70, 0xbd, 0xd9, 0xae, 0xa1, 0xb7, 0xc0, 0xdd,
+	0x4a, 0x48, 0x66, 0xc0, 0x48, 0x95, 0x43, 0x13, 0x67, 0xb2, 0xe1, 0xd3,
+	0x9a, 0x47, 0x62, 0xf5, 0xbf, 0xc4, 0x45, 0xb0, 0x09, 0x24, 0x13, 0x6f,
+	0x6e, 0x68, 0xb6, 0x7a, 0xec, 0xaf, 0xb8, 0x46, 0x9f, 0x37, 0x73, 0x48,
+	0xd5, 0xc0, 0xcd, 0x9f, 0xbb, 0x39, 0x3b, 0x28, 0x9f, 0x63, 0x52, 0x6c,
+	0xdb, 0x4c, 0x24, 0x73, 0x47, 0x9a, 0x02, 0x8c, 0x56, 0x10, 0xb0, 0xac,
+	0xf4, 0xc0, 0x1d, 0xb8, 0x99, 0x51, 0xcf, 0x5b, 0xa8, 0xac, 0x63, 0xae,
+	0x33, 0xb6, 0xa4, 0xaa, 0x27, 0xab, 0xb9, 0xb2, 0x53, 0x79, 0xa8, 0x78,
+	0xb6, 0xde, 0x64, 0x78, 0x66, 0x2a, 0xf6, 0xa5, 0x03, 0x6f, 0xb9, 0xe0,
+	0x99, 0xbe, 0xec, 0xf3, 0x56, 0x72, 0xc6, 0x8f, 0xd7, 0x56, 0xa4, 0x36,
+	0x83, 0xa4, 0x28, 0xd2, 0x19, 0x85, 0x38, 0x35, 0x70, 0xcb, 0x98, 0x26,
+	0xd2, 0x2a, 0x32, 0x57, 0x50, 0xca, 0xaa, 0x37, 0x29, 0xea, 0xf4, 0x1a,
+	0xbd, 0x8a, 0x1b, 0x7f, 0xb2, 0x45, 0xee, 0xc5, 0xe0, 0x87, 0x8a, 0x9a,
+	0xc5, 0xb1, 0x44, 0x69, 0xce, 0x68, 0xec, 0x38, 0xdb, 0x5b, 0xae, 0x25,
+	0x08, 0xba, 0x1b, 0x2e, 0x8e, 0xc8, 0x1f, 0xa0, 0x19, 0xe6, 0x79, 0xd1,
+	0x14, 0xc6, 0x8c, 0xbe, 0xce, 0x1f, 0x1c, 0x82, 0x48, 0xc2, 0x86, 0x02,
+	0xf5, 0x48, 0x58, 0x90, 0x79, 0xdd, 0x63, 0x7c, 0x5e, 0xe1, 0x53, 0xf0,
+	0x0b, 0xf7, 0x0a, 0x66, 0x0e, 0x79, 0x19, 0xc4, 0x6b, 0x7d, 0xe5, 0xe2,
+	0xe0, 0x4e, 0x59, 0x02, 0xa5, 0x5d, 0x39, 0x01, 0x1c, 0x1d, 0x2c, 0x84,
+	0x96, 0xfd, 0xab, 0x58, 0xa6, 0x07, 0xd2, 0xa0, 0xa4, 0x96, 0x07, 0xec,
+	0xbb, 0x9d, 0x56, 0x91, 0x81, 0x1f, 0xf8, 0x52, 0x10, 0x50, 0x55, 0xa3,
+	0xdf, 0xdc, 0x22, 0x5b, 0x98, 0x6a, 0xfc, 0xf9, 0x51, 0xf5, 0x8c, 0xa2,
+	0x59, 0xdf, 0x6d, 0xb1, 0x2e, 0xe6, 0x9f, 0x21, 0xa3, 0xf3, 0xd3, 0x88,
+	0xb9, 0xad, 0x18, 0x41, 0x40, 0x2c, 0xb6, 0x8f, 0xa0, 0x97, 0xf5, 0x83,
+	0x08, 0x98, 0xca, 0x51, 0x4d, 0x3f, 0xfb, 0x30, 0x35, 0x25, 0xf7, 0xc0,
+	0xfe, 0x64, 0xbe, 0x45, 0xda, 0x2f, 0x76, 0x18, 0xda, 0x73, 0xee, 0xc0,
+	0xcb, 0xb3, 0xa4, 0x58, 0xf4, 0xcf, 0x96, 0x6d, 0xee, 0xdb, 0x8d, 0x6f,
+	0x2f, 0xde, 0x10, 0x45, 0xe9, 0x8a, 0xc8, 0x00, 0x5f, 0xa7, 0x22, 0x40,
+	0xf7, 0xbe, 0x6b, 0xf1, 0xba, 0x91, 0x55, 0xf4, 0x4d, 0x03, 0x58, 0xc4,
+	0xc8, 0x5b, 0x1c, 0xbb, 0x09, 0x5f, 0x66, 0x6d, 0x77, 0xc7, 0xb1, 0xd0,
+	0x14, 0x80, 0x07, 0x92, 0x7a, 0x76, 0xf2, 0x0d, 0x6c, 0xe3, 0x42, 0xd1,
+	0x88, 0x5d, 0xa4, 0xfe, 0xcc, 0xbf, 0x4d, 0xc2, 0xe2, 0xa9, 0x99, 0x11,
+	0x4b, 0x4c, 0x1c, 0x6a, 0x40, 0xf5, 0x77, 0x18, 0xd8, 0x65, 0x9d, 0x38,
+	0x74, 0xc2, 0x0f, 0x99, 0xf8, 0x4d, 0x47, 0x77, 0x84, 0x65, 0x4e, 0x07,
+	0xe5, 0xa5, 0xab, 0x42, 0x61, 0x30, 0x2b, 0xb8, 0x66, 0x37, 0x17, 0xdc,
+	0x33, 0xd2, 0xcf, 0x0d, 0x46, 0x28, 0xfa, 0xaa, 0xa9, 0x5f, 0xc0, 0xeb,
+	0x99, 0x61, 0xb7, 0xa8, 0x5b, 0x23, 0x4d, 0x26, 0x18, 0x8f, 0x89, 0xcf,
+	0x73, 0x6e, 0xfa, 0x97, 0x9e, 0x3c, 0x94, 0x63, 0xda, 0xf9, 0x07, 0xeb,
+	0x0d, 0x1b, 0x45, 0x1d, 0x66, 0x65, 0x23, 0xd9, 0xab, 0x0d, 0x8f, 0x47,
+	0x52, 0xea, 0xf3, 0x11, 0x94, 0x76, 0x90, 0x30, 0x90, 0x42, 0x84, 0x73,
+	0x88, 0x21, 0x55, 0xaf, 0x0e, 0x8c, 0xd8, 0x39, 0xcb, 0xa7, 0xd4, 0x6e,
+	0xc9, 0xdd, 0xba, 0x9d, 0x1c, 0xcb, 0x04, 0x04, 0x24, 0x32, 0x10, 0x4e,
+	0x6c, 0x1b, 0x3d, 0x3f, 0xea, 0xd2, 0xbf, 0x6a, 0x5e, 0x60, 0xf4, 0x67,
+	0x02, 0x92, 0x7d, 0x49, 0xaf, 0xf6, 0xba, 0x15, 0x17, 0x60, 0xd3, 0xd3,
+	0xa4, 0xaf, 0x1d, 0xc8, 0x11, 0xf8, 0x36, 0x59, 0xbd, 0xc1, 0x77, 0xd2,
+	0x69, 0x77, 0x0b, 0xde, 0x54, 0x0f, 0x8d, 0x41, 0x6b, 0x7c, 0xad, 0x2e,
+	0xb5, 0x5a, 0x44, 0xb3, 0x8c, 0xee, 0xcf, 0x02, 0x2c, 0x77, 0x1a, 0x10,
+	0xa2, 0x5b, 0x1c, 0xd7, 0xd9, 0xc0, 0x58, 0xe7, 0x35, 0xf2, 0x9b, 0xb2,
+	0xf4, 0x13, 0xbd, 0xfe, 0xb3, 0x37, 0x97, 0x9d, 0xf0, 0x48, 0x28, 0x8a,
+	0x9e, 0xc5, 0x51, 0x2c, 0x72, 0x17, 0x25, 0x1d, 0xa3, 0x57, 0x3f, 0x47,
+	0x4e, 0x79, 0x5a, 0x14, 0xe4, 0x2f, 0xed, 0xcf, 0xd1, 0x65, 0x8a, 0xfb,
+	0x3b, 0xe1, 0xa0, 0x72, 0xec, 0xea, 0xa8, 0x50, 0x3f, 0xa5, 0x40, 0xcb,
+	0x8d, 0x94, 0x19, 0xbf, 0x7f, 0x74, 0x95, 0xf6, 0x61, 0x31, 0x78, 0x13,
+	0xf7, 0xdb, 0xd1, 0x4b, 0xce, 0x02, 0xc4, 0xf7, 0xce, 0xf0, 0xf2, 0x2f,
+	0x4b, 0x29, 0x00, 0x11, 0x9e, 0xf9, 0xff, 0x38, 0x88, 0x28, 0x2e, 0x7c,
+	0x99, 0x06, 0x78, 0xac, 0x5a, 0xdf, 0xaa, 0x59, 0x37, 0x7d, 0x9c, 0x64,
+	0x3b, 0x88, 0x14, 0x93, 0xb7, 0x09, 0xef, 0x90, 0x81, 0x60, 0xd5, 0xf5,
+	0x39, 0x74, 0x0d, 0x84, 0x68, 0xbb, 0xb7, 0xe9, 0xff, 0x9f, 0xd3, 0xb2,
+	0x3e, 0xf2, 0x33, 0xf6, 0x40, 0xa7, 0x4d, 0x99, 0x15, 0xbf, 0x13, 0x0d,
+	0x9e, 0x78, 0x65, 0x9e, 0x70, 0x0e, 0x4c, 0x2c, 0xfe, 0xda, 0xfb, 0x0b,
+	0x32, 0x1b, 0xb0, 0x30, 0x36, 0x6d, 0x1e, 0xb9, 0x7b, 0x26, 0xfa, 0xc9,
+	0xc1, 0x12, 0x5e, 0x20, 0x32, 0xcf, 0xe2, 0xd2, 0x25, 0xb7, 0x75, 0x1a,
+	0xa0, 0xf1, 0x4e, 0xc2, 0xad, 0xe1, 0x51, 0x2a, 0x22, 0xb1, 0x43, 0x03,
+	0x00, 0xd8, 0x70, 0x02, 0x51, 0xb4, 0xff, 0x27, 0x06, 0x69, 0xc0, 0xdf,
+	0xbb, 0xaa, 0x87, 0x9d, 0x04, 0x6c, 0x3b, 0xca, 0x2b, 0x6d, 0xef, 0x16,
+	0xaa, 0xb1, 0x6e, 0xae, 0x1e, 0x5a, 0x6a, 0x0a, 0xf8, 0x51, 0x5e, 0xbf,
+	0xcc, 0x7f, 0x3a, 0x2c, 0xe9, 0xc5, 0x50, 0x16, 0x14, 0x16, 0xa2, 0xc6,
+	0xb8, 0x40, 0x5b, 0xa4, 0xd0, 0x55, 0x68, 0x77, 0xc9, 0x05, 0x35, 0xc5,
+	0xcf, 0x6c, 0xfd, 0xd8, 0x57, 0xb6, 0x7f, 0x2d, 0xc9, 0xbe, 0x41, 0x9a,
+	0xff, 0x2f, 0xd2, 0xca, 0xbd, 0x2e, 0xa9, 0x54, 0x22, 0xfe, 0xa6, 0x67,
+	0x19, 0x5f, 0xf8, 0x8b, 0x78, 0x6f, 0xd1, 0xf3, 0xc1, 0xd7, 0xdd, 0x14,
+	0xd9, 0x0d, 0x29, 0x81, 0x5e, 0x20, 0x2e, 0xc9, 0x88, 0x99, 0x06, 0x18,
+	0xa3, 0x04, 0x59, 0xa7, 0xbd, 0x81, 0xd3, 0xa1, 0x74, 0xab, 0x4e, 0x17,
+	0xeb, 0xa1, 0x24, 0xf1, 0x30, 0x10, 0xb9, 0x0c, 0xbf, 0xeb, 0x14, 0x69,
+	0x57, 0x6f, 0xd2, 0xe2, 0x13, 0x9f, 0x52, 0x5a, 0x4a, 0xe8, 0xe6, 0xd1,
+	0xca, 0x77, 0x05, 0x96, 0xd9, 0x96, 0x04, 0x2b, 0x3a, 0x56, 0x49, 0xc5,
+	0x38, 0x5a, 0x70, 0x43, 0xca, 0x3f, 0xf3, 0x1a, 0xc6, 0x9c, 0x7e, 0x6c,
+	0x60, 0x6f, 0x06, 0xaf, 0x41, 0xb9, 0x98, 0x97, 0xbd, 0x0f, 0xb9, 0xa7,
+	0xdb, 0x0e, 0x5a, 0x86, 0x17, 0x9d, 0x34, 0xb7, 0x74, 0x87, 0xbe, 0x50,
+	0x43, 0x56, 0x4c, 0xa1, 0x57, 0x2b, 0xc8, 0xfe, 0xfa, 0xf1, 0x85, 0x73,
+	0x06, 0x8b, 0x74, 0xca, 0x77, 0x02, 0x50, 0x1c, 0x93, 0xf9, 0x8b, 0xd4,
+	0xe1, 0xe7, 0x65, 0xf9, 0x0a, 0x1e, 0x78, 0xb3, 0x6e, 0x2f, 0x93, 0x62,
+	0x4e, 0x50, 0xd4, 0x5b, 0x92, 0x7b, 0xcf, 0x2c, 0x8c, 0xce, 0x82, 0xa1,
+	0x9a, 0xa5, 0x82, 0xe2, 0xf4, 0x07, 0xc2, 0xd8, 0x59, 0x6e, 0x5e, 0xec,
+	0xe8, 0x29, 0xc9, 0x30, 0x15, 0xdd, 0x53, 0xee, 0x5d, 0xd8, 0x83, 0xb4,
+	0x06, 0x4e, 0xe8, 0xa8, 0x31, 0x88, 0x88, 0x60, 0x99, 0x16, 0x36, 0x64,
+	0xc9, 0x00, 0x56, 0x3a, 0x66, 0x65, 0x91, 0xda, 0xd2, 0x67, 0x4b, 0x40,
+	0xb6, 0x59, 0x32, 0x54, 0xde, 0x48, 0x86, 0x1f, 0xbb, 0x72, 0x2e, 0xce,
+	0x55, 0x18, 0x0b, 0xd0, 0x39, 0xa2, 0xff, 0x86, 0x5c, 0x5a, 0x8f, 0xde,
+	0x8f, 0xe6, 0x8a, 0x66, 0x4f, 0x3a, 0xfa, 0xbc, 0x6d, 0xf2, 0x79, 0x3a,
+	0xaf, 0x2d, 0xc1, 0x36, 0x49, 0xeb, 0xce, 0xbb, 0x2d, 0x9f, 0xd0, 0x8c,
+	0xe1, 0xb0, 0xff, 0xc0, 0xad, 0xc9, 0x90, 0xb7, 0x4d, 0xc1, 0xa6, 0x6b,
+	0x91, 0x8b, 0x3e, 0xb0, 0x46, 0x0a, 0x00, 0x8a, 0xfa, 0x05, 0x3f, 0x89,
+	0x95, 0x34, 0xff, 0xfe, 0x8e, 0xca, 0xcc,
+};
+
+static uint8_t lzma_test_mem[AL_LZMA_MEM_SIZE(LZMA_TEST_DICT, 3)];
+static uint8_t lzma_test_plain[LZMA_TEST_LEN];
+static uint8_t lzma_test_out[LZMA_TEST_LEN + 64];
+static size_t lzma_test_out_len;
+static uint32_t lzma_test_writes;
+static size_t lzma_test_fail_at;
+static size_t lzma_test_in_pos;
+
+/* lines of ten words picked by an LCG */
+static void lzma_test_text(uint8_t *buf, size_t len)
+{
+	static const char *words[] = {
+		"alumy ", "flash ", "bank ", "image ", "lzma ", "ymodem ", "sector ", "crc32 ",
+	};
+	uint32_t x = 1;
+	size_t off = 0, n;
+
+	for (uint_t i = 1; off < len; i++) {
+		x = x * 1103515245 + 12345;
+		n = min_t(size_t, strlen(words[(x >> 16) & 7]), len - off);
+		memcpy(buf + off, words[(x >> 16) & 7], n);
+		off += n;
+
+		if ((i % 10 == 0) && (off < len)) {
+			buf[off++] = '\n';
+		}
+	}
+}
+
+static int32_t lzma_test_write(void *ctx, const void *data, size_t len)
+{
+	if ((lzma_test_fail_at > 0) && (lzma_test_out_len + len >= lzma_test_fail_at)) {
+		return -1;
+	}
+
+	TEST_ASSERT_TRUE(lzma_test_out_len + len <= sizeof(lzma_test_out));
+	memcpy(lzma_test_out + lzma_test_out_len, data, len);
+	lzma_test_out_len += len;
+	lzma_test_writes++;
+
+	return 0;
+}
+
+static ssize_t lzma_test_read(void *ctx, void *buf, size_t len)
+{
+	len = min_t(size_t, len, sizeof(lzma_test_vec) - lzma_test_in_pos);
+
+	memcpy(buf, lzma_test_vec + lzma_test_in_pos, len);
+	lzma_test_in_pos += len;
+
+	return len;
+}
+
+TEST_GROUP(lzma);
+
+TEST_SETUP(lzma)
+{
+	lzma_test_text(lzma_test_plain, sizeof(lzma_test_plain));
+	lzma_test_out_len = 0;
+	lzma_test_writes = 0;
+	lzma_test_fail_at = 0;
+	lzma_test_in_pos = 0;
+}
+
+TEST_TEAR_DOWN(lzma)
+{
+
+}
+
+TEST(lzma, feed)
+{
+	static const size_t chunks[] = { sizeof(lzma_test_vec), 1024, 128, 13, 7, 1 };
+	al_lzma_stream_t s;
+	size_t off, n;
+
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_init(&s, lzma_test_mem, sizeof(lzma_test_mem),
+											 lzma_test_write, NULL));
+
+	for (size_t i = 0; i < ARRAY_SIZE(chunks); i++) {
+		al_lzma_stream_reset(&s);
+		lzma_test_out_len = 0;
+		lzma_test_writes = 0;
+
+		for (off = 0; off < sizeof(lzma_test_vec); off += n) {
+			n = min_t(size_t, chunks[i], sizeof(lzma_test_vec) - off);
+			TEST_ASSERT_EQUAL(0, al_lzma_stream_feed(&s, lzma_test_vec + off, n));
+		}
+
+		TEST_ASSERT_EQUAL(0, al_lzma_stream_end(&s));
+		TEST_ASSERT_TRUE(al_lzma_stream_size(&s) == AL_LZMA_SIZE_UNKNOWN);
+		TEST_ASSERT_EQUAL(LZMA_TEST_LEN, al_lzma_stream_len(&s));
+		TEST_ASSERT_EQUAL_HEX32(LZMA_TEST_CRC, al_lzma_stream_crc32(&s));
+		TEST_ASSERT_EQUAL(LZMA_TEST_LEN, lzma_test_out_len);
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(lzma_test_plain, lzma_test_out, LZMA_TEST_LEN);
+
+		/* fed whole, the output comes in runs of the whole dictionary */
+		if (i == 0) {
+			TEST_ASSERT_EQUAL(DIV_ROUND_UP(LZMA_TEST_LEN, LZMA_TEST_DICT), lzma_test_writes);
+		}
+	}
+}
+
+TEST(lzma, size)
+{
+	uint8_t vec[sizeof(lzma_test_vec) + 16];
+	al_lzma_stream_t s;
+
+	/* a size in the header stops before the end mark, the rest is ignored */
+	memcpy(vec, lzma_test_vec, sizeof(lzma_test_vec));
+	memset(vec + sizeof(lzma_test_vec), 0xFF, 16);
+	memset(vec + LZMA_PROPS_SIZE, 0, 8);
+	vec[LZMA_PROPS_SIZE] = LZMA_TEST_LEN & 0xFF;
+	vec[LZMA_PROPS_SIZE + 1] = LZMA_TEST_LEN >> 8;
+
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_init(&s, lzma_test_mem, sizeof(lzma_test_mem),
+											 lzma_test_write, NULL));
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_feed(&s, vec, sizeof(vec)));
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_end(&s));
+	TEST_ASSERT_TRUE(al_lzma_stream_size(&s) == LZMA_TEST_LEN);
+	TEST_ASSERT_EQUAL(LZMA_TEST_LEN, lzma_test_out_len);
+	TEST_ASSERT_EQUAL_HEX32(LZMA_TEST_CRC, al_lzma_stream_crc32(&s));
+
+	/* a shorter size is a prefix */
+	al_lzma_stream_reset(&s);
+	lzma_test_out_len = 0;
+	vec[LZMA_PROPS_SIZE] = 100;
+	vec[LZMA_PROPS_SIZE + 1] = 0;
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_feed(&s, vec, sizeof(vec)));
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_end(&s));
+	TEST_ASSERT_EQUAL(100, lzma_test_out_len);
+	TEST_ASSERT_EQUAL_HEX32(al_crc32(0, lzma_test_plain, 100), al_lzma_stream_crc32(&s));
+
+	/* a longer one runs into the end mark */
+	al_lzma_stream_reset(&s);
+	lzma_test_out_len = 0;
+	vec[LZMA_PROPS_SIZE + 2] = 1;
+	TEST_ASSERT_EQUAL(-1, al_lzma_stream_feed(&s, vec, sizeof(vec)));
+	TEST_ASSERT_EQUAL(EINVAL, errno);
+}
+
+TEST(lzma, decode)
+{
+	uint8_t buf[100];
+	al_lzma_stream_t s;
+
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_init(&s, lzma_test_mem, sizeof(lzma_test_mem),
+											 lzma_test_write, NULL));
+	TEST_ASSERT_EQUAL(LZMA_TEST_LEN, al_lzma_stream_decode(&s, lzma_test_read, NULL,
+														   buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_HEX32(LZMA_TEST_CRC, al_lzma_stream_crc32(&s));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(lzma_test_plain, lzma_test_out, LZMA_TEST_LEN);
+}
+
+TEST(lzma, error)
+{
+	uint8_t vec[sizeof(lzma_test_vec)];
+	al_lzma_stream_t s;
+
+	/* the dictionary does not fit */
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_init(&s, lzma_test_mem, sizeof(lzma_test_mem) / 2,
+											 lzma_test_write, NULL));
+	TEST_ASSERT_EQUAL(-1, al_lzma_stream_feed(&s, lzma_test_vec, sizeof(lzma_test_vec)));
+	TEST_ASSERT_EQUAL(ENOMEM, errno);
+
+	/* cut short */
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_init(&s, lzma_test_mem, sizeof(lzma_test_mem),
+											 lzma_test_write, NULL));
+	TEST_ASSERT_EQUAL(0, al_lzma_stream_feed(&s, lzma_test_vec, sizeof(lzma_test_vec) - 8));
+	TEST_ASSERT_EQUAL(-1, al_lzma_stream_end(&s));
+	TEST_ASSERT_EQUAL(EINVAL, errno);
+
+	/* bad properties */
+	al_lzma_stream_reset(&s);
+	memcpy(vec, lzma_test_vec, sizeof(vec));
+	vec[0] = 225;
+	TEST_ASSERT_EQUAL(-1, al_lzma_stream_feed(&s, vec, sizeof(vec)));
+	TEST_ASSERT_EQUAL(EINVAL, errno);
+
+	/* corrupt data fails or at least shows in the CRC */
+	al_lzma_stream_reset(&s);
+	lzma_test_out_len = 0;
+	vec[0] = lzma_test_vec[0];
+	vec[sizeof(vec) / 2] ^= 0x55;
+	if (al_lzma_stream_feed(&s, vec, sizeof(vec)) == 0 && al_lzma_stream_end(&s) == 0) {
+		TEST_ASSERT_NOT_EQUAL(LZMA_TEST_CRC, al_lzma_stream_crc32(&s));
+	}
+
+	/* a failing sink stops the stream, and it stays stopped */
+	al_lzma_stream_reset(&s);
+	lzma_test_out_len = 0;
+	lzma_test_fail_at = 5000;
+	TEST_ASSERT_EQUAL(-1, al_lzma_stream_feed(&s, lzma_test_vec, sizeof(lzma_test_vec)));
+	TEST_ASSERT_EQUAL(EIO, errno);
+	TEST_ASSERT_EQUAL(-1, al_lzma_stream_feed(&s, lzma_test_vec, 1));
+	TEST_ASSERT_EQUAL(EIO, errno);
+	TEST_ASSERT_EQUAL(-1, al_lzma_stream_end(&s));
+}
+
+static uint32_t lzma_test_opens;
+static size_t lzma_test_open_size;
+static bool lzma_test_close_ok;
+
+static int32_t lzma_test_sink_open(void *ctx, const char *filename, size_t filesize)
+{
+	TEST_ASSERT_EQUAL_STRING("fw.bin.lzma", filename);
+	lzma_test_opens++;
+	lzma_test_open_size = filesize;
+	return 0;
+}
+
+static int32_t lzma_test_sink_close(void *ctx, bool ok)
+{
+	lzma_test_close_ok = ok;
+	return 0;
+}
+
+TEST(lzma, ymodem_sink)
+{
+	static const al_ymodem_sink_t out = {
+		.open = lzma_test_sink_open,
+		.write = lzma_test_write,
+		.close = lzma_test_sink_close,
+	};
+	al_ymodem_sink_t sink;
+	al_lzma_ymodem_t z;
+	char name[] = "fw.bin.lzma";
+
+	TEST_ASSERT_EQUAL(0, al_lzma_ymodem_sink(&sink, &z, &out, lzma_test_mem,
+											 sizeof(lzma_test_mem), NULL, 0));
+
+	/* the name is kept, the buffer it came in is reused by the packets */
+	lzma_test_opens = 0;
+	TEST_ASSERT_EQUAL(0, sink.open(sink.ctx, name, sizeof(lzma_test_vec)));
+	memset(name, 0, sizeof(name));
+	TEST_ASSERT_EQUAL(0, lzma_test_opens);
+
+	for (size_t off = 0; off < sizeof(lzma_test_vec); off += 1024) {
+		TEST_ASSERT_EQUAL(0, sink.write(sink.ctx, lzma_test_vec + off,
+										min_t(size_t, 1024, sizeof(lzma_test_vec) - off)));
+	}
+
+	TEST_ASSERT_EQUAL(0, sink.close(sink.ctx, true));
+	TEST_ASSERT_EQUAL(1, lzma_test_opens);
+	TEST_ASSERT_EQUAL(0, lzma_test_open_size);
+	TEST_ASSERT_TRUE(lzma_test_close_ok);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(lzma_test_plain, lzma_test_out, LZMA_TEST_LEN);
+
+	/* a transfer cut short closes the sink behind as failed */
+	strcpy(name, "fw.bin.lzma");
+	lzma_test_out_len = 0;
+	TEST_ASSERT_EQUAL(0, sink.open(sink.ctx, name, sizeof(lzma_test_vec)));
+	TEST_ASSERT_EQUAL(0, sink.write(sink.ctx, lzma_test_vec, 1024));
+	TEST_ASSERT_EQUAL(-1, sink.close(sink.ctx, true));
+	TEST_ASSERT_FALSE(lzma_test_close_ok);
+}
+
+/* a NOR flash in RAM that programs units of 8 bytes */
+#define LZMA_TEST_SECTOR	4096
+
+static uint8_t lzma_test_flash[4 * LZMA_TEST_SECTOR];
+static bool lzma_test_flash_bad;
+
+static int32_t lzma_test_flash_prog(uint32_t addr, const void *buf, size_t len)
+{
+	if ((addr % 8) || (len % 8) ||
+		!al_mem_is_filled(lzma_test_flash + addr, 0xFF, len)) {
+		lzma_test_flash_bad = true;
+		return -1;
+	}
+
+	memcpy(lzma_test_flash + addr, buf, len);
+	return 0;
+}
+
+static int32_t lzma_test_flash_erase(uint32_t addr, size_t len)
+{
+	memset(lzma_test_flash + addr, 0xFF, len);
+	return 0;
+}
+
+TEST(lzma, ymodem_flash)
+{
+	static uint8_t buf[256];
+	al_ymodem_flash_t flash;
+	al_ymodem_sink_t out, sink;
+	al_lzma_ymodem_t z;
+
+	memset(&flash, 0, sizeof(flash));
+	memset(lzma_test_flash, 0, sizeof(lzma_test_flash));
+	lzma_test_flash_bad = false;
+
+	flash.size = sizeof(lzma_test_flash);
+	flash.sector_size = LZMA_TEST_SECTOR;
+	flash.align = 8;
+	flash.prog = lzma_test_flash_prog;
+	flash.erase = lzma_test_flash_erase;
+
+	TEST_ASSERT_EQUAL(0, al_ymodem_flash_sink(&out, &flash));
+	TEST_ASSERT_EQUAL(0, al_lzma_ymodem_sink(&sink, &z, &out, lzma_test_mem,
+											 sizeof(lzma_test_mem), buf,
+											 sizeof(buf)));
+
+	/* packets that cut the runs of the decoder at odd places */
+	TEST_ASSERT_EQUAL(0, sink.open(sink.ctx, "fw.bin.lzma", sizeof(lzma_test_vec)));
+
+	for (size_t off = 0; off < sizeof(lzma_test_vec); off += 100) {
+		TEST_ASSERT_EQUAL(0, sink.write(sink.ctx, lzma_test_vec + off,
+										min_t(size_t, 100, sizeof(lzma_test_vec) - off)));
+	}
+
+	TEST_ASSERT_EQUAL(0, sink.close(sink.ctx, true));
+	TEST_ASSERT_FALSE(lzma_test_flash_bad);
+	TEST_ASSERT_EQUAL(LZMA_TEST_LEN, flash.off);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(lzma_test_plain, lzma_test_flash, LZMA_TEST_LEN);
+	TEST_ASSERT_TRUE(al_mem_is_filled(lzma_test_flash + LZMA_TEST_LEN, 0xFF,
+									  flash.erased - LZMA_TEST_LEN));
+
+	TEST_ASSERT_EQUAL(-1, al_lzma_ymodem_sink(&sink, &z, &out, lzma_test_mem,
+											  sizeof(lzma_test_mem), buf, 0));
+}
+
+TEST_GROUP_RUNNER(lzma)
+{
+	RUN_TEST_CASE(lzma, feed);
+	RUN_TEST_CASE(lzma, size);
+	RUN_TEST_CASE(lzma, decode);
+	RUN_TEST_CASE(lzma, error);
+	RUN_TEST_CASE(lzma, ymodem_sink);
+	RUN_TEST_CASE(lzma, ymodem_flash);
+}
+
+static int32_t __add_lzma_tests(void)
+{
+	RUN_TEST_GROUP(lzma);
+	return 0;
+}
+
+al_test_suite_init(__add_lzma_tests);
+
+__END_DECLS
@@ -56,9 +56,120 @@ TEST(mem, al_mem_is_filled)
     TEST_ASSERT(!al_mem_is_filled(buf, 0xAA, sizeof(buf) - 3));
 }
 
+TEST(mem, stat)
+{
+    al_mem_stat_t st;
+
+    TEST_ASSERT_EQUAL(0, al_mem_stat_bucket(0));
+    TEST_ASSERT_EQUAL(0, al_mem_stat_bucket(16));
+    TEST_ASSERT_EQUAL(1, al_mem_stat_bucket(17));
+    TEST_ASSERT_EQUAL(6, al_mem_stat_bucket(1024));
+    TEST_ASSERT_EQUAL(AL_MEM_STAT_BUCKETS - 1, al_mem_stat_bucket(SIZE_MAX));
+
+    memset(&st, 0, sizeof(st));
+
+    al_mem_stat_alloc(&st, 100, 128);
+    al_mem_stat_alloc(&st, 20, 32);
+    al_mem_stat_alloc(&st, 4096, 0);
+    al_mem_stat_free(&st, 128);
+
+    TEST_ASSERT_EQUAL(2, st.nr_alloc);
+    TEST_ASSERT_EQUAL(1, st.nr_free);
+    TEST_ASSERT_EQUAL(1, st.nr_fail);
+    TEST_ASSERT_EQUAL(32, st.cur);
+    TEST_ASSERT_EQUAL(160, st.peak);
+    TEST_ASSERT_EQUAL(1, st.hist[al_mem_stat_bucket(100)]);
+    TEST_ASSERT_EQUAL(1, st.hist[al_mem_stat_bucket(20)]);
+    TEST_ASSERT_EQUAL(1, st.hist[al_mem_stat_bucket(4096)]);
+
+    al_mem_stat_reset(&st);
+    TEST_ASSERT_EQUAL(0, st.nr_alloc);
+    TEST_ASSERT_EQUAL(32, st.peak);
+}
+
+TEST(mem, tag)
+{
+    static AL_MEM_TAG_DEFINE(tag, "mem_test");
+    al_mem_tag_t *t;
+    void *p, *q;
+
+    p = al_mem_tag_malloc(&tag, 100);
+    q = al_mem_tag_malloc(&tag, 50);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_EQUAL(150, tag.stat.cur);
+
+    al_mem_tag_free(&tag, p);
+    al_mem_tag_free(&tag, q);
+    TEST_ASSERT_EQUAL(0, tag.stat.cur);
+    TEST_ASSERT_EQUAL(150, tag.stat.peak);
+
+    for (t = al_mem_tag_first(); t; t = t->next) {
+        if (t == &tag) {
+            break;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_PTR(&tag, t);
+}
+
+TEST(mem, heap)
+{
+    al_mem_stat_t before, after;
+    void *p;
+
+    TEST_ASSERT_EQUAL(0, al_os_get_heap_stat(&before));
+
+    p = al_os_malloc(1000);
+    TEST_ASSERT_NOT_NULL(p);
+
+    TEST_ASSERT_EQUAL(0, al_os_get_heap_stat(&after));
+    TEST_ASSERT_EQUAL(before.nr_alloc + 1, after.nr_alloc);
+    TEST_ASSERT_EQUAL(before.hist[al_mem_stat_bucket(1000)] + 1,
+                      after.hist[al_mem_stat_bucket(1000)]);
+    if (al_os_get_free_heap_size() != AL_OS_HEAP_SIZE_UNKNOWN) {
+        TEST_ASSERT(al_os_get_free_heap_size() > 0);
+        TEST_ASSERT(al_os_get_min_free_heap_size() <= al_os_get_free_heap_size());
+    } else {
+        TEST_ASSERT_EQUAL(AL_OS_HEAP_SIZE_UNKNOWN, al_os_get_min_free_heap_size());
+    }
+
+    al_os_free(p);
+
+    TEST_ASSERT_NULL(al_os_malloc(SIZE_MAX / 2));
+    TEST_ASSERT_EQUAL(0, al_os_get_heap_stat(&after));
+    TEST_ASSERT_EQUAL(before.nr_fail + 1, after.nr_fail);
+}
+
+TEST(mem, pool)
+{
+    struct item {
+        list_head_t link;
+        int32_t v;
+    } items[2];
+    al_pool_t po;
+
+    al_create_pool(&po, items, sizeof(items[0]), ARRAY_SIZE(items), 0);
+
+    TEST_ASSERT_NOT_NULL(al_get_from_pool(&po, 0));
+    TEST_ASSERT_NOT_NULL(al_get_from_pool(&po, 0));
+    TEST_ASSERT_NULL(al_get_from_pool(&po, 0));
+
+    al_put_into_pool(&po, &items[0], 0);
+    al_put_into_pool(&po, &items[1], 0);
+
+    TEST_ASSERT_EQUAL(0, po.nr_used);
+    TEST_ASSERT_EQUAL(2, po.nr_peak);
+    TEST_ASSERT_EQUAL(1, po.nr_fail);
+}
+
 TEST_GROUP_RUNNER(mem)
 {
     RUN_TEST_CASE(mem, al_mem_is_filled);
+    RUN_TEST_CASE(mem, stat);
+    RUN_TEST_CASE(mem, tag);
+    RUN_TEST_CASE(mem, heap);
+    RUN_TEST_CASE(mem, pool);
 }
 
 static int32_t __add_mem_tests(void)
@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+TEST_GROUP(osal);
+
+TEST_SETUP(osal)
+{
+
+}
+
+TEST_TEAR_DOWN(osal)
+{
+
+}
+
+TEST(osal, queue)
+{
+	al_os_queue_t q;
+	al_os_tick_t start;
+	int32_t v;
+
+	q = al_os_queue_create(3, sizeof(int32_t));
+	TEST_ASSERT_NOT_NULL(q);
+
+	v = 1;
+	TEST_ASSERT_EQUAL(0, al_os_queue_send(q, &v, 0));
+	v = 2;
+	TEST_ASSERT_EQUAL(0, al_os_queue_send_back(q, &v, 0));
+	v = 0;
+	TEST_ASSERT_EQUAL(0, al_os_queue_send_front(q, &v, 0));
+	TEST_ASSERT_EQUAL(3, al_os_queue_count(q));
+
+	/* full, the timeout must really elapse */
+	start = al_os_get_tick();
+	TEST_ASSERT_EQUAL(-1, al_os_queue_send(q, &v, 20));
+	TEST_ASSERT(al_os_tick2ms(al_os_get_tick() - start) >= 20);
+
+	TEST_ASSERT_EQUAL(0, al_os_queue_peek(q, &v, 0));
+	TEST_ASSERT_EQUAL(0, v);
+
+	for (int32_t i = 0; i < 3; i++) {
+		TEST_ASSERT_EQUAL(0, al_os_queue_recv(q, &v, 0));
+		TEST_ASSERT_EQUAL(i, v);
+	}
+
+	TEST_ASSERT_EQUAL(-1, al_os_queue_recv(q, &v, 0));
+	TEST_ASSERT_EQUAL(-1, al_os_queue_recv(q, &v, 10));
+
+	TEST_ASSERT_EQUAL(0, al_os_queue_del(q));
+}
+
+TEST(osal, sem)
+{
+	al_os_sem_t sem;
+	al_os_mutex_t mutex;
+
+	sem = al_os_sem_count_create(2, 1);
+	TEST_ASSERT_NOT_NULL(sem);
+
+	TEST_ASSERT_EQUAL(0, al_os_sem_give(sem));
+	TEST_ASSERT_EQUAL(-1, al_os_sem_give(sem));
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(sem, 0));
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(sem, 0));
+	TEST_ASSERT_EQUAL(-1, al_os_sem_take(sem, 10));
+
+	al_os_sem_count_del(sem);
+
+	mutex = al_os_mutex_create();
+	TEST_ASSERT_NOT_NULL(mutex);
+
+	TEST_ASSERT_EQUAL(0, al_os_mutex_take(mutex, -1));
+	TEST_ASSERT_EQUAL(-1, al_os_mutex_take(mutex, 0));
+	TEST_ASSERT_EQUAL(0, al_os_mutex_give(mutex));
+	TEST_ASSERT_EQUAL(0, al_os_mutex_take(mutex, 0));
+	TEST_ASSERT_EQUAL(0, al_os_mutex_give(mutex));
+
+	al_os_mutex_del(mutex);
+}
+
+static void osal_task_func(void *arg)
+{
+	al_os_sem_t *sem = (al_os_sem_t *)arg;
+
+	al_os_sem_take(sem[0], -1);
+	al_os_sem_give(sem[1]);
+
+	al_os_task_delete(NULL);
+}
+
+TEST(osal, task)
+{
+	al_os_sem_t sem[2];
+	al_os_task_t *task;
+
+	sem[0] = al_os_sem_bin_create();
+	sem[1] = al_os_sem_bin_create();
+	TEST_ASSERT_NOT_NULL(sem[0]);
+	TEST_ASSERT_NOT_NULL(sem[1]);
+
+	task = al_os_task_create("osal", 1, 4096, osal_task_func, sem);
+	TEST_ASSERT_NOT_NULL(task);
+	TEST_ASSERT_EQUAL(1, al_os_task_get_prio(*task));
+
+	TEST_ASSERT_EQUAL(0, al_os_sem_give(sem[0]));
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(sem[1], 1000));
+
+	al_os_sem_bin_del(sem[0]);
+	al_os_sem_bin_del(sem[1]);
+}
+
+static void osal_task_return(void *arg)
+{
+	al_os_sem_give((al_os_sem_t)arg);
+}
+
+static void osal_task_block(void *arg)
+{
+	al_os_sem_give((al_os_sem_t)arg);
+	al_os_delay(-1);
+}
+
+TEST(osal, task_delete)
+{
+	al_os_task_t *task;
+	al_os_sem_t sem;
+
+	sem = al_os_sem_bin_create();
+	TEST_ASSERT_NOT_NULL(sem);
+
+	/* the handle outlives a task that returned */
+	task = al_os_task_create("osal", 1, 0, osal_task_return, sem);
+	TEST_ASSERT_NOT_NULL(task);
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(sem, 1000));
+	al_os_delay(20);
+	TEST_ASSERT_EQUAL(1, al_os_task_get_prio(*task));
+	TEST_ASSERT_EQUAL(0, al_os_task_delete(task));
+
+	/* and a running one is cancelled */
+	task = al_os_task_create("osal", 1, 0, osal_task_block, sem);
+	TEST_ASSERT_NOT_NULL(task);
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(sem, 1000));
+	TEST_ASSERT_EQUAL(0, al_os_task_delete(task));
+
+	al_os_sem_bin_del(sem);
+}
+
+static void osal_task_recv(void *arg)
+{
+	void **args = (void **)arg;
+	int32_t v;
+
+	al_os_sem_give((al_os_sem_t)args[1]);
+	al_os_queue_recv((al_os_queue_t)args[0], &v, -1);
+}
+
+TEST(osal, task_delete_blocked)
+{
+	al_os_task_t *task;
+	void *args[2];
+	int32_t v;
+
+	args[0] = al_os_queue_create(1, sizeof(int32_t));
+	args[1] = al_os_sem_bin_create();
+	TEST_ASSERT_NOT_NULL(args[0]);
+	TEST_ASSERT_NOT_NULL(args[1]);
+
+	/* deleted while it waits, the queue must stay usable */
+	task = al_os_task_create("osal", 1, 0, osal_task_recv, args);
+	TEST_ASSERT_NOT_NULL(task);
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(args[1], 1000));
+	al_os_delay(20);
+	TEST_ASSERT_EQUAL(0, al_os_task_delete(task));
+
+	v = 5;
+	TEST_ASSERT_EQUAL(0, al_os_queue_send(args[0], &v, 100));
+	v = 0;
+	TEST_ASSERT_EQUAL(0, al_os_queue_recv(args[0], &v, 100));
+	TEST_ASSERT_EQUAL(5, v);
+
+	TEST_ASSERT_EQUAL(0, al_os_queue_del(args[0]));
+	al_os_sem_bin_del(args[1]);
+}
+
+static void osal_timer_cb(void *arg)
+{
+	al_os_sem_give((al_os_sem_t)arg);
+}
+
+TEST(osal, timer)
+{
+	al_os_sem_t sem;
+	al_os_timer_t *tmr;
+
+	sem = al_os_sem_count_create(16, 0);
+	TEST_ASSERT_NOT_NULL(sem);
+
+	tmr = al_os_timer_create("osal", 5, true, osal_timer_cb, sem);
+	TEST_ASSERT_NOT_NULL(tmr);
+
+	/* not started yet */
+	TEST_ASSERT_EQUAL(-1, al_os_sem_take(sem, 20));
+
+	TEST_ASSERT_EQUAL(0, al_os_timer_start(tmr));
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(sem, 1000));
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(sem, 1000));
+
+	TEST_ASSERT_EQUAL(0, al_os_timer_del(tmr));
+
+	al_os_delay(20);
+	al_os_sem_reset(sem);
+	TEST_ASSERT_EQUAL(-1, al_os_sem_take(sem, 20));
+
+	al_os_sem_count_del(sem);
+}
+
+#define OSAL_TIMERS		1000
+
+static void osal_timer_count(void *arg)
+{
+	__atomic_add_fetch((int_t *)arg, 1, __ATOMIC_RELAXED);
+}
+
+TEST(osal, timer_many)
+{
+	static al_os_timer_t *tmr[OSAL_TIMERS];
+	int_t fired = 0;
+	int_t i;
+
+	for (i = 0; i < OSAL_TIMERS; i++) {
+		tmr[i] = al_os_timer_create("osal", 1 + i % 50, false,
+									osal_timer_count, &fired);
+		TEST_ASSERT_NOT_NULL(tmr[i]);
+		TEST_ASSERT_EQUAL(0, al_os_timer_start(tmr[i]));
+	}
+
+	/* the second half is stopped before it expires */
+	for (i = OSAL_TIMERS / 2; i < OSAL_TIMERS; i++) {
+		if (i % 50 >= 40) {
+			TEST_ASSERT_EQUAL(0, al_os_timer_stop(tmr[i]));
+		}
+	}
+
+	TEST_ASSERT_TRUE(al_os_timer_poll() <= 50);
+
+	al_os_delay(200);
+
+	TEST_ASSERT_EQUAL(OSAL_TIMERS - OSAL_TIMERS / 2 / 5,
+					  __atomic_load_n(&fired, __ATOMIC_RELAXED));
+	TEST_ASSERT_EQUAL(-1, al_os_timer_poll());
+
+	for (i = 0; i < OSAL_TIMERS; i++) {
+		TEST_ASSERT_EQUAL(0, al_os_timer_del(tmr[i]));
+	}
+}
+
+static void osal_worker_func(void *arg)
+{
+	al_os_sem_give((al_os_sem_t)arg);
+}
+
+TEST(osal, worker)
+{
+	static al_worker_t worker;
+	al_os_sem_t sem;
+
+	sem = al_os_sem_count_create(64, 0);
+	TEST_ASSERT_NOT_NULL(sem);
+
+	TEST_ASSERT_EQUAL(0, al_worker_init(&worker, 8, "worker", 1, 4096));
+	TEST_ASSERT_EQUAL(0, al_worker_check(&worker));
+
+	for (int_t i = 0; i < 32; i++) {
+		TEST_ASSERT_EQUAL(0, al_worker_run(&worker, osal_worker_func, sem, -1));
+	}
+
+	for (int_t i = 0; i < 32; i++) {
+		TEST_ASSERT_EQUAL(0, al_os_sem_take(sem, 1000));
+	}
+
+	TEST_ASSERT_EQUAL(-1, al_os_sem_take(sem, 0));
+
+	al_os_sem_count_del(sem);
+}
+
+static void osal_worker_pool_func(void *arg)
+{
+	__atomic_add_fetch((int32_t *)arg, 1, __ATOMIC_RELAXED);
+}
+
+TEST(osal, worker_pool)
+{
+	static al_worker_pool_t pool;
+	al_worker_item_t items[256];
+	int32_t count = 0;
+
+	TEST_ASSERT_EQUAL(0, al_worker_pool_init(&pool, 4, 64, "pool", 1, 4096));
+
+	for (int_t i = 0; i < 1000; i++) {
+		TEST_ASSERT_EQUAL(0, al_worker_pool_run(&pool, osal_worker_pool_func,
+												&count, -1));
+	}
+
+	for (int_t i = 0; i < ARRAY_SIZE(items); i++) {
+		items[i].func = osal_worker_pool_func;
+		items[i].arg = &count;
+	}
+
+	TEST_ASSERT_EQUAL(ARRAY_SIZE(items),
+					  al_worker_pool_run_batch(&pool, items,
+											   ARRAY_SIZE(items), -1));
+
+	/* deinit runs what is still queued */
+	TEST_ASSERT_EQUAL(0, al_worker_pool_deinit(&pool));
+	TEST_ASSERT_EQUAL(1000 + ARRAY_SIZE(items), count);
+	TEST_ASSERT_EQUAL(-1, al_worker_pool_deinit(&pool));
+}
+
+TEST_GROUP_RUNNER(osal)
+{
+	RUN_TEST_CASE(osal, queue);
+	RUN_TEST_CASE(osal, sem);
+	RUN_TEST_CASE(osal, task);
+	RUN_TEST_CASE(osal, task_delete);
+	RUN_TEST_CASE(osal, task_delete_blocked);
+	RUN_TEST_CASE(osal, timer);
+	RUN_TEST_CASE(osal, timer_many);
+	RUN_TEST_CASE(osal, worker);
+	RUN_TEST_CASE(osal, worker_pool);
+}
+
+static int32_t __add_osal_tests(void)
+{
+	RUN_TEST_GROUP(osal);
+	return 0;
+}
+
+al_test_suite_init(__add_osal_tests);
+
+__END_DECLS
+
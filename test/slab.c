@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+TEST_GROUP(slab);
+
+TEST_SETUP(slab)
+{
+
+}
+
+TEST_TEAR_DOWN(slab)
+{
+
+}
+
+TEST(slab, classes)
+{
+	static uint8_t buf[1024];
+	const uint32_t nmemb[] = { 4, 2, 1 };
+	al_slab_t slab = { 0 };
+	void *p[4], *q;
+
+	TEST_ASSERT_NULL(al_slab_alloc(&slab, 10));
+	TEST_ASSERT_EQUAL(-1, al_slab_init(&slab, buf, 64, nmemb,
+									   ARRAY_SIZE(nmemb), 0));
+	TEST_ASSERT_EQUAL(0, al_slab_init(&slab, buf, sizeof(buf), nmemb,
+									  ARRAY_SIZE(nmemb), 0));
+
+	for (int_t i = 0; i < 4; i++) {
+		p[i] = al_slab_alloc(&slab, 10);
+		TEST_ASSERT_NOT_NULL(p[i]);
+		TEST_ASSERT_EQUAL(0, (uintptr_t)p[i] % AL_SLAB_MIN_SIZE);
+		TEST_ASSERT_TRUE(al_slab_owns(&slab, p[i]));
+	}
+
+	TEST_ASSERT_EQUAL(0, slab.cls[0].pool.nr_free);
+	TEST_ASSERT_EQUAL(4, slab.cls[0].pool.nr_used);
+
+	/* the 16 byte class is empty, the next one steps in */
+	q = al_slab_alloc(&slab, 1);
+	TEST_ASSERT_EQUAL_PTR(slab.cls[1].base, q);
+	al_slab_free(&slab, q);
+
+	al_slab_free(&slab, p[2]);
+	TEST_ASSERT_EQUAL_PTR(p[2], al_slab_alloc(&slab, 16));
+
+	TEST_ASSERT_EQUAL_PTR(slab.cls[2].base, al_slab_alloc(&slab, 64));
+	TEST_ASSERT_NULL(al_slab_alloc(&slab, 64));
+	TEST_ASSERT_NULL(al_slab_alloc(&slab, 65));
+
+	/* too large for the slab, served by the heap */
+	q = al_slab_malloc(&slab, 100);
+	TEST_ASSERT_NOT_NULL(q);
+	TEST_ASSERT_FALSE(al_slab_owns(&slab, q));
+	al_slab_free(&slab, q);
+
+	TEST_ASSERT_EQUAL(4, slab.cls[0].pool.nr_peak);
+	TEST_ASSERT_TRUE(slab.cls[0].pool.nr_fail > 0);
+	TEST_ASSERT_EQUAL(3, slab.stat.nr_fail);
+	/* 65 and 100 bytes share the 128 byte bucket */
+	TEST_ASSERT_EQUAL(2, slab.stat.hist[al_mem_stat_bucket(65)]);
+
+	TEST_ASSERT_EQUAL(0, al_slab_deinit(&slab));
+	TEST_ASSERT_EQUAL(-1, al_slab_deinit(&slab));
+}
+
+TEST(slab, heap)
+{
+	const uint32_t nmemb[] = { 8, 8, 8, 8 };
+	al_slab_t slab = { 0 };
+	uint8_t *p;
+
+	TEST_ASSERT_EQUAL(0, al_slab_init(&slab, NULL, 0, nmemb,
+									  ARRAY_SIZE(nmemb), AL_SLAB_F_LOCKFREE));
+
+	al_heap_set_slab(&slab);
+
+	p = (uint8_t *)al_heap_calloc(4, 8);
+	TEST_ASSERT_TRUE(al_slab_owns(&slab, p));
+	TEST_ASSERT_TRUE(al_mem_is_filled(p, 0, 32));
+	al_heap_free(p);
+
+	TEST_ASSERT_EQUAL(0, slab.cls[1].pool.nr_used);
+
+	al_heap_set_slab(NULL);
+
+	TEST_ASSERT_EQUAL(0, al_slab_deinit(&slab));
+}
+
+#define SLAB_MT_THREADS		4
+#define SLAB_MT_COUNT		20000
+
+static al_slab_t slab_mt;
+
+static void slab_mt_task(void *arg)
+{
+	void *p[8];
+
+	for (int_t n = 0; n < SLAB_MT_COUNT; n++) {
+		for (int_t i = 0; i < ARRAY_SIZE(p); i++) {
+			p[i] = al_slab_alloc(&slab_mt, 16 << (i & 3));
+			if (p[i]) {
+				memset(p[i], i, 16);
+			}
+		}
+
+		for (int_t i = 0; i < ARRAY_SIZE(p); i++) {
+			if (p[i]) {
+				/* a block is never handed to two threads at once */
+				if (!al_mem_is_filled(p[i], i, 16)) {
+					__atomic_store_n((int32_t *)((void **)arg)[1], 1,
+									 __ATOMIC_RELAXED);
+				}
+
+				al_slab_free(&slab_mt, p[i]);
+			}
+		}
+	}
+
+	al_slab_flush(&slab_mt);
+
+	al_os_sem_give((al_os_sem_t)((void **)arg)[0]);
+	al_os_task_delete(NULL);
+}
+
+static void slab_mt_run(uint32_t flags)
+{
+	const uint32_t nmemb[] = { 16, 16, 16, 16 };
+	al_os_sem_t done;
+	int32_t corrupt = 0;
+	void *args[2];
+
+	TEST_ASSERT_EQUAL(0, al_slab_init(&slab_mt, NULL, 0, nmemb,
+									  ARRAY_SIZE(nmemb), flags));
+
+	done = al_os_sem_count_create(SLAB_MT_THREADS, 0);
+	TEST_ASSERT_NOT_NULL(done);
+
+	args[0] = done;
+	args[1] = &corrupt;
+
+	for (int_t i = 0; i < SLAB_MT_THREADS; i++) {
+		TEST_ASSERT_NOT_NULL(al_os_task_create("slab", 1, 0, slab_mt_task, args));
+	}
+
+	for (int_t i = 0; i < SLAB_MT_THREADS; i++) {
+		TEST_ASSERT_EQUAL(0, al_os_sem_take(done, 10000));
+	}
+
+	TEST_ASSERT_EQUAL(0, corrupt);
+
+	for (int_t i = 0; i < ARRAY_SIZE(nmemb); i++) {
+		TEST_ASSERT_EQUAL(nmemb[i], slab_mt.cls[i].pool.nr_free);
+		TEST_ASSERT_EQUAL(0, slab_mt.cls[i].pool.nr_used);
+	}
+
+	al_os_sem_count_del(done);
+
+	TEST_ASSERT_EQUAL(0, al_slab_deinit(&slab_mt));
+}
+
+TEST(slab, lockfree)
+{
+	slab_mt_run(AL_SLAB_F_LOCKFREE);
+}
+
+TEST(slab, magazine)
+{
+	slab_mt_run(AL_SLAB_F_MAGAZINE);
+}
+
+TEST_GROUP_RUNNER(slab)
+{
+	RUN_TEST_CASE(slab, classes);
+	RUN_TEST_CASE(slab, heap);
+	RUN_TEST_CASE(slab, lockfree);
+	RUN_TEST_CASE(slab, magazine);
+}
+
+static int32_t __add_slab_tests(void)
+{
+	RUN_TEST_GROUP(slab);
+	return 0;
+}
+
+al_test_suite_init(__add_slab_tests);
+
+__END_DECLS
+
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "alumy/net/slip.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define SLIP_TEST_LEN		1500
+
+static uint8_t slip_out[AL_SLIP_ENCODE_MAX(SLIP_TEST_LEN) * 4];
+static size_t slip_out_len;
+static size_t slip_in_pos;
+static uint32_t slip_writes;
+
+static uint8_t slip_data[SLIP_TEST_LEN];
+static uint8_t slip_enc[AL_SLIP_ENCODE_MAX(SLIP_TEST_LEN) * 4];
+static uint8_t slip_recv[SLIP_TEST_LEN + 1];
+
+static int_t slip_test_putc(int_t c)
+{
+	slip_out[slip_out_len++] = c;
+	return c;
+}
+
+static int_t slip_test_write(const void *buf, size_t len)
+{
+	memcpy(slip_out + slip_out_len, buf, len);
+	slip_out_len += len;
+	slip_writes++;
+	return 0;
+}
+
+static int_t slip_test_getc(void)
+{
+	return (slip_in_pos < slip_out_len) ? slip_out[slip_in_pos++] : EOF;
+}
+
+static const al_slip_opt_t slip_opt_putc = {
+	.sl_putc = slip_test_putc,
+	.sl_getc = slip_test_getc,
+};
+
+static const al_slip_opt_t slip_opt_write = {
+	.sl_write = slip_test_write,
+};
+
+/* random bytes, with 1 in density of them END or ESC */
+static void slip_test_fill(uint8_t *buf, size_t len, int_t density)
+{
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = rand();
+
+		if ((density > 0) && (rand() % density == 0)) {
+			buf[i] = (rand() & 1) ? 0xC0 : 0xDB;
+		}
+	}
+}
+
+TEST_GROUP(slip);
+
+TEST_SETUP(slip)
+{
+	slip_out_len = 0;
+	slip_in_pos = 0;
+	slip_writes = 0;
+}
+
+TEST_TEAR_DOWN(slip)
+{
+
+}
+
+TEST(slip, encode)
+{
+	static const uint8_t data[] = { 0x41, 0xC0, 0x42, 0xDB };
+	static const uint8_t enc[] = {
+		0xC0, 0x41, 0xDB, 0xDC, 0x42, 0xDB, 0xDD, 0xC0
+	};
+	uint8_t out[16];
+
+	TEST_ASSERT_EQUAL(sizeof(enc), al_slip_encode(out, sizeof(out),
+												  data, sizeof(data)));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(enc, out, sizeof(enc));
+
+	TEST_ASSERT_EQUAL(2, al_slip_encode(out, sizeof(out), NULL, 0));
+	TEST_ASSERT_EQUAL_HEX8(0xC0, out[0]);
+	TEST_ASSERT_EQUAL_HEX8(0xC0, out[1]);
+
+	/* an escape is never split and the last delimiter always fits */
+	TEST_ASSERT_EQUAL(-1, al_slip_encode(out, sizeof(enc) - 1, data, sizeof(data)));
+	TEST_ASSERT_EQUAL(ENOBUFS, errno);
+	TEST_ASSERT_EQUAL(-1, al_slip_encode(out, 3, data, sizeof(data)));
+	TEST_ASSERT_EQUAL(ENOBUFS, errno);
+	TEST_ASSERT_EQUAL(-1, al_slip_encode(out, 1, NULL, 0));
+	TEST_ASSERT_EQUAL(ENOBUFS, errno);
+}
+
+TEST(slip, write)
+{
+	static const int_t density[] = { 0, 1, 3, 64 };
+	static const size_t lens[] = { 0, 1, 7, 8, 63, 64, 127, 128, 129, 1500 };
+	al_slip_t putc_slip, write_slip;
+	size_t putc_len;
+	ssize_t enc_len;
+
+	TEST_ASSERT_EQUAL(0, al_slip_init(&putc_slip, slip_recv, sizeof(slip_recv),
+									  &slip_opt_putc));
+	TEST_ASSERT_EQUAL(0, al_slip_init(&write_slip, slip_recv, sizeof(slip_recv),
+									  &slip_opt_write));
+
+	for (size_t d = 0; d < ARRAY_SIZE(density); d++) {
+		for (size_t l = 0; l < ARRAY_SIZE(lens); l++) {
+			slip_test_fill(slip_data, lens[l], density[d]);
+
+			/* the byte by byte output is the reference */
+			slip_out_len = 0;
+			TEST_ASSERT_EQUAL(lens[l], al_slip_write(&putc_slip, slip_data, lens[l]));
+			putc_len = slip_out_len;
+			memcpy(slip_enc, slip_out, putc_len);
+
+			slip_out_len = 0;
+			slip_writes = 0;
+			TEST_ASSERT_EQUAL(lens[l], al_slip_write(&write_slip, slip_data, lens[l]));
+			TEST_ASSERT_EQUAL(putc_len, slip_out_len);
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(slip_enc, slip_out, putc_len);
+			TEST_ASSERT_TRUE(slip_writes <= putc_len / (AL_SLIP_WRITE_BUF - 1) + 1);
+
+			enc_len = al_slip_encode(slip_out, sizeof(slip_out), slip_data, lens[l]);
+			TEST_ASSERT_EQUAL(putc_len, enc_len);
+			TEST_ASSERT_EQUAL_HEX8_ARRAY(slip_enc, slip_out, putc_len);
+		}
+	}
+}
+
+TEST(slip, decode)
+{
+	static const size_t lens[] = { 1, 300, 8, 1500, 64 };
+	size_t pos[ARRAY_SIZE(lens)];
+	size_t enc_len = 0, off, used, n, chunk;
+	uint_t frame;
+	al_slip_t slip;
+
+	TEST_ASSERT_EQUAL(0, al_slip_init(&slip, slip_recv, sizeof(slip_recv),
+									  &slip_opt_putc));
+
+	/* all frames back to back in one buffer */
+	slip_test_fill(slip_data, sizeof(slip_data), 16);
+	for (size_t i = 0, o = 0; i < ARRAY_SIZE(lens); o += lens[i++]) {
+		pos[i] = o % (sizeof(slip_data) - lens[i] + 1);
+		enc_len += al_slip_encode(slip_enc + enc_len, sizeof(slip_enc) - enc_len,
+								  slip_data + pos[i], lens[i]);
+	}
+
+	/* one chunk, then chunks of every size up to a few words */
+	for (chunk = enc_len; chunk > 0; chunk = (chunk > 17) ? 17 : chunk - 1) {
+		frame = 0;
+		off = 0;
+
+		while (off < enc_len) {
+			n = al_slip_decode(&slip, slip_enc + off,
+							   min_t(size_t, chunk, enc_len - off), &used);
+			off += used;
+
+			if (n > 0) {
+				TEST_ASSERT_TRUE(frame < ARRAY_SIZE(lens));
+				TEST_ASSERT_EQUAL(lens[frame], n);
+				TEST_ASSERT_EQUAL_HEX8_ARRAY(slip_data + pos[frame],
+											 al_slip_get_recv(&slip), n);
+				frame++;
+			}
+		}
+
+		TEST_ASSERT_EQUAL(ARRAY_SIZE(lens), frame);
+	}
+}
+
+TEST(slip, recv)
+{
+	al_slip_t slip;
+	size_t used;
+
+	TEST_ASSERT_EQUAL(0, al_slip_init(&slip, slip_recv, sizeof(slip_recv),
+									  &slip_opt_putc));
+
+	slip_test_fill(slip_data, 200, 4);
+	al_slip_write(&slip, slip_data, 200);
+	al_slip_write(&slip, slip_data + 100, 50);
+
+	TEST_ASSERT_EQUAL(200, al_slip_recv(&slip));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(slip_data, slip_recv, 200);
+
+	/* the leading delimiter of the next frame ends nothing */
+	TEST_ASSERT_EQUAL(50, al_slip_recv(&slip));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(slip_data + 100, slip_recv, 50);
+	TEST_ASSERT_EQUAL(0, al_slip_recv(&slip));
+
+	/* nothing between two delimiters is no frame */
+	TEST_ASSERT_EQUAL(0, al_slip_decode(&slip, "\xC0\xC0\xC0", 3, &used));
+	TEST_ASSERT_EQUAL(3, used);
+}
+
+TEST(slip, overflow)
+{
+	uint8_t recv[17];
+	al_slip_t slip;
+	size_t len;
+
+	/* the last byte of recv guards the 16 of the buffer */
+	TEST_ASSERT_EQUAL(0, al_slip_init(&slip, recv, 16, &slip_opt_putc));
+	memset(recv, 0x5A, sizeof(recv));
+
+	memset(slip_data, 0x11, 40);
+	len = al_slip_encode(slip_enc, sizeof(slip_enc), slip_data, 40);
+
+	TEST_ASSERT_EQUAL(16, al_slip_decode(&slip, slip_enc, len, NULL));
+	TEST_ASSERT_EQUAL_HEX8(0x5A, recv[16]);
+
+	/* the same through the byte path */
+	slip_out_len = 0;
+	al_slip_write(&slip, slip_data, 40);
+	TEST_ASSERT_EQUAL(16, al_slip_recv(&slip));
+	TEST_ASSERT_EQUAL_HEX8(0x5A, recv[16]);
+
+	/* and a cut frame leaves the next one intact */
+	memset(slip_data, 0xC0, 8);
+	len = al_slip_encode(slip_enc, sizeof(slip_enc), slip_data, 8);
+	TEST_ASSERT_EQUAL(8, al_slip_decode(&slip, slip_enc, len, NULL));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(slip_data, recv, 8);
+}
+
+TEST_GROUP_RUNNER(slip)
+{
+	RUN_TEST_CASE(slip, encode);
+	RUN_TEST_CASE(slip, write);
+	RUN_TEST_CASE(slip, decode);
+	RUN_TEST_CASE(slip, recv);
+	RUN_TEST_CASE(slip, overflow);
+}
+
+static int32_t __add_slip_tests(void)
+{
+	RUN_TEST_GROUP(slip);
+	return 0;
+}
+
+al_test_suite_init(__add_slip_tests);
+
+__END_DECLS
@@ -30,6 +30,8 @@ int main(int argc, char *argv[])
 {
     bsp_init();
 
+    alumy_init();
+
     const char *__argv[] = {
         "alumy",
     };
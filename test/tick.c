@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+static volatile int tick_stop;
+
+static void *tick_writer(void *arg)
+{
+	UNUSED(arg);
+
+	while (!tick_stop) {
+		/* both halves of the 64-bit tick change at once */
+		al_tick_adj(0xFFFFFFFF);
+		al_tick_inc();
+	}
+
+	return NULL;
+}
+
+TEST_GROUP(tick);
+
+TEST_SETUP(tick)
+{
+	al_tick_init();
+}
+
+TEST_TEAR_DOWN(tick)
+{
+	al_tick_init();
+}
+
+TEST(tick, rollover)
+{
+	al_tick_adj(999);
+	TEST_ASSERT_EQUAL(0, al_tick_get_sec());
+	TEST_ASSERT_EQUAL(999, al_tick_get_msec());
+
+	al_tick_inc();
+	TEST_ASSERT_EQUAL(1, al_tick_get_sec());
+	TEST_ASSERT_EQUAL(0, al_tick_get_msec());
+	TEST_ASSERT_EQUAL(1000, al_tick_get_tick());
+
+	al_tick_adj(1000);
+	TEST_ASSERT_EQUAL(2, al_tick_get_sec());
+	TEST_ASSERT_EQUAL(0, al_tick_get_msec());
+}
+
+TEST(tick, wrap)
+{
+	uint32_t last;
+
+	al_tick_adj(0xFFFFFFFF);
+	last = al_tick_get_tick();
+	al_tick_adj(0xFFFFFFFF);
+
+	/* the 32-bit view wraps, the 64-bit tick does not */
+	TEST_ASSERT_TRUE(al_tick_get_tick64() == 0x1FFFFFFFEULL);
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFE, al_tick_get_tick());
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, al_tick_elapsed_tick(last));
+	TEST_ASSERT_EQUAL(0x1FFFFFFFEULL / 1000, al_tick_get_sec());
+}
+
+TEST(tick, ns)
+{
+	uint64_t t0, t1;
+
+	TEST_ASSERT_EQUAL(0, al_tick_hires_init(0));
+
+	t0 = al_tick_get_ns();
+	al_os_delay(2);
+	t1 = al_tick_get_ns();
+
+	TEST_ASSERT_TRUE(t1 - t0 >= 2000000);
+	TEST_ASSERT_TRUE(t1 - t0 < 1000000000);
+
+	/* finer than the tick */
+	t0 = al_tick_get_ns();
+	do {
+		t1 = al_tick_get_ns();
+	} while (t1 == t0);
+
+	TEST_ASSERT_TRUE(t1 - t0 < 1000000);
+}
+
+TEST(tick, tear)
+{
+	pthread_t th;
+	uint64_t t, last = 0;
+	uint32_t i;
+
+	tick_stop = 0;
+	TEST_ASSERT_EQUAL(0, pthread_create(&th, NULL, tick_writer, NULL));
+
+	for (i = 0; i < 1000000; i++) {
+		t = al_tick_get_tick64();
+
+		TEST_ASSERT_TRUE(t >= last);
+		TEST_ASSERT_TRUE(((uint32_t)t == 0) || ((uint32_t)t == 0xFFFFFFFF));
+		last = t;
+	}
+
+	tick_stop = 1;
+	pthread_join(th, NULL);
+
+	TEST_ASSERT_TRUE(last > 0);
+}
+
+TEST(tick, stamp)
+{
+	char ts[AL_LOG_STAMP_MAX];
+	unsigned long sec, usec;
+	size_t len;
+	char end;
+
+	al_tick_adj(1234);
+
+	len = al_log_stamp(ts, sizeof(ts));
+	TEST_ASSERT_EQUAL(strlen(ts), len);
+	TEST_ASSERT_EQUAL(3, sscanf(ts, "[%lu.%lu%c", &sec, &usec, &end));
+	TEST_ASSERT_EQUAL(']', end);
+#if AL_LOG_TS_USEC
+	TEST_ASSERT_EQUAL(7, strchr(ts, ']') - strchr(ts, '.'));
+#endif
+}
+
+TEST_GROUP_RUNNER(tick)
+{
+	RUN_TEST_CASE(tick, rollover);
+	RUN_TEST_CASE(tick, wrap);
+	RUN_TEST_CASE(tick, ns);
+	RUN_TEST_CASE(tick, tear);
+	RUN_TEST_CASE(tick, stamp);
+}
+
+static int32_t __add_tick_tests(void)
+{
+	RUN_TEST_GROUP(tick);
+	return 0;
+}
+
+al_test_suite_init(__add_tick_tests);
+
+__END_DECLS
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define TW_TIMERS		2000
+
+static al_timer_wheel_t tw;
+static al_timer_t tw_tmr[TW_TIMERS];
+static uint64_t tw_fired[TW_TIMERS];
+static uint64_t tw_now;
+static uint32_t tw_runs;
+
+static void tw_func(al_timer_t *tmr, void *arg)
+{
+	UNUSED(arg);
+
+	tw_fired[tmr - tw_tmr] = tw_now;
+	tw_runs++;
+}
+
+static uint64_t tw_rand(uint64_t max)
+{
+	return (((uint64_t)rand() << 31) ^ (uint64_t)rand()) % max;
+}
+
+/* the soonest expiry of the pending timers, by brute force */
+static uint64_t tw_min(void)
+{
+	uint64_t e = AL_TIMER_NEVER;
+	int_t i;
+
+	for (i = 0; i < TW_TIMERS; i++) {
+		if (al_timer_pending(&tw_tmr[i])) {
+			e = min_t(uint64_t, e, max_t(uint64_t, tw_tmr[i].expires, tw.clk));
+		}
+	}
+
+	return e;
+}
+
+TEST_GROUP(timer_wheel);
+
+TEST_SETUP(timer_wheel)
+{
+	int_t i;
+
+	srand(1);
+
+	tw_now = 1000;
+	tw_runs = 0;
+	al_timer_wheel_init(&tw, tw_now);
+
+	for (i = 0; i < TW_TIMERS; i++) {
+		al_timer_init(&tw_tmr[i], tw_func, NULL);
+		tw_fired[i] = 0;
+	}
+}
+
+TEST_TEAR_DOWN(timer_wheel)
+{
+}
+
+TEST(timer_wheel, expiry)
+{
+	uint64_t expires[TW_TIMERS];
+	uint64_t next;
+	int_t i;
+
+	/* every level, and beyond the wheel */
+	for (i = 0; i < TW_TIMERS; i++) {
+		expires[i] = tw_now + 1 + tw_rand(i < TW_TIMERS / 2 ? 5000 : 40000000);
+		TEST_ASSERT_EQUAL(0, al_timer_add(&tw, &tw_tmr[i], expires[i], 0));
+	}
+
+	/* a timer of the past runs on the next advance */
+	TEST_ASSERT_EQUAL(0, al_timer_add(&tw, &tw_tmr[0], 10, 0));
+	expires[0] = tw_now;
+
+	while (tw.count > 0) {
+		next = al_timer_wheel_next(&tw);
+		TEST_ASSERT_TRUE(next == tw_min());
+
+		/* jump straight to the next expiry like a tickless sleep */
+		tw_now = next;
+		al_timer_wheel_advance(&tw, tw_now);
+	}
+
+	TEST_ASSERT_EQUAL(TW_TIMERS, tw_runs);
+	TEST_ASSERT_TRUE(al_timer_wheel_next(&tw) == AL_TIMER_NEVER);
+
+	for (i = 0; i < TW_TIMERS; i++) {
+		TEST_ASSERT_TRUE(tw_fired[i] == expires[i]);
+	}
+}
+
+TEST(timer_wheel, step)
+{
+	uint64_t expires[200];
+	int_t i;
+
+	for (i = 0; i < 200; i++) {
+		expires[i] = tw_now + 1 + tw_rand(300000);
+		al_timer_add(&tw, &tw_tmr[i], expires[i], 0);
+	}
+
+	/* tick by tick and in random strides */
+	while (tw.count > 0) {
+		tw_now += (tw_now & 1) ? 1 : tw_rand(5000);
+		al_timer_wheel_advance(&tw, tw_now);
+	}
+
+	for (i = 0; i < 200; i++) {
+		TEST_ASSERT_TRUE(tw_fired[i] >= expires[i]);
+		TEST_ASSERT_TRUE(tw_fired[i] - expires[i] < 5000);
+	}
+}
+
+TEST(timer_wheel, cancel)
+{
+	int_t i;
+
+	for (i = 0; i < TW_TIMERS; i++) {
+		al_timer_add(&tw, &tw_tmr[i], tw_now + 1 + tw_rand(100000), 0);
+	}
+
+	/* cancel the odd ones and move half of the even ones */
+	for (i = 1; i < TW_TIMERS; i += 2) {
+		TEST_ASSERT_EQUAL(1, al_timer_del(&tw, &tw_tmr[i]));
+		TEST_ASSERT_EQUAL(0, al_timer_del(&tw, &tw_tmr[i]));
+	}
+
+	for (i = 0; i < TW_TIMERS; i += 4) {
+		al_timer_add(&tw, &tw_tmr[i], tw_now + 200000, 0);
+	}
+
+	TEST_ASSERT_EQUAL(TW_TIMERS / 2, tw.count);
+
+	al_timer_wheel_advance(&tw, tw_now + 100000);
+	TEST_ASSERT_EQUAL(TW_TIMERS / 4, tw_runs);
+
+	tw_now += 200000;
+	al_timer_wheel_advance(&tw, tw_now);
+	TEST_ASSERT_EQUAL(TW_TIMERS / 2, tw_runs);
+
+	for (i = 1; i < TW_TIMERS; i += 2) {
+		TEST_ASSERT_TRUE(tw_fired[i] == 0);
+	}
+}
+
+static void tw_periodic(al_timer_t *tmr, void *arg)
+{
+	UNUSED(arg);
+
+	tw_func(tmr, NULL);
+
+	/* the third run stops it, and cancels its neighbour */
+	if (tw_runs == 3) {
+		al_timer_del(&tw, tmr);
+		al_timer_del(&tw, tmr + 1);
+	}
+}
+
+TEST(timer_wheel, periodic)
+{
+	al_timer_init(&tw_tmr[0], tw_periodic, NULL);
+	al_timer_add(&tw, &tw_tmr[0], tw_now + 10, 10);
+	al_timer_add(&tw, &tw_tmr[1], tw_now + 35, 0);
+
+	for (tw_now = 1001; tw_now < 1100; tw_now++) {
+		al_timer_wheel_advance(&tw, tw_now);
+	}
+
+	TEST_ASSERT_EQUAL(3, tw_runs);
+	TEST_ASSERT_TRUE(tw_fired[0] == 1030);
+	TEST_ASSERT_TRUE(tw_fired[1] == 0);
+	TEST_ASSERT_EQUAL(0, tw.count);
+}
+
+TEST_GROUP_RUNNER(timer_wheel)
+{
+	RUN_TEST_CASE(timer_wheel, expiry);
+	RUN_TEST_CASE(timer_wheel, step);
+	RUN_TEST_CASE(timer_wheel, cancel);
+	RUN_TEST_CASE(timer_wheel, periodic);
+}
+
+static int32_t __add_timer_wheel_tests(void)
+{
+	RUN_TEST_GROUP(timer_wheel);
+	return 0;
+}
+
+al_test_suite_init(__add_timer_wheel_tests);
+
+__END_DECLS
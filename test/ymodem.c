@@ -0,0 +1,606 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include "alumy/test_init.h"
+#include "alumy.h"
+#include "alumy/xyzmodem.h"
+#include "test.h"
+
+__BEGIN_DECLS
+
+#define YM_FILE_SIZE		(32 * 1024 + 300)
+#define YM_BUF_SIZE			YMODEM_TOTAL_LEN(YMODEM_PACKET_SIZE_1K)
+
+/* the link, two pipes: the sender reads [0] and writes [1], the receiver
+ * reads [2] and writes [3] */
+static int ym_fd[4];
+
+/* bytes the sender read back from the receiver */
+static uint32_t ym_replies;
+
+/* the sender corrupts its n-th packet written, 0 for none */
+static uint32_t ym_corrupt_at;
+static uint32_t ym_writes;
+
+static uint8_t ym_file[YM_FILE_SIZE];
+static uint8_t ym_got[YM_FILE_SIZE];
+static size_t ym_got_len;
+static size_t ym_got_size;
+static char ym_got_name[32];
+static al_ymodem_finish_reason_t ym_reason;
+
+/* the sender reads ym_src instead of ym_file, the receiver writes ym_sink */
+static const al_ymodem_source_t *ym_src;
+static size_t ym_src_size;
+static const al_ymodem_sink_t *ym_sink;
+
+static uint8_t ym_tx_recv[YM_BUF_SIZE], ym_tx_send[YM_BUF_SIZE];
+static uint8_t ym_rx_recv[YM_BUF_SIZE], ym_rx_send[YM_BUF_SIZE];
+
+static ssize_t ym_read(int fd, void *buf, size_t size, int32_t timeout)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	ssize_t n;
+
+	if (poll(&pfd, 1, timeout) <= 0) {
+		return 0;
+	}
+
+	n = read(fd, buf, size);
+
+	return (n < 0) ? 0 : n;
+}
+
+static int32_t ym_getc(int fd, int32_t timeout)
+{
+	uint8_t c;
+
+	return (ym_read(fd, &c, 1, timeout) == 1) ? c : AL_EOF;
+}
+
+static int32_t ym_tx_putc(int32_t c)
+{
+	uint8_t b = c;
+
+	return (write(ym_fd[1], &b, 1) == 1) ? c : AL_EOF;
+}
+
+static int32_t ym_rx_putc(int32_t c)
+{
+	uint8_t b = c;
+
+	return (write(ym_fd[3], &b, 1) == 1) ? c : AL_EOF;
+}
+
+static int32_t ym_tx_getc(int32_t timeout)
+{
+	int32_t c = ym_getc(ym_fd[0], timeout);
+
+	if (c != AL_EOF) {
+		ym_replies++;
+	}
+
+	return c;
+}
+
+static int32_t ym_rx_getc(int32_t timeout)
+{
+	return ym_getc(ym_fd[2], timeout);
+}
+
+static ssize_t ym_tx_write(const void *buf, size_t len)
+{
+	uint8_t pkt[YM_BUF_SIZE];
+
+	if ((++ym_writes == ym_corrupt_at) && (len <= sizeof(pkt))) {
+		memcpy(pkt, buf, len);
+		pkt[len / 2] ^= 0x55;
+		buf = pkt;
+	}
+
+	return write(ym_fd[1], buf, len);
+}
+
+static ssize_t ym_rx_recv_data(void *buf, size_t size)
+{
+	return ym_read(ym_fd[2], buf, size, 0);
+}
+
+static int32_t ym_recv_clear(int fd)
+{
+	uint8_t buf[64];
+
+	while (ym_read(fd, buf, sizeof(buf), 0) > 0) {
+	}
+
+	return 0;
+}
+
+static int32_t ym_tx_recv_clear(void)
+{
+	return ym_recv_clear(ym_fd[0]);
+}
+
+static int32_t ym_rx_recv_clear(void)
+{
+	return ym_recv_clear(ym_fd[2]);
+}
+
+static ssize_t ym_tx_recv_data(void *buf, size_t size)
+{
+	ssize_t n = ym_read(ym_fd[0], buf, size, 0);
+
+	ym_replies += n;
+
+	return n;
+}
+
+static void ym_flush(void)
+{
+
+}
+
+static uint32_t ym_tick_ms(void)
+{
+	return al_tick_get_ns() / 1000000;
+}
+
+static void ym_delay_ms(int32_t ms)
+{
+	usleep(ms * 1000);
+}
+
+static int32_t ym_recv_header(const char *filename, size_t filesize)
+{
+	strncpy(ym_got_name, filename, sizeof(ym_got_name) - 1);
+	ym_got_size = filesize;
+	ym_got_len = 0;
+
+	return (filesize <= sizeof(ym_got)) ? 0 : -1;
+}
+
+static int32_t ym_recv_packet(const void *data, size_t len)
+{
+	/* the last packet is padded */
+	len = min_t(size_t, len, ym_got_size - ym_got_len);
+	memcpy(ym_got + ym_got_len, data, len);
+	ym_got_len += len;
+
+	return 0;
+}
+
+static int32_t ym_recv_finish(al_ymodem_finish_reason_t reason)
+{
+	ym_reason = reason;
+	return 0;
+}
+
+static const al_ymodem_callback_t ym_cb = {
+	.recv_header = ym_recv_header,
+	.recv_packet = ym_recv_packet,
+	.recv_finish = ym_recv_finish,
+};
+
+static const al_ymodem_opt_t ym_rx_opt = {
+	.ym_putc = ym_rx_putc,
+	.ym_getc = ym_rx_getc,
+	.ym_flush = ym_flush,
+	.recv = ym_rx_recv_data,
+	.recv_clear = ym_rx_recv_clear,
+	.tick_ms = ym_tick_ms,
+	.delay_ms = ym_delay_ms,
+};
+
+static const al_ymodem_opt_t ym_tx_opt_putc = {
+	.ym_putc = ym_tx_putc,
+	.ym_getc = ym_tx_getc,
+	.ym_flush = ym_flush,
+	.recv = ym_tx_recv_data,
+	.recv_clear = ym_tx_recv_clear,
+	.tick_ms = ym_tick_ms,
+	.delay_ms = ym_delay_ms,
+};
+
+static const al_ymodem_opt_t ym_tx_opt_write = {
+	.ym_putc = ym_tx_putc,
+	.ym_getc = ym_tx_getc,
+	.ym_flush = ym_flush,
+	.recv = ym_tx_recv_data,
+	.recv_clear = ym_tx_recv_clear,
+	.tick_ms = ym_tick_ms,
+	.delay_ms = ym_delay_ms,
+	.ym_write = ym_tx_write,
+};
+
+typedef struct ym_sender {
+	const al_ymodem_opt_t *opt;
+	al_os_sem_t done;
+	int32_t ret;
+	bool stream;
+} ym_sender_t;
+
+static void ym_sender_task(void *arg)
+{
+	ym_sender_t *s = (ym_sender_t *)arg;
+	al_ymodem_t ym;
+	int_t i;
+
+	s->ret = -1;
+
+	if (al_ymodem_init(&ym, ym_tx_recv, sizeof(ym_tx_recv), ym_tx_send,
+					   sizeof(ym_tx_send), s->opt, &ym_cb) == 0) {
+		for (i = 0; i < 100; i++) {
+			if (al_ymodem_wait_send(&ym) == 0) {
+				s->stream = ym.stream;
+
+				if (ym_src != NULL) {
+					s->ret = al_ymodem_send_source(&ym, "fw.bin", ym_src_size,
+												   ym_src);
+				} else {
+					s->ret = al_ymodem_send_file(&ym, "fw.bin", ym_file,
+												 sizeof(ym_file));
+				}
+				break;
+			}
+		}
+	}
+
+	al_os_sem_give(s->done);
+	al_os_task_delete(NULL);
+}
+
+/* run a transfer, return what the receiver returned, the time in *ms */
+static int32_t ym_transfer(const al_ymodem_opt_t *tx_opt, bool stream,
+						   ym_sender_t *s, double *ms)
+{
+	al_ymodem_t ym;
+	uint64_t t0;
+	int32_t ret = 0;
+	int fd[2];
+
+	/* the receiver reads what the sender writes and the other way round */
+	TEST_ASSERT_EQUAL(0, pipe(fd));
+	ym_fd[2] = fd[0];
+	ym_fd[1] = fd[1];
+	TEST_ASSERT_EQUAL(0, pipe(fd));
+	ym_fd[0] = fd[0];
+	ym_fd[3] = fd[1];
+
+	ym_got_len = 0;
+	ym_got_size = 0;
+	ym_writes = 0;
+	ym_replies = 0;
+	ym_reason = AL_YM_FINISH_OK;
+	memset(ym_got_name, 0, sizeof(ym_got_name));
+
+	TEST_ASSERT_EQUAL(0, al_ymodem_init(&ym, ym_rx_recv, sizeof(ym_rx_recv),
+										ym_rx_send, sizeof(ym_rx_send),
+										&ym_rx_opt, &ym_cb));
+	TEST_ASSERT_EQUAL(0, al_ymodem_set_stream(&ym, stream));
+	TEST_ASSERT_EQUAL(0, al_ymodem_set_sink(&ym, ym_sink));
+
+	s->opt = tx_opt;
+	s->done = al_os_sem_bin_create();
+	TEST_ASSERT_NOT_NULL(s->done);
+
+	t0 = al_tick_get_ns();
+	TEST_ASSERT_NOT_NULL(al_os_task_create("ymodem", 1, 0, ym_sender_task, s));
+
+	while ((ret == 0) && (al_tick_get_ns() - t0 < 10000000000ULL)) {
+		ret = al_ymodem_recv(&ym);
+	}
+
+	TEST_ASSERT_EQUAL(0, al_os_sem_take(s->done, 5000));
+	*ms = (al_tick_get_ns() - t0) / 1e6;
+
+	al_os_sem_bin_del(s->done);
+	for (int_t i = 0; i < 4; i++) {
+		close(ym_fd[i]);
+	}
+
+	return ret;
+}
+
+/* a NOR flash in RAM, two partitions of 64 KB in sectors of 4 KB */
+#define YM_FLASH_SECTOR		4096
+#define YM_FLASH_PART		(64 * 1024)
+
+static uint8_t ym_flash[2 * YM_FLASH_PART];
+static uint32_t ym_flash_erases;
+static bool ym_flash_bad;
+
+static int32_t ym_flash_read(uint32_t addr, void *buf, size_t len)
+{
+	memcpy(buf, ym_flash + addr, len);
+	return 0;
+}
+
+static int32_t ym_flash_prog(uint32_t addr, const void *buf, size_t len)
+{
+	/* units of 8 bytes, erased before */
+	if ((addr % 8) || (len % 8) || !al_mem_is_filled(ym_flash + addr, 0xFF, len)) {
+		ym_flash_bad = true;
+		return -1;
+	}
+
+	memcpy(ym_flash + addr, buf, len);
+	return 0;
+}
+
+static int32_t ym_flash_erase(uint32_t addr, size_t len)
+{
+	if ((addr % YM_FLASH_SECTOR) || (len != YM_FLASH_SECTOR)) {
+		ym_flash_bad = true;
+		return -1;
+	}
+
+	memset(ym_flash + addr, 0xFF, len);
+	ym_flash_erases++;
+	return 0;
+}
+
+static void ym_flash_part(al_ymodem_flash_t *flash, uint32_t addr)
+{
+	memset(flash, 0, sizeof(*flash));
+	flash->addr = addr;
+	flash->size = YM_FLASH_PART;
+	flash->sector_size = YM_FLASH_SECTOR;
+	flash->align = 8;
+	flash->read = ym_flash_read;
+	flash->prog = ym_flash_prog;
+	flash->erase = ym_flash_erase;
+}
+
+/* a littlefs in RAM, one for each side */
+#define YM_LFS_BLOCK		4096
+#define YM_LFS_BLOCKS		32
+
+static uint8_t ym_lfs_ram[2][YM_LFS_BLOCK * YM_LFS_BLOCKS];
+
+static int ym_lfs_read(const struct lfs_config *c, lfs_block_t block,
+					   lfs_off_t off, void *buf, lfs_size_t size)
+{
+	memcpy(buf, (uint8_t *)c->context + block * c->block_size + off, size);
+	return 0;
+}
+
+static int ym_lfs_prog(const struct lfs_config *c, lfs_block_t block,
+					   lfs_off_t off, const void *buf, lfs_size_t size)
+{
+	memcpy((uint8_t *)c->context + block * c->block_size + off, buf, size);
+	return 0;
+}
+
+static int ym_lfs_erase(const struct lfs_config *c, lfs_block_t block)
+{
+	memset((uint8_t *)c->context + block * c->block_size, 0xFF, c->block_size);
+	return 0;
+}
+
+static int ym_lfs_sync(const struct lfs_config *c)
+{
+	return 0;
+}
+
+static void ym_lfs_mount(lfs_t *lfs, struct lfs_config *cfg, int_t i)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->context = ym_lfs_ram[i];
+	cfg->read = ym_lfs_read;
+	cfg->prog = ym_lfs_prog;
+	cfg->erase = ym_lfs_erase;
+	cfg->sync = ym_lfs_sync;
+	cfg->read_size = 16;
+	cfg->prog_size = 16;
+	cfg->block_size = YM_LFS_BLOCK;
+	cfg->block_count = YM_LFS_BLOCKS;
+	cfg->cache_size = 256;
+	cfg->lookahead_size = 16;
+	cfg->block_cycles = 500;
+
+	TEST_ASSERT_EQUAL(0, lfs_format(lfs, cfg));
+	TEST_ASSERT_EQUAL(0, lfs_mount(lfs, cfg));
+}
+
+TEST_GROUP(ymodem);
+
+TEST_SETUP(ymodem)
+{
+	for (size_t i = 0; i < sizeof(ym_file); i++) {
+		ym_file[i] = rand();
+	}
+
+	ym_corrupt_at = 0;
+	ym_src = NULL;
+	ym_sink = NULL;
+}
+
+TEST_TEAR_DOWN(ymodem)
+{
+
+}
+
+TEST(ymodem, classic)
+{
+	ym_sender_t s;
+	double ms;
+
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_putc, false, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	TEST_ASSERT_FALSE(s.stream);
+	TEST_ASSERT_EQUAL_STRING("fw.bin", ym_got_name);
+	TEST_ASSERT_EQUAL(sizeof(ym_file), ym_got_len);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ym_file, ym_got, sizeof(ym_file));
+}
+
+TEST(ymodem, stream)
+{
+	ym_sender_t s;
+	double ms;
+
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_write, true, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	TEST_ASSERT_TRUE(s.stream);
+	TEST_ASSERT_EQUAL(AL_YM_FINISH_OK, ym_reason);
+	TEST_ASSERT_EQUAL(sizeof(ym_file), ym_got_len);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ym_file, ym_got, sizeof(ym_file));
+
+	/* the whole packets of ym_write() take the same path */
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_write, false, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ym_file, ym_got, sizeof(ym_file));
+}
+
+TEST(ymodem, stream_corrupt)
+{
+	ym_sender_t s;
+	double ms;
+
+	/* the header, then the fifth data packet */
+	ym_corrupt_at = 6;
+
+	TEST_ASSERT_EQUAL(-1, ym_transfer(&ym_tx_opt_write, true, &s, &ms));
+	TEST_ASSERT_EQUAL(-1, s.ret);
+	TEST_ASSERT_EQUAL(AL_YM_FINISH_PACKET_RECV_ERR, ym_reason);
+	TEST_ASSERT_EQUAL(4 * YMODEM_PACKET_SIZE_1K, ym_got_len);
+}
+
+TEST(ymodem, round_trips)
+{
+	const uint32_t packets = DIV_ROUND_UP(sizeof(ym_file), YMODEM_PACKET_SIZE_1K);
+	ym_sender_t s;
+	uint32_t classic;
+	double ms;
+
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_write, false, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	classic = ym_replies;
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_write, true, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ym_file, ym_got, sizeof(ym_file));
+
+	/* classic waits for an ACK after every packet, ymodem-g only in the
+	 * handshakes of the header, the EOT and the closing header */
+	TEST_ASSERT_TRUE(classic >= packets);
+	TEST_ASSERT_TRUE(ym_replies <= 6);
+}
+
+TEST(ymodem, flash)
+{
+	al_ymodem_flash_t src_part, sink_part;
+	al_ymodem_source_t src;
+	al_ymodem_sink_t sink;
+	ym_sender_t s;
+	double ms;
+
+	memset(ym_flash, 0, sizeof(ym_flash));
+	memcpy(ym_flash, ym_file, sizeof(ym_file));
+	ym_flash_erases = 0;
+	ym_flash_bad = false;
+
+	ym_flash_part(&src_part, 0);
+	ym_flash_part(&sink_part, YM_FLASH_PART);
+	TEST_ASSERT_EQUAL(0, al_ymodem_flash_source(&src, &src_part));
+	TEST_ASSERT_EQUAL(0, al_ymodem_flash_sink(&sink, &sink_part));
+
+	/* partition to partition, in stream and in classic mode */
+	ym_src = &src;
+	ym_src_size = sizeof(ym_file);
+	ym_sink = &sink;
+
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_write, true, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	TEST_ASSERT_FALSE(ym_flash_bad);
+	TEST_ASSERT_EQUAL(DIV_ROUND_UP(sizeof(ym_file), YM_FLASH_SECTOR),
+					  ym_flash_erases);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ym_file, ym_flash + YM_FLASH_PART, sizeof(ym_file));
+
+	/* the tail of the last unit is padded, the rest left erased */
+	TEST_ASSERT_TRUE(al_mem_is_filled(ym_flash + YM_FLASH_PART + sizeof(ym_file),
+									  0xFF, 4));
+
+	TEST_ASSERT_EQUAL(0, al_ymodem_flash_source(&src, &src_part));
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_putc, false, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	TEST_ASSERT_FALSE(ym_flash_bad);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ym_file, ym_flash + YM_FLASH_PART, sizeof(ym_file));
+
+	/* a file larger than the partition is refused with the header */
+	sink_part.size = 16 * 1024;
+	TEST_ASSERT_EQUAL(0, al_ymodem_flash_source(&src, &src_part));
+	TEST_ASSERT_EQUAL(-1, ym_transfer(&ym_tx_opt_write, false, &s, &ms));
+	TEST_ASSERT_EQUAL(-1, s.ret);
+	TEST_ASSERT_EQUAL(AL_YM_FINISH_HEADER_PROC_ERR, ym_reason);
+}
+
+TEST(ymodem, lfs)
+{
+	static al_ymodem_lfs_t src_file, sink_file;
+	static lfs_t lfs[2];
+	struct lfs_config cfg[2];
+	al_ymodem_source_t src;
+	al_ymodem_sink_t sink;
+	struct lfs_info info;
+	ssize_t size;
+	ym_sender_t s;
+	double ms;
+
+	ym_lfs_mount(&lfs[0], &cfg[0], 0);
+	ym_lfs_mount(&lfs[1], &cfg[1], 1);
+
+	TEST_ASSERT_EQUAL(0, al_lfs_write_file(&lfs[0], "image", ym_file, sizeof(ym_file),
+										   LFS_O_WRONLY | LFS_O_CREAT));
+
+	size = al_ymodem_lfs_source(&src, &src_file, &lfs[0], "image");
+	TEST_ASSERT_EQUAL(sizeof(ym_file), size);
+	TEST_ASSERT_EQUAL(0, al_ymodem_lfs_sink(&sink, &sink_file, &lfs[1], NULL));
+
+	ym_src = &src;
+	ym_src_size = size;
+	ym_sink = &sink;
+
+	/* stored under the name received */
+	TEST_ASSERT_EQUAL(1, ym_transfer(&ym_tx_opt_write, true, &s, &ms));
+	TEST_ASSERT_EQUAL(0, s.ret);
+	TEST_ASSERT_FALSE(src_file.open);
+	TEST_ASSERT_EQUAL(sizeof(ym_file), al_lfs_read_file(&lfs[1], "fw.bin", ym_got,
+														sizeof(ym_got)));
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(ym_file, ym_got, sizeof(ym_file));
+
+	/* a transfer cancelled leaves no file behind */
+	TEST_ASSERT_EQUAL(0, al_ymodem_lfs_sink(&sink, &sink_file, &lfs[1], "new.bin"));
+	TEST_ASSERT_EQUAL(sizeof(ym_file),
+					  al_ymodem_lfs_source(&src, &src_file, &lfs[0], "image"));
+	ym_corrupt_at = 6;
+
+	TEST_ASSERT_EQUAL(-1, ym_transfer(&ym_tx_opt_write, true, &s, &ms));
+	TEST_ASSERT_EQUAL(-1, s.ret);
+	TEST_ASSERT_FALSE(src_file.open);
+	TEST_ASSERT_EQUAL(LFS_ERR_NOENT, lfs_stat(&lfs[1], "new.bin", &info));
+
+	TEST_ASSERT_EQUAL(0, lfs_unmount(&lfs[0]));
+	TEST_ASSERT_EQUAL(0, lfs_unmount(&lfs[1]));
+}
+
+TEST_GROUP_RUNNER(ymodem)
+{
+	RUN_TEST_CASE(ymodem, classic);
+	RUN_TEST_CASE(ymodem, stream);
+	RUN_TEST_CASE(ymodem, stream_corrupt);
+	RUN_TEST_CASE(ymodem, round_trips);
+	RUN_TEST_CASE(ymodem, flash);
+	RUN_TEST_CASE(ymodem, lfs);
+}
+
+static int32_t __add_ymodem_tests(void)
+{
+	RUN_TEST_GROUP(ymodem);
+	return 0;
+}
+
+al_test_suite_init(__add_ymodem_tests);
+
+__END_DECLS
@@ -6,18 +6,11 @@
 
 __BEGIN_DECLS
 
-typedef struct al_worker_item {
-	void (*func)(void *arg);
-	void *arg;
-} al_worker_item_t;
-
 static void al_worker_task(void *arg);
 
 int32_t al_worker_init(al_worker_t *ctx, int_t cnt,
 					   const char *name, uint32_t prio, uint32_t stack)
 {
-	int32_t ret;
-
 	ctx->queue = NULL;
 
 	if (!al_initialized_init(&ctx->init)) {
@@ -0,0 +1,359 @@
+#include <string.h>
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/bug.h"
+#include "alumy/log2.h"
+#include "alumy/initialized.h"
+#include "alumy/thread/worker_pool.h"
+
+__BEGIN_DECLS
+
+/*
+ * Every worker owns a bounded multi-producer/multi-consumer ring (D. Vyukov's
+ * sequence-per-cell design). Any thread may push to any ring and any worker
+ * may pop from any ring without a lock: a worker drains its own ring first
+ * and steals from the rings of its peers when it runs dry.
+ */
+typedef struct al_worker_cell {
+	uint32_t seq;
+	al_worker_item_t item;
+} al_worker_cell_t;
+
+typedef struct al_worker_pool_thread {
+	al_worker_pool_t *pool;
+	al_os_task_t task;
+	int_t index;
+	uint32_t mask;
+	uint32_t head;
+	uint32_t tail;
+	al_worker_cell_t *cells;
+} al_worker_pool_thread_t;
+
+#define atomic_load(p)			__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define atomic_store(p, v)		__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define atomic_add(p, v)		__atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+#define atomic_cas(p, o, n)		__atomic_compare_exchange_n((p), (o), (n), \
+									false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+
+static void al_worker_pool_task(void *arg);
+
+static bool_t ring_push(al_worker_pool_thread_t *w, const al_worker_item_t *item)
+{
+	al_worker_cell_t *cell;
+	uint32_t pos = __atomic_load_n(&w->tail, __ATOMIC_RELAXED);
+	int32_t diff;
+
+	for (;;) {
+		cell = &w->cells[pos & w->mask];
+		diff = (int32_t)(atomic_load(&cell->seq) - pos);
+
+		if (diff == 0) {
+			if (atomic_cas(&w->tail, &pos, pos + 1)) {
+				break;
+			}
+		} else if (diff < 0) {
+			/* full */
+			return false;
+		} else {
+			pos = __atomic_load_n(&w->tail, __ATOMIC_RELAXED);
+		}
+	}
+
+	cell->item = *item;
+	atomic_store(&cell->seq, pos + 1);
+
+	return true;
+}
+
+static bool_t ring_pop(al_worker_pool_thread_t *w, al_worker_item_t *item)
+{
+	al_worker_cell_t *cell;
+	uint32_t pos = __atomic_load_n(&w->head, __ATOMIC_RELAXED);
+	int32_t diff;
+
+	for (;;) {
+		cell = &w->cells[pos & w->mask];
+		diff = (int32_t)(atomic_load(&cell->seq) - (pos + 1));
+
+		if (diff == 0) {
+			if (atomic_cas(&w->head, &pos, pos + 1)) {
+				break;
+			}
+		} else if (diff < 0) {
+			/* empty */
+			return false;
+		} else {
+			pos = __atomic_load_n(&w->head, __ATOMIC_RELAXED);
+		}
+	}
+
+	*item = cell->item;
+	atomic_store(&cell->seq, pos + w->mask + 1);
+
+	return true;
+}
+
+static bool_t pool_pop(al_worker_pool_t *pool, int_t self,
+					   al_worker_item_t *item)
+{
+	int_t i;
+
+	for (i = 0; i < pool->nr_workers; i++) {
+		if (ring_pop(&pool->workers[(self + i) % pool->nr_workers], item)) {
+			atomic_add(&pool->pending, -1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool_t pool_push(al_worker_pool_t *pool, const al_worker_item_t *item)
+{
+	uint32_t start = __atomic_fetch_add(&pool->rr, 1, __ATOMIC_RELAXED);
+	int_t i;
+
+	for (i = 0; i < pool->nr_workers; i++) {
+		if (ring_push(&pool->workers[(start + i) % pool->nr_workers], item)) {
+			atomic_add(&pool->pending, 1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void pool_wakeup(al_worker_pool_t *pool)
+{
+	if (atomic_add(&pool->idle, 0) > 0) {
+		al_os_sem_give(pool->wake);
+	}
+}
+
+static void pool_free(al_worker_pool_t *pool)
+{
+	int_t i;
+
+	if (pool->workers) {
+		for (i = 0; i < pool->nr_workers; i++) {
+			if (pool->workers[i].cells) {
+				al_os_free(pool->workers[i].cells);
+			}
+		}
+
+		al_os_free(pool->workers);
+		pool->workers = NULL;
+	}
+
+	if (pool->wake) {
+		al_os_sem_count_del(pool->wake);
+		pool->wake = NULL;
+	}
+
+	if (pool->done) {
+		al_os_sem_count_del(pool->done);
+		pool->done = NULL;
+	}
+}
+
+/* Stop the first nr_tasks workers once they drained the rings */
+static void pool_stop(al_worker_pool_t *pool, int_t nr_tasks)
+{
+	int_t i;
+
+	atomic_store(&pool->stop, true);
+
+	for (i = 0; i < nr_tasks; i++) {
+		al_os_sem_give(pool->wake);
+	}
+
+	for (i = 0; i < nr_tasks; i++) {
+		al_os_sem_take(pool->done, -1);
+	}
+
+	for (i = 0; i < nr_tasks; i++) {
+		al_os_task_delete(pool->workers[i].task);
+	}
+}
+
+int32_t al_worker_pool_init(al_worker_pool_t *pool, int_t nr_workers,
+							int_t cnt, const char *name,
+							uint32_t prio, uint32_t stack)
+{
+	al_worker_pool_thread_t *w;
+	uint32_t size;
+	int_t i, j;
+
+	AL_CHECK_RET((nr_workers > 0) && (cnt > 0), EINVAL, -1);
+
+	if (!al_initialized_init(&pool->init)) {
+		set_errno(EEXIST);
+		return -1;
+	}
+
+	/* a ring of one cell can not tell full from empty */
+	size = roundup_pow_of_two(max_t(uint32_t, cnt, 2));
+
+	pool->nr_workers = nr_workers;
+	pool->rr = 0;
+	pool->pending = 0;
+	pool->idle = 0;
+	pool->stop = false;
+
+	pool->wake = al_os_sem_count_create(nr_workers, 0);
+	pool->done = al_os_sem_count_create(nr_workers, 0);
+
+	pool->workers = (al_worker_pool_thread_t *)al_os_calloc(nr_workers,
+													sizeof(*pool->workers));
+	if (!pool->wake || !pool->done || !pool->workers) {
+		goto err;
+	}
+
+	for (i = 0; i < nr_workers; i++) {
+		w = &pool->workers[i];
+
+		w->pool = pool;
+		w->index = i;
+		w->mask = size - 1;
+
+		w->cells = (al_worker_cell_t *)al_os_malloc(size * sizeof(*w->cells));
+		if (w->cells == NULL) {
+			goto err;
+		}
+
+		for (j = 0; j < (int_t)size; j++) {
+			w->cells[j].seq = j;
+		}
+	}
+
+	for (i = 0; i < nr_workers; i++) {
+		w = &pool->workers[i];
+
+		w->task = al_os_task_create(name, prio, stack, al_worker_pool_task, w);
+		if (w->task == NULL) {
+			pool_stop(pool, i);
+			goto err;
+		}
+	}
+
+	return 0;
+
+err:
+	pool_free(pool);
+	al_initialized_cleanup(&pool->init);
+	set_errno(ENOMEM);
+	return -1;
+}
+
+int32_t al_worker_pool_deinit(al_worker_pool_t *pool)
+{
+	if (!al_initialized_cleanup(&pool->init)) {
+		return -1;
+	}
+
+	pool_stop(pool, pool->nr_workers);
+	pool_free(pool);
+
+	return 0;
+}
+
+int32_t al_worker_pool_run(al_worker_pool_t *pool,
+						   void (*func)(void *arg), void *arg,
+						   int32_t timeout)
+{
+	al_worker_item_t item;
+
+	if (func == NULL) {
+		set_errno(ENOEXEC);
+		return -1;
+	}
+
+	item.func = func;
+	item.arg = arg;
+
+	if (al_worker_pool_run_batch(pool, &item, 1, timeout) != 1) {
+		set_errno(ENOMEM);
+		return -1;
+	}
+
+	return 0;
+}
+
+int32_t al_worker_pool_run_batch(al_worker_pool_t *pool,
+								 const al_worker_item_t *items, int_t n,
+								 int32_t timeout)
+{
+	al_os_tick_t start = al_os_get_tick();
+	int_t i;
+
+	AL_CHECK_RET(pool->workers && items && (n >= 0), EINVAL, -1);
+
+	for (i = 0; i < n; i++) {
+		if (items[i].func == NULL) {
+			continue;
+		}
+
+		while (!pool_push(pool, &items[i])) {
+			/* rings are full, let the workers catch up */
+			pool_wakeup(pool);
+
+			if ((timeout >= 0) &&
+				(al_os_tick2ms(al_os_get_tick() - start) >= (uint32_t)timeout)) {
+				set_errno(ENOMEM);
+				return i;
+			}
+
+			al_os_delay(1);
+		}
+	}
+
+	pool_wakeup(pool);
+
+	return n;
+}
+
+static void al_worker_pool_loop(al_worker_pool_thread_t *w)
+{
+	al_worker_pool_t *pool = w->pool;
+	al_worker_item_t item;
+
+	for (;;) {
+		if (pool_pop(pool, w->index, &item)) {
+			/* chain the wakeup while items are left */
+			if (atomic_add(&pool->pending, 0) > 0) {
+				pool_wakeup(pool);
+			}
+
+			item.func(item.arg);
+			continue;
+		}
+
+		if (atomic_load(&pool->stop)) {
+			return;
+		}
+
+		atomic_add(&pool->idle, 1);
+
+		/* recheck after publishing idle, a submitter may have missed us */
+		if (atomic_add(&pool->pending, 0) <= 0) {
+			al_os_sem_take(pool->wake, -1);
+		}
+
+		atomic_add(&pool->idle, -1);
+	}
+}
+
+static void al_worker_pool_task(void *arg)
+{
+	al_worker_pool_thread_t *w = (al_worker_pool_thread_t *)arg;
+
+	al_worker_pool_loop(w);
+
+	al_os_sem_give(w->pool->done);
+
+	/* al_worker_pool_deinit() deletes the task */
+	al_os_delay(-1);
+}
+
+__END_DECLS
+
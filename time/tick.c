@@ -1,74 +1,207 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "alumy/config.h"
 #include "alumy/byteorder.h"
 #include "alumy/types.h"
 #include "alumy/base.h"
 #include "alumy/bug.h"
 #include "alumy/errno.h"
+#include "alumy/check.h"
 #include "alumy/time/tick.h"
 
 __BEGIN_DECLS
 
-static volatile uint32_t tick_tick = 0;
-static volatile uint32_t tick_msec = 0;
-static volatile uint32_t tick_sec = 0;
+#if defined(__linux__)
+#define TICK_HIRES_CLOCK    1
+#elif defined(__aarch64__)
+#define TICK_HIRES_CNTVCT   1
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+#define TICK_HIRES_DWT      1
+
+/* the cycle counter of the Cortex-M debug unit */
+#define DEMCR               (*(volatile uint32_t *)0xE000EDFC)
+#define DEMCR_TRCENA        (1UL << 24)
+#define DWT_CTRL            (*(volatile uint32_t *)0xE0001000)
+#define DWT_CTRL_CYCCNTENA  (1UL << 0)
+#define DWT_CYCCNT          (*(volatile uint32_t *)0xE0001004)
+#endif
+
+#if defined(__GNUC__)
+#define tick_fence()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define tick_fence()        do { } while (0)
+#endif
+
+/**
+ * The tick is double buffered, al_tick_inc() writes the slot not in use
+ * and then advances tick_seq to publish it. A reader takes the slot of
+ * tick_seq and retries when tick_seq moved meanwhile. The writer never
+ * waits for a reader, so the tick may be read in any interrupt, but only
+ * one context may advance it.
+ */
+struct tick_slot {
+    uint64_t ms;
+    uint32_t cyc;           /* cycle counter at the tick */
+};
+
+static volatile struct tick_slot tick_slot[2];
+static volatile uint32_t tick_seq = 0;
+
+#if TICK_HIRES_DWT
+static uint32_t tick_hz = 0;
+#endif
+
+static void tick_read(uint64_t *ms, uint32_t *cyc)
+{
+    const volatile struct tick_slot *slot;
+    uint32_t seq;
+
+    do {
+        seq = tick_seq;
+        tick_fence();
+
+        slot = &tick_slot[seq & 1];
+        *ms = slot->ms;
+        *cyc = slot->cyc;
+
+        tick_fence();
+    } while (seq != tick_seq);
+}
+
+static void tick_write(uint64_t ms)
+{
+    volatile struct tick_slot *slot = &tick_slot[(tick_seq + 1) & 1];
+
+    slot->ms = ms;
+#if TICK_HIRES_DWT
+    slot->cyc = DWT_CYCCNT;
+#endif
+
+    tick_fence();
+    tick_seq++;
+}
 
 void al_tick_init(void)
 {
-    tick_tick = 0;
-    tick_msec = 0;
-    tick_sec = 0;
+    memset((void *)tick_slot, 0, sizeof(tick_slot));
+    tick_seq = 0;
 }
 
-__always_inline void al_tick_inc(void)
+int32_t al_tick_hires_init(uint32_t hz)
 {
-    tick_tick++;
+#if TICK_HIRES_DWT
+    AL_CHECK_RET(hz > 0, EINVAL, -1);
 
-    tick_msec++;
-    if (tick_msec >= 1000) {
-        tick_msec = 0;
-        tick_sec++;
-    }
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+    tick_hz = hz;
+
+    return 0;
+#elif TICK_HIRES_CLOCK || TICK_HIRES_CNTVCT
+    UNUSED(hz);
+
+    return 0;
+#else
+    UNUSED(hz);
+
+    set_errno(ENOTSUP);
+    return -1;
+#endif
 }
 
-__always_inline void al_tick_adj(uint32_t tick_elapsed)
+void al_tick_inc(void)
 {
-    tick_tick += tick_elapsed;
+    uint64_t ms;
+    uint32_t cyc;
 
-    tick_msec += tick_elapsed;
+    tick_read(&ms, &cyc);
+    tick_write(ms + 1);
+}
+
+void al_tick_adj(uint32_t tick_elapsed)
+{
+    uint64_t ms;
+    uint32_t cyc;
+
+    tick_read(&ms, &cyc);
+    tick_write(ms + tick_elapsed);
+}
+
+uint64_t al_tick_get_tick64(void)
+{
+    uint64_t ms;
+    uint32_t cyc;
+
+    tick_read(&ms, &cyc);
+
+    return ms;
+}
 
-    while (tick_msec > 1000) {
-        tick_sec++;
-        tick_msec -= 1000;
+uint64_t al_tick_get_ns(void)
+{
+#if TICK_HIRES_CLOCK
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#elif TICK_HIRES_CNTVCT
+    uint64_t cnt, frq;
+
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(cnt));
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frq));
+
+    /* split to keep cnt * 1e9 from overflowing */
+    return cnt / frq * 1000000000 + cnt % frq * 1000000000 / frq;
+#else
+    uint64_t ms, ns = 0;
+    uint32_t cyc;
+
+    tick_read(&ms, &cyc);
+
+#if TICK_HIRES_DWT
+    if (tick_hz > 0) {
+        ns = (uint64_t)(DWT_CYCCNT - cyc) * 1000000000 / tick_hz;
+
+        /* a late tick must not let the time run past the next one */
+        if (ns > 999999) {
+            ns = 999999;
+        }
     }
+#endif
+
+    return ms * 1000000 + ns;
+#endif
 }
 
-__always_inline uint32_t al_tick_get_tick(void)
+uint32_t al_tick_get_tick(void)
 {
-    return tick_tick;
+    return (uint32_t)al_tick_get_tick64();
 }
 
-__always_inline uint32_t al_tick_get_sec(void)
+uint32_t al_tick_get_sec(void)
 {
-    return tick_sec;
+    return (uint32_t)(al_tick_get_tick64() / 1000);
 }
 
-__always_inline uint32_t al_tick_get_msec(void)
+uint32_t al_tick_get_msec(void)
 {
-    return tick_msec;
+    return (uint32_t)(al_tick_get_tick64() % 1000);
 }
 
-__always_inline uint32_t al_tick_elapsed_tick(uint32_t last)
+uint32_t al_tick_elapsed_tick(uint32_t last)
 {
     return al_tick_get_tick() - last;
 }
 
-__always_inline uint32_t al_tick_elapsed_sec(uint32_t last)
+uint32_t al_tick_elapsed_sec(uint32_t last)
 {
     return al_tick_get_sec() - last;
 }
 
 __END_DECLS
-
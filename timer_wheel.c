@@ -0,0 +1,275 @@
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/types.h"
+#include "alumy/base.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/bit.h"
+#include "alumy/list.h"
+#include "alumy/timer_wheel.h"
+
+__BEGIN_DECLS
+
+#define WHEEL_MASK		(AL_TIMER_WHEEL_SLOTS - 1)
+#define WHEEL_SHIFT(n)	((n) * AL_TIMER_WHEEL_BITS)
+
+/* the first occupied slot from start on, cyclic, -1 for none */
+static int_t wheel_find(uint64_t bitmap, uint_t start)
+{
+	if (bitmap == 0) {
+		return -1;
+	}
+
+	if (start > 0) {
+		bitmap = (bitmap >> start) | (bitmap << (AL_TIMER_WHEEL_SLOTS - start));
+	}
+
+	return (start + al_ctzll(bitmap)) & WHEEL_MASK;
+}
+
+static uint64_t wheel_min(const struct list_head *head)
+{
+	const struct list_head *pos;
+	uint64_t e = AL_TIMER_NEVER;
+
+	list_for_each(pos, head) {
+		e = min_t(uint64_t, e, list_entry(pos, al_timer_t, node)->expires);
+	}
+
+	return e;
+}
+
+static void wheel_link(al_timer_wheel_t *wheel, al_timer_t *tmr)
+{
+	uint64_t e = max_t(uint64_t, tmr->expires, wheel->clk);
+	uint64_t delta = e - wheel->clk;
+	uint_t level;
+
+	for (level = 0; level < AL_TIMER_WHEEL_LEVELS - 1; level++) {
+		if ((delta >> WHEEL_SHIFT(level + 1)) == 0) {
+			break;
+		}
+	}
+
+	if ((delta >> WHEEL_SHIFT(AL_TIMER_WHEEL_LEVELS)) != 0) {
+		/* beyond the wheel, wait at its far end and be placed again */
+		e = wheel->clk + (1ULL << WHEEL_SHIFT(AL_TIMER_WHEEL_LEVELS)) - 1;
+	}
+
+	tmr->slot = level * AL_TIMER_WHEEL_SLOTS +
+				((e >> WHEEL_SHIFT(level)) & WHEEL_MASK);
+
+	list_add_tail(&tmr->node, &wheel->slot[0][0] + tmr->slot);
+	wheel->bitmap[level] |= 1ULL << (tmr->slot & WHEEL_MASK);
+}
+
+static void wheel_unlink(al_timer_wheel_t *wheel, al_timer_t *tmr)
+{
+	struct list_head *head = &wheel->slot[0][0] + tmr->slot;
+
+	list_del_init(&tmr->node);
+
+	/* a timer of a slot being run is on a private list by now */
+	if (list_empty(head)) {
+		wheel->bitmap[tmr->slot / AL_TIMER_WHEEL_SLOTS] &=
+			~(1ULL << (tmr->slot & WHEEL_MASK));
+	}
+}
+
+static uint_t wheel_cascade(al_timer_wheel_t *wheel, uint_t level)
+{
+	uint_t idx = (wheel->clk >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+	struct list_head *head = &wheel->slot[level][idx];
+	struct list_head work;
+	al_timer_t *tmr;
+
+	INIT_LIST_HEAD(&work);
+	list_splice_init(head, &work);
+	wheel->bitmap[level] &= ~(1ULL << idx);
+
+	while (!list_empty(&work)) {
+		tmr = list_entry(work.next, al_timer_t, node);
+		list_del(&tmr->node);
+		wheel_link(wheel, tmr);
+	}
+
+	return idx;
+}
+
+void al_timer_wheel_init(al_timer_wheel_t *wheel, uint64_t now)
+{
+	uint_t i, j;
+
+	AL_CHECK(wheel != NULL, EINVAL);
+
+	wheel->clk = now;
+	wheel->count = 0;
+
+	for (i = 0; i < AL_TIMER_WHEEL_LEVELS; i++) {
+		wheel->bitmap[i] = 0;
+
+		for (j = 0; j < AL_TIMER_WHEEL_SLOTS; j++) {
+			INIT_LIST_HEAD(&wheel->slot[i][j]);
+		}
+	}
+}
+
+void al_timer_init(al_timer_t *tmr, al_timer_func_t func, void *arg)
+{
+	AL_CHECK(tmr != NULL, EINVAL);
+
+	INIT_LIST_HEAD(&tmr->node);
+	tmr->expires = 0;
+	tmr->period = 0;
+	tmr->slot = 0;
+	tmr->func = func;
+	tmr->arg = arg;
+}
+
+int32_t al_timer_add(al_timer_wheel_t *wheel, al_timer_t *tmr,
+					 uint64_t expires, uint32_t period)
+{
+	AL_CHECK_RET(wheel != NULL, EINVAL, -1);
+	AL_CHECK_RET(tmr != NULL, EINVAL, -1);
+	AL_CHECK_RET(tmr->func != NULL, EINVAL, -1);
+
+	if (al_timer_pending(tmr)) {
+		wheel_unlink(wheel, tmr);
+	} else {
+		wheel->count++;
+	}
+
+	tmr->expires = expires;
+	tmr->period = period;
+
+	wheel_link(wheel, tmr);
+
+	return 0;
+}
+
+int32_t al_timer_del(al_timer_wheel_t *wheel, al_timer_t *tmr)
+{
+	AL_CHECK_RET(wheel != NULL, EINVAL, -1);
+	AL_CHECK_RET(tmr != NULL, EINVAL, -1);
+
+	if (!al_timer_pending(tmr)) {
+		return 0;
+	}
+
+	wheel_unlink(wheel, tmr);
+	wheel->count--;
+
+	return 1;
+}
+
+uint32_t al_timer_wheel_advance(al_timer_wheel_t *wheel, uint64_t now)
+{
+	struct list_head work;
+	al_timer_t *tmr;
+	uint32_t n = 0;
+	uint_t idx, level;
+
+	AL_CHECK_RET(wheel != NULL, EINVAL, 0);
+
+	INIT_LIST_HEAD(&work);
+
+	while (wheel->clk <= now) {
+		if (wheel->count == 0) {
+			wheel->clk = now + 1;
+			break;
+		}
+
+		idx = wheel->clk & WHEEL_MASK;
+
+		if (idx == 0) {
+			for (level = 1; level < AL_TIMER_WHEEL_LEVELS; level++) {
+				if (wheel_cascade(wheel, level) != 0) {
+					break;
+				}
+			}
+		} else if ((wheel->bitmap[0] >> idx) == 0) {
+			/* nothing left in this turn of level 0, skip to its end */
+			wheel->clk = min_t(uint64_t, (wheel->clk | WHEEL_MASK) + 1,
+							   now + 1);
+			continue;
+		}
+
+		list_splice_init(&wheel->slot[0][idx], &work);
+		wheel->bitmap[0] &= ~(1ULL << idx);
+
+		/* a timer added by a callback lands on the next tick at the soonest */
+		wheel->clk++;
+
+		while (!list_empty(&work)) {
+			tmr = list_entry(work.next, al_timer_t, node);
+			list_del_init(&tmr->node);
+			wheel->count--;
+
+			if (tmr->period > 0) {
+				tmr->expires += tmr->period;
+				wheel->count++;
+				wheel_link(wheel, tmr);
+			}
+
+			/* the callback may free tmr, don't touch it afterwards */
+			tmr->func(tmr, tmr->arg);
+			n++;
+		}
+	}
+
+	return n;
+}
+
+uint64_t al_timer_wheel_next(const al_timer_wheel_t *wheel)
+{
+	uint64_t next = AL_TIMER_NEVER;
+	uint_t level, cur, start;
+	int_t idx;
+
+	AL_CHECK_RET(wheel != NULL, EINVAL, AL_TIMER_NEVER);
+
+	if (wheel->count == 0) {
+		return AL_TIMER_NEVER;
+	}
+
+	/* a slot of level 0 is a single tick */
+	idx = wheel_find(wheel->bitmap[0], wheel->clk & WHEEL_MASK);
+	if (idx >= 0) {
+		next = wheel->clk + ((idx - wheel->clk) & WHEEL_MASK);
+	}
+
+	/*
+	 * The current slot of a higher level was cascaded already, unless the
+	 * clock sits on its boundary, then it holds timers of the next turn
+	 * and the search starts behind it.
+	 */
+	for (level = 1; level < AL_TIMER_WHEEL_LEVELS; level++) {
+		cur = (wheel->clk >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+		start = cur;
+
+		if (wheel->clk & ((1ULL << WHEEL_SHIFT(level)) - 1)) {
+			start = (cur + 1) & WHEEL_MASK;
+		}
+
+		idx = wheel_find(wheel->bitmap[level], start);
+		if (idx < 0) {
+			continue;
+		}
+
+		next = min_t(uint64_t, next, wheel_min(&wheel->slot[level][idx]));
+
+		/*
+		 * The timers beyond the wheel wait in the slot before the current
+		 * one and may hide a sooner timer of the current slot.
+		 */
+		if ((level == AL_TIMER_WHEEL_LEVELS - 1) && (idx != (int_t)cur) &&
+			(wheel->bitmap[level] & (1ULL << cur))) {
+			next = min_t(uint64_t, next, wheel_min(&wheel->slot[level][cur]));
+		}
+	}
+
+	/* an overdue timer runs on the next advance */
+	return max_t(uint64_t, next, wheel->clk);
+}
+
+__END_DECLS
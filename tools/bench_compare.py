@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Compare two result files of alumy-bench -j and flag the regressions
+
+    tools/bench_compare.py [-t percent] [-m metric] base.json new.json
+
+The benchmarks are matched by name and compared on the median time of an
+operation, p50 of ns_per_op by default. A benchmark slower than the base by
+more than the threshold, 10 percent by default, is a regression and makes
+the script exit with 1, so a CI job fails on it.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        doc = json.load(f)
+    return doc, {b["name"]: b for b in doc.get("benchmarks", [])}
+
+
+def metric_of(bench, metric):
+    return bench["ns_per_op"][metric]
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("-t", "--threshold", type=float, default=10.0,
+                    help="percent slower to flag, default 10")
+    ap.add_argument("-m", "--metric", default="p50",
+                    choices=("min", "mean", "p50", "p90", "p99"),
+                    help="statistic of ns_per_op to compare, default p50")
+    ap.add_argument("base")
+    ap.add_argument("new")
+    args = ap.parse_args(argv[1:])
+
+    base_doc, base = load(args.base)
+    new_doc, new = load(args.new)
+
+    print("base %s (%s), new %s (%s), %s ns/op, threshold %.1f%%" %
+          (base_doc.get("version", "?"), base_doc.get("git", "?"),
+           new_doc.get("version", "?"), new_doc.get("git", "?"),
+           args.metric, args.threshold))
+    print("%-28s %12s %12s %9s" % ("benchmark", "base", "new", "change"))
+
+    regressed = []
+
+    for name in sorted(set(base) | set(new)):
+        if name not in base:
+            print("%-28s %12s %12.1f %9s" %
+                  (name, "-", metric_of(new[name], args.metric), "new"))
+            continue
+        if name not in new:
+            print("%-28s %12.1f %12s %9s" %
+                  (name, metric_of(base[name], args.metric), "-", "gone"))
+            continue
+
+        b = metric_of(base[name], args.metric)
+        n = metric_of(new[name], args.metric)
+        change = (n - b) * 100.0 / b if b > 0 else 0.0
+        mark = ""
+
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressed.append(name)
+
+        print("%-28s %12.1f %12.1f %+8.1f%%%s" % (name, b, n, change, mark))
+
+    if regressed:
+        print("%d regression(s): %s" % (len(regressed), ", ".join(regressed)))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
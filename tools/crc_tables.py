@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Generate the const CRC tables of crc/
+
+    tools/crc_tables.py crc
+
+writes crc/crc_tables.h (the al_crc_model_t instances) and
+crc/crc32_slice.h (the CRC32 slicing tables). Row k of a table holds the
+register after one byte followed by k zero bytes, the same layout
+al_crc_gen_table() builds at runtime.
+"""
+
+import os
+import sys
+
+
+def reflect(v, width):
+    r = 0
+    for _ in range(width):
+        r = (r << 1) | (v & 1)
+        v >>= 1
+    return r
+
+
+def gen(width, poly, refin, rows):
+    mask = (1 << width) - 1
+    t = [[0] * 256 for _ in range(rows)]
+
+    for n in range(256):
+        if refin:
+            c = n
+            rpoly = reflect(poly, width)
+            for _ in range(8):
+                c = (c >> 1) ^ rpoly if c & 1 else c >> 1
+        else:
+            c = n << (width - 8)
+            for _ in range(8):
+                c = ((c << 1) ^ poly) if c & (1 << (width - 1)) else c << 1
+                c &= mask
+        t[0][n] = c
+
+    for k in range(1, rows):
+        for n in range(256):
+            p = t[k - 1][n]
+            if refin:
+                t[k][n] = (p >> 8) ^ t[0][p & 0xff]
+            else:
+                t[k][n] = ((p << 8) & mask) ^ t[0][p >> (width - 8)]
+
+    return t
+
+
+def rows_out(t, first, width, per_line):
+    fmt = "0x%%0%dx" % (width // 4)
+    out = []
+    for k in range(first, len(t)):
+        if k == 1 and first == 0:
+            out.append("#if AL_CRC_SLICE > 1")
+        if k == 4 and first == 0:
+            out.append("#if AL_CRC_SLICE > 4")
+        if k == 8 and first == 1:
+            out.append("#if AL_CRC32_SLICE > 8")
+        out.append("{")
+        for i in range(0, 256, per_line):
+            line = ", ".join(fmt % v + ("L" if width == 32 else "")
+                             for v in t[k][i:i + per_line])
+            out.append(line + ("," if i + per_line < 256 else ""))
+        out.append("},")
+    return out
+
+
+MODELS = [
+    # name, ctype, width, poly, reflected
+    ("crc8_maxim_table", "uint8_t", 8, 0x31, True),
+    ("crc16_modbus_table", "uint16_t", 16, 0x8005, True),
+    ("crc16_xmodem_table", "uint16_t", 16, 0x1021, False),
+]
+
+
+def crc_tables():
+    out = ["/*",
+           " * Tables of the al_crc_model_t instances, generated by",
+           " * tools/crc_tables.py, do not edit.",
+           " */",
+           "",
+           "#ifndef __AL_CRC_TABLES_H",
+           "#define __AL_CRC_TABLES_H 1",
+           ""]
+
+    for name, ctype, width, poly, refin in MODELS:
+        t = gen(width, poly, refin, 8)
+        out.append("static const %s %s[AL_CRC_SLICE][256] = {" % (ctype, name))
+        out += rows_out(t, 0, width, 8)
+        out.append("#endif")
+        out.append("#endif")
+        out.append("};")
+        out.append("")
+
+    out.append("#endif")
+    out.append("")
+    return "\n".join(out)
+
+
+def crc32_slice():
+    t = gen(32, 0x04C11DB7, True, 16)
+    out = ["/*",
+           " * Slicing tables of crc/crc32.c, row k - 1 holds the CRC of every byte",
+           " * value followed by k zero bytes. Row 0 of the algorithm is crc_table.",
+           " * Little endian only, generated by tools/crc_tables.py.",
+           " */",
+           "",
+           "#ifndef __AL_CRC32_SLICE_H",
+           "#define __AL_CRC32_SLICE_H 1",
+           "",
+           "static const uint32_t crc_slice_table[AL_CRC32_SLICE - 1][256] = {"]
+    out += rows_out(t, 1, 32, 4)
+    out.append("#endif")
+    out.append("};")
+    out.append("")
+    out.append("#endif")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    outdir = sys.argv[1] if len(sys.argv) > 1 else "crc"
+
+    with open(os.path.join(outdir, "crc_tables.h"), "w") as f:
+        f.write(crc_tables())
+
+    with open(os.path.join(outdir, "crc32_slice.h"), "w") as f:
+        f.write(crc32_slice())
+
+
+if __name__ == "__main__":
+    main()
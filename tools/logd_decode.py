@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""
+Decode the records of the deferred log (alumy/log_defer.h)
+
+    tools/logd_decode.py alumy-test.logd [records]
+
+The first argument is the string table, the .al_logd section extracted by
+al_logd_strtab() of cmake/log_defer.cmake. The records are read from the
+file or stdin, a capture of the UART or of the log ring output, and printed
+as al_vlog() would have printed them.
+"""
+
+import re
+import struct
+import sys
+
+I32, I64, F64, STR, PTR = 1, 2, 3, 4, 5
+
+CONV = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?"
+                  r"(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGcsp%])")
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise EOFError
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+    def bytes(self, n):
+        if self.pos + n > len(self.data):
+            raise EOFError
+        self.pos += n
+        return self.data[self.pos - n:self.pos]
+
+    def varint(self):
+        v, shift = 0, 0
+        while True:
+            b = self.byte()
+            v |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                return v
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def decode_args(r, types):
+    args = []
+    for t in types:
+        if t in (I32, I64):
+            args.append((t, unzigzag(r.varint())))
+        elif t == F64:
+            args.append((t, struct.unpack("<d", r.bytes(8))[0]))
+        elif t == STR:
+            args.append((t, r.bytes(r.varint()).decode("utf-8", "replace")))
+        elif t == PTR:
+            args.append((t, r.varint()))
+        else:
+            raise ValueError("unknown argument type %d" % t)
+    return args
+
+
+def render(fmt, args):
+    args = list(args)
+
+    def take():
+        return args.pop(0) if args else (I32, 0)
+
+    def conv(m):
+        flags, width, prec, _, c = m.groups()
+        if c == "%":
+            return "%"
+        if width == "*":
+            width = str(take()[1])
+        if prec == "*":
+            prec = str(take()[1])
+        spec = "%" + flags + (width or "") + ("." + prec if prec else "")
+        t, v = take()
+        if c in "di":
+            return (spec + "d") % int(v)
+        if c in "ouxX":
+            if isinstance(v, int) and v < 0:
+                v += 1 << (32 if t == I32 else 64)
+            return (spec + ("d" if c == "u" else c)) % int(v)
+        if c in "eEfFgG":
+            return (spec + c) % float(v)
+        if c == "c":
+            return (spec + "c") % chr(int(v) & 0xFF)
+        if c == "p":
+            return (spec + "s") % ("0x%x" % int(v))
+        return (spec + "s") % v
+
+    return CONV.sub(conv, fmt)
+
+
+def strtab_get(strtab, off):
+    end = strtab.find(b"\0", off)
+    if off >= len(strtab) or end < 0:
+        return None
+    return strtab[off:end].decode("utf-8", "replace")
+
+
+def decode(strtab, data, out):
+    r = Reader(data)
+    while True:
+        try:
+            n = r.varint()
+            rec = Reader(r.bytes(n))
+            head = rec.byte()
+            tick = rec.varint()
+            fid = rec.varint()
+            nargs = head >> 3
+            types = []
+            for i in range(0, nargs, 2):
+                b = rec.byte()
+                types += [b & 0x0F, b >> 4]
+            args = decode_args(rec, types[:nargs])
+        except EOFError:
+            return
+
+        fmt = strtab_get(strtab, fid)
+        if fmt is None:
+            text = "<unknown format %d>" % fid
+        else:
+            text = render(fmt, args).rstrip("\r\n")
+
+        out.write("[%5d.%03d] %s\n" % (tick // 1000, tick % 1000, text))
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+
+    with open(argv[1], "rb") as f:
+        strtab = f.read()
+
+    if len(argv) > 2:
+        with open(argv[2], "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    decode(strtab, data, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
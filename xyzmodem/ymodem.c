@@ -15,6 +15,7 @@
 #include "alumy/errno.h"
 #include "alumy/bug.h"
 #include "alumy/check.h"
+#include "alumy/crc.h"
 #include "tinyprintf.h"
 
 __BEGIN_DECLS
@@ -36,22 +37,7 @@ enum {
 
 static uint16_t ymodem_crc16(uint16_t crc, const void *data, uint32_t len)
 {
-    const uint8_t *p = (const uint8_t *)data;
-    int32_t i;
-
-    while (len--) {
-        crc = crc ^ *p++ << 8;
-
-        for (i = 0; i < 8; i++) {
-            if (crc & 0x8000) {
-                crc = crc << 1 ^ 0x1021;
-            } else {
-                crc = crc << 1;
-            }
-        }
-    }
-
-    return crc;
+    return al_crc_update(&al_crc16_xmodem_model, crc, data, len);
 }
 
 static void ymodem_recv_status_reset(al_ymodem_t *ym)
@@ -128,6 +114,65 @@ static ssize_t ymodem_recv_pkg(al_ymodem_t *ym)
     return 0;
 }
 
+static int32_t ymodem_sink_open(al_ymodem_t *ym,
+                                const char *filename, size_t filesize)
+{
+    ym->file_size = filesize;
+    ym->file_off = 0;
+
+    if (ym->sink == NULL) {
+        if (ym->callback->recv_header == NULL) {
+            return -1;
+        }
+
+        return ym->callback->recv_header(filename, filesize);
+    }
+
+    if (ym->sink->open(ym->sink->ctx, filename, filesize) != 0) {
+        return -1;
+    }
+
+    ym->sink_open = true;
+
+    return 0;
+}
+
+static int32_t ymodem_sink_write(al_ymodem_t *ym, const void *data, size_t len)
+{
+    if (ym->sink == NULL) {
+        if (ym->callback->recv_packet == NULL) {
+            return -1;
+        }
+
+        return ym->callback->recv_packet(data, len);
+    }
+
+    /* the padding of the last packet is not part of the file */
+    len = min_t(size_t, len, ym->file_size - ym->file_off);
+    ym->file_off += len;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    return ym->sink->write(ym->sink->ctx, data, len);
+}
+
+static int32_t ymodem_sink_close(al_ymodem_t *ym, bool ok)
+{
+    if (!ym->sink_open) {
+        return 0;
+    }
+
+    ym->sink_open = false;
+
+    if (ym->sink->close == NULL) {
+        return 0;
+    }
+
+    return ym->sink->close(ym->sink->ctx, ok);
+}
+
 static int32_t ymodem_check_pkg(const void *__data, size_t len, int32_t __seq)
 {
     const uint8_t *data = (const uint8_t *)__data;
@@ -190,8 +235,7 @@ int32_t al_ymodem_init(al_ymodem_t *ym,
 
     AL_CHECK_RET(cb != NULL, EINVAL, -1);
     AL_CHECK_RET(opt != NULL, EINVAL, -1);
-    AL_CHECK_RET(cb->recv_header != NULL, EINVAL, -1);
-    AL_CHECK_RET(cb->recv_packet != NULL, EINVAL, -1);
+    /* recv_header and recv_packet are not needed with a sink */
     AL_CHECK_RET(cb->recv_finish != NULL, EINVAL, -1);
     AL_CHECK_RET(opt->ym_putc != NULL, EINVAL, -1);
     AL_CHECK_RET(opt->ym_getc != NULL, EINVAL, -1);
@@ -212,6 +256,7 @@ int32_t al_ymodem_init(al_ymodem_t *ym,
     ym->timeout = YMODEM_TIMEOUT_DFT;
     ym->max_err_cnt = YMODEM_MAX_ERR_CNT_DFT;
     ym->send_packet_1k = true;
+    ym->stream = false;
 
     return 0;
 }
@@ -284,7 +329,7 @@ int32_t al_ymodem_recv(al_ymodem_t *ym)
                 ym->opt->recv_clear();
             }
 
-            ym->opt->ym_putc('C');
+            ym->opt->ym_putc(ym->stream ? 'G' : 'C');
             ym->status = YMODEM_STATUS_RECV_HEADER;
             ym->last_time = ym->opt->tick_ms();
             ym->seq = 0;
@@ -312,9 +357,9 @@ int32_t al_ymodem_recv(al_ymodem_t *ym)
                         break;
                     }
 
-                    if (ym->callback->recv_header(filename, filesize) == 0) {
+                    if (ymodem_sink_open(ym, filename, filesize) == 0) {
                         ym->opt->ym_putc(AL_ACK);
-                        ym->opt->ym_putc('C');
+                        ym->opt->ym_putc(ym->stream ? 'G' : 'C');
 
                         ym->seq++;
                         ym->status = YMODEM_STATUS_RECV_DATA;
@@ -345,6 +390,20 @@ int32_t al_ymodem_recv(al_ymodem_t *ym)
                 ret = ymodem_check_pkg(ym->recv_buf, ym->recv_wp, ym->seq);
                 switch (ret) {
                     case AL_EOT:
+                        if (ym->stream) {
+                            if (ymodem_sink_close(ym, true) != 0) {
+                                ym->status = YMODEM_STATUS_RECV_ERR;
+                                ym->finish_reason = AL_YM_FINISH_PACKET_PROC_ERR;
+                                break;
+                            }
+
+                            /* YMODEM-g acknowledges the first EOT */
+                            ym->status = YMODEM_STATUS_RECV_FINISH;
+                            ym->opt->ym_putc(AL_ACK);
+                            ym->opt->ym_putc('G');
+                            break;
+                        }
+
                         ym->status = YMODEM_STATUS_RECV_EOT_CONFIRM;
                         ym->opt->ym_putc(AL_NAK);
                         break;
@@ -355,19 +414,42 @@ int32_t al_ymodem_recv(al_ymodem_t *ym)
                         break;
 
                     case 0:
-                        if (ym->callback->recv_packet(
+                    {
+                        /*
+                         * The sender of a stream does not wait for the ACK.
+                         * With a sink it goes on with the next packet while
+                         * the sink writes, a failed write cancels then.
+                         */
+                        bool ack_first = (ym->sink != NULL) && !ym->stream;
+
+                        if (ack_first) {
+                            ym->opt->ym_putc(AL_ACK);
+                        }
+
+                        if (ymodem_sink_write(ym,
                                 ym->recv_buf + YMODEM_HEADER_SIZE,
                                 ym->packet_size) == 0) {
                             ym->seq++;
-                            ym->opt->ym_putc(AL_ACK);
+
+                            if (!ym->stream && !ack_first) {
+                                ym->opt->ym_putc(AL_ACK);
+                            }
                         } else {
                             ym->status = YMODEM_STATUS_RECV_ERR;
                             ym->finish_reason = AL_YM_FINISH_PACKET_PROC_ERR;
                         }
 
                         break;
+                    }
 
                     default:
+                        /* a stream has no retransmission, give up */
+                        if (ym->stream) {
+                            ym->status = YMODEM_STATUS_RECV_ERR;
+                            ym->finish_reason = AL_YM_FINISH_PACKET_RECV_ERR;
+                            break;
+                        }
+
                         ym->opt->ym_putc(AL_NAK);
                         ymodem_recv_status_reset(ym);
                         break;
@@ -375,6 +457,12 @@ int32_t al_ymodem_recv(al_ymodem_t *ym)
             }
 
             if ((ym->opt->tick_ms() - ym->last_time) > ym->timeout) {
+                if (ym->stream) {
+                    ym->status = YMODEM_STATUS_RECV_ERR;
+                    ym->finish_reason = AL_YM_FINISH_TIMEOUT;
+                    break;
+                }
+
                 ym->opt->ym_putc(AL_NAK);
                 ym->last_time = ym->opt->tick_ms();
                 ymodem_recv_status_reset(ym);
@@ -399,6 +487,12 @@ int32_t al_ymodem_recv(al_ymodem_t *ym)
                 int32_t ret = ymodem_check_pkg(ym->recv_buf, ym->recv_wp, 0);
                 switch (ret) {
                     case AL_EOT:
+                        if (ymodem_sink_close(ym, true) != 0) {
+                            ym->status = YMODEM_STATUS_RECV_ERR;
+                            ym->finish_reason = AL_YM_FINISH_PACKET_PROC_ERR;
+                            break;
+                        }
+
                         ym->status = YMODEM_STATUS_RECV_FINISH;
                         ym->opt->ym_putc(AL_ACK);
                         ym->opt->ym_putc('C');
@@ -507,6 +601,7 @@ int32_t al_ymodem_recv(al_ymodem_t *ym)
             ym->opt->ym_putc(AL_CAN);
             ym->opt->ym_putc(AL_CAN);
 
+            ymodem_sink_close(ym, false);
             ym->callback->recv_finish(ym->finish_reason);
 
             ym->status = YMODEM_STATUS_IDLE;
@@ -534,8 +629,15 @@ static int32_t al_ymodem_send_check_ack(al_ymodem_t *ym, uint8_t expect)
 		if (c == expect) {
 			return 0;
 		}
+
+		/* the receiver gave up, nothing to wait for */
+		if (c == AL_CAN) {
+			set_errno(ECANCELED);
+			return -1;
+		}
 	}
 
+	set_errno(ETIMEDOUT);
 	return -1;
 }
 
@@ -548,6 +650,7 @@ static ssize_t __al_ymodem_send_packet(al_ymodem_t *ym,
     uint16_t crc = 0;
     ssize_t total_len = 0;
     const uint8_t *p;
+    uint8_t *buf;
 
     if (ym == NULL) {
         set_errno(EINVAL);
@@ -568,6 +671,33 @@ static ssize_t __al_ymodem_send_packet(al_ymodem_t *ym,
         return -1;
     }
 
+    /* the whole packet in one write, data may be in send_buf already */
+    if ((ym->opt->ym_write != NULL) &&
+        (ym->send_bufsz >= YMODEM_TOTAL_LEN(cal_len))) {
+        buf = ym->send_buf;
+
+        memmove(buf + YMODEM_HEADER_SIZE, data, len);
+        memset(buf + YMODEM_HEADER_SIZE + len, fill, cal_len - len);
+
+        buf[YMODEM_HEADER] = header;
+        buf[YMODEM_SEQ] = seq;
+        buf[YMODEM_SEQ_COMP] = ~seq;
+
+        crc = ymodem_crc16(0, buf + YMODEM_HEADER_SIZE, cal_len);
+        buf[YMODEM_CRC(cal_len)] = (crc & 0xFF00) >> 8;
+        buf[YMODEM_CRC(cal_len) + 1] = crc & 0x00FF;
+
+        total_len = YMODEM_TOTAL_LEN(cal_len);
+
+        if (ym->opt->ym_write(buf, total_len) != total_len) {
+            return -1;
+        }
+
+        ym->opt->ym_flush();
+
+        return total_len;
+    }
+
     ym->opt->ym_putc(header);
     ym->opt->ym_putc(seq);
     ym->opt->ym_putc(~seq);
@@ -575,10 +705,10 @@ static ssize_t __al_ymodem_send_packet(al_ymodem_t *ym,
     total_len += 3;
     
     p = (const uint8_t *)data;
+    crc = ymodem_crc16(crc, p, len);
 
     while ((n--) > 0) {
         ym->opt->ym_putc(*p);
-        crc = ymodem_crc16(crc, p, 1);
 
         p++;
         total_len++;
@@ -619,6 +749,10 @@ static int32_t al_ymodem_send_packet(al_ymodem_t *ym,
 
             break;
         }
+
+        if (errno == ECANCELED) {
+            return -1;
+        }
     }
 
     if (i >= YMODEM_RETRANS_CNT) {
@@ -628,52 +762,101 @@ static int32_t al_ymodem_send_packet(al_ymodem_t *ym,
     return 0;
 }
 
-static int32_t al_ymodem_send_file_data(al_ymodem_t *ym,
-                                        const char *file_name,
-                                        const void *data, size_t file_size)
+/*
+ * A data packet of YMODEM-g is not acknowledged, the receiver cancels the
+ * transfer when one is corrupted. Only a CAN is looked for, without a wait.
+ */
+static int32_t al_ymodem_stream_packet(al_ymodem_t *ym,
+                                       uint8_t header, uint8_t seq, uint8_t fill,
+                                       const void *data, size_t len)
+{
+    if (__al_ymodem_send_packet(ym, header, seq, fill, data, len) <= 0) {
+        return -1;
+    }
+
+    if (ym->opt->ym_getc(0) == AL_CAN) {
+        set_errno(ECANCELED);
+        return -1;
+    }
+
+    ym->send_seq++;
+
+    return 0;
+}
+
+static int32_t al_ymodem_send_data_packet(al_ymodem_t *ym,
+                                          const void *data, size_t len)
+{
+    if (ym->stream) {
+        return al_ymodem_stream_packet(ym, YMODEM_GET_HEADER(len),
+                                       ym->send_seq, 0x1A, data, len);
+    }
+
+    return al_ymodem_send_packet(ym, YMODEM_GET_HEADER(len),
+                                 ym->send_seq, 0x1A, data, len);
+}
+
+/* read the next len bytes of the source into the packet of send_buf */
+static const void *al_ymodem_source_read(al_ymodem_t *ym,
+                                         const al_ymodem_source_t *src,
+                                         size_t len)
+{
+    uint8_t *buf = ym->send_buf + YMODEM_HEADER_SIZE;
+    size_t off = 0;
+    ssize_t n;
+
+    while (off < len) {
+        n = src->read(src->ctx, buf + off, len - off);
+        if (n <= 0) {
+            set_errno(EIO);
+            return NULL;
+        }
+
+        off += n;
+    }
+
+    return buf;
+}
+
+/* the data of the file, from data or from src when data is NULL */
+static int32_t al_ymodem_send_file_data(al_ymodem_t *ym, const void *data,
+                                        const al_ymodem_source_t *src,
+                                        size_t file_size)
 {
     ssize_t len;
     int32_t ret;
-    ssize_t remain = file_size;
-    const uint8_t *p = (const uint8_t *)data;
-
-	if (ym->send_packet_1k) {
-		while (remain >= YMODEM_PACKET_SIZE_1K) {
-			len = YMODEM_PACKET_SIZE_1K;
-			ret = al_ymodem_send_packet(ym, YMODEM_GET_HEADER(len),
-										ym->send_seq, 0x1A, p, len);
-			if (ret < 0) {
-                AL_ERROR(1, "ymodem send packet failed @ %s:%d, send_seq = %d",
-                         __func__, __LINE__, ym->send_seq);
-				return -1;
-			}
-
-			remain -= YMODEM_PACKET_SIZE_1K;
-			p += YMODEM_PACKET_SIZE_1K;
-		}
-	}
+    size_t off = 0;
+    const void *p;
 
-    while (remain >= YMODEM_PACKET_SIZE_128) {
+    while (off < file_size) {
         len = YMODEM_PACKET_SIZE_128;
-        ret = al_ymodem_send_packet(ym, YMODEM_GET_HEADER(len),
-                                    ym->send_seq, 0x1A, p, len);
+
+        if (ym->send_packet_1k && (file_size - off >= YMODEM_PACKET_SIZE_1K)) {
+            len = YMODEM_PACKET_SIZE_1K;
+        }
+
+        /* the last packet is padded */
+        len = min_t(size_t, len, file_size - off);
+
+        if (data != NULL) {
+            p = (const uint8_t *)data + off;
+        } else {
+            p = al_ymodem_source_read(ym, src, len);
+            if (p == NULL) {
+                AL_ERROR(1, "ymodem read source failed @ %s:%d, off = %u",
+                         __func__, __LINE__, (uint_t)off);
+                return -1;
+            }
+        }
+
+        ret = al_ymodem_send_data_packet(ym, p, len);
         if (ret != 0) {
             AL_ERROR(1, "ymodem send packet failed @ %s:%d, send_seq = %d",
                      __func__, __LINE__, ym->send_seq);
             return -1;
         }
 
-        remain -= YMODEM_PACKET_SIZE_128;
-        p += YMODEM_PACKET_SIZE_128;
-    }
-
-    len = remain;
-    ret = al_ymodem_send_packet(ym, YMODEM_GET_HEADER(len),
-                                ym->send_seq, 0x1A, p, len);
-    if (ret != 0) {
-        AL_ERROR(1, "ymodem send packet failed @ %s:%d, send_seq = %d",
-                 __func__, __LINE__, ym->send_seq);
-        return -1;
+        off += len;
     }
 
     return 0;
@@ -681,10 +864,15 @@ static int32_t al_ymodem_send_file_data(al_ymodem_t *ym,
 
 int32_t al_ymodem_wait_send(al_ymodem_t *ym)
 {
-    if (ym->opt->ym_getc(ym->getc_timeout) != 'C') {
+    int32_t c = ym->opt->ym_getc(ym->getc_timeout);
+
+    if ((c != 'C') && (c != 'G')) {
         return -1;
     }
 
+    /* a 'G' asks for YMODEM-g, the data packets are streamed */
+    ym->stream = (c == 'G');
+
     return 0;
 }
 
@@ -706,6 +894,15 @@ int32_t al_ymodem_set_getc_timeout(al_ymodem_t *ym, uint32_t timeout)
 	return 0;
 }
 
+int32_t al_ymodem_set_stream(al_ymodem_t *ym, bool stream)
+{
+	AL_CHECK_RET(ym, EINVAL, -1);
+
+	ym->stream = stream;
+
+	return 0;
+}
+
 int32_t al_ymodem_set_send_packet_1k(al_ymodem_t *ym, bool send_1k)
 {
 	AL_CHECK_RET(ym, EINVAL, -1);
@@ -715,8 +912,10 @@ int32_t al_ymodem_set_send_packet_1k(al_ymodem_t *ym, bool send_1k)
 	return 0;
 }
 
-int32_t al_ymodem_send_file(al_ymodem_t *ym, const char *file_name,
-                            const void *data, size_t file_size)
+static int32_t __al_ymodem_send_file(al_ymodem_t *ym, const char *file_name,
+                                     const void *data,
+                                     const al_ymodem_source_t *src,
+                                     size_t file_size)
 {
     ssize_t len;
     ssize_t ret;
@@ -754,25 +953,29 @@ int32_t al_ymodem_send_file(al_ymodem_t *ym, const char *file_name,
         return -1;
     }
 
-    if (al_ymodem_send_check_ack(ym, 'C') != 0) {
+    if (al_ymodem_send_check_ack(ym, ym->stream ? 'G' : 'C') != 0) {
         AL_ERROR(1, "ymodem check ack failed @ %s:%d", __FILE__, __LINE__);
         return -1;
     }
 
-    if (al_ymodem_send_file_data(ym, file_name, data, file_size) != 0) {
+    if (al_ymodem_send_file_data(ym, data, src, file_size) != 0) {
         AL_ERROR(1, "ymodem send file failed @ %s:%d", __FILE__, __LINE__);
+        return -1;
     }
 
     ym->opt->ym_putc(AL_EOT);
     ym->opt->ym_flush();
 
-    if (al_ymodem_send_check_ack(ym, AL_NAK) != 0) {
-        AL_ERROR(1, "ymodem check ack failed @ %s:%d", __FILE__, __LINE__);
-        return -1;
-    }
+    /* YMODEM-g acknowledges the first EOT, YMODEM wants it twice */
+    if (!ym->stream) {
+        if (al_ymodem_send_check_ack(ym, AL_NAK) != 0) {
+            AL_ERROR(1, "ymodem check ack failed @ %s:%d", __FILE__, __LINE__);
+            return -1;
+        }
 
-    ym->opt->ym_putc(AL_EOT);
-    ym->opt->ym_flush();
+        ym->opt->ym_putc(AL_EOT);
+        ym->opt->ym_flush();
+    }
 
     if (al_ymodem_send_check_ack(ym, AL_ACK) != 0) {
         AL_ERROR(1, "al_ymodem_send_check_ack failed @ %s:%d",
@@ -780,7 +983,7 @@ int32_t al_ymodem_send_file(al_ymodem_t *ym, const char *file_name,
         return -1;
     }
 
-    if (al_ymodem_send_check_ack(ym, 'C') != 0) {
+    if (al_ymodem_send_check_ack(ym, ym->stream ? 'G' : 'C') != 0) {
         AL_ERROR(1, "al_ymodem_send_check_ack failed @ %s:%d",
                  __FILE__, __LINE__);
         return -1;
@@ -798,5 +1001,43 @@ int32_t al_ymodem_send_file(al_ymodem_t *ym, const char *file_name,
     return 0;
 }
 
+int32_t al_ymodem_send_file(al_ymodem_t *ym, const char *file_name,
+                            const void *data, size_t file_size)
+{
+    AL_CHECK_RET((data != NULL) || (file_size == 0), EINVAL, -1);
+
+    return __al_ymodem_send_file(ym, file_name, data, NULL, file_size);
+}
+
+int32_t al_ymodem_send_source(al_ymodem_t *ym, const char *file_name,
+                              size_t file_size, const al_ymodem_source_t *src)
+{
+    size_t pkt = ym->send_packet_1k ? YMODEM_PACKET_SIZE_1K :
+                                      YMODEM_PACKET_SIZE_128;
+    int32_t ret;
+
+    AL_CHECK_RET((src != NULL) && (src->read != NULL), EINVAL, -1);
+    AL_CHECK_RET(ym->send_bufsz >= YMODEM_TOTAL_LEN(pkt), ENOBUFS, -1);
+
+    ret = __al_ymodem_send_file(ym, file_name, NULL, src, file_size);
+
+    if ((src->close != NULL) && (src->close(src->ctx) != 0)) {
+        ret = -1;
+    }
+
+    return ret;
+}
+
+int32_t al_ymodem_set_sink(al_ymodem_t *ym, const al_ymodem_sink_t *sink)
+{
+    AL_CHECK_RET(ym, EINVAL, -1);
+    AL_CHECK_RET((sink == NULL) ||
+                 ((sink->open != NULL) && (sink->write != NULL)), EINVAL, -1);
+
+    ym->sink = sink;
+
+    return 0;
+}
+
 __END_DECLS
 
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <string.h>
+#include "alumy/config.h"
+#include "alumy/base.h"
+#include "alumy/types.h"
+#include "alumy/errno.h"
+#include "alumy/check.h"
+#include "alumy/log2.h"
+#include "alumy/xyzmodem/ymodem_io.h"
+
+__BEGIN_DECLS
+
+static ssize_t ymodem_flash_read(void *ctx, void *buf, size_t len)
+{
+    al_ymodem_flash_t *flash = (al_ymodem_flash_t *)ctx;
+
+    len = min_t(size_t, len, flash->size - flash->off);
+
+    if ((len > 0) && (flash->read(flash->addr + flash->off, buf, len) != 0)) {
+        set_errno(EIO);
+        return -1;
+    }
+
+    flash->off += len;
+
+    return len;
+}
+
+int32_t al_ymodem_flash_source(al_ymodem_source_t *src, al_ymodem_flash_t *flash)
+{
+    AL_CHECK_RET((src != NULL) && (flash != NULL), EINVAL, -1);
+    AL_CHECK_RET(flash->read != NULL, EINVAL, -1);
+
+    flash->off = 0;
+
+    src->read = ymodem_flash_read;
+    src->close = NULL;
+    src->ctx = flash;
+
+    return 0;
+}
+
+static int32_t ymodem_flash_open(void *ctx, const char *filename, size_t filesize)
+{
+    al_ymodem_flash_t *flash = (al_ymodem_flash_t *)ctx;
+
+    AL_CHECK_RET(filesize <= flash->size, EFBIG, -1);
+
+    flash->off = 0;
+    flash->erased = 0;
+
+    return 0;
+}
+
+static int32_t ymodem_flash_write(void *ctx, const void *data, size_t len)
+{
+    al_ymodem_flash_t *flash = (al_ymodem_flash_t *)ctx;
+    uint8_t tail[AL_YMODEM_FLASH_ALIGN_MAX];
+    uint32_t end = flash->off + len;
+    size_t n;
+
+    /* only the last write of a file may leave a partial unit */
+    AL_CHECK_RET((flash->off & (flash->align - 1)) == 0, EINVAL, -1);
+    AL_CHECK_RET(end <= flash->size, EFBIG, -1);
+
+    while (flash->erased < end) {
+        if (flash->erase(flash->addr + flash->erased, flash->sector_size) != 0) {
+            set_errno(EIO);
+            return -1;
+        }
+
+        flash->erased += flash->sector_size;
+    }
+
+    n = len & ~(size_t)(flash->align - 1);
+
+    if ((n > 0) && (flash->prog(flash->addr + flash->off, data, n) != 0)) {
+        set_errno(EIO);
+        return -1;
+    }
+
+    if (n < len) {
+        memset(tail, 0xFF, flash->align);
+        memcpy(tail, (const uint8_t *)data + n, len - n);
+
+        if (flash->prog(flash->addr + flash->off + n, tail, flash->align) != 0) {
+            set_errno(EIO);
+            return -1;
+        }
+    }
+
+    flash->off = end;
+
+    return 0;
+}
+
+int32_t al_ymodem_flash_sink(al_ymodem_sink_t *sink, al_ymodem_flash_t *flash)
+{
+    AL_CHECK_RET((sink != NULL) && (flash != NULL), EINVAL, -1);
+    AL_CHECK_RET((flash->prog != NULL) && (flash->erase != NULL), EINVAL, -1);
+    AL_CHECK_RET(is_power_of_2(flash->sector_size), EINVAL, -1);
+    AL_CHECK_RET(is_power_of_2(flash->align) &&
+                 (flash->align <= AL_YMODEM_FLASH_ALIGN_MAX) &&
+                 (flash->align <= flash->sector_size), EINVAL, -1);
+
+    flash->off = 0;
+    flash->erased = 0;
+
+    sink->open = ymodem_flash_open;
+    sink->write = ymodem_flash_write;
+    sink->close = NULL;
+    sink->ctx = flash;
+
+    return 0;
+}
+
+#if !defined(__ICCRL78__)
+static ssize_t ymodem_lfs_read(void *ctx, void *buf, size_t len)
+{
+    al_ymodem_lfs_t *f = (al_ymodem_lfs_t *)ctx;
+    lfs_ssize_t n = lfs_file_read(f->lfs, &f->file, buf, len);
+
+    if (n < 0) {
+        set_errno(EIO);
+        return -1;
+    }
+
+    return n;
+}
+
+static int32_t ymodem_lfs_close(void *ctx)
+{
+    al_ymodem_lfs_t *f = (al_ymodem_lfs_t *)ctx;
+
+    if (!f->open) {
+        return 0;
+    }
+
+    f->open = false;
+
+    if (lfs_file_close(f->lfs, &f->file) != 0) {
+        set_errno(EIO);
+        return -1;
+    }
+
+    return 0;
+}
+
+ssize_t al_ymodem_lfs_source(al_ymodem_source_t *src, al_ymodem_lfs_t *f,
+                             lfs_t *lfs, const char *path)
+{
+    lfs_soff_t size;
+
+    AL_CHECK_RET((src != NULL) && (f != NULL), EINVAL, -1);
+    AL_CHECK_RET((lfs != NULL) && (path != NULL), EINVAL, -1);
+
+    f->lfs = lfs;
+    f->path = path;
+    f->open = false;
+
+    if (lfs_file_open(lfs, &f->file, path, LFS_O_RDONLY) != 0) {
+        set_errno(ENOENT);
+        return -1;
+    }
+
+    f->open = true;
+
+    size = lfs_file_size(lfs, &f->file);
+    if (size < 0) {
+        ymodem_lfs_close(f);
+        set_errno(EIO);
+        return -1;
+    }
+
+    src->read = ymodem_lfs_read;
+    src->close = ymodem_lfs_close;
+    src->ctx = f;
+
+    return size;
+}
+
+static int32_t ymodem_lfs_open(void *ctx, const char *filename, size_t filesize)
+{
+    al_ymodem_lfs_t *f = (al_ymodem_lfs_t *)ctx;
+    const char *path = (f->path != NULL) ? f->path : filename;
+
+    AL_CHECK_RET(strlen(path) < sizeof(f->name), ENAMETOOLONG, -1);
+
+    strcpy(f->name, path);
+
+    if (lfs_file_open(f->lfs, &f->file, f->name,
+                      LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) != 0) {
+        set_errno(EIO);
+        return -1;
+    }
+
+    f->open = true;
+
+    return 0;
+}
+
+static int32_t ymodem_lfs_write(void *ctx, const void *data, size_t len)
+{
+    al_ymodem_lfs_t *f = (al_ymodem_lfs_t *)ctx;
+
+    if (lfs_file_write(f->lfs, &f->file, data, len) != (lfs_ssize_t)len) {
+        set_errno(EIO);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int32_t ymodem_lfs_sink_close(void *ctx, bool ok)
+{
+    al_ymodem_lfs_t *f = (al_ymodem_lfs_t *)ctx;
+    int32_t ret = ymodem_lfs_close(f);
+
+    /* a partial file is worse than none */
+    if ((!ok || (ret != 0)) && (lfs_remove(f->lfs, f->name) != 0)) {
+        set_errno(EIO);
+        return -1;
+    }
+
+    return ok ? ret : 0;
+}
+
+int32_t al_ymodem_lfs_sink(al_ymodem_sink_t *sink, al_ymodem_lfs_t *f,
+                           lfs_t *lfs, const char *path)
+{
+    AL_CHECK_RET((sink != NULL) && (f != NULL) && (lfs != NULL), EINVAL, -1);
+
+    f->lfs = lfs;
+    f->path = path;
+    f->open = false;
+    f->name[0] = '\0';
+
+    sink->open = ymodem_lfs_open;
+    sink->write = ymodem_lfs_write;
+    sink->close = ymodem_lfs_sink_close;
+    sink->ctx = f;
+
+    return 0;
+}
+#endif
+
+__END_DECLS